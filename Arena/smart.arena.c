@@ -0,0 +1,400 @@
+/*----------------------------------------------------------------------------
+  Smart Arena
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Arena application programmer's interface (API) implementation file
+  ----------------------------------------------------------------------------*/
+
+#include <string.h>
+
+#include "compilation.t.h"
+#include "types.t.h"
+#include "smart.memory.t.h"
+#include "smart.memory.i.h"
+
+/*----------------------------------------------------------------------------
+  Private defines, data types and function prototypes
+  ----------------------------------------------------------------------------*/
+
+#include "smart.arena.h"
+
+/*----------------------------------------------------------------------------
+  Public data types and function prototypes
+  ----------------------------------------------------------------------------*/
+
+#include "smart.arena.t.h"
+#include "smart.arena.i.h"
+
+/*----------------------------------------------------------------------------
+  Public functions
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartArenaConstructSmartArena
+(
+    smartArenaHandle * pArena,
+    size_t pChunkSize
+)
+{
+    /*
+    ** there is no arena handle
+    */
+
+    if (NULL == pArena)
+    {
+        return(FALSE);
+    }
+
+    if (0 == pChunkSize)
+    {
+        pChunkSize = ARENA_DEFAULT_CHUNK_SIZE;
+    }
+
+    pChunkSize = (pChunkSize + SafePageSize() - 1) & ~(SafePageSize() - 1);
+
+    if (!SafeMalloc(pArena, sizeof(smartArena)))
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** initialize the allocator interface, blocks are released in bulk
+    */
+
+    (* pArena)->allocator.allocate = ArenaAllocate;
+    (* pArena)->allocator.allocateZeroed = ArenaAllocateZeroed;
+    (* pArena)->allocator.allocateAligned = ArenaAllocateAligned;
+    (* pArena)->allocator.reallocate = ArenaReallocate;
+    (* pArena)->allocator.deallocate = NULL;
+    (* pArena)->allocator.context = *pArena;
+
+    (* pArena)->current = NULL;
+    (* pArena)->chunkSize = pChunkSize;
+
+    (* pArena)->memoryAllocated = sizeof(smartArena);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS smartAllocatorHandle CALLING_CONVENTION SmartArenaGetAllocator
+(
+    smartArenaHandle pArena
+)
+{
+    /*
+    ** there is no arena
+    */
+
+    if (NULL == pArena)
+    {
+        return(NULL);
+    }
+
+    return(&pArena->allocator);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartArenaGetMark
+(
+    smartArenaHandle pArena,
+    smartArenaMark * pMark
+)
+{
+    /*
+    ** there is no arena or mark
+    */
+
+    if (NULL == pArena || NULL == pMark)
+    {
+        return(FALSE);
+    }
+
+    pMark->chunk = pArena->current;
+    pMark->used = (NULL == pArena->current) ? 0 : pArena->current->used;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartArenaRewind
+(
+    smartArenaHandle pArena,
+    const smartArenaMark * pMark
+)
+{
+    smartArenaChunk * lChunk;
+
+    /*
+    ** there is no arena or mark
+    */
+
+    if (NULL == pArena || NULL == pMark)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** the marked chunk must still belong to the arena
+    */
+
+    for (lChunk = pArena->current; lChunk != pMark->chunk; lChunk = lChunk->previous)
+    {
+        if (NULL == lChunk)
+        {
+            return(FALSE);
+        }
+    }
+
+    if (NULL != lChunk && lChunk->used < pMark->used)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** release the newer chunks and rewind the marked chunk
+    */
+
+    if (!ArenaChunkRelease(pArena, (smartArenaChunk *) pMark->chunk))
+    {
+        return(FALSE);
+    }
+
+    if (NULL != pArena->current)
+    {
+        pArena->current->used = pMark->used;
+    }
+
+    return(TRUE);
+}
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartArenaGetMemoryAllocated
+(
+    smartArenaHandle pArena
+)
+{
+    /*
+    ** there is no arena
+    */
+
+    if (NULL == pArena)
+    {
+        return(0);
+    }
+
+    return(pArena->memoryAllocated);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartArenaDestructSmartArena
+(
+    smartArenaHandle * pArena
+)
+{
+    /*
+    ** there is no arena
+    */
+
+    if (NULL == pArena || NULL == *pArena)
+    {
+        return(TRUE);
+    }
+
+    if (!ArenaChunkRelease(*pArena, NULL))
+    {
+        return(FALSE);
+    }
+
+    SafeFree(pArena);
+
+    return(TRUE);
+}
+
+/*----------------------------------------------------------------------------
+  Private functions
+  ----------------------------------------------------------------------------*/
+
+static void * ArenaAllocate
+(
+    void * pContext,
+    size_t pSize
+)
+{
+    return(ArenaAllocateAligned(pContext, pSize, ARENA_ALIGNMENT));
+}
+
+static void * ArenaAllocateAligned
+(
+    void * pContext,
+    size_t pSize,
+    size_t pAlignment
+)
+{
+    smartArenaHandle lArena = (smartArenaHandle) pContext;
+    smartArenaChunk * lChunk = lArena->current;
+
+    size_t lChunkSize;
+    size_t lPadding = 0;
+
+    void * lBlock;
+
+    if (pAlignment < ARENA_ALIGNMENT)
+    {
+        pAlignment = ARENA_ALIGNMENT;
+    }
+
+    pSize = ArenaAlign(pSize);
+
+    if (NULL != lChunk)
+    {
+        lPadding = (size_t) (0 - ((size_t) lChunk + lChunk->used)) & (pAlignment - 1);
+    }
+
+    if (NULL == lChunk || lChunk->size - lChunk->used < lPadding + pSize)
+    {
+        /*
+        ** map a new chunk (oversized requests get a chunk of their own size)
+        */
+
+        lChunkSize = lArena->chunkSize;
+
+        if (lChunkSize < ARENA_CHUNK_HEADER_SIZE + pAlignment - ARENA_ALIGNMENT + pSize)
+        {
+            lChunkSize = (ARENA_CHUNK_HEADER_SIZE + pAlignment - ARENA_ALIGNMENT + pSize + SafePageSize() - 1) & ~(SafePageSize() - 1);
+        }
+
+        lChunk = NULL;
+
+        if (!SafePageAlloc(&lChunk, lChunkSize, 0))
+        {
+            return(NULL);
+        }
+
+        lChunk->previous = lArena->current;
+        lChunk->size = lChunkSize;
+        lChunk->used = ARENA_CHUNK_HEADER_SIZE;
+
+        lArena->current = lChunk;
+
+        lArena->memoryAllocated += lChunkSize;
+
+        lPadding = (size_t) (0 - ((size_t) lChunk + lChunk->used)) & (pAlignment - 1);
+    }
+
+    lBlock = (char *) lChunk + lChunk->used + lPadding;
+
+    lChunk->used += lPadding + pSize;
+
+    return(lBlock);
+}
+
+static void * ArenaAllocateZeroed
+(
+    void * pContext,
+    size_t pSize
+)
+{
+    void * lBlock = ArenaAllocate(pContext, pSize);
+
+    if (NULL != lBlock)
+    {
+        memset(lBlock, 0, pSize);
+    }
+
+    return(lBlock);
+}
+
+static void * ArenaReallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pOldSize,
+    size_t pSize
+)
+{
+    smartArenaHandle lArena = (smartArenaHandle) pContext;
+    smartArenaChunk * lChunk = lArena->current;
+
+    void * lBlock;
+
+    if (NULL == pBuffer)
+    {
+        return(ArenaAllocate(pContext, pSize));
+    }
+
+    /*
+    ** grow or shrink the most recent block in place
+    */
+
+    if (NULL != lChunk && (char *) pBuffer + ArenaAlign(pOldSize) == (char *) lChunk + lChunk->used)
+    {
+        if (lChunk->size - (lChunk->used - ArenaAlign(pOldSize)) >= ArenaAlign(pSize))
+        {
+            lChunk->used = lChunk->used - ArenaAlign(pOldSize) + ArenaAlign(pSize);
+
+            return(pBuffer);
+        }
+    }
+
+    lBlock = ArenaAllocate(pContext, pSize);
+
+    if (NULL != lBlock)
+    {
+        memcpy(lBlock, pBuffer, (pOldSize < pSize) ? pOldSize : pSize);
+    }
+
+    return(lBlock);
+}
+
+static Bool ArenaChunkRelease
+(
+    smartArenaHandle pArena,
+    smartArenaChunk * pChunk
+)
+{
+    smartArenaChunk * lChunk;
+    smartArenaChunk * lPrevious;
+
+    size_t lChunkSize;
+
+    for (lChunk = pArena->current; pChunk != lChunk; lChunk = lPrevious)
+    {
+        lPrevious = lChunk->previous;
+        lChunkSize = lChunk->size;
+
+        if (!SafePageFree(&lChunk, lChunkSize))
+        {
+            return(FALSE);
+        }
+
+        pArena->current = lPrevious;
+
+        pArena->memoryAllocated -= lChunkSize;
+    }
+
+    return(TRUE);
+}
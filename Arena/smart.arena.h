@@ -0,0 +1,181 @@
+/*----------------------------------------------------------------------------
+  Smart Arena
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Arena internal header file
+  ----------------------------------------------------------------------------*/
+
+#ifndef SMART_ARENA_H
+#define SMART_ARENA_H
+
+/*----------------------------------------------------------------------------
+  Private defines
+  ----------------------------------------------------------------------------*/
+
+#define ARENA_ALIGNMENT          ((size_t) 16)
+
+#define ARENA_DEFAULT_CHUNK_SIZE ((size_t) 1024 * 1024)
+
+#define ArenaAlign(pSize) (((pSize) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1))
+
+/*----------------------------------------------------------------------------
+  Private data types
+  ----------------------------------------------------------------------------*/
+
+typedef struct smartArenaChunk {
+    struct smartArenaChunk * previous;
+
+    size_t size;
+    size_t used;
+} smartArenaChunk;
+
+#define ARENA_CHUNK_HEADER_SIZE ArenaAlign(sizeof(smartArenaChunk))
+
+typedef struct smartArena {
+    smartAllocator allocator;
+
+    smartArenaChunk * current;
+    size_t chunkSize;
+
+    size_t memoryAllocated;
+} smartArena;
+
+typedef smartArena * smartArenaHandle;
+
+/*----------------------------------------------------------------------------
+  Private function prototypes
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  ArenaAllocate()
+  ----------------------------------------------------------------------------
+  Bump allocate a block from the current chunk, mapping a new chunk when the
+  current chunk cannot hold the request
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pContext - (I) The arena handle
+  pSize    - (I) The number of bytes requested
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  NULL - A new chunk could not be mapped
+
+  void * - The block
+  ----------------------------------------------------------------------------*/
+
+static void * ArenaAllocate
+(
+    void * pContext,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  ArenaAllocateAligned()
+  ----------------------------------------------------------------------------
+  ArenaAllocate() for a block whose address is a multiple of pAlignment. The
+  gap skipped to reach the aligned address is left unused.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pContext   - (I) The arena handle
+  pSize      - (I) The number of bytes requested
+  pAlignment - (I) The required alignment, a power of two
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  NULL - A new chunk could not be mapped
+
+  void * - The block
+  ----------------------------------------------------------------------------*/
+
+static void * ArenaAllocateAligned
+(
+    void * pContext,
+    size_t pSize,
+    size_t pAlignment
+);
+
+/*----------------------------------------------------------------------------
+  ArenaAllocateZeroed()
+  ----------------------------------------------------------------------------
+  ArenaAllocate() followed by zero filling the requested bytes (rewound
+  chunks are reused so their contents are not known to be zero)
+  ----------------------------------------------------------------------------*/
+
+static void * ArenaAllocateZeroed
+(
+    void * pContext,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  ArenaReallocate()
+  ----------------------------------------------------------------------------
+  Resize a block in place when it is the most recent block of the current
+  chunk and the chunk has room, otherwise copy it to a new block (the old
+  block is released with the arena)
+  ----------------------------------------------------------------------------*/
+
+static void * ArenaReallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pOldSize,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  ArenaChunkRelease()
+  ----------------------------------------------------------------------------
+  Return chunks to the operating system, newest first, until the chunk
+  passed becomes the current chunk
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pArena - (I) The arena handle
+  pChunk - (I) The chunk to stop at (NULL releases every chunk)
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The chunks were released
+
+  False - A SafePageFree() failed
+  ----------------------------------------------------------------------------*/
+
+static Bool ArenaChunkRelease
+(
+    smartArenaHandle pArena,
+    smartArenaChunk * pChunk
+);
+
+#endif
@@ -0,0 +1,216 @@
+/*----------------------------------------------------------------------------
+  Smart Arena
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Arena application programmer's interface (API) header file
+  ----------------------------------------------------------------------------*/
+
+#ifndef SMART_ARENA_I_H
+#define SMART_ARENA_I_H
+
+/*----------------------------------------------------------------------------
+  SmartArenaConstructSmartArena()
+  ----------------------------------------------------------------------------
+  Construct an empty region (arena) allocator.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pArena     - (I/O) Pointer to recieve the arena handle
+  pChunkSize - (I)   The number of bytes in each chunk (zero selects 1M)
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Arena was succesfully constructed
+
+  False - Arena was not successfully constructed due to:
+
+          1. The arena handle pointer was NULL
+          2. The SafeMalloc() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  This function requires the contents of the pArena handle to be initialized
+  to NULL prior to calling this function.
+
+  Blocks are bump allocated from large chunks obtained with SafePageAlloc().
+  Individual blocks are never returned; every block is released at once by
+  SmartArenaRewind() or SmartArenaDestructSmartArena(). Requests larger than
+  a chunk are given a chunk of their own.
+
+  An arena is not thread safe.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartArenaConstructSmartArena
+(
+    smartArenaHandle * pArena,
+    size_t pChunkSize
+);
+
+/*----------------------------------------------------------------------------
+  SmartArenaGetAllocator()
+  ----------------------------------------------------------------------------
+  Get the allocator interface of an arena.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pArena - (I) Arena handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  NULL - There is no arena
+
+  smartAllocatorHandle - The allocator to pass to SmartAllocatorMalloc() or a
+                         container constructor
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The allocator has no deallocate function. SmartAllocatorFree() of an arena
+  block only clears the pointer and the accounting, and trees and stacks
+  bound to an arena skip the per node walk when they are destructed.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS smartAllocatorHandle CALLING_CONVENTION SmartArenaGetAllocator
+(
+    smartArenaHandle pArena
+);
+
+/*----------------------------------------------------------------------------
+  SmartArenaGetMark()
+  ----------------------------------------------------------------------------
+  Record the current allocation position of an arena.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pArena - (I) Arena handle
+  pMark  - (O) The position
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The position was recorded
+
+  False - The position was not recorded due to:
+
+          1. The arena handle was NULL
+          2. The mark pointer was NULL
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartArenaGetMark
+(
+    smartArenaHandle pArena,
+    smartArenaMark * pMark
+);
+
+/*----------------------------------------------------------------------------
+  SmartArenaRewind()
+  ----------------------------------------------------------------------------
+  Release every block allocated since a mark was recorded.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pArena - (I) Arena handle
+  pMark  - (I) A position recorded by SmartArenaGetMark()
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The arena was rewound
+
+  False - The arena was not rewound due to:
+
+          1. The arena handle was NULL
+          2. The mark pointer was NULL
+          3. The mark does not belong to the arena (or was released by an
+             earlier rewind)
+          4. A SafePageFree() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Chunks mapped after the mark are returned to the operating system. Any
+  container constructed after the mark becomes invalid and must not be used
+  (or destructed) afterwards.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartArenaRewind
+(
+    smartArenaHandle pArena,
+    const smartArenaMark * pMark
+);
+
+/*----------------------------------------------------------------------------
+  SmartArenaGetMemoryAllocated()
+  ----------------------------------------------------------------------------
+  Get the number of bytes mapped by an arena.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pArena - (I) Arena handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  The number of bytes in the chunks and control structure of the arena
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartArenaGetMemoryAllocated
+(
+    smartArenaHandle pArena
+);
+
+/*----------------------------------------------------------------------------
+  SmartArenaDestructSmartArena()
+  ----------------------------------------------------------------------------
+  Destruct an arena, releasing every block allocated from it.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pArena - (I/O) Pointer to the arena handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Arena was succesfully destructed
+
+  False - Arena was not successfully destructed due to:
+
+          1. A SafePageFree() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The cost is one SafePageFree() per chunk regardless of the number of
+  blocks. Trees and stacks constructed in the arena are released with it;
+  their handles must not be used afterwards. They may optionally be
+  destructed first, which is cheap as their nodes are not visited.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartArenaDestructSmartArena
+(
+    smartArenaHandle * pArena
+);
+
+#endif
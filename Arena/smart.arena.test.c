@@ -0,0 +1,567 @@
+/*----------------------------------------------------------------------------
+  Smart Arena test application
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Arena test program implementation file
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Standard libraries
+  ----------------------------------------------------------------------------*/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*----------------------------------------------------------------------------
+  Public data types
+  ----------------------------------------------------------------------------*/
+
+#include "compilation.t.h"
+#include "types.t.h"
+
+#include "smart.memory.t.h"
+#include "smart.arena.t.h"
+#include "smart.tree.t.h"
+#include "smart.stack.t.h"
+
+/*----------------------------------------------------------------------------
+  Public functions
+  ----------------------------------------------------------------------------*/
+
+#include "smart.memory.i.h"
+
+#include "smart.arena.i.h"
+#include "smart.tree.i.h"
+#include "smart.stack.i.h"
+
+/*----------------------------------------------------------------------------
+  Private defines, data types and function prototypes
+  ----------------------------------------------------------------------------*/
+
+#include "smart.arena.test.h"
+
+/*----------------------------------------------------------------------------
+  <Eeek> Globals </Eeek>
+  ----------------------------------------------------------------------------*/
+
+smartArenaHandle gArena;
+
+void * gNodes[TEST_NODES];
+void * gKeys[TEST_NODES];
+void * gData[TEST_NODES];
+
+size_t gSizes[TEST_NODES];
+
+/*----------------------------------------------------------------------------
+  Main
+  ----------------------------------------------------------------------------*/
+
+void main
+(
+    void
+)
+{
+    int lOption;
+
+    srand(TEST_SEED);
+
+    SmartArenaConstructSmartArena(&gArena, (size_t) 0);
+
+    do
+    {
+        printf("Option: ");
+
+        do
+        {
+            lOption = toupper(fgetc(stdin));
+        }
+        while (!isprint(lOption)); /* eat carriage returns (etc) */
+
+        switch ((char) lOption)
+        {
+            case '?':
+            {
+                DisplayOptions();
+                break;
+            }
+
+            case 'Q':
+            {
+                SmartArenaDestructSmartArena(&gArena);
+                break;
+            }
+
+            case 'P':
+            {
+                IteratedTeardownPerformanceTest();
+                break;
+            }
+
+            case 'M':
+            {
+                IteratedMarkRewindTest();
+                break;
+            }
+
+            case 'C':
+            {
+                ContainerRegionTest();
+                break;
+            }
+
+            case 'I':
+            {
+                OutputArenaInformation(stdout);
+                break;
+            }
+
+            default:
+            {
+                printf("Valid options are P,M,C,I,Q,?\n");
+                break;
+            }
+        }
+    }
+    while ('Q' != lOption);
+}
+
+void DisplayOptions
+(
+    void
+)
+{
+    printf("\n"
+           "Options:\n"
+           "(P) Iterated construct/teardown performance test (SmartMalloc vs arena)\n"
+           "(M) Iterated mark and rewind test\n"
+           "(C) Tree and stack built in the arena test\n\n"
+           "(I) Display arena information\n\n"
+           "(Q) Quit\n"
+           "(?) Display this option list\n"
+           "\n");
+}
+
+void OutputArenaInformation
+(
+    FILE * pFile
+)
+{
+    fprintf(pFile, "Memory Allocated = %ld\n\n", SmartArenaGetMemoryAllocated(gArena));
+}
+
+void IteratedTeardownPerformanceTest
+(
+    void
+)
+{
+    unsigned long lIterations;
+    unsigned long lIteration;
+
+    unsigned long lNodeIndex;
+
+    size_t lMemoryUsed;
+
+    smartArenaHandle lArena;
+    smartAllocatorHandle lAllocator;
+
+    clock_t lStartTime;
+
+    double lMallocConstructSeconds = 0, lMallocTeardownSeconds = 0;
+    double lArenaConstructSeconds = 0, lArenaTeardownSeconds = 0;
+
+    printf("\n");
+    printf("Iterations: ");
+    scanf("%ld", &lIterations);
+
+    for (lIteration = 1; lIteration <= lIterations; lIteration++)
+    {
+        printf("Iteration : %ld ", lIteration);
+
+        /*
+        ** node by node construction and destruction
+        */
+
+        memset(gNodes, 0, sizeof(gNodes));
+        memset(gKeys, 0, sizeof(gKeys));
+        memset(gData, 0, sizeof(gData));
+
+        lMemoryUsed = 0;
+
+        lStartTime = clock();
+
+        for (lNodeIndex = 0; lNodeIndex < TEST_NODES; lNodeIndex++)
+        {
+            SmartMalloc(&gNodes[lNodeIndex], NODE_ELEMENT_SIZE, &lMemoryUsed);
+            SmartMalloc(&gKeys[lNodeIndex], KEY_ELEMENT_SIZE, &lMemoryUsed);
+            SmartMalloc(&gData[lNodeIndex], DATA_ELEMENT_SIZE, &lMemoryUsed);
+        }
+
+        lMallocConstructSeconds += ((double) (clock() - lStartTime)) / CLOCKS_PER_SEC;
+
+        lStartTime = clock();
+
+        for (lNodeIndex = 0; lNodeIndex < TEST_NODES; lNodeIndex++)
+        {
+            SmartFree(&gData[lNodeIndex], DATA_ELEMENT_SIZE, &lMemoryUsed);
+            SmartFree(&gKeys[lNodeIndex], KEY_ELEMENT_SIZE, &lMemoryUsed);
+            SmartFree(&gNodes[lNodeIndex], NODE_ELEMENT_SIZE, &lMemoryUsed);
+        }
+
+        lMallocTeardownSeconds += ((double) (clock() - lStartTime)) / CLOCKS_PER_SEC;
+
+        printf(">");
+
+        /*
+        ** arena construction and bulk release
+        */
+
+        memset(gNodes, 0, sizeof(gNodes));
+        memset(gKeys, 0, sizeof(gKeys));
+        memset(gData, 0, sizeof(gData));
+
+        lMemoryUsed = 0;
+
+        lArena = NULL;
+
+        lStartTime = clock();
+
+        SmartArenaConstructSmartArena(&lArena, (size_t) 0);
+
+        lAllocator = SmartArenaGetAllocator(lArena);
+
+        for (lNodeIndex = 0; lNodeIndex < TEST_NODES; lNodeIndex++)
+        {
+            SmartAllocatorMalloc(lAllocator, &gNodes[lNodeIndex], NODE_ELEMENT_SIZE, &lMemoryUsed);
+            SmartAllocatorMalloc(lAllocator, &gKeys[lNodeIndex], KEY_ELEMENT_SIZE, &lMemoryUsed);
+            SmartAllocatorMalloc(lAllocator, &gData[lNodeIndex], DATA_ELEMENT_SIZE, &lMemoryUsed);
+        }
+
+        lArenaConstructSeconds += ((double) (clock() - lStartTime)) / CLOCKS_PER_SEC;
+
+        lStartTime = clock();
+
+        SmartArenaDestructSmartArena(&lArena);
+
+        lArenaTeardownSeconds += ((double) (clock() - lStartTime)) / CLOCKS_PER_SEC;
+
+        printf("<");
+
+        printf("\r");
+    }
+
+    printf("\n\n");
+
+    printf("SmartMalloc Construct Timer: %9.3f secs %12.0f nodes/sec\n", lMallocConstructSeconds, ((double) (lIterations * TEST_NODES)) / lMallocConstructSeconds);
+    printf("SmartFree Teardown Timer:    %9.3f secs %12.0f nodes/sec\n", lMallocTeardownSeconds, ((double) (lIterations * TEST_NODES)) / lMallocTeardownSeconds);
+    printf("Arena Construct Timer:       %9.3f secs %12.0f nodes/sec\n", lArenaConstructSeconds, ((double) (lIterations * TEST_NODES)) / lArenaConstructSeconds);
+    printf("Arena Teardown Timer:        %9.3f secs %12.0f nodes/sec\n", lArenaTeardownSeconds, ((double) (lIterations * TEST_NODES)) / lArenaTeardownSeconds);
+    printf("\n");
+}
+
+void IteratedMarkRewindTest
+(
+    void
+)
+{
+    unsigned long lIterations;
+    unsigned long lIteration;
+
+    unsigned long lIndex;
+    unsigned long lMarkIndex;
+
+    size_t lMemoryUsed = 0;
+    size_t lMarkedMemory = 0;
+
+    smartArenaMark lMark;
+
+    smartAllocatorHandle lAllocator = SmartArenaGetAllocator(gArena);
+
+    printf("\n");
+    printf("Iterations: ");
+    scanf("%ld", &lIterations);
+
+    for (lIteration = 1; lIteration <= lIterations; lIteration++)
+    {
+        printf("Iteration : %ld ", lIteration);
+
+        memset(gNodes, 0, sizeof(gNodes));
+
+        lMarkIndex = rand() % TEST_NODES;
+
+        for (lIndex = 0; lIndex < TEST_NODES; lIndex++)
+        {
+            if (lMarkIndex == lIndex)
+            {
+                SmartArenaGetMark(gArena, &lMark);
+
+                lMarkedMemory = SmartArenaGetMemoryAllocated(gArena);
+            }
+
+            gSizes[lIndex] = (size_t) (1 + rand() % TEST_MAXIMUM_BLOCK_SIZE);
+
+            if (!SmartAllocatorMalloc(lAllocator, &gNodes[lIndex], gSizes[lIndex], &lMemoryUsed))
+            {
+                printf("Allocation failed: block %ld\n", lIndex);
+                break;
+            }
+
+            FillBlock(gNodes[lIndex], gSizes[lIndex], lIndex);
+        }
+
+        printf(">");
+
+        /*
+        ** blocks allocated before the mark survive the rewind
+        */
+
+        if (!SmartArenaRewind(gArena, &lMark))
+        {
+            printf("Rewind failed\n");
+        }
+
+        if (lMarkedMemory != SmartArenaGetMemoryAllocated(gArena))
+        {
+            printf("Rewind memory disagreement: marked %ld rewound %ld\n", lMarkedMemory, SmartArenaGetMemoryAllocated(gArena));
+        }
+
+        for (lIndex = 0; lIndex < lMarkIndex; lIndex++)
+        {
+            if (!CheckBlock(gNodes[lIndex], gSizes[lIndex], lIndex))
+            {
+                printf("Block content disagreement: block %ld\n", lIndex);
+                break;
+            }
+        }
+
+        /*
+        ** rewinding to the very beginning empties the arena
+        */
+
+        lMark.chunk = NULL;
+        lMark.used = 0;
+
+        SmartArenaRewind(gArena, &lMark);
+
+        printf("<");
+
+        printf("\r");
+    }
+
+    printf("\n\n");
+}
+
+void ContainerRegionTest
+(
+    void
+)
+{
+    smartTreeHandle lTree = NULL;
+    smartStackHandle lStack = NULL;
+
+    smartTreeNodeHandle lTreeNode;
+    smartStackNodeHandle lStackNode;
+
+    long * lKeyPointer;
+    char * lDataPointer;
+
+    unsigned long lIndex;
+
+    size_t lMarkedMemory;
+    size_t lFilledMemory;
+
+    smartArenaMark lMark;
+
+    smartAllocatorHandle lAllocator = SmartArenaGetAllocator(gArena);
+
+    clock_t lStartTime;
+
+    double lDestructSeconds;
+
+    Bool lPassed = TRUE;
+
+    SmartArenaGetMark(gArena, &lMark);
+
+    lMarkedMemory = SmartArenaGetMemoryAllocated(gArena);
+
+    /*
+    ** a tree and a stack whose control structures and nodes all live in the
+    ** arena
+    */
+
+    if (!SmartTreeConstructSmartTreeWithAllocator(&lTree, CompareKeys, (size_t) 0, lAllocator) || !SmartStackConstructSmartStackWithAllocator(&lStack, (size_t) 0, lAllocator))
+    {
+        printf("Container construction failed\n");
+
+        SmartTreeDestructSmartTree(&lTree);
+        SmartArenaRewind(gArena, &lMark);
+        return;
+    }
+
+    for (lIndex = 0; lIndex < TEST_CONTAINER_NODES; lIndex++)
+    {
+        lTreeNode = NULL;
+        lKeyPointer = NULL;
+        lDataPointer = NULL;
+
+        if (!SmartTreeConstructNode(lTree, &lTreeNode, (smartTreeKeyHandle *) &lKeyPointer, sizeof(long), (smartTreeDataHandle *) &lDataPointer, (size_t) DATA_ELEMENT_SIZE))
+        {
+            printf("Tree node construction failed: node %ld\n", lIndex);
+            lPassed = FALSE;
+            break;
+        }
+
+        *lKeyPointer = (long) lIndex;
+        sprintf(lDataPointer, "Entry #%06ld", lIndex + 1);
+
+        SmartTreeInsertNode(lTree, lTreeNode);
+
+        lStackNode = NULL;
+        lDataPointer = NULL;
+
+        if (!SmartStackConstructNode(lStack, &lStackNode, (smartStackDataHandle *) &lDataPointer, (size_t) DATA_ELEMENT_SIZE))
+        {
+            printf("Stack node construction failed: node %ld\n", lIndex);
+            lPassed = FALSE;
+            break;
+        }
+
+        sprintf(lDataPointer, "Entry #%06ld", lIndex + 1);
+
+        SmartStackPushNode(lStack, lStackNode);
+    }
+
+    if (!SmartTreeIsValid(lTree) || TEST_CONTAINER_NODES != SmartTreeGetNodeCount(SmartTreeGetRoot(lTree)))
+    {
+        printf("Tree disagreement: %ld nodes\n", SmartTreeGetNodeCount(SmartTreeGetRoot(lTree)));
+        lPassed = FALSE;
+    }
+
+    if (!SmartStackIsValid(lStack) || TEST_CONTAINER_NODES != SmartStackGetDepth(lStack))
+    {
+        printf("Stack disagreement: %ld nodes\n", SmartStackGetDepth(lStack));
+        lPassed = FALSE;
+    }
+
+    lFilledMemory = SmartArenaGetMemoryAllocated(gArena);
+
+    /*
+    ** destructing a container bound to a region leaves its nodes to the
+    ** region rather than visiting them
+    */
+
+    lStartTime = clock();
+
+    if (!SmartTreeDestructSmartTree(&lTree) || NULL != lTree)
+    {
+        printf("Tree destruction failed\n");
+        lPassed = FALSE;
+    }
+
+    if (!SmartStackDestructSmartStack(&lStack) || NULL != lStack)
+    {
+        printf("Stack destruction failed\n");
+        lPassed = FALSE;
+    }
+
+    lDestructSeconds = (double) (clock() - lStartTime) / CLOCKS_PER_SEC;
+
+    /*
+    ** the rewind releases every node at once
+    */
+
+    if (!SmartArenaRewind(gArena, &lMark))
+    {
+        printf("Rewind failed\n");
+        lPassed = FALSE;
+    }
+
+    if (lMarkedMemory != SmartArenaGetMemoryAllocated(gArena))
+    {
+        printf("Rewind memory disagreement: marked %ld rewound %ld\n", lMarkedMemory, SmartArenaGetMemoryAllocated(gArena));
+        lPassed = FALSE;
+    }
+
+    printf("\n");
+    printf("Nodes per container = %ld\n", (unsigned long) TEST_CONTAINER_NODES);
+    printf("Arena filled        = %ld bytes\n", lFilledMemory);
+    printf("Arena rewound       = %ld bytes\n", SmartArenaGetMemoryAllocated(gArena));
+    printf("Destruct time       = %.6f secs\n", lDestructSeconds);
+    printf("\n");
+    printf("Container region test: %s\n\n", lPassed ? "OK" : "FAILED");
+}
+
+long CompareKeys
+(
+    const smartTreeKeyHandle pKey1,
+    const smartTreeKeyHandle pKey2
+)
+{
+    return(* (long *) pKey1 - * (long *) pKey2);
+}
+
+void FillBlock
+(
+    unsigned char * pBlock,
+    size_t pSize,
+    unsigned long pSeed
+)
+{
+    size_t lByte;
+
+    for (lByte = 0; lByte < pSize; lByte++)
+    {
+        pBlock[lByte] = (unsigned char) (pSeed + lByte);
+    }
+}
+
+Bool CheckBlock
+(
+    unsigned char * pBlock,
+    size_t pSize,
+    unsigned long pSeed
+)
+{
+    size_t lByte;
+
+    for (lByte = 0; lByte < pSize; lByte++)
+    {
+        if ((unsigned char) (pSeed + lByte) != pBlock[lByte])
+        {
+            return(FALSE);
+        }
+    }
+
+    return(TRUE);
+}
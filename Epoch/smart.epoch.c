@@ -0,0 +1,718 @@
+/*----------------------------------------------------------------------------
+  Smart Epoch
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Epoch application programmer's interface (API) implementation file
+  ----------------------------------------------------------------------------*/
+
+#include <stdatomic.h>
+#include <threads.h>
+
+#include "compilation.t.h"
+#include "types.t.h"
+#include "smart.memory.t.h"
+#include "smart.memory.i.h"
+
+/*----------------------------------------------------------------------------
+  Private defines, data types and function prototypes
+  ----------------------------------------------------------------------------*/
+
+#include "smart.epoch.h"
+
+/*----------------------------------------------------------------------------
+  Public function prototypes
+  ----------------------------------------------------------------------------*/
+
+#include "smart.epoch.i.h"
+
+/*----------------------------------------------------------------------------
+  Public functions
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochConstructSmartEpoch
+(
+    smartEpochHandle * pEpoch
+)
+{
+    /*
+    ** there is no domain handle
+    */
+
+    if (NULL == pEpoch)
+    {
+        return(FALSE);
+    }
+
+    if (!SafeMalloc(pEpoch, sizeof(smartEpoch)))
+    {
+        return(FALSE);
+    }
+
+    if (thrd_success != mtx_init(&(* pEpoch)->lock, mtx_plain))
+    {
+        SafeFree(pEpoch);
+
+        return(FALSE);
+    }
+
+    atomic_init(&(* pEpoch)->epoch, 0);
+
+    (* pEpoch)->participants = NULL;
+    (* pEpoch)->orphans = NULL;
+
+    atomic_init(&(* pEpoch)->pendingBlocks, 0);
+    atomic_init(&(* pEpoch)->pendingBytes, 0);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochDestructSmartEpoch
+(
+    smartEpochHandle * pEpoch
+)
+{
+    /*
+    ** there is no domain
+    */
+
+    if (NULL == pEpoch || NULL == *pEpoch)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** a registered participant may still be reading
+    */
+
+    if (NULL != (* pEpoch)->participants)
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    /*
+    ** with no participants left every orphan batch is safe
+    */
+
+    EpochFreeBatches(*pEpoch, NULL, (* pEpoch)->orphans);
+
+    mtx_destroy(&(* pEpoch)->lock);
+
+    return(SafeFree(pEpoch));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochRegister
+(
+    smartEpochHandle pEpoch,
+    smartEpochParticipantHandle * pParticipant
+)
+{
+    /*
+    ** there is no domain or participant handle
+    */
+
+    if (NULL == pEpoch || NULL == pParticipant)
+    {
+        return(FALSE);
+    }
+
+    if (!SafeMalloc(pParticipant, sizeof(smartEpochParticipant)))
+    {
+        return(FALSE);
+    }
+
+    atomic_init(&(* pParticipant)->state, EpochState(0ULL, FALSE));
+
+    (* pParticipant)->domain = pEpoch;
+
+    (* pParticipant)->nesting = 0;
+    (* pParticipant)->retires = 0;
+
+    (* pParticipant)->batches = NULL;
+    (* pParticipant)->spare = NULL;
+
+    mtx_lock(&pEpoch->lock);
+
+    (* pParticipant)->next = pEpoch->participants;
+
+    pEpoch->participants = *pParticipant;
+
+    mtx_unlock(&pEpoch->lock);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochUnregister
+(
+    smartEpochParticipantHandle * pParticipant
+)
+{
+    smartEpochHandle lEpoch;
+
+    smartEpochParticipantHandle * lLink;
+
+    epochBatch * lBatch;
+
+    /*
+    ** there is no participant
+    */
+
+    if (NULL == pParticipant || NULL == *pParticipant)
+    {
+        return(FALSE);
+    }
+
+    if (0 != (* pParticipant)->nesting)
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    lEpoch = (* pParticipant)->domain;
+
+    mtx_lock(&lEpoch->lock);
+
+    for (lLink = &lEpoch->participants; *pParticipant != *lLink; lLink = &(* lLink)->next)
+    {
+        /* find the participant */
+    }
+
+    *lLink = (* pParticipant)->next;
+
+    /*
+    ** hand the batches that are not yet safe to the domain
+    */
+
+    while (NULL != (lBatch = (* pParticipant)->batches))
+    {
+        (* pParticipant)->batches = lBatch->next;
+
+        lBatch->next = lEpoch->orphans;
+
+        lEpoch->orphans = lBatch;
+    }
+
+    mtx_unlock(&lEpoch->lock);
+
+    if (NULL != (* pParticipant)->spare)
+    {
+        SafeFree(&(* pParticipant)->spare);
+    }
+
+    return(SafeFree(pParticipant));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochEnter
+(
+    smartEpochParticipantHandle pParticipant
+)
+{
+    /*
+    ** there is no participant
+    */
+
+    if (NULL == pParticipant)
+    {
+        return(FALSE);
+    }
+
+    if (0 == pParticipant->nesting++)
+    {
+        /*
+        ** publish the epoch observed before reading any shared pointer, the
+        ** fence orders the publication before the reads that follow
+        */
+
+        atomic_store(&pParticipant->state, EpochState(atomic_load(&pParticipant->domain->epoch), TRUE));
+
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochExit
+(
+    smartEpochParticipantHandle pParticipant
+)
+{
+    unsigned long long lState;
+
+    /*
+    ** there is no participant
+    */
+
+    if (NULL == pParticipant)
+    {
+        return(FALSE);
+    }
+
+    if (0 == pParticipant->nesting)
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    if (0 == --pParticipant->nesting)
+    {
+        /*
+        ** the release orders the reads of the critical section before the
+        ** participant is seen to have left it
+        */
+
+        lState = atomic_load_explicit(&pParticipant->state, memory_order_relaxed);
+
+        atomic_store_explicit(&pParticipant->state, EpochState(EpochStateEpoch(lState), FALSE), memory_order_release);
+    }
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochRetire
+(
+    smartEpochParticipantHandle pParticipant,
+    smartAllocatorHandle pAllocator,
+    void ** pBuffer,
+    size_t pSize,
+    smartBudgetHandle pBudget
+)
+{
+    epochRetired lRetired;
+
+    /*
+    ** there is no participant
+    */
+
+    if (NULL == pParticipant)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** there is no block
+    */
+
+    if (NULL == pBuffer || NULL == *pBuffer || 0 == pSize)
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    lRetired.buffer = *pBuffer;
+    lRetired.size = pSize;
+
+    lRetired.freeFunction = NULL;
+    lRetired.context = pAllocator;
+
+    lRetired.budget = pBudget;
+
+    if (!EpochRetire(pParticipant, &lRetired))
+    {
+        return(FALSE);
+    }
+
+    *pBuffer = NULL;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochRetireFunction
+(
+    smartEpochParticipantHandle pParticipant,
+    void ** pBuffer,
+    size_t pSize,
+    smartEpochFreeFunction pFreeFunction,
+    void * pContext
+)
+{
+    epochRetired lRetired;
+
+    /*
+    ** there is no participant
+    */
+
+    if (NULL == pParticipant)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** there is no block or no way to free it
+    */
+
+    if (NULL == pBuffer || NULL == *pBuffer || NULL == pFreeFunction)
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    lRetired.buffer = *pBuffer;
+    lRetired.size = pSize;
+
+    lRetired.freeFunction = pFreeFunction;
+    lRetired.context = pContext;
+
+    lRetired.budget = NULL;
+
+    if (!EpochRetire(pParticipant, &lRetired))
+    {
+        return(FALSE);
+    }
+
+    *pBuffer = NULL;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochReclaim
+(
+    smartEpochParticipantHandle pParticipant
+)
+{
+    /*
+    ** there is no participant
+    */
+
+    if (NULL == pParticipant)
+    {
+        return(FALSE);
+    }
+
+    EpochCollect(pParticipant, TRUE);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochSynchronize
+(
+    smartEpochParticipantHandle pParticipant
+)
+{
+    /*
+    ** there is no participant
+    */
+
+    if (NULL == pParticipant)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** the participant would hold back the epoch it is waiting for
+    */
+
+    if (0 != pParticipant->nesting)
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    /*
+    ** each pass advances the epoch at most once, the newest batch is safe
+    ** two advances after it was filled
+    */
+
+    while (NULL != pParticipant->batches)
+    {
+        EpochCollect(pParticipant, TRUE);
+
+        if (NULL != pParticipant->batches)
+        {
+            thrd_yield();
+        }
+    }
+
+    return(TRUE);
+}
+
+STORAGE_CLASS unsigned long long CALLING_CONVENTION SmartEpochGetEpoch
+(
+    smartEpochHandle pEpoch
+)
+{
+    /*
+    ** there is no domain
+    */
+
+    if (NULL == pEpoch)
+    {
+        return(0);
+    }
+
+    return(atomic_load(&pEpoch->epoch));
+}
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartEpochGetPending
+(
+    smartEpochHandle pEpoch
+)
+{
+    /*
+    ** there is no domain
+    */
+
+    if (NULL == pEpoch)
+    {
+        return(0);
+    }
+
+    return(atomic_load(&pEpoch->pendingBlocks));
+}
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartEpochGetPendingBytes
+(
+    smartEpochHandle pEpoch
+)
+{
+    /*
+    ** there is no domain
+    */
+
+    if (NULL == pEpoch)
+    {
+        return(0);
+    }
+
+    return(atomic_load(&pEpoch->pendingBytes));
+}
+
+/*----------------------------------------------------------------------------
+  Private functions
+  ----------------------------------------------------------------------------*/
+
+static Bool EpochRetire
+(
+    smartEpochParticipantHandle pParticipant,
+    epochRetired * pRetired
+)
+{
+    smartEpochHandle lEpoch = pParticipant->domain;
+
+    unsigned long long lGlobal = atomic_load(&lEpoch->epoch);
+
+    epochBatch * lBatch = pParticipant->batches;
+
+    /*
+    ** a batch only holds blocks retired in one epoch
+    */
+
+    if (NULL == lBatch || lGlobal != lBatch->epoch || EPOCH_BATCH_BLOCKS == lBatch->count)
+    {
+        lBatch = pParticipant->spare;
+
+        if (NULL != lBatch)
+        {
+            pParticipant->spare = NULL;
+        }
+        else if (!SafeMalloc(&lBatch, sizeof(epochBatch)))
+        {
+            return(FALSE);
+        }
+
+        lBatch->epoch = lGlobal;
+        lBatch->count = 0;
+
+        lBatch->next = pParticipant->batches;
+
+        pParticipant->batches = lBatch;
+    }
+
+    lBatch->blocks[lBatch->count++] = *pRetired;
+
+    atomic_fetch_add_explicit(&lEpoch->pendingBlocks, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&lEpoch->pendingBytes, pRetired->size, memory_order_relaxed);
+
+    if (0 == ++pParticipant->retires % EPOCH_ADVANCE_INTERVAL)
+    {
+        EpochCollect(pParticipant, FALSE);
+    }
+
+    return(TRUE);
+}
+
+static unsigned long long EpochAdvance
+(
+    smartEpochHandle pEpoch,
+    Bool pWait,
+    epochBatch ** pOrphans
+)
+{
+    unsigned long long lGlobal;
+    unsigned long long lState;
+
+    smartEpochParticipantHandle lParticipant;
+
+    epochBatch ** lLink;
+    epochBatch * lBatch;
+
+    *pOrphans = NULL;
+
+    /*
+    ** a retire does not wait for a thread that is already advancing
+    */
+
+    if (pWait)
+    {
+        mtx_lock(&pEpoch->lock);
+    }
+    else if (thrd_success != mtx_trylock(&pEpoch->lock))
+    {
+        return(atomic_load(&pEpoch->epoch));
+    }
+
+    lGlobal = atomic_load(&pEpoch->epoch);
+
+    for (lParticipant = pEpoch->participants; NULL != lParticipant; lParticipant = lParticipant->next)
+    {
+        lState = atomic_load(&lParticipant->state);
+
+        if (EpochStateActive(lState) && lGlobal != EpochStateEpoch(lState))
+        {
+            break;
+        }
+    }
+
+    if (NULL == lParticipant)
+    {
+        atomic_store(&pEpoch->epoch, ++lGlobal);
+    }
+
+    /*
+    ** detach the orphan batches that have become safe
+    */
+
+    lLink = &pEpoch->orphans;
+
+    while (NULL != (lBatch = *lLink))
+    {
+        if (EpochIsSafe(lBatch->epoch, lGlobal))
+        {
+            *lLink = lBatch->next;
+
+            lBatch->next = *pOrphans;
+
+            *pOrphans = lBatch;
+        }
+        else
+        {
+            lLink = &lBatch->next;
+        }
+    }
+
+    mtx_unlock(&pEpoch->lock);
+
+    return(lGlobal);
+}
+
+static void EpochCollect
+(
+    smartEpochParticipantHandle pParticipant,
+    Bool pWait
+)
+{
+    unsigned long long lGlobal;
+
+    epochBatch ** lLink;
+    epochBatch * lOrphans;
+    epochBatch * lSafe;
+
+    lGlobal = EpochAdvance(pParticipant->domain, pWait, &lOrphans);
+
+    EpochFreeBatches(pParticipant->domain, pParticipant, lOrphans);
+
+    /*
+    ** the batches are newest first, so the safe batches end the list
+    */
+
+    for (lLink = &pParticipant->batches; NULL != *lLink && !EpochIsSafe((* lLink)->epoch, lGlobal); lLink = &(* lLink)->next)
+    {
+        /* find the newest safe batch */
+    }
+
+    lSafe = *lLink;
+
+    *lLink = NULL;
+
+    EpochFreeBatches(pParticipant->domain, pParticipant, lSafe);
+}
+
+static void EpochFreeBatches
+(
+    smartEpochHandle pEpoch,
+    smartEpochParticipantHandle pParticipant,
+    epochBatch * pBatches
+)
+{
+    epochBatch * lBatch;
+    epochRetired * lRetired;
+
+    unsigned long lBlock;
+
+    size_t lBytes;
+
+    while (NULL != (lBatch = pBatches))
+    {
+        pBatches = lBatch->next;
+
+        lBytes = 0;
+
+        for (lBlock = 0; lBlock < lBatch->count; lBlock++)
+        {
+            lRetired = &lBatch->blocks[lBlock];
+
+            lBytes += lRetired->size;
+
+            /*
+            ** the budget charge is released only now the block is freed
+            */
+
+            if (NULL != lRetired->freeFunction)
+            {
+                lRetired->freeFunction(lRetired->context, lRetired->buffer, lRetired->size);
+            }
+            else if (NULL != lRetired->budget)
+            {
+                SmartBudgetFree(lRetired->context, &lRetired->buffer, lRetired->size, lRetired->budget);
+            }
+            else
+            {
+                SafeAllocatorFree(lRetired->context, &lRetired->buffer, lRetired->size);
+            }
+        }
+
+        atomic_fetch_sub_explicit(&pEpoch->pendingBlocks, lBatch->count, memory_order_relaxed);
+        atomic_fetch_sub_explicit(&pEpoch->pendingBytes, lBytes, memory_order_relaxed);
+
+        if (NULL != pParticipant && NULL == pParticipant->spare)
+        {
+            pParticipant->spare = lBatch;
+        }
+        else
+        {
+            SafeFree(&lBatch);
+        }
+    }
+}
@@ -0,0 +1,227 @@
+/*----------------------------------------------------------------------------
+  Smart Epoch
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Epoch internal header file
+  ----------------------------------------------------------------------------*/
+
+#ifndef SMART_EPOCH_H
+#define SMART_EPOCH_H
+
+#include <stdatomic.h>
+#include <threads.h>
+
+#include "smart.epoch.t.h"
+
+/*----------------------------------------------------------------------------
+  Private defines
+  ----------------------------------------------------------------------------*/
+
+#define EPOCH_BATCH_BLOCKS     64                                   /* retired blocks held by a batch */
+#define EPOCH_ADVANCE_INTERVAL 64                                   /* retires between attempts to advance */
+#define EPOCH_LINE_SIZE        64                                   /* keeps the global epoch on a line of its own */
+
+/*
+** the state of a participant is its epoch shifted up one bit below the
+** active bit, so that a scan sees both in one load
+*/
+
+#define EPOCH_ACTIVE            ((unsigned long long) 1)
+
+#define EpochState(pEpoch, pActive) (((pEpoch) << 1) | ((pActive) ? EPOCH_ACTIVE : 0))
+#define EpochStateEpoch(pState)     ((pState) >> 1)
+#define EpochStateActive(pState)    (EPOCH_ACTIVE & (pState))
+
+/*
+** a block retired in an epoch may be freed once the global epoch is two
+** ahead, every participant then having left the critical sections that
+** could have seen it
+*/
+
+#define EpochIsSafe(pRetired, pGlobal) ((pRetired) + 2 <= (pGlobal))
+
+/*----------------------------------------------------------------------------
+  Private data types
+  ----------------------------------------------------------------------------
+  A retired block records how it is to be freed: either a free function
+  and its context, or an allocator and the budget the block is charged to.
+  The budget charge is released when the block is freed, not when it is
+  retired, so a budget counts every block the reclamation still holds.
+
+  Retired blocks are collected in batches, each batch holding blocks
+  retired in one epoch. A participant keeps its batches newest first, so
+  the batches that can be freed are always at the end of its list. The
+  batches of a participant that unregisters are handed to the domain as
+  orphans and freed by a later advance.
+  ----------------------------------------------------------------------------*/
+
+typedef struct epochRetired {
+    void * buffer;
+    size_t size;
+
+    smartEpochFreeFunction freeFunction;
+    void * context;
+
+    smartBudgetHandle budget;
+} epochRetired;
+
+typedef struct epochBatch {
+    struct epochBatch * next;
+
+    unsigned long long epoch;
+    unsigned long count;
+
+    epochRetired blocks[EPOCH_BATCH_BLOCKS];
+} epochBatch;
+
+typedef struct smartEpoch {
+    atomic_ullong epoch;
+
+    char padding[EPOCH_LINE_SIZE - sizeof(atomic_ullong)];
+
+    mtx_t lock;
+
+    struct smartEpochParticipant * participants;
+
+    epochBatch * orphans;
+
+    atomic_size_t pendingBlocks;
+    atomic_size_t pendingBytes;
+} smartEpoch;
+
+typedef smartEpoch * smartEpochHandle;
+
+typedef struct smartEpochParticipant {
+    atomic_ullong state;
+
+    struct smartEpochParticipant * next;
+
+    smartEpochHandle domain;
+
+    unsigned long nesting;
+    unsigned long retires;
+
+    epochBatch * batches;
+    epochBatch * spare;
+} smartEpochParticipant;
+
+typedef smartEpochParticipant * smartEpochParticipantHandle;
+
+/*----------------------------------------------------------------------------
+  Private function prototypes
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  EpochRetire()
+  ----------------------------------------------------------------------------
+  Add a block to the newest batch of a participant, starting a new batch
+  when the newest is full or was filled in an earlier epoch, and try to
+  advance the epoch every EPOCH_ADVANCE_INTERVAL retires
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pParticipant - (I) The participant handle
+  pRetired     - (I) The retired block
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The block was retired
+
+  False - A new batch could not be allocated
+  ----------------------------------------------------------------------------*/
+
+static Bool EpochRetire
+(
+    smartEpochParticipantHandle pParticipant,
+    epochRetired * pRetired
+);
+
+/*----------------------------------------------------------------------------
+  EpochAdvance()
+  ----------------------------------------------------------------------------
+  Move the global epoch on by one when every active participant has
+  observed it, and detach the orphan batches that have become safe
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pEpoch   - (I) The domain handle
+  pWait    - (I) TRUE to wait for the domain lock, FALSE to give up when
+                 another thread holds it
+  pOrphans - (O) The orphan batches that may be freed
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  The global epoch after the attempt
+  ----------------------------------------------------------------------------*/
+
+static unsigned long long EpochAdvance
+(
+    smartEpochHandle pEpoch,
+    Bool pWait,
+    epochBatch ** pOrphans
+);
+
+/*----------------------------------------------------------------------------
+  EpochCollect()
+  ----------------------------------------------------------------------------
+  Try to advance the epoch, then free the batches of a participant and the
+  orphan batches that were retired two or more epochs ago
+  ----------------------------------------------------------------------------*/
+
+static void EpochCollect
+(
+    smartEpochParticipantHandle pParticipant,
+    Bool pWait
+);
+
+/*----------------------------------------------------------------------------
+  EpochFreeBatches()
+  ----------------------------------------------------------------------------
+  Free every block of a list of batches, releasing each block's budget
+  charge, and then the batches themselves (keeping one as the spare of the
+  participant when it has none)
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pEpoch       - (I) The domain handle
+  pParticipant - (I) The participant to keep a spare batch for, or NULL
+  pBatches     - (I) The list of batches
+  ----------------------------------------------------------------------------*/
+
+static void EpochFreeBatches
+(
+    smartEpochHandle pEpoch,
+    smartEpochParticipantHandle pParticipant,
+    epochBatch * pBatches
+);
+
+#endif
@@ -0,0 +1,410 @@
+/*----------------------------------------------------------------------------
+  Smart Epoch
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Epoch application programmer's interface (API) header file
+  ----------------------------------------------------------------------------*/
+
+#ifndef SMART_EPOCH_I_H
+#define SMART_EPOCH_I_H
+
+/*----------------------------------------------------------------------------
+  SmartEpochConstructSmartEpoch()
+  ----------------------------------------------------------------------------
+  Construct an epoch based reclamation domain. Threads reading a lock free
+  container join the domain as participants and read inside critical
+  sections, and a block unlinked from the container is retired to the
+  domain rather than freed, to be freed once no critical section that could
+  have seen it is still open.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pEpoch - (I/O) Pointer to recieve the domain handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Domain was succesfully constructed
+
+  False - Domain was not successfully constructed due to:
+
+          1. The domain handle pointer was NULL
+          2. The SafeMalloc() failed
+          3. The lock could not be initialized
+  ----------------------------------------------------------------------------
+  Notes:
+
+  This function requires the contents of the pEpoch handle to be initialized
+  to NULL prior to calling this function.
+
+  The domain keeps a global epoch. Each participant records the epoch it
+  observed when it entered its critical section, and the global epoch is
+  moved on once every participant inside a critical section has observed
+  it. A block retired in one epoch is freed when the global epoch is two
+  ahead of it.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochConstructSmartEpoch
+(
+    smartEpochHandle * pEpoch
+);
+
+/*----------------------------------------------------------------------------
+  SmartEpochDestructSmartEpoch()
+  ----------------------------------------------------------------------------
+  Free the blocks still retired to a domain and destruct the domain.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pEpoch - (I/O) Pointer to the domain handle, set to NULL
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Domain was succesfully destructed
+
+  False - Domain was not successfully destructed due to:
+
+          1. The domain handle pointer was NULL or pointed to NULL
+          2. A participant is still registered
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochDestructSmartEpoch
+(
+    smartEpochHandle * pEpoch
+);
+
+/*----------------------------------------------------------------------------
+  SmartEpochRegister()
+  ----------------------------------------------------------------------------
+  Join a domain as a participant.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pEpoch       - (I)   The domain handle
+  pParticipant - (I/O) Pointer to recieve the participant handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Participant was succesfully registered
+
+  False - Participant was not successfully registered due to:
+
+          1. The domain handle was NULL
+          2. The participant handle pointer was NULL
+          3. The SafeMalloc() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  This function requires the contents of the pParticipant handle to be
+  initialized to NULL prior to calling this function.
+
+  A participant belongs to one thread, which uses it for each of its
+  critical sections and retires. A thread usually registers once when it
+  starts and unregisters before it exits.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochRegister
+(
+    smartEpochHandle pEpoch,
+    smartEpochParticipantHandle * pParticipant
+);
+
+/*----------------------------------------------------------------------------
+  SmartEpochUnregister()
+  ----------------------------------------------------------------------------
+  Leave a domain. The blocks the participant retired that cannot yet be
+  freed are handed to the domain and freed by a later reclamation.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pParticipant - (I/O) Pointer to the participant handle, set to NULL
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Participant was succesfully unregistered
+
+  False - Participant was not successfully unregistered due to:
+
+          1. The participant handle pointer was NULL or pointed to NULL
+          2. The participant is inside a critical section
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochUnregister
+(
+    smartEpochParticipantHandle * pParticipant
+);
+
+/*----------------------------------------------------------------------------
+  SmartEpochEnter()
+  ----------------------------------------------------------------------------
+  Enter a critical section. A block reachable from a container when the
+  critical section is entered is not freed before it is exited, even if it
+  is retired in between.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pParticipant - (I) The participant handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The critical section was entered
+
+  False - The participant handle was NULL
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Critical sections nest; only the outermost enter and exit are seen by the
+  domain. A participant that stays inside a critical section holds back
+  the reclamation of every block retired to the domain, so critical
+  sections should be as short as a single container operation.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochEnter
+(
+    smartEpochParticipantHandle pParticipant
+);
+
+/*----------------------------------------------------------------------------
+  SmartEpochExit()
+  ----------------------------------------------------------------------------
+  Exit a critical section entered by SmartEpochEnter().
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pParticipant - (I) The participant handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The critical section was exited
+
+  False - The critical section was not exited due to:
+
+          1. The participant handle was NULL
+          2. The participant was not inside a critical section
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochExit
+(
+    smartEpochParticipantHandle pParticipant
+);
+
+/*----------------------------------------------------------------------------
+  SmartEpochRetire()
+  ----------------------------------------------------------------------------
+  The deferred form of SmartBudgetFree(). The block is returned to its
+  allocator and its size released from the budget once no participant can
+  still be reading it, and the memory pointer is set to NULL now.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pParticipant - (I)   The participant handle
+  pAllocator   - (I)   The allocator handle (NULL selects Free())
+  pBuffer      - (I/O) The address of a memory pointer to the block being
+                       retired
+  pSize        - (I)   The number of bytes being retired
+  pBudget      - (I)   The budget handle the block is charged to, or NULL
+                       when it is not charged to a budget
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The block was retired
+
+  False - The block was not retired due to:
+
+          1. The participant handle was NULL
+          2. The buffer pointer pointer was NULL or pointed to NULL
+          3. Zero bytes were retired
+          4. A new batch could not be allocated
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The block must already be unlinked from the container, so that a
+  participant entering a critical section after the retire cannot reach
+  it. A block that was not retired is still owned by the caller, which may
+  retire it again later.
+
+  The bytes stay charged to the budget (and its ancestors) until the block
+  is freed, so a budget maximum also bounds the memory the domain holds
+  for the container. SmartEpochGetPendingBytes() reports those bytes.
+
+  The block may be freed on another thread, the one that reclaims the
+  batches left by a participant that unregisters, so a block of an
+  allocator that may only be used by one thread (a slab or an arena) needs
+  SmartEpochSynchronize() to be called before its participant unregisters.
+
+  A retire may be made inside or outside a critical section. Every
+  EPOCH_ADVANCE_INTERVAL retires the participant tries to advance the
+  epoch and frees the blocks that have become safe.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochRetire
+(
+    smartEpochParticipantHandle pParticipant,
+    smartAllocatorHandle pAllocator,
+    void ** pBuffer,
+    size_t pSize,
+    smartBudgetHandle pBudget
+);
+
+/*----------------------------------------------------------------------------
+  SmartEpochRetireFunction()
+  ----------------------------------------------------------------------------
+  SmartEpochRetire() for a block freed by a function of the caller, such as
+  a node whose data is freed along with it.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pParticipant  - (I)   The participant handle
+  pBuffer       - (I/O) The address of a memory pointer to the block being
+                        retired
+  pSize         - (I)   The number of bytes passed to the free function
+  pFreeFunction - (I)   The free function
+  pContext      - (I)   A pointer passed back to the free function
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The block was retired
+
+  False - The block was not retired due to:
+
+          1. The participant handle was NULL
+          2. The buffer pointer pointer was NULL or pointed to NULL
+          3. The free function was NULL
+          4. A new batch could not be allocated
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The free function is called from whichever thread reclaims the batch
+  holding the block; it must not enter a critical section or retire to
+  the domain.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochRetireFunction
+(
+    smartEpochParticipantHandle pParticipant,
+    void ** pBuffer,
+    size_t pSize,
+    smartEpochFreeFunction pFreeFunction,
+    void * pContext
+);
+
+/*----------------------------------------------------------------------------
+  SmartEpochReclaim()
+  ----------------------------------------------------------------------------
+  Try once to advance the epoch and free the blocks retired by the
+  participant (and by participants that have unregistered) that have
+  become safe. Call it at a point where latency does not matter, such as
+  between requests.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pParticipant - (I) The participant handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The reclamation was made
+
+  False - The participant handle was NULL
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochReclaim
+(
+    smartEpochParticipantHandle pParticipant
+);
+
+/*----------------------------------------------------------------------------
+  SmartEpochSynchronize()
+  ----------------------------------------------------------------------------
+  Advance the epoch until every block the participant has retired has been
+  freed, waiting for the other participants to leave their critical
+  sections.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pParticipant - (I) The participant handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Every block the participant retired was freed
+
+  False - The blocks were not freed due to:
+
+          1. The participant handle was NULL
+          2. The participant is inside a critical section
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The wait lasts as long as the longest critical section open when it is
+  called, and for ever if another participant never exits its critical
+  section.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartEpochSynchronize
+(
+    smartEpochParticipantHandle pParticipant
+);
+
+/*----------------------------------------------------------------------------
+  SmartEpochGetEpoch()
+  ----------------------------------------------------------------------------
+  Returns the global epoch of a domain, or zero when the handle is NULL.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS unsigned long long CALLING_CONVENTION SmartEpochGetEpoch
+(
+    smartEpochHandle pEpoch
+);
+
+/*----------------------------------------------------------------------------
+  SmartEpochGetPending()
+  ----------------------------------------------------------------------------
+  Returns the number of blocks retired to a domain that have not yet been
+  freed, or zero when the handle is NULL.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartEpochGetPending
+(
+    smartEpochHandle pEpoch
+);
+
+/*----------------------------------------------------------------------------
+  SmartEpochGetPendingBytes()
+  ----------------------------------------------------------------------------
+  Returns the number of bytes retired to a domain that have not yet been
+  freed, or zero when the handle is NULL.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartEpochGetPendingBytes
+(
+    smartEpochHandle pEpoch
+);
+
+#endif
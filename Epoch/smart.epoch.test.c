@@ -0,0 +1,525 @@
+/*----------------------------------------------------------------------------
+  Smart Epoch
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Epoch test program implementation file
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Standard libraries
+  ----------------------------------------------------------------------------*/
+
+#include <ctype.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+
+/*----------------------------------------------------------------------------
+  Public data types
+  ----------------------------------------------------------------------------*/
+
+#include "compilation.t.h"
+#include "types.t.h"
+
+#include "smart.memory.t.h"
+#include "smart.epoch.t.h"
+
+/*----------------------------------------------------------------------------
+  Public functions
+  ----------------------------------------------------------------------------*/
+
+#include "smart.memory.i.h"
+
+#include "smart.epoch.i.h"
+
+/*----------------------------------------------------------------------------
+  Private defines, data types and function prototypes
+  ----------------------------------------------------------------------------*/
+
+#include "smart.epoch.test.h"
+
+/*----------------------------------------------------------------------------
+  <Eeek> Globals </Eeek>
+  ----------------------------------------------------------------------------*/
+
+smartEpochHandle gEpoch;
+
+smartBudgetHandle gBudget;
+
+_Atomic(testNode *) gSlots[TEST_SLOTS];
+
+atomic_bool gWritersDone;
+
+atomic_ulong gReads;
+
+/*----------------------------------------------------------------------------
+  Main
+  ----------------------------------------------------------------------------*/
+
+void main
+(
+    void
+)
+{
+    int lOption;
+
+    SmartEpochConstructSmartEpoch(&gEpoch);
+
+    do
+    {
+        printf("Option: ");
+
+        do
+        {
+            lOption = toupper(fgetc(stdin));
+        }
+        while (!isprint(lOption)); /* eat carriage returns (etc) */
+
+        switch ((char) lOption)
+        {
+            case '?':
+            {
+                DisplayOptions();
+                break;
+            }
+
+            case 'Q':
+            {
+                SmartEpochDestructSmartEpoch(&gEpoch);
+                break;
+            }
+
+            case 'R':
+            {
+                IteratedReclamationTest();
+                break;
+            }
+
+            case 'A':
+            {
+                AccountingTest();
+                break;
+            }
+
+            case 'I':
+            {
+                OutputEpochInformation(stdout);
+                break;
+            }
+
+            default:
+            {
+                printf("Valid options are R,A,I,Q,?\n");
+                break;
+            }
+        }
+    }
+    while ('Q' != lOption);
+}
+
+void DisplayOptions
+(
+    void
+)
+{
+    printf("\n"
+           "Options:\n"
+           "(R) Iterated concurrent read, replace and retire test\n"
+           "(A) Retired block accounting test\n\n"
+           "(I) Display epoch information\n\n"
+           "(Q) Quit\n"
+           "(?) Display this option list\n"
+           "\n");
+}
+
+void OutputEpochInformation
+(
+    FILE * pFile
+)
+{
+    fprintf(pFile, "Epoch          = %lld\n", SmartEpochGetEpoch(gEpoch));
+    fprintf(pFile, "Pending Blocks = %ld\n", SmartEpochGetPending(gEpoch));
+    fprintf(pFile, "Pending Bytes  = %ld\n\n", SmartEpochGetPendingBytes(gEpoch));
+}
+
+void IteratedReclamationTest
+(
+    void
+)
+{
+    unsigned long lIterations;
+    unsigned long lIteration;
+
+    unsigned long lSlot;
+    unsigned long lThreadIndex;
+    unsigned long lSeeds[TEST_WRITERS];
+
+    unsigned long lDisagreements = 0;
+
+    int lThreadDisagreements;
+
+    thrd_t lReaders[TEST_READERS];
+    thrd_t lWriters[TEST_WRITERS];
+
+    testNode * lNode;
+
+    unsigned long long lStartEpoch;
+
+    struct timespec lStartTime;
+    struct timespec lEndTime;
+
+    double lSeconds = 0;
+
+    printf("\n");
+    printf("Iterations: ");
+    scanf("%ld", &lIterations);
+
+    lStartEpoch = SmartEpochGetEpoch(gEpoch);
+
+    atomic_store(&gReads, 0);
+
+    for (lIteration = 1; lIteration <= lIterations; lIteration++)
+    {
+        printf("Iteration : %ld ", lIteration);
+
+        gBudget = NULL;
+
+        SmartBudgetConstructSmartBudget(&gBudget, 0, NULL);
+
+        for (lSlot = 0; lSlot < TEST_SLOTS; lSlot++)
+        {
+            lNode = NULL;
+
+            SmartBudgetMalloc(NULL, (void **) &lNode, sizeof(testNode), gBudget);
+
+            lNode->magic = TEST_NODE_MAGIC;
+
+            memset(lNode->words, 0, sizeof(lNode->words));
+
+            atomic_store(&gSlots[lSlot], lNode);
+        }
+
+        printf(">");
+
+        /*
+        ** readers check every slot while writers replace and retire nodes
+        */
+
+        atomic_store(&gWritersDone, FALSE);
+
+        timespec_get(&lStartTime, TIME_UTC);
+
+        for (lThreadIndex = 0; lThreadIndex < TEST_READERS; lThreadIndex++)
+        {
+            thrd_create(&lReaders[lThreadIndex], ReaderWorker, NULL);
+        }
+
+        for (lThreadIndex = 0; lThreadIndex < TEST_WRITERS; lThreadIndex++)
+        {
+            lSeeds[lThreadIndex] = TEST_SEED + lIteration * TEST_WRITERS + lThreadIndex;
+
+            thrd_create(&lWriters[lThreadIndex], WriterWorker, &lSeeds[lThreadIndex]);
+        }
+
+        for (lThreadIndex = 0; lThreadIndex < TEST_WRITERS; lThreadIndex++)
+        {
+            thrd_join(lWriters[lThreadIndex], NULL);
+        }
+
+        atomic_store(&gWritersDone, TRUE);
+
+        for (lThreadIndex = 0; lThreadIndex < TEST_READERS; lThreadIndex++)
+        {
+            thrd_join(lReaders[lThreadIndex], &lThreadDisagreements);
+
+            lDisagreements += (unsigned long) lThreadDisagreements;
+        }
+
+        timespec_get(&lEndTime, TIME_UTC);
+
+        lSeconds += (double) (lEndTime.tv_sec - lStartTime.tv_sec) + ((double) (lEndTime.tv_nsec - lStartTime.tv_nsec)) / 1e9;
+
+        printf("<");
+
+        /*
+        ** every writer synchronized before unregistering, so only the nodes
+        ** in the slots are still charged
+        */
+
+        if (0 != SmartEpochGetPending(gEpoch))
+        {
+            printf("Pending disagreement: %ld blocks\n", SmartEpochGetPending(gEpoch));
+        }
+
+        if (TEST_SLOTS * sizeof(testNode) != SmartBudgetGetValue(gBudget))
+        {
+            printf("Budget disagreement: expected %ld charged %ld\n", TEST_SLOTS * sizeof(testNode), SmartBudgetGetValue(gBudget));
+        }
+
+        for (lSlot = 0; lSlot < TEST_SLOTS; lSlot++)
+        {
+            lNode = atomic_exchange(&gSlots[lSlot], NULL);
+
+            SmartBudgetFree(NULL, (void **) &lNode, sizeof(testNode), gBudget);
+        }
+
+        SmartBudgetDestructSmartBudget(&gBudget);
+
+        printf("\r");
+    }
+
+    printf("\n\n");
+
+    printf("Read disagreements: %ld\n", lDisagreements);
+    printf("Epochs advanced:    %lld\n", SmartEpochGetEpoch(gEpoch) - lStartEpoch);
+    printf("Retire Timer:       %9.3f secs %12.0f retires/sec %12.0f reads/sec\n", lSeconds, ((double) (lIterations * TEST_WRITERS * TEST_WRITER_ROUNDS)) / lSeconds, ((double) atomic_load(&gReads)) / lSeconds);
+    printf("\n");
+}
+
+int ReaderWorker
+(
+    void * pUnused
+)
+{
+    smartEpochParticipantHandle lParticipant = NULL;
+
+    testNode * lNode;
+
+    unsigned long lSlot;
+    unsigned long lWord;
+    unsigned long lReads = 0;
+
+    int lDisagreements = 0;
+
+    (void) pUnused;
+
+    SmartEpochRegister(gEpoch, &lParticipant);
+
+    while (!atomic_load(&gWritersDone))
+    {
+        SmartEpochEnter(lParticipant);
+
+        for (lSlot = 0; lSlot < TEST_SLOTS; lSlot++)
+        {
+            lNode = atomic_load(&gSlots[lSlot]);
+
+            /*
+            ** a node freed too soon has been poisoned
+            */
+
+            if (TEST_NODE_MAGIC != lNode->magic)
+            {
+                lDisagreements++;
+            }
+
+            for (lWord = 1; lWord < TEST_NODE_WORDS; lWord++)
+            {
+                if (lNode->words[0] != lNode->words[lWord])
+                {
+                    lDisagreements++;
+                    break;
+                }
+            }
+
+            lReads++;
+        }
+
+        SmartEpochExit(lParticipant);
+    }
+
+    SmartEpochUnregister(&lParticipant);
+
+    atomic_fetch_add(&gReads, lReads);
+
+    return(lDisagreements);
+}
+
+int WriterWorker
+(
+    void * pSeed
+)
+{
+    smartEpochParticipantHandle lParticipant = NULL;
+
+    testNode * lNode;
+    testNode * lOldNode;
+
+    unsigned long lRound;
+    unsigned long lWord;
+
+    unsigned long lRandom = *((unsigned long *) pSeed);
+
+    SmartEpochRegister(gEpoch, &lParticipant);
+
+    for (lRound = 0; lRound < TEST_WRITER_ROUNDS; lRound++)
+    {
+        lNode = NULL;
+
+        if (!SmartBudgetMalloc(NULL, (void **) &lNode, sizeof(testNode), gBudget))
+        {
+            printf("Allocation failed: round %ld\n", lRound);
+            break;
+        }
+
+        lNode->magic = TEST_NODE_MAGIC;
+
+        for (lWord = 0; lWord < TEST_NODE_WORDS; lWord++)
+        {
+            lNode->words[lWord] = lRound;
+        }
+
+        lRandom = lRandom * 1103515245 + 12345;
+
+        lOldNode = atomic_exchange(&gSlots[(lRandom >> 16) % TEST_SLOTS], lNode);
+
+        /*
+        ** retire half of the nodes to be poisoned when they are freed
+        */
+
+        if (0 == (lRound & 1))
+        {
+            SmartEpochRetire(lParticipant, NULL, (void **) &lOldNode, sizeof(testNode), gBudget);
+        }
+        else
+        {
+            SmartEpochRetireFunction(lParticipant, (void **) &lOldNode, sizeof(testNode), PoisonFree, gBudget);
+        }
+    }
+
+    SmartEpochSynchronize(lParticipant);
+
+    SmartEpochUnregister(&lParticipant);
+
+    return(0);
+}
+
+void PoisonFree
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pSize
+)
+{
+    memset(pBuffer, TEST_POISON, pSize);
+
+    SmartBudgetFree(NULL, &pBuffer, pSize, pContext);
+}
+
+void AccountingTest
+(
+    void
+)
+{
+    smartEpochParticipantHandle lParticipant = NULL;
+    smartEpochParticipantHandle lReader = NULL;
+
+    void * lBlocks[TEST_ACCOUNT_BLOCKS];
+
+    unsigned long lBlock;
+
+    size_t lCharged = TEST_ACCOUNT_BLOCKS * TEST_ACCOUNT_BLOCK_SIZE;
+
+    gBudget = NULL;
+
+    SmartBudgetConstructSmartBudget(&gBudget, 0, NULL);
+
+    SmartEpochRegister(gEpoch, &lParticipant);
+    SmartEpochRegister(gEpoch, &lReader);
+
+    memset(lBlocks, 0, sizeof(lBlocks));
+
+    for (lBlock = 0; lBlock < TEST_ACCOUNT_BLOCKS; lBlock++)
+    {
+        SmartBudgetMalloc(NULL, &lBlocks[lBlock], TEST_ACCOUNT_BLOCK_SIZE, gBudget);
+    }
+
+    printf("\n");
+
+    /*
+    ** a reader inside a critical section holds back every retired block
+    */
+
+    SmartEpochEnter(lReader);
+
+    for (lBlock = 0; lBlock < TEST_ACCOUNT_BLOCKS; lBlock++)
+    {
+        if (!SmartEpochRetire(lParticipant, NULL, &lBlocks[lBlock], TEST_ACCOUNT_BLOCK_SIZE, gBudget) || NULL != lBlocks[lBlock])
+        {
+            printf("Retire failed: block %ld\n", lBlock);
+        }
+    }
+
+    SmartEpochReclaim(lParticipant);
+    SmartEpochReclaim(lParticipant);
+
+    printf("Held by a reader:   %ld blocks %ld bytes pending, %ld bytes charged\n", SmartEpochGetPending(gEpoch), SmartEpochGetPendingBytes(gEpoch), SmartBudgetGetValue(gBudget));
+
+    if (TEST_ACCOUNT_BLOCKS != SmartEpochGetPending(gEpoch) || lCharged != SmartEpochGetPendingBytes(gEpoch) || lCharged != SmartBudgetGetValue(gBudget))
+    {
+        printf("Accounting disagreement: blocks were freed under a reader\n");
+    }
+
+    if (SmartEpochSynchronize(lReader) || SmartEpochUnregister(&lReader))
+    {
+        printf("Synchronize or unregister inside a critical section was not refused\n");
+    }
+
+    /*
+    ** once the reader exits the blocks are freed and their charge released
+    */
+
+    SmartEpochExit(lReader);
+
+    SmartEpochSynchronize(lParticipant);
+
+    printf("Reader exited:      %ld blocks %ld bytes pending, %ld bytes charged\n", SmartEpochGetPending(gEpoch), SmartEpochGetPendingBytes(gEpoch), SmartBudgetGetValue(gBudget));
+
+    if (0 != SmartEpochGetPending(gEpoch) || 0 != SmartEpochGetPendingBytes(gEpoch) || 0 != SmartBudgetGetValue(gBudget))
+    {
+        printf("Accounting disagreement: retired blocks were not freed\n");
+    }
+
+    if (SmartEpochDestructSmartEpoch(&gEpoch))
+    {
+        printf("Destruct with registered participants was not refused\n");
+    }
+
+    SmartEpochUnregister(&lReader);
+    SmartEpochUnregister(&lParticipant);
+
+    SmartBudgetDestructSmartBudget(&gBudget);
+
+    printf("\n");
+}
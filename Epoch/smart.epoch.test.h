@@ -0,0 +1,107 @@
+/*----------------------------------------------------------------------------
+  Smart Epoch
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Epoch test program header file
+  ----------------------------------------------------------------------------*/
+
+#ifndef SMART_EPOCH_TEST_H
+#define SMART_EPOCH_TEST_H
+
+#define TEST_SLOTS 64
+
+#define TEST_READERS 4
+#define TEST_WRITERS 2
+
+#define TEST_WRITER_ROUNDS 200000
+
+#define TEST_NODE_WORDS 6
+#define TEST_NODE_MAGIC 0x5EED5EEDUL
+#define TEST_POISON 0xDD
+
+#define TEST_ACCOUNT_BLOCKS 1000
+#define TEST_ACCOUNT_BLOCK_SIZE 48
+
+#define TEST_SEED 1
+
+/*----------------------------------------------------------------------------
+  Private data types
+  ----------------------------------------------------------------------------*/
+
+typedef struct testNode {
+    unsigned long magic;
+
+    unsigned long words[TEST_NODE_WORDS];
+} testNode;
+
+/*----------------------------------------------------------------------------
+  Private function prototypes
+  ----------------------------------------------------------------------------*/
+
+void DisplayOptions
+(
+    void
+);
+
+void OutputEpochInformation
+(
+    FILE * pFile
+);
+
+void IteratedReclamationTest
+(
+    void
+);
+
+int ReaderWorker
+(
+    void * pUnused
+);
+
+int WriterWorker
+(
+    void * pSeed
+);
+
+void PoisonFree
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pSize
+);
+
+void AccountingTest
+(
+    void
+);
+
+#endif
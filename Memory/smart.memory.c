@@ -39,8 +39,51 @@
 
 #include "smart.memory.h"
 
+#include "smart.memory.t.h"
+
 #include "smart.memory.i.h"
 
+/*----------------------------------------------------------------------------
+  Private globals
+  ----------------------------------------------------------------------------*/
+
+static once_flag gCacheOnce = ONCE_FLAG_INIT;
+
+static tss_t gCacheThreadExit;
+
+static memoryCacheBackend gCacheBackend;
+
+static _Thread_local memoryThreadCache gThreadCache;
+
+static smartAllocator gCacheAllocator = {CacheAllocate, CacheAllocateZeroed, CacheAllocateAligned, CacheReallocate, CacheDeallocate, NULL};
+
+static once_flag gDeferredOnce = ONCE_FLAG_INIT;
+
+static tss_t gDeferredThreadExit;
+
+static memoryDeferredReclaimer gDeferred;
+
+static _Thread_local memoryDeferredBatch * gDeferredBatch;
+
+static atomic_uint gCounterNextShard;
+
+static _Thread_local unsigned int gCounterShard;
+
+#ifdef SMART_MEMORY_PROFILE
+
+static once_flag gProfileOnce = ONCE_FLAG_INIT;
+
+static memoryProfile gProfile;
+
+static _Thread_local const char * gProfileFile;
+static _Thread_local int gProfileLine;
+
+#endif
+
+/*----------------------------------------------------------------------------
+  Public functions
+  ----------------------------------------------------------------------------*/
+
 STORAGE_CLASS Bool CALLING_CONVENTION SafeMalloc
 (
     void ** pBuffer,
@@ -105,7 +148,7 @@ STORAGE_CLASS Bool CALLING_CONVENTION SafeFree
 {
     if (NULL != pBuffer && NULL != *pBuffer)
     {
-        Free(*pBuffer);
+        DeferredRelease(*pBuffer);
 
         *pBuffer = NULL;
 
@@ -126,6 +169,8 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartMalloc
     {
         *pMemoryUsed += pSize;
 
+        ProfileAllocate(pSize);
+
         return(TRUE);
     }
 
@@ -143,6 +188,8 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartCalloc
     {
         *pMemoryUsed += pSize;
 
+        ProfileAllocate(pSize);
+
         return(TRUE);
     }
 
@@ -160,8 +207,2998 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartFree
     {
         *pMemoryUsed -= pSize;
 
+        ProfileDeallocate(pSize);
+
+        return(TRUE);
+    }
+
+    return(FALSE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeAlignedMalloc
+(
+    void ** pBuffer,
+    size_t  pSize,
+    size_t  pAlignment
+)
+{
+    if (0 < pSize && NULL != pBuffer && NULL == *pBuffer && 0 == (pAlignment & (pAlignment - 1)))
+    {
+        if (pAlignment < MEMORY_NATURAL_ALIGNMENT)
+        {
+            pAlignment = MEMORY_NATURAL_ALIGNMENT;
+        }
+
+        *pBuffer = AlignedMalloc(pSize, pAlignment);
+
+        if (NULL != *pBuffer) 
+        {
+            return(TRUE);
+        }
+    }
+
+    return(FALSE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeAlignedFree
+(
+    void ** pBuffer
+)
+{
+    if (NULL != pBuffer && NULL != *pBuffer)
+    {
+        AlignedFree(*pBuffer);
+
+        *pBuffer = NULL;
+
+        return(TRUE);
+    }
+
+    return(FALSE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartAlignedMalloc
+(
+    void **  pBuffer,
+    size_t   pSize,
+    size_t   pAlignment,
+    size_t * pMemoryUsed
+)
+{
+    if (NULL != pMemoryUsed && 0 < pSize && SafeAlignedMalloc((void **)pBuffer, pSize, pAlignment))
+    {
+        *pMemoryUsed += pSize;
+
+        ProfileAllocate(pSize);
+
+        return(TRUE);
+    }
+
+    return(FALSE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartAlignedFree
+(
+    void **  pBuffer,
+    size_t   pSize,
+    size_t * pMemoryUsed
+)
+{
+    if (NULL != pMemoryUsed && 0 < pSize && SafeAlignedFree((void **)pBuffer))
+    {
+        *pMemoryUsed -= pSize;
+
+        ProfileDeallocate(pSize);
+
+        return(TRUE);
+    }
+
+    return(FALSE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeAllocatorMalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize
+)
+{
+    if (0 < pSize && NULL != pBuffer && NULL == *pBuffer)
+    {
+        if (NULL == pAllocator)
+        {
+            *pBuffer = Malloc(pSize);
+        }
+        else
+        {
+            *pBuffer = pAllocator->allocate(pAllocator->context, pSize);
+        }
+
+        if (NULL != *pBuffer) 
+        {
+            ProfileAllocate(pSize);
+
+            return(TRUE);
+        }
+    }
+
+    return(FALSE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeAllocatorCalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize
+)
+{
+    if (0 < pSize && NULL != pBuffer && NULL == *pBuffer)
+    {
+        if (NULL == pAllocator)
+        {
+            *pBuffer = Calloc(pSize);
+        }
+        else
+        {
+            *pBuffer = pAllocator->allocateZeroed(pAllocator->context, pSize);
+        }
+
+        if (NULL != *pBuffer) 
+        {
+            ProfileAllocate(pSize);
+
+            return(TRUE);
+        }
+    }
+
+    return(FALSE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeAllocatorRealloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pOldSize,
+    size_t               pSize
+)
+{
+    void * lBuffer;
+
+    if (0 < pSize && NULL != pBuffer)
+    {
+        if (NULL == pAllocator)
+        {
+            lBuffer = Realloc(*pBuffer, pSize);
+        }
+        else
+        {
+            lBuffer = pAllocator->reallocate(pAllocator->context, *pBuffer, pOldSize, pSize);
+        }
+
+        /*
+        ** a failed reallocation leaves the original block intact
+        */
+
+        if (NULL != lBuffer) 
+        {
+            *pBuffer = lBuffer;
+
+            ProfileReallocate(pOldSize, pSize);
+
+            return(TRUE);
+        }
+    }
+
+    return(FALSE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeAllocatorFree
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize
+)
+{
+    if (NULL != pBuffer && NULL != *pBuffer)
+    {
+        if (NULL == pAllocator)
+        {
+            DeferredRelease(*pBuffer);
+        }
+        else if (NULL != pAllocator->deallocate)
+        {
+            pAllocator->deallocate(pAllocator->context, *pBuffer, pSize);
+        }
+
+        *pBuffer = NULL;
+
+        ProfileDeallocate(pSize);
+
+        return(TRUE);
+    }
+
+    return(FALSE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeAllocatorAlignedMalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    size_t               pAlignment
+)
+{
+    if (0 != (pAlignment & (pAlignment - 1)))
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** every block is already aligned this far
+    */
+
+    if (pAlignment <= MEMORY_NATURAL_ALIGNMENT)
+    {
+        return(SafeAllocatorMalloc(pAllocator, pBuffer, pSize));
+    }
+
+    if (0 < pSize && NULL != pBuffer && NULL == *pBuffer)
+    {
+        if (NULL == pAllocator)
+        {
+            *pBuffer = AlignedMalloc(pSize, pAlignment);
+        }
+        else if (NULL != pAllocator->allocateAligned)
+        {
+            *pBuffer = pAllocator->allocateAligned(pAllocator->context, AlignSize(pSize, pAlignment), pAlignment);
+        }
+
+        if (NULL != *pBuffer) 
+        {
+            ProfileAllocate(pSize);
+
+            return(TRUE);
+        }
+    }
+
+    return(FALSE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeAllocatorAlignedFree
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    size_t               pAlignment
+)
+{
+    if (pAlignment <= MEMORY_NATURAL_ALIGNMENT)
+    {
+        return(SafeAllocatorFree(pAllocator, pBuffer, pSize));
+    }
+
+    if (NULL != pBuffer && NULL != *pBuffer)
+    {
+        if (NULL == pAllocator)
+        {
+            AlignedFree(*pBuffer);
+        }
+        else if (NULL != pAllocator->deallocate)
+        {
+            pAllocator->deallocate(pAllocator->context, *pBuffer, AlignSize(pSize, pAlignment));
+        }
+
+        *pBuffer = NULL;
+
+        ProfileDeallocate(pSize);
+
+        return(TRUE);
+    }
+
+    return(FALSE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartAllocatorMalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    size_t *             pMemoryUsed
+)
+{
+    if (NULL != pMemoryUsed && 0 < pSize && SafeAllocatorMalloc(pAllocator, pBuffer, pSize))
+    {
+        *pMemoryUsed += pSize;
+
+        return(TRUE);
+    }
+
+    return(FALSE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartAllocatorCalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    size_t *             pMemoryUsed
+)
+{
+    if (NULL != pMemoryUsed && 0 < pSize && SafeAllocatorCalloc(pAllocator, pBuffer, pSize))
+    {
+        *pMemoryUsed += pSize;
+
         return(TRUE);
     }
 
     return(FALSE);
 }
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartAllocatorFree
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    size_t *             pMemoryUsed
+)
+{
+    if (NULL != pMemoryUsed && 0 < pSize && SafeAllocatorFree(pAllocator, pBuffer, pSize))
+    {
+        *pMemoryUsed -= pSize;
+
+        return(TRUE);
+    }
+
+    return(FALSE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafePageAlloc
+(
+    void ** pBuffer,
+    size_t  pSize,
+    size_t  pAlignment
+)
+{
+    size_t lPageSize = PageSize();
+
+    char * lPages;
+    char * lAligned;
+
+    size_t lLead;
+
+    if (0 == pSize || NULL == pBuffer || NULL != *pBuffer)
+    {
+        return(FALSE);
+    }
+
+    if (0 != (pAlignment & (pAlignment - 1)))
+    {
+        return(FALSE);
+    }
+
+    pSize = (pSize + lPageSize - 1) & ~(lPageSize - 1);
+
+    if (pAlignment < lPageSize)
+    {
+        pAlignment = lPageSize;
+    }
+
+#if defined _WIN32 || defined _WIN64
+
+    /*
+    ** reserve an oversized region to find an aligned address then map
+    ** exactly the run at that address (another thread may take the address
+    ** between the release and the mapping, in which case try again)
+    */
+
+    for (;;)
+    {
+        lPages = VirtualAlloc(NULL, pSize + pAlignment, MEM_RESERVE, PAGE_NOACCESS);
+
+        if (NULL == lPages)
+        {
+            return(FALSE);
+        }
+
+        lAligned = (char *) (((size_t) lPages + pAlignment - 1) & ~(pAlignment - 1));
+
+        VirtualFree(lPages, 0, MEM_RELEASE);
+
+        lPages = VirtualAlloc(lAligned, pSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+
+        if (NULL != lPages)
+        {
+            break;
+        }
+    }
+
+    lLead = 0;
+
+#else
+
+    if (lPageSize == pAlignment)
+    {
+        lPages = PageMap(pSize);
+
+        if (PageMapFailed(lPages))
+        {
+            return(FALSE);
+        }
+
+        *pBuffer = lPages;
+
+        return(TRUE);
+    }
+
+    /*
+    ** map an oversized region then trim the unaligned lead and the tail
+    */
+
+    lPages = PageMap(pSize + pAlignment - lPageSize);
+
+    if (PageMapFailed(lPages))
+    {
+        return(FALSE);
+    }
+
+    lAligned = (char *) (((size_t) lPages + pAlignment - 1) & ~(pAlignment - 1));
+
+    lLead = (size_t) (lAligned - lPages);
+
+    if (0 < lLead)
+    {
+        PageUnmap(lPages, lLead);
+    }
+
+    if (0 < pAlignment - lPageSize - lLead)
+    {
+        PageUnmap(lAligned + pSize, pAlignment - lPageSize - lLead);
+    }
+
+    lPages = lAligned;
+
+#endif
+
+    *pBuffer = lPages;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafePageFree
+(
+    void ** pBuffer,
+    size_t  pSize
+)
+{
+    size_t lPageSize = PageSize();
+
+    if (NULL == pBuffer || NULL == *pBuffer)
+    {
+        return(FALSE);
+    }
+
+    pSize = (pSize + lPageSize - 1) & ~(lPageSize - 1);
+
+#if defined _WIN32 || defined _WIN64
+
+    if (!VirtualFree(*pBuffer, 0, MEM_RELEASE))
+    {
+        return(FALSE);
+    }
+
+#else
+
+    if (0 != PageUnmap(*pBuffer, pSize))
+    {
+        return(FALSE);
+    }
+
+#endif
+
+    *pBuffer = NULL;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafePageDecommit
+(
+    void * pPages,
+    size_t pSize
+)
+{
+    size_t lPageSize = PageSize();
+
+    if (NULL == pPages || 0 == pSize || 0 != ((size_t) pPages & (lPageSize - 1)))
+    {
+        return(FALSE);
+    }
+
+    pSize = (pSize + lPageSize - 1) & ~(lPageSize - 1);
+
+#if defined _WIN32 || defined _WIN64
+
+    if (!VirtualFree(pPages, pSize, MEM_DECOMMIT))
+    {
+        return(FALSE);
+    }
+
+#else
+
+    if (0 != madvise(pPages, pSize, MADV_DONTNEED))
+    {
+        return(FALSE);
+    }
+
+#endif
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafePageRecommit
+(
+    void * pPages,
+    size_t pSize
+)
+{
+    size_t lPageSize = PageSize();
+
+    if (NULL == pPages || 0 == pSize || 0 != ((size_t) pPages & (lPageSize - 1)))
+    {
+        return(FALSE);
+    }
+
+    pSize = (pSize + lPageSize - 1) & ~(lPageSize - 1);
+
+#if defined _WIN32 || defined _WIN64
+
+    if (NULL == VirtualAlloc(pPages, pSize, MEM_COMMIT, PAGE_READWRITE))
+    {
+        return(FALSE);
+    }
+
+#endif
+
+    /*
+    ** decommitted pages of a private mapping fault back in zero filled
+    */
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafePagePrefault
+(
+    void * pPages,
+    size_t pSize
+)
+{
+    size_t lPageSize = PageSize();
+
+    volatile char * lByte;
+
+    if (NULL == pPages || 0 == pSize || 0 != ((size_t) pPages & (lPageSize - 1)))
+    {
+        return(FALSE);
+    }
+
+    pSize = (pSize + lPageSize - 1) & ~(lPageSize - 1);
+
+#if defined MADV_POPULATE_WRITE
+
+    /*
+    ** populate the whole run in one call where the kernel supports it, the
+    ** equivalent of MAP_POPULATE for pages that are already mapped
+    */
+
+    if (0 == madvise(pPages, pSize, MADV_POPULATE_WRITE))
+    {
+        return(TRUE);
+    }
+
+#endif
+
+    /*
+    ** otherwise write every hardware page back with its own contents
+    */
+
+    for (lByte = (volatile char *) pPages; lByte < (volatile char *) pPages + pSize; lByte += MEMORY_PREFAULT_STRIDE)
+    {
+        *lByte = *lByte;
+    }
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafePageAdviseHuge
+(
+    void * pPages,
+    size_t pSize
+)
+{
+    size_t lPageSize = PageSize();
+
+    if (NULL == pPages || 0 == pSize || 0 != ((size_t) pPages & (lPageSize - 1)))
+    {
+        return(FALSE);
+    }
+
+    pSize = (pSize + lPageSize - 1) & ~(lPageSize - 1);
+
+#if defined MADV_HUGEPAGE
+
+    if (0 != madvise(pPages, pSize, MADV_HUGEPAGE))
+    {
+        return(FALSE);
+    }
+
+#endif
+
+    /*
+    ** the advice is only a hint, platforms without it keep their pages
+    */
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafePageAdviseSequential
+(
+    void * pPages,
+    size_t pSize
+)
+{
+    size_t lPageSize = PageSize();
+
+    if (NULL == pPages || 0 == pSize || 0 != ((size_t) pPages & (lPageSize - 1)))
+    {
+        return(FALSE);
+    }
+
+    pSize = (pSize + lPageSize - 1) & ~(lPageSize - 1);
+
+#if defined MADV_SEQUENTIAL
+
+    if (0 != madvise(pPages, pSize, MADV_SEQUENTIAL))
+    {
+        return(FALSE);
+    }
+
+#endif
+
+    return(TRUE);
+}
+
+STORAGE_CLASS size_t CALLING_CONVENTION SafePageSize
+(
+    void
+)
+{
+    return(PageSize());
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeFileMap
+(
+    void ** pBuffer,
+    const char * pPath,
+    size_t pSize,
+    size_t pAlignment
+)
+{
+    size_t lPageSize = PageSize();
+
+    char * lPages;
+    char * lAligned;
+
+#if defined _WIN32 || defined _WIN64
+
+    HANDLE lFile;
+    HANDLE lMapping;
+
+#else
+
+    int lFile;
+
+    struct stat lStatus;
+
+    size_t lLead;
+
+#endif
+
+    if (NULL == pBuffer || NULL != *pBuffer || NULL == pPath || 0 == pSize)
+    {
+        return(FALSE);
+    }
+
+    if (0 != (pAlignment & (pAlignment - 1)))
+    {
+        return(FALSE);
+    }
+
+    pSize = (pSize + lPageSize - 1) & ~(lPageSize - 1);
+
+    if (pAlignment < lPageSize)
+    {
+        pAlignment = lPageSize;
+    }
+
+#if defined _WIN32 || defined _WIN64
+
+    lFile = CreateFileA(pPath, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (INVALID_HANDLE_VALUE == lFile)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** a mapping larger than its file extends the file
+    */
+
+    lMapping = CreateFileMappingA(lFile, NULL, PAGE_READWRITE, (DWORD) ((unsigned long long) pSize >> 32), (DWORD) pSize, NULL);
+
+    CloseHandle(lFile);
+
+    if (NULL == lMapping)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** find an aligned address as SafePageAlloc() does, the view keeps the
+    ** mapping open once it is made
+    */
+
+    for (;;)
+    {
+        lPages = VirtualAlloc(NULL, pSize + pAlignment, MEM_RESERVE, PAGE_NOACCESS);
+
+        if (NULL == lPages)
+        {
+            CloseHandle(lMapping);
+
+            return(FALSE);
+        }
+
+        lAligned = (char *) (((size_t) lPages + pAlignment - 1) & ~(pAlignment - 1));
+
+        VirtualFree(lPages, 0, MEM_RELEASE);
+
+        lPages = MapViewOfFileEx(lMapping, FILE_MAP_ALL_ACCESS, 0, 0, pSize, lAligned);
+
+        if (NULL != lPages)
+        {
+            break;
+        }
+    }
+
+    CloseHandle(lMapping);
+
+#else
+
+    lFile = open(pPath, O_RDWR | O_CREAT, 0600);
+
+    if (0 > lFile)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** a file is only ever extended, sparsely, never cut short
+    */
+
+    if (0 != fstat(lFile, &lStatus) || ((size_t) lStatus.st_size < pSize && 0 != ftruncate(lFile, (off_t) pSize)))
+    {
+        close(lFile);
+
+        return(FALSE);
+    }
+
+    /*
+    ** reserve an oversized anonymous region and map the file over its
+    ** aligned part, then trim the lead and the tail
+    */
+
+    lPages = PageMap(pSize + pAlignment - lPageSize);
+
+    if (PageMapFailed(lPages))
+    {
+        close(lFile);
+
+        return(FALSE);
+    }
+
+    lAligned = (char *) (((size_t) lPages + pAlignment - 1) & ~(pAlignment - 1));
+
+    if (MAP_FAILED == mmap(lAligned, pSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, lFile, 0))
+    {
+        PageUnmap(lPages, pSize + pAlignment - lPageSize);
+
+        close(lFile);
+
+        return(FALSE);
+    }
+
+    close(lFile);
+
+    lLead = (size_t) (lAligned - lPages);
+
+    if (0 < lLead)
+    {
+        PageUnmap(lPages, lLead);
+    }
+
+    if (0 < pAlignment - lPageSize - lLead)
+    {
+        PageUnmap(lAligned + pSize, pAlignment - lPageSize - lLead);
+    }
+
+    lPages = lAligned;
+
+#endif
+
+    *pBuffer = lPages;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeFileMapRead
+(
+    void ** pBuffer,
+    const char * pPath,
+    size_t * pSize,
+    size_t pAlignment
+)
+{
+    size_t lPageSize = PageSize();
+    size_t lSize;
+
+    char * lPages;
+    char * lAligned;
+
+#if defined _WIN32 || defined _WIN64
+
+    HANDLE lFile;
+    HANDLE lMapping;
+
+    LARGE_INTEGER lFileSize;
+
+#else
+
+    int lFile;
+
+    struct stat lStatus;
+
+    size_t lLead;
+    size_t lMapped;
+
+#endif
+
+    if (NULL == pBuffer || NULL != *pBuffer || NULL == pPath || NULL == pSize)
+    {
+        return(FALSE);
+    }
+
+    if (0 != (pAlignment & (pAlignment - 1)))
+    {
+        return(FALSE);
+    }
+
+    if (pAlignment < lPageSize)
+    {
+        pAlignment = lPageSize;
+    }
+
+#if defined _WIN32 || defined _WIN64
+
+    lFile = CreateFileA(pPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+    if (INVALID_HANDLE_VALUE == lFile)
+    {
+        return(FALSE);
+    }
+
+    if (!GetFileSizeEx(lFile, &lFileSize))
+    {
+        CloseHandle(lFile);
+
+        return(FALSE);
+    }
+
+    lSize = (size_t) lFileSize.QuadPart;
+
+    /*
+    ** an empty file has nothing to map
+    */
+
+    if (0 == lSize)
+    {
+        CloseHandle(lFile);
+
+        *pSize = 0;
+
+        return(TRUE);
+    }
+
+    lMapping = CreateFileMappingA(lFile, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    CloseHandle(lFile);
+
+    if (NULL == lMapping)
+    {
+        return(FALSE);
+    }
+
+    for (;;)
+    {
+        lPages = VirtualAlloc(NULL, lSize + pAlignment, MEM_RESERVE, PAGE_NOACCESS);
+
+        if (NULL == lPages)
+        {
+            CloseHandle(lMapping);
+
+            return(FALSE);
+        }
+
+        lAligned = (char *) (((size_t) lPages + pAlignment - 1) & ~(pAlignment - 1));
+
+        VirtualFree(lPages, 0, MEM_RELEASE);
+
+        lPages = MapViewOfFileEx(lMapping, FILE_MAP_READ, 0, 0, lSize, lAligned);
+
+        if (NULL != lPages)
+        {
+            break;
+        }
+    }
+
+    CloseHandle(lMapping);
+
+#else
+
+    lFile = open(pPath, O_RDONLY);
+
+    if (0 > lFile)
+    {
+        return(FALSE);
+    }
+
+    if (0 != fstat(lFile, &lStatus))
+    {
+        close(lFile);
+
+        return(FALSE);
+    }
+
+    lSize = (size_t) lStatus.st_size;
+
+    /*
+    ** an empty file has nothing to map
+    */
+
+    if (0 == lSize)
+    {
+        close(lFile);
+
+        *pSize = 0;
+
+        return(TRUE);
+    }
+
+    lMapped = (lSize + lPageSize - 1) & ~(lPageSize - 1);
+
+    /*
+    ** reserve an oversized anonymous region and map the file over its
+    ** aligned part, then trim the lead and the tail as SafeFileMap() does
+    */
+
+    lPages = PageMap(lMapped + pAlignment - lPageSize);
+
+    if (PageMapFailed(lPages))
+    {
+        close(lFile);
+
+        return(FALSE);
+    }
+
+    lAligned = (char *) (((size_t) lPages + pAlignment - 1) & ~(pAlignment - 1));
+
+    if (MAP_FAILED == mmap(lAligned, lMapped, PROT_READ, MAP_PRIVATE | MAP_FIXED, lFile, 0))
+    {
+        PageUnmap(lPages, lMapped + pAlignment - lPageSize);
+
+        close(lFile);
+
+        return(FALSE);
+    }
+
+    close(lFile);
+
+    lLead = (size_t) (lAligned - lPages);
+
+    if (0 < lLead)
+    {
+        PageUnmap(lPages, lLead);
+    }
+
+    if (0 < pAlignment - lPageSize - lLead)
+    {
+        PageUnmap(lAligned + lMapped, pAlignment - lPageSize - lLead);
+    }
+
+    lPages = lAligned;
+
+#endif
+
+    *pBuffer = lPages;
+    *pSize = lSize;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeFileUnmap
+(
+    void ** pBuffer,
+    size_t pSize
+)
+{
+    size_t lPageSize = PageSize();
+
+    if (NULL == pBuffer || NULL == *pBuffer)
+    {
+        return(FALSE);
+    }
+
+    pSize = (pSize + lPageSize - 1) & ~(lPageSize - 1);
+
+#if defined _WIN32 || defined _WIN64
+
+    if (!UnmapViewOfFile(*pBuffer))
+    {
+        return(FALSE);
+    }
+
+#else
+
+    if (0 != PageUnmap(*pBuffer, pSize))
+    {
+        return(FALSE);
+    }
+
+#endif
+
+    *pBuffer = NULL;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeFileSync
+(
+    void * pPages,
+    size_t pSize
+)
+{
+    size_t lPageSize = PageSize();
+
+    if (NULL == pPages || 0 == pSize || 0 != ((size_t) pPages & (lPageSize - 1)))
+    {
+        return(FALSE);
+    }
+
+    pSize = (pSize + lPageSize - 1) & ~(lPageSize - 1);
+
+#if defined _WIN32 || defined _WIN64
+
+    if (!FlushViewOfFile(pPages, pSize))
+    {
+        return(FALSE);
+    }
+
+#else
+
+    if (0 != msync(pPages, pSize, MS_SYNC))
+    {
+        return(FALSE);
+    }
+
+#endif
+
+    return(TRUE);
+}
+
+STORAGE_CLASS smartAllocatorHandle CALLING_CONVENTION SmartThreadCacheGetAllocator
+(
+    void
+)
+{
+    call_once(&gCacheOnce, CacheInitialize);
+
+    return(&gCacheAllocator);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartThreadCacheFlush
+(
+    void
+)
+{
+    unsigned int lClassIndex;
+
+    call_once(&gCacheOnce, CacheInitialize);
+
+    for (lClassIndex = 0; lClassIndex < CACHE_CLASSES; lClassIndex++)
+    {
+        CacheDrain(&gThreadCache.lists[lClassIndex], lClassIndex, gThreadCache.lists[lClassIndex].count);
+    }
+
+    return(TRUE);
+}
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartThreadCacheGetMemoryAllocated
+(
+    void
+)
+{
+    size_t lMemoryAllocated;
+
+    call_once(&gCacheOnce, CacheInitialize);
+
+    mtx_lock(&gCacheBackend.lock);
+
+    lMemoryAllocated = gCacheBackend.memoryAllocated;
+
+    mtx_unlock(&gCacheBackend.lock);
+
+    return(lMemoryAllocated);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartDeferredFreeStart
+(
+    Bool pReclaimer
+)
+{
+    call_once(&gDeferredOnce, DeferredInitialize);
+
+    mtx_lock(&gDeferred.lock);
+
+    if (pReclaimer && !gDeferred.running)
+    {
+        gDeferred.running = TRUE;
+
+        if (thrd_success != thrd_create(&gDeferred.thread, DeferredReclaimer, NULL))
+        {
+            gDeferred.running = FALSE;
+
+            mtx_unlock(&gDeferred.lock);
+
+            return(FALSE);
+        }
+    }
+
+    mtx_unlock(&gDeferred.lock);
+
+    atomic_store(&gDeferred.enabled, TRUE);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartDeferredFreeFlush
+(
+    void
+)
+{
+    memoryDeferredBatch * lBatch = gDeferredBatch;
+
+    call_once(&gDeferredOnce, DeferredInitialize);
+
+    /*
+    ** detach the batch first so that the frees it makes land in a new one
+    */
+
+    gDeferredBatch = NULL;
+
+    tss_set(gDeferredThreadExit, NULL);
+
+    DeferredSubmit(lBatch);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartDeferredFreeStop
+(
+    void
+)
+{
+    memoryDeferredBatch * lQueue;
+
+    Bool lRunning;
+
+    call_once(&gDeferredOnce, DeferredInitialize);
+
+    atomic_store(&gDeferred.enabled, FALSE);
+
+    SmartDeferredFreeFlush();
+
+    /*
+    ** let the reclaimer finish the queue and exit
+    */
+
+    mtx_lock(&gDeferred.lock);
+
+    lRunning = gDeferred.running;
+
+    gDeferred.running = FALSE;
+
+    cnd_signal(&gDeferred.wake);
+
+    mtx_unlock(&gDeferred.lock);
+
+    if (lRunning)
+    {
+        thrd_join(gDeferred.thread, NULL);
+    }
+
+    /*
+    ** batches queued while the reclaimer was stopping
+    */
+
+    mtx_lock(&gDeferred.lock);
+
+    lQueue = gDeferred.queue;
+
+    gDeferred.queue = NULL;
+
+    mtx_unlock(&gDeferred.lock);
+
+    DeferredReclaim(lQueue);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartDeferredFreeGetPending
+(
+    void
+)
+{
+    return(atomic_load(&gDeferred.pending));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartCounterConstructSmartCounter
+(
+    smartCounterHandle * pCounter,
+    size_t pMemoryMaximum
+)
+{
+    if (NULL == pCounter)
+    {
+        return(FALSE);
+    }
+
+    if (!SafeMalloc((void **) pCounter, sizeof(memoryCounter)))
+    {
+        return(FALSE);
+    }
+
+    CounterInitialize(*pCounter, pMemoryMaximum, COUNTER_SHARDS);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartCounterReserve
+(
+    smartCounterHandle pCounter,
+    size_t pSize
+)
+{
+    memoryCounterShard * lShard;
+
+    size_t lSlack;
+
+    if (NULL == pCounter)
+    {
+        return(FALSE);
+    }
+
+    if (0 == pSize)
+    {
+        return(TRUE);
+    }
+
+    if (0 == pCounter->shardCount)
+    {
+        return(CounterGrant(pCounter, pSize));
+    }
+
+    /*
+    ** take the bytes from the headroom already held by this thread's shard
+    */
+
+    lShard = &pCounter->shards[CounterShardIndex()];
+
+    lSlack = atomic_load_explicit(&lShard->slack, memory_order_relaxed);
+
+    while (pSize <= lSlack)
+    {
+        if (atomic_compare_exchange_weak_explicit(&lShard->slack, &lSlack, lSlack - pSize, memory_order_acq_rel, memory_order_relaxed))
+        {
+            return(TRUE);
+        }
+    }
+
+    /*
+    ** charge the request along with fresh headroom for the shard, or just the
+    ** request when the maximum is close
+    */
+
+    if (CounterGrant(pCounter, pSize + COUNTER_GRANT_SIZE))
+    {
+        atomic_fetch_add_explicit(&lShard->slack, COUNTER_GRANT_SIZE, memory_order_relaxed);
+
+        return(TRUE);
+    }
+
+    if (CounterGrant(pCounter, pSize))
+    {
+        return(TRUE);
+    }
+
+    /*
+    ** headroom parked in other shards may be all that stands in the way
+    */
+
+    CounterReclaim(pCounter);
+
+    return(CounterGrant(pCounter, pSize));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartCounterRelease
+(
+    smartCounterHandle pCounter,
+    size_t pSize
+)
+{
+    memoryCounterShard * lShard;
+
+    size_t lSlack;
+
+    if (NULL == pCounter)
+    {
+        return(FALSE);
+    }
+
+    if (0 == pCounter->shardCount)
+    {
+        atomic_fetch_sub_explicit(&pCounter->granted, pSize, memory_order_acq_rel);
+
+        return(TRUE);
+    }
+
+    lShard = &pCounter->shards[CounterShardIndex()];
+
+    lSlack = atomic_fetch_add_explicit(&lShard->slack, pSize, memory_order_acq_rel) + pSize;
+
+    /*
+    ** a shard that frees more than it allocates hands its headroom back so
+    ** that other shards can reach the maximum
+    */
+
+    if (2 * COUNTER_GRANT_SIZE < lSlack)
+    {
+        lSlack = atomic_exchange_explicit(&lShard->slack, 0, memory_order_acq_rel);
+
+        atomic_fetch_sub_explicit(&pCounter->granted, lSlack, memory_order_acq_rel);
+    }
+
+    return(TRUE);
+}
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartCounterGetValue
+(
+    smartCounterHandle pCounter
+)
+{
+    unsigned int lShardIndex;
+
+    size_t lGranted;
+    size_t lSlack = 0;
+
+    if (NULL == pCounter)
+    {
+        return(0);
+    }
+
+    /*
+    ** the value is exact when the counter is quiescent and approximate while
+    ** other threads are reserving or releasing
+    */
+
+    for (lShardIndex = 0; lShardIndex < pCounter->shardCount; lShardIndex++)
+    {
+        lSlack += atomic_load_explicit(&pCounter->shards[lShardIndex].slack, memory_order_acquire);
+    }
+
+    lGranted = atomic_load_explicit(&pCounter->granted, memory_order_acquire);
+
+    return(lSlack < lGranted ? lGranted - lSlack : 0);
+}
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartCounterGetMaximum
+(
+    smartCounterHandle pCounter
+)
+{
+    if (NULL == pCounter)
+    {
+        return(0);
+    }
+
+    return(pCounter->maximum);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartCounterDestructSmartCounter
+(
+    smartCounterHandle * pCounter
+)
+{
+    if (NULL == pCounter || NULL == *pCounter)
+    {
+        return(FALSE);
+    }
+
+    return(SafeFree((void **) pCounter));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartCounterMalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    smartCounterHandle   pCounter
+)
+{
+    if (!SmartCounterReserve(pCounter, pSize))
+    {
+        return(FALSE);
+    }
+
+    if (!SafeAllocatorMalloc(pAllocator, pBuffer, pSize))
+    {
+        SmartCounterRelease(pCounter, pSize);
+
+        return(FALSE);
+    }
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartCounterCalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    smartCounterHandle   pCounter
+)
+{
+    if (!SmartCounterReserve(pCounter, pSize))
+    {
+        return(FALSE);
+    }
+
+    if (!SafeAllocatorCalloc(pAllocator, pBuffer, pSize))
+    {
+        SmartCounterRelease(pCounter, pSize);
+
+        return(FALSE);
+    }
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartCounterFree
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    smartCounterHandle   pCounter
+)
+{
+    if (NULL == pCounter)
+    {
+        return(FALSE);
+    }
+
+    if (!SafeAllocatorFree(pAllocator, pBuffer, pSize))
+    {
+        return(FALSE);
+    }
+
+    return(SmartCounterRelease(pCounter, pSize));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetConstructSmartBudget
+(
+    smartBudgetHandle * pBudget,
+    size_t pMemoryMaximum,
+    smartBudgetHandle pParent
+)
+{
+    if (NULL == pBudget)
+    {
+        return(FALSE);
+    }
+
+    if (!SafeMalloc((void **) pBudget, sizeof(memoryBudget)))
+    {
+        return(FALSE);
+    }
+
+    CounterInitialize(&(* pBudget)->counter, pMemoryMaximum, COUNTER_SHARDS);
+
+    (* pBudget)->parent = pParent;
+
+    (* pBudget)->pressureFunction = NULL;
+    (* pBudget)->pressureContext = NULL;
+
+    (* pBudget)->allocator = NULL;
+    (* pBudget)->allocated = 0;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetConstructSmartBudgetWithAllocator
+(
+    smartBudgetHandle * pBudget,
+    size_t pMemoryMaximum,
+    smartBudgetHandle pParent,
+    smartAllocatorHandle pAllocator
+)
+{
+    unsigned int lShardCount = COUNTER_SHARDS;
+
+    size_t lSize = sizeof(memoryBudget);
+
+    if (NULL == pBudget)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** a budget with neither a limit nor a parent only keeps a count, which
+    ** needs no shards
+    */
+
+    if (0 == pMemoryMaximum && NULL == pParent)
+    {
+        lShardCount = 0;
+        lSize = BUDGET_UNSHARDED_SIZE;
+    }
+
+    if (!SafeAllocatorMalloc(pAllocator, (void **) pBudget, lSize))
+    {
+        return(FALSE);
+    }
+
+    CounterInitialize(&(* pBudget)->counter, pMemoryMaximum, lShardCount);
+
+    (* pBudget)->parent = pParent;
+
+    (* pBudget)->pressureFunction = NULL;
+    (* pBudget)->pressureContext = NULL;
+
+    (* pBudget)->allocator = pAllocator;
+    (* pBudget)->allocated = lSize;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetReserve
+(
+    smartBudgetHandle pBudget,
+    size_t pSize
+)
+{
+    if (NULL == pBudget)
+    {
+        return(FALSE);
+    }
+
+    return(BudgetReserve(pBudget, pSize, NULL));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetRelease
+(
+    smartBudgetHandle pBudget,
+    size_t pSize
+)
+{
+    if (NULL == pBudget)
+    {
+        return(FALSE);
+    }
+
+    BudgetRelease(pBudget, pSize, NULL);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetTransfer
+(
+    smartBudgetHandle pFromBudget,
+    smartBudgetHandle pToBudget,
+    size_t pSize
+)
+{
+    memoryBudget * lCommon;
+
+    if (NULL == pFromBudget || NULL == pToBudget)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** the shared ancestors keep the charge, only the levels below them move
+    */
+
+    lCommon = BudgetCommonAncestor(pFromBudget, pToBudget);
+
+    if (!BudgetReserve(pToBudget, pSize, lCommon))
+    {
+        return(FALSE);
+    }
+
+    BudgetRelease(pFromBudget, pSize, lCommon);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetSetPressureFunction
+(
+    smartBudgetHandle pBudget,
+    smartPressureFunction pPressureFunction,
+    void * pContext
+)
+{
+    if (NULL == pBudget)
+    {
+        return(FALSE);
+    }
+
+    pBudget->pressureFunction = pPressureFunction;
+    pBudget->pressureContext = pContext;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartBudgetGetValue
+(
+    smartBudgetHandle pBudget
+)
+{
+    if (NULL == pBudget)
+    {
+        return(0);
+    }
+
+    return(SmartCounterGetValue(&pBudget->counter));
+}
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartBudgetGetMaximum
+(
+    smartBudgetHandle pBudget
+)
+{
+    if (NULL == pBudget)
+    {
+        return(0);
+    }
+
+    return(pBudget->counter.maximum);
+}
+
+STORAGE_CLASS smartBudgetHandle CALLING_CONVENTION SmartBudgetGetParent
+(
+    smartBudgetHandle pBudget
+)
+{
+    if (NULL == pBudget)
+    {
+        return(NULL);
+    }
+
+    return(pBudget->parent);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetDestructSmartBudget
+(
+    smartBudgetHandle * pBudget
+)
+{
+    if (NULL == pBudget || NULL == *pBudget)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** whatever is still charged (such as the nodes of a container built in a
+    ** region) is handed back to the ancestors
+    */
+
+    if (NULL != (* pBudget)->parent)
+    {
+        BudgetRelease((* pBudget)->parent, SmartCounterGetValue(&(* pBudget)->counter), NULL);
+    }
+
+    if (0 != (* pBudget)->allocated)
+    {
+        return(SafeAllocatorFree((* pBudget)->allocator, (void **) pBudget, (* pBudget)->allocated));
+    }
+
+    return(SafeFree((void **) pBudget));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetMalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    smartBudgetHandle    pBudget
+)
+{
+    if (!SmartBudgetReserve(pBudget, pSize))
+    {
+        return(FALSE);
+    }
+
+    if (!SafeAllocatorMalloc(pAllocator, pBuffer, pSize))
+    {
+        SmartBudgetRelease(pBudget, pSize);
+
+        return(FALSE);
+    }
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetCalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    smartBudgetHandle    pBudget
+)
+{
+    if (!SmartBudgetReserve(pBudget, pSize))
+    {
+        return(FALSE);
+    }
+
+    if (!SafeAllocatorCalloc(pAllocator, pBuffer, pSize))
+    {
+        SmartBudgetRelease(pBudget, pSize);
+
+        return(FALSE);
+    }
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetFree
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    smartBudgetHandle    pBudget
+)
+{
+    if (NULL == pBudget)
+    {
+        return(FALSE);
+    }
+
+    if (!SafeAllocatorFree(pAllocator, pBuffer, pSize))
+    {
+        return(FALSE);
+    }
+
+    return(SmartBudgetRelease(pBudget, pSize));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartMemoryProfileSetSite
+(
+    const char * pFile,
+    int pLine
+)
+{
+#ifdef SMART_MEMORY_PROFILE
+
+    gProfileFile = pFile;
+    gProfileLine = pLine;
+
+#else
+
+    (void) pFile;
+    (void) pLine;
+
+#endif
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartMemoryProfileSnapshot
+(
+    smartMemoryProfile * pProfile
+)
+{
+#ifdef SMART_MEMORY_PROFILE
+
+    memoryProfileSite * lSite;
+
+    smartMemoryProfileSite lSnapshotSite;
+
+    struct timespec lTime;
+
+    unsigned int lBucket;
+    unsigned long lSiteIndex;
+    unsigned long lLeastIndex;
+
+    if (NULL == pProfile)
+    {
+        return(FALSE);
+    }
+
+    call_once(&gProfileOnce, ProfileInitialize);
+
+    pProfile->allocations = atomic_load(&gProfile.allocations);
+    pProfile->deallocations = atomic_load(&gProfile.deallocations);
+    pProfile->bytesAllocated = atomic_load(&gProfile.bytesAllocated);
+
+    pProfile->currentBytes = atomic_load(&gProfile.currentBytes);
+    pProfile->peakBytes = atomic_load(&gProfile.peakBytes);
+
+    timespec_get(&lTime, TIME_UTC);
+
+    mtx_lock(&gProfile.siteLock);
+
+    pProfile->seconds = (double) (lTime.tv_sec - gProfile.resetTime.tv_sec) + ((double) (lTime.tv_nsec - gProfile.resetTime.tv_nsec)) / 1e9;
+
+    mtx_unlock(&gProfile.siteLock);
+
+    for (lBucket = 0; lBucket < SMART_MEMORY_PROFILE_BUCKETS; lBucket++)
+    {
+        pProfile->histogram[lBucket] = atomic_load(&gProfile.histogram[lBucket]);
+    }
+
+    /*
+    ** gather the call sites, keeping the busiest when there are too many
+    */
+
+    pProfile->siteCount = 0;
+
+    for (lSiteIndex = 0; lSiteIndex <= PROFILE_SITE_SLOTS; lSiteIndex++)
+    {
+        if (PROFILE_SITE_SLOTS == lSiteIndex)
+        {
+            lSnapshotSite.file = NULL;
+            lSnapshotSite.line = 0;
+            lSnapshotSite.allocations = atomic_load(&gProfile.unknownSiteAllocations);
+            lSnapshotSite.bytes = atomic_load(&gProfile.unknownSiteBytes);
+        }
+        else
+        {
+            lSite = &gProfile.sites[lSiteIndex];
+
+            lSnapshotSite.file = atomic_load_explicit(&lSite->file, memory_order_acquire);
+            lSnapshotSite.line = lSite->line;
+            lSnapshotSite.allocations = atomic_load(&lSite->allocations);
+            lSnapshotSite.bytes = atomic_load(&lSite->bytes);
+        }
+
+        if (0 == lSnapshotSite.allocations)
+        {
+            continue;
+        }
+
+        if (SMART_MEMORY_PROFILE_SITES > pProfile->siteCount)
+        {
+            pProfile->sites[pProfile->siteCount++] = lSnapshotSite;
+
+            continue;
+        }
+
+        lLeastIndex = 0;
+
+        for (lBucket = 1; lBucket < SMART_MEMORY_PROFILE_SITES; lBucket++)
+        {
+            if (pProfile->sites[lBucket].allocations < pProfile->sites[lLeastIndex].allocations)
+            {
+                lLeastIndex = lBucket;
+            }
+        }
+
+        if (pProfile->sites[lLeastIndex].allocations < lSnapshotSite.allocations)
+        {
+            pProfile->sites[lLeastIndex] = lSnapshotSite;
+        }
+    }
+
+    qsort(pProfile->sites, pProfile->siteCount, sizeof(smartMemoryProfileSite), ProfileCompareSites);
+
+    return(TRUE);
+
+#else
+
+    (void) pProfile;
+
+    return(FALSE);
+
+#endif
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartMemoryProfileReset
+(
+    void
+)
+{
+#ifdef SMART_MEMORY_PROFILE
+
+    unsigned int lBucket;
+    unsigned long lSiteIndex;
+
+    call_once(&gProfileOnce, ProfileInitialize);
+
+    atomic_store(&gProfile.allocations, 0);
+    atomic_store(&gProfile.deallocations, 0);
+    atomic_store(&gProfile.bytesAllocated, 0);
+
+    /*
+    ** memory still allocated stays allocated, so the current bytes carry on
+    ** and become the new peak
+    */
+
+    atomic_store(&gProfile.peakBytes, atomic_load(&gProfile.currentBytes));
+
+    for (lBucket = 0; lBucket < SMART_MEMORY_PROFILE_BUCKETS; lBucket++)
+    {
+        atomic_store(&gProfile.histogram[lBucket], 0);
+    }
+
+    for (lSiteIndex = 0; lSiteIndex < PROFILE_SITE_SLOTS; lSiteIndex++)
+    {
+        atomic_store(&gProfile.sites[lSiteIndex].allocations, 0);
+        atomic_store(&gProfile.sites[lSiteIndex].bytes, 0);
+    }
+
+    atomic_store(&gProfile.unknownSiteAllocations, 0);
+    atomic_store(&gProfile.unknownSiteBytes, 0);
+
+    mtx_lock(&gProfile.siteLock);
+
+    timespec_get(&gProfile.resetTime, TIME_UTC);
+
+    mtx_unlock(&gProfile.siteLock);
+
+    return(TRUE);
+
+#else
+
+    return(FALSE);
+
+#endif
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartMemoryProfileDump
+(
+    FILE * pFile,
+    Bool pJson
+)
+{
+#ifdef SMART_MEMORY_PROFILE
+
+    static smartMemoryProfile lProfile;
+
+    unsigned int lBucket;
+    unsigned long lSiteIndex;
+
+    double lRate;
+
+    if (NULL == pFile || !SmartMemoryProfileSnapshot(&lProfile))
+    {
+        return(FALSE);
+    }
+
+    lRate = 0 < lProfile.seconds ? ((double) lProfile.allocations) / lProfile.seconds : 0;
+
+    if (!pJson)
+    {
+        fprintf(pFile, "Memory profile (%.3f secs)\n\n", lProfile.seconds);
+        fprintf(pFile, "Allocations     = %llu (%.0f/sec)\n", lProfile.allocations, lRate);
+        fprintf(pFile, "Deallocations   = %llu\n", lProfile.deallocations);
+        fprintf(pFile, "Bytes Allocated = %llu\n", lProfile.bytesAllocated);
+        fprintf(pFile, "Current Bytes   = %llu\n", (unsigned long long) lProfile.currentBytes);
+        fprintf(pFile, "Peak Bytes      = %llu\n\n", (unsigned long long) lProfile.peakBytes);
+
+        fprintf(pFile, "Allocation sizes:\n");
+
+        for (lBucket = 0; lBucket < SMART_MEMORY_PROFILE_BUCKETS; lBucket++)
+        {
+            if (0 < lProfile.histogram[lBucket])
+            {
+                fprintf(pFile, "  %s%11llu bytes %12llu\n", SMART_MEMORY_PROFILE_BUCKETS - 1 == lBucket ? "> " : "<=", 1ULL << (SMART_MEMORY_PROFILE_BUCKETS - 1 == lBucket ? lBucket - 1 : lBucket), lProfile.histogram[lBucket]);
+            }
+        }
+
+        fprintf(pFile, "\nCall sites:\n");
+
+        for (lSiteIndex = 0; lSiteIndex < lProfile.siteCount; lSiteIndex++)
+        {
+            fprintf(pFile, "  %12llu %14llu bytes  %s:%d\n", lProfile.sites[lSiteIndex].allocations, lProfile.sites[lSiteIndex].bytes, NULL == lProfile.sites[lSiteIndex].file ? "(unknown)" : lProfile.sites[lSiteIndex].file, lProfile.sites[lSiteIndex].line);
+        }
+
+        fprintf(pFile, "\n");
+    }
+    else
+    {
+        fprintf(pFile, "{\"seconds\":%.3f,\"allocations\":%llu,\"allocationsPerSecond\":%.0f,\"deallocations\":%llu,\"bytesAllocated\":%llu,\"currentBytes\":%llu,\"peakBytes\":%llu,",
+                lProfile.seconds, lProfile.allocations, lRate, lProfile.deallocations, lProfile.bytesAllocated, (unsigned long long) lProfile.currentBytes, (unsigned long long) lProfile.peakBytes);
+
+        fprintf(pFile, "\"histogram\":[");
+
+        for (lBucket = 0; lBucket < SMART_MEMORY_PROFILE_BUCKETS; lBucket++)
+        {
+            fprintf(pFile, "%s%llu", 0 == lBucket ? "" : ",", lProfile.histogram[lBucket]);
+        }
+
+        fprintf(pFile, "],\"sites\":[");
+
+        for (lSiteIndex = 0; lSiteIndex < lProfile.siteCount; lSiteIndex++)
+        {
+            fprintf(pFile, "%s{\"file\":", 0 == lSiteIndex ? "" : ",");
+
+            ProfileDumpString(pFile, lProfile.sites[lSiteIndex].file);
+
+            fprintf(pFile, ",\"line\":%d,\"allocations\":%llu,\"bytes\":%llu}", lProfile.sites[lSiteIndex].line, lProfile.sites[lSiteIndex].allocations, lProfile.sites[lSiteIndex].bytes);
+        }
+
+        fprintf(pFile, "]}\n");
+    }
+
+    fflush(pFile);
+
+    return(TRUE);
+
+#else
+
+    (void) pFile;
+    (void) pJson;
+
+    return(FALSE);
+
+#endif
+}
+
+/*----------------------------------------------------------------------------
+  Private functions
+  ----------------------------------------------------------------------------*/
+
+#ifdef SMART_MEMORY_PROFILE
+
+static void ProfileInitialize
+(
+    void
+)
+{
+    mtx_init(&gProfile.siteLock, mtx_plain);
+
+    timespec_get(&gProfile.resetTime, TIME_UTC);
+}
+
+static void ProfileRecord
+(
+    size_t pSize,
+    size_t pOldSize,
+    Bool pIsAllocation
+)
+{
+    memoryProfileSite * lSite = NULL;
+
+    size_t lCurrent;
+    size_t lPeak;
+
+    call_once(&gProfileOnce, ProfileInitialize);
+
+    if (pIsAllocation)
+    {
+        atomic_fetch_add_explicit(&gProfile.allocations, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&gProfile.bytesAllocated, pSize, memory_order_relaxed);
+        atomic_fetch_add_explicit(&gProfile.histogram[ProfileSizeBucket(pSize)], 1, memory_order_relaxed);
+
+        if (NULL != gProfileFile)
+        {
+            lSite = ProfileGetSite(gProfileFile, gProfileLine);
+        }
+
+        if (NULL != lSite)
+        {
+            atomic_fetch_add_explicit(&lSite->allocations, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&lSite->bytes, pSize, memory_order_relaxed);
+        }
+        else
+        {
+            atomic_fetch_add_explicit(&gProfile.unknownSiteAllocations, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&gProfile.unknownSiteBytes, pSize, memory_order_relaxed);
+        }
+    }
+    else
+    {
+        atomic_fetch_add_explicit(&gProfile.deallocations, 1, memory_order_relaxed);
+    }
+
+    /*
+    ** track the current bytes and raise the peak to meet them
+    */
+
+    if (pSize >= pOldSize)
+    {
+        lCurrent = atomic_fetch_add_explicit(&gProfile.currentBytes, pSize - pOldSize, memory_order_relaxed) + pSize - pOldSize;
+
+        lPeak = atomic_load_explicit(&gProfile.peakBytes, memory_order_relaxed);
+
+        while (lPeak < lCurrent && !atomic_compare_exchange_weak_explicit(&gProfile.peakBytes, &lPeak, lCurrent, memory_order_relaxed, memory_order_relaxed))
+        {
+        }
+    }
+    else
+    {
+        atomic_fetch_sub_explicit(&gProfile.currentBytes, pOldSize - pSize, memory_order_relaxed);
+    }
+
+    gProfileFile = NULL;
+}
+
+static unsigned int ProfileSizeBucket
+(
+    size_t pSize
+)
+{
+    unsigned int lBucket = 0;
+
+    if (0 == pSize)
+    {
+        return(0);
+    }
+
+    pSize--;
+
+    while (0 != pSize && SMART_MEMORY_PROFILE_BUCKETS - 1 > lBucket)
+    {
+        pSize >>= 1;
+
+        lBucket++;
+    }
+
+    return(lBucket);
+}
+
+static memoryProfileSite * ProfileGetSite
+(
+    const char * pFile,
+    int pLine
+)
+{
+    memoryProfileSite * lSite;
+
+    const char * lFile;
+
+    size_t lHash = (((size_t) pFile) >> 3) ^ ((size_t) pLine * 2654435761U);
+
+    unsigned long lProbe;
+
+    for (lProbe = 0; lProbe < PROFILE_SITE_SLOTS; lProbe++)
+    {
+        lSite = &gProfile.sites[(lHash + lProbe) & (PROFILE_SITE_SLOTS - 1)];
+
+        lFile = atomic_load_explicit(&lSite->file, memory_order_acquire);
+
+        /*
+        ** claim an empty slot under the lock, publishing the line before the
+        ** file so that readers never see a half claimed slot
+        */
+
+        if (NULL == lFile)
+        {
+            mtx_lock(&gProfile.siteLock);
+
+            lFile = atomic_load_explicit(&lSite->file, memory_order_acquire);
+
+            if (NULL == lFile)
+            {
+                lSite->line = pLine;
+
+                atomic_store_explicit(&lSite->file, pFile, memory_order_release);
+
+                lFile = pFile;
+            }
+
+            mtx_unlock(&gProfile.siteLock);
+        }
+
+        if (pFile == lFile && pLine == lSite->line)
+        {
+            return(lSite);
+        }
+    }
+
+    return(NULL);
+}
+
+static int ProfileCompareSites
+(
+    const void * pSite1,
+    const void * pSite2
+)
+{
+    unsigned long long lAllocations1 = ((const smartMemoryProfileSite *) pSite1)->allocations;
+    unsigned long long lAllocations2 = ((const smartMemoryProfileSite *) pSite2)->allocations;
+
+    return(lAllocations1 < lAllocations2 ? 1 : lAllocations1 > lAllocations2 ? -1 : 0);
+}
+
+static void ProfileDumpString
+(
+    FILE * pFile,
+    const char * pString
+)
+{
+    if (NULL == pString)
+    {
+        fprintf(pFile, "null");
+
+        return;
+    }
+
+    fputc('"', pFile);
+
+    for (; '\0' != *pString; pString++)
+    {
+        if ('"' == *pString || '\\' == *pString)
+        {
+            fputc('\\', pFile);
+        }
+
+        fputc(*pString, pFile);
+    }
+
+    fputc('"', pFile);
+}
+
+#endif
+
+static void CounterInitialize
+(
+    memoryCounter * pCounter,
+    size_t pMemoryMaximum,
+    unsigned int pShardCount
+)
+{
+    unsigned int lShardIndex;
+
+    atomic_init(&pCounter->granted, 0);
+
+    for (lShardIndex = 0; lShardIndex < pShardCount; lShardIndex++)
+    {
+        atomic_init(&pCounter->shards[lShardIndex].slack, 0);
+    }
+
+    pCounter->maximum = pMemoryMaximum;
+    pCounter->shardCount = pShardCount;
+}
+
+static unsigned int CounterShardIndex
+(
+    void
+)
+{
+    if (0 == gCounterShard)
+    {
+        gCounterShard = 1 + (atomic_fetch_add_explicit(&gCounterNextShard, 1, memory_order_relaxed) & (COUNTER_SHARDS - 1));
+    }
+
+    return(gCounterShard - 1);
+}
+
+static Bool CounterGrant
+(
+    memoryCounter * pCounter,
+    size_t pSize
+)
+{
+    size_t lGranted = atomic_load_explicit(&pCounter->granted, memory_order_relaxed);
+
+    do
+    {
+        if (0 < pCounter->maximum && (pCounter->maximum < lGranted || pCounter->maximum - lGranted < pSize))
+        {
+            return(FALSE);
+        }
+    }
+    while (!atomic_compare_exchange_weak_explicit(&pCounter->granted, &lGranted, lGranted + pSize, memory_order_acq_rel, memory_order_relaxed));
+
+    return(TRUE);
+}
+
+static void CounterReclaim
+(
+    memoryCounter * pCounter
+)
+{
+    unsigned int lShardIndex;
+
+    size_t lSlack;
+
+    for (lShardIndex = 0; lShardIndex < pCounter->shardCount; lShardIndex++)
+    {
+        lSlack = atomic_exchange_explicit(&pCounter->shards[lShardIndex].slack, 0, memory_order_acq_rel);
+
+        if (0 < lSlack)
+        {
+            atomic_fetch_sub_explicit(&pCounter->granted, lSlack, memory_order_acq_rel);
+        }
+    }
+}
+
+static Bool BudgetReserve
+(
+    memoryBudget * pBudget,
+    size_t pSize,
+    memoryBudget * pStop
+)
+{
+    memoryBudget * lBudget;
+    memoryBudget * lReserved;
+
+    for (lBudget = pBudget; pStop != lBudget; lBudget = lBudget->parent)
+    {
+        if (!BudgetReserveLevel(lBudget, pSize))
+        {
+            for (lReserved = pBudget; lBudget != lReserved; lReserved = lReserved->parent)
+            {
+                SmartCounterRelease(&lReserved->counter, pSize);
+            }
+
+            return(FALSE);
+        }
+    }
+
+    return(TRUE);
+}
+
+static Bool BudgetReserveLevel
+(
+    memoryBudget * pBudget,
+    size_t pSize
+)
+{
+    unsigned int lRetry;
+
+    size_t lValue;
+
+    for (lRetry = 0; ; lRetry++)
+    {
+        if (SmartCounterReserve(&pBudget->counter, pSize))
+        {
+            return(TRUE);
+        }
+
+        if (NULL == pBudget->pressureFunction || BUDGET_PRESSURE_RETRIES <= lRetry)
+        {
+            return(FALSE);
+        }
+
+        /*
+        ** another thread may have released memory since the refusal, in which
+        ** case the shortfall is rounded up to a byte to keep the call useful
+        */
+
+        lValue = SmartCounterGetValue(&pBudget->counter);
+
+        if (!pBudget->pressureFunction(pBudget->pressureContext, lValue + pSize > pBudget->counter.maximum ? lValue + pSize - pBudget->counter.maximum : 1))
+        {
+            return(FALSE);
+        }
+    }
+}
+
+static void BudgetRelease
+(
+    memoryBudget * pBudget,
+    size_t pSize,
+    memoryBudget * pStop
+)
+{
+    memoryBudget * lBudget;
+
+    for (lBudget = pBudget; pStop != lBudget; lBudget = lBudget->parent)
+    {
+        SmartCounterRelease(&lBudget->counter, pSize);
+    }
+}
+
+static memoryBudget * BudgetCommonAncestor
+(
+    memoryBudget * pBudget1,
+    memoryBudget * pBudget2
+)
+{
+    memoryBudget * lBudget1;
+    memoryBudget * lBudget2;
+
+    for (lBudget1 = pBudget1; NULL != lBudget1; lBudget1 = lBudget1->parent)
+    {
+        for (lBudget2 = pBudget2; NULL != lBudget2; lBudget2 = lBudget2->parent)
+        {
+            if (lBudget1 == lBudget2)
+            {
+                return(lBudget1);
+            }
+        }
+    }
+
+    return(NULL);
+}
+
+static unsigned int CacheClassIndex
+(
+    size_t pSize
+)
+{
+    unsigned int lClassIndex = 0;
+
+    if (0 == pSize)
+    {
+        return(0);
+    }
+
+    pSize = (pSize - 1) >> CACHE_MINIMUM_BLOCK_SHIFT;
+
+    while (0 != pSize)
+    {
+        pSize >>= 1;
+
+        lClassIndex++;
+    }
+
+    return(lClassIndex);
+}
+
+static unsigned long CacheBatchCount
+(
+    unsigned int pClassIndex
+)
+{
+    return((unsigned long) (CACHE_BATCH_BYTES >> (CACHE_MINIMUM_BLOCK_SHIFT + pClassIndex)));
+}
+
+static void CacheInitialize
+(
+    void
+)
+{
+    mtx_init(&gCacheBackend.lock, mtx_plain);
+
+    tss_create(&gCacheThreadExit, CacheThreadExit);
+}
+
+static memoryThreadCache * CacheGetThreadCache
+(
+    void
+)
+{
+    if (!gThreadCache.registered)
+    {
+        /*
+        ** the exit hook only runs for non NULL values so registering the
+        ** cache is what arms it
+        */
+
+        tss_set(gCacheThreadExit, &gThreadCache);
+
+        gThreadCache.registered = TRUE;
+    }
+
+    return(&gThreadCache);
+}
+
+static Bool CacheRefill
+(
+    memoryCacheList * pList,
+    unsigned int pClassIndex
+)
+{
+    memoryCacheList * lBackendList = &gCacheBackend.lists[pClassIndex];
+
+    memoryCacheBlock * lHead;
+    memoryCacheBlock * lTail;
+
+    size_t lBlockSize = CACHE_MINIMUM_BLOCK_SIZE << pClassIndex;
+    size_t lOffset;
+
+    unsigned long lCount;
+    unsigned long lBatchCount = CacheBatchCount(pClassIndex);
+
+    char * lSpan = NULL;
+    char * lBlock;
+
+    mtx_lock(&gCacheBackend.lock);
+
+    if (NULL == lBackendList->head)
+    {
+        if (!SafePageAlloc((void **) &lSpan, CACHE_SPAN_SIZE, 0))
+        {
+            mtx_unlock(&gCacheBackend.lock);
+
+            return(FALSE);
+        }
+
+        gCacheBackend.memoryAllocated += CACHE_SPAN_SIZE;
+
+        /*
+        ** thread the span into blocks back to front so that the batches
+        ** handed out are in address order
+        */
+
+        for (lOffset = CACHE_SPAN_SIZE; 0 < lOffset; lOffset -= lBlockSize)
+        {
+            lBlock = lSpan + lOffset - lBlockSize;
+
+            ((memoryCacheBlock *) lBlock)->next = lBackendList->head;
+
+            lBackendList->head = (memoryCacheBlock *) lBlock;
+            lBackendList->count++;
+        }
+    }
+
+    /*
+    ** detach up to a batch of blocks from the front of the backend list
+    */
+
+    lHead = lBackendList->head;
+    lTail = lHead;
+
+    for (lCount = 1; lCount < lBatchCount && NULL != lTail->next; lCount++)
+    {
+        lTail = lTail->next;
+    }
+
+    lBackendList->head = lTail->next;
+    lBackendList->count -= lCount;
+
+    mtx_unlock(&gCacheBackend.lock);
+
+    lTail->next = pList->head;
+
+    pList->head = lHead;
+    pList->count += lCount;
+
+    return(TRUE);
+}
+
+static void CacheDrain
+(
+    memoryCacheList * pList,
+    unsigned int pClassIndex,
+    unsigned long pCount
+)
+{
+    memoryCacheList * lBackendList = &gCacheBackend.lists[pClassIndex];
+
+    memoryCacheBlock * lHead = pList->head;
+    memoryCacheBlock * lTail;
+
+    unsigned long lCount;
+
+    if (0 == pCount || NULL == lHead)
+    {
+        return;
+    }
+
+    /*
+    ** find the end of the chain outside the lock so that the backend is only
+    ** held for the splice
+    */
+
+    lTail = lHead;
+
+    for (lCount = 1; lCount < pCount && NULL != lTail->next; lCount++)
+    {
+        lTail = lTail->next;
+    }
+
+    pList->head = lTail->next;
+    pList->count -= lCount;
+
+    mtx_lock(&gCacheBackend.lock);
+
+    lTail->next = lBackendList->head;
+
+    lBackendList->head = lHead;
+    lBackendList->count += lCount;
+
+    mtx_unlock(&gCacheBackend.lock);
+}
+
+static void CacheThreadExit
+(
+    void * pThreadCache
+)
+{
+    memoryThreadCache * lThreadCache = (memoryThreadCache *) pThreadCache;
+
+    unsigned int lClassIndex;
+
+    for (lClassIndex = 0; lClassIndex < CACHE_CLASSES; lClassIndex++)
+    {
+        CacheDrain(&lThreadCache->lists[lClassIndex], lClassIndex, lThreadCache->lists[lClassIndex].count);
+    }
+}
+
+static void * CacheAllocate
+(
+    void * pContext,
+    size_t pSize
+)
+{
+    memoryCacheList * lList;
+    memoryCacheBlock * lBlock;
+
+    unsigned int lClassIndex;
+
+    (void) pContext;
+
+    if (CACHE_MAXIMUM_BLOCK_SIZE < pSize)
+    {
+        return(Malloc(pSize));
+    }
+
+    lClassIndex = CacheClassIndex(pSize);
+
+    lList = &CacheGetThreadCache()->lists[lClassIndex];
+
+    if (NULL == lList->head && !CacheRefill(lList, lClassIndex))
+    {
+        return(NULL);
+    }
+
+    lBlock = lList->head;
+
+    lList->head = lBlock->next;
+    lList->count--;
+
+    return(lBlock);
+}
+
+static void * CacheAllocateZeroed
+(
+    void * pContext,
+    size_t pSize
+)
+{
+    void * lBuffer;
+
+    if (CACHE_MAXIMUM_BLOCK_SIZE < pSize)
+    {
+        return(Calloc(pSize));
+    }
+
+    lBuffer = CacheAllocate(pContext, pSize);
+
+    if (NULL != lBuffer)
+    {
+        memset(lBuffer, 0, pSize);
+    }
+
+    return(lBuffer);
+}
+
+static void * CacheAllocateAligned
+(
+    void * pContext,
+    size_t pSize,
+    size_t pAlignment
+)
+{
+    if (CACHE_MAXIMUM_BLOCK_SIZE < pSize)
+    {
+#if defined _WIN32 || defined _WIN64
+
+        return(NULL);
+
+#else
+
+        return(AlignedMalloc(pSize, pAlignment));
+
+#endif
+    }
+
+    /*
+    ** the size is a multiple of the alignment so its size class is too
+    */
+
+    return(CacheAllocate(pContext, pSize));
+}
+
+static void * CacheReallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pOldSize,
+    size_t pSize
+)
+{
+    void * lBuffer;
+
+    if (CACHE_MAXIMUM_BLOCK_SIZE < pOldSize && CACHE_MAXIMUM_BLOCK_SIZE < pSize)
+    {
+        return(Realloc(pBuffer, pSize));
+    }
+
+    /*
+    ** a block already large enough for the new size stays where it is
+    */
+
+    if (CACHE_MAXIMUM_BLOCK_SIZE >= pSize && CacheClassIndex(pOldSize) == CacheClassIndex(pSize))
+    {
+        return(pBuffer);
+    }
+
+    lBuffer = CacheAllocate(pContext, pSize);
+
+    if (NULL == lBuffer)
+    {
+        return(NULL);
+    }
+
+    memcpy(lBuffer, pBuffer, pOldSize < pSize ? pOldSize : pSize);
+
+    CacheDeallocate(pContext, pBuffer, pOldSize);
+
+    return(lBuffer);
+}
+
+static void CacheDeallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pSize
+)
+{
+    memoryCacheList * lList;
+
+    unsigned int lClassIndex;
+
+    (void) pContext;
+
+    if (CACHE_MAXIMUM_BLOCK_SIZE < pSize)
+    {
+        Free(pBuffer);
+
+        return;
+    }
+
+    lClassIndex = CacheClassIndex(pSize);
+
+    lList = &CacheGetThreadCache()->lists[lClassIndex];
+
+    ((memoryCacheBlock *) pBuffer)->next = lList->head;
+
+    lList->head = (memoryCacheBlock *) pBuffer;
+    lList->count++;
+
+    /*
+    ** keep a batch in hand after draining so that alternating allocate and
+    ** free calls at the threshold do not bounce blocks through the backend
+    */
+
+    if (2 * CacheBatchCount(lClassIndex) < lList->count)
+    {
+        CacheDrain(lList, lClassIndex, CacheBatchCount(lClassIndex));
+    }
+}
+
+static void DeferredInitialize
+(
+    void
+)
+{
+    mtx_init(&gDeferred.lock, mtx_plain);
+
+    cnd_init(&gDeferred.wake);
+
+    tss_create(&gDeferredThreadExit, DeferredThreadExit);
+}
+
+static void DeferredRelease
+(
+    void * pBlock
+)
+{
+    memoryDeferredBatch * lBatch = gDeferredBatch;
+
+    if (!atomic_load_explicit(&gDeferred.enabled, memory_order_relaxed))
+    {
+        Free(pBlock);
+
+        return;
+    }
+
+    if (NULL == lBatch)
+    {
+        lBatch = Malloc(sizeof(memoryDeferredBatch));
+
+        if (NULL == lBatch)
+        {
+            Free(pBlock);
+
+            return;
+        }
+
+        lBatch->next = NULL;
+        lBatch->count = 0;
+
+        gDeferredBatch = lBatch;
+
+        /*
+        ** arm the exit hook so that a thread's last batch is not lost
+        */
+
+        tss_set(gDeferredThreadExit, lBatch);
+    }
+
+    lBatch->blocks[lBatch->count++] = pBlock;
+
+    atomic_fetch_add_explicit(&gDeferred.pending, 1, memory_order_relaxed);
+
+    if (DEFERRED_BATCH_BLOCKS == lBatch->count)
+    {
+        gDeferredBatch = NULL;
+
+        tss_set(gDeferredThreadExit, NULL);
+
+        DeferredSubmit(lBatch);
+    }
+}
+
+static void DeferredSubmit
+(
+    memoryDeferredBatch * pBatch
+)
+{
+    if (NULL == pBatch)
+    {
+        return;
+    }
+
+    mtx_lock(&gDeferred.lock);
+
+    if (gDeferred.running)
+    {
+        pBatch->next = gDeferred.queue;
+
+        gDeferred.queue = pBatch;
+
+        cnd_signal(&gDeferred.wake);
+
+        mtx_unlock(&gDeferred.lock);
+
+        return;
+    }
+
+    mtx_unlock(&gDeferred.lock);
+
+    DeferredReclaim(pBatch);
+}
+
+static void DeferredReclaim
+(
+    memoryDeferredBatch * pBatch
+)
+{
+    memoryDeferredBatch * lNextBatch;
+
+    unsigned long lBlockIndex;
+
+    for (; NULL != pBatch; pBatch = lNextBatch)
+    {
+        lNextBatch = pBatch->next;
+
+        for (lBlockIndex = 0; lBlockIndex < pBatch->count; lBlockIndex++)
+        {
+            Free(pBatch->blocks[lBlockIndex]);
+        }
+
+        atomic_fetch_sub_explicit(&gDeferred.pending, pBatch->count, memory_order_relaxed);
+
+        Free(pBatch);
+    }
+}
+
+static int DeferredReclaimer
+(
+    void * pUnused
+)
+{
+    memoryDeferredBatch * lQueue;
+
+    (void) pUnused;
+
+    mtx_lock(&gDeferred.lock);
+
+    for (;;)
+    {
+        while (NULL == gDeferred.queue && gDeferred.running)
+        {
+            cnd_wait(&gDeferred.wake, &gDeferred.lock);
+        }
+
+        lQueue = gDeferred.queue;
+
+        gDeferred.queue = NULL;
+
+        if (NULL == lQueue)
+        {
+            break; /* stopped with nothing left to free */
+        }
+
+        mtx_unlock(&gDeferred.lock);
+
+        DeferredReclaim(lQueue);
+
+        mtx_lock(&gDeferred.lock);
+    }
+
+    mtx_unlock(&gDeferred.lock);
+
+    return(0);
+}
+
+static void DeferredThreadExit
+(
+    void * pBatch
+)
+{
+    DeferredSubmit((memoryDeferredBatch *) pBatch);
+}
+
+#if defined _WIN32 || defined _WIN64
+
+static size_t GetPageSize
+(
+    void
+)
+{
+    SYSTEM_INFO lSystemInfo;
+
+    GetSystemInfo(&lSystemInfo);
+
+    return((size_t) lSystemInfo.dwAllocationGranularity);
+}
+
+#else
+
+static void * AlignedAllocate
+(
+    size_t pSize,
+    size_t pAlignment
+)
+{
+    void * lBuffer;
+
+    if (pAlignment < sizeof(void *))
+    {
+        pAlignment = sizeof(void *);
+    }
+
+    if (0 != posix_memalign(&lBuffer, pAlignment, pSize))
+    {
+        return(NULL);
+    }
+
+    return(lBuffer);
+}
+
+#endif
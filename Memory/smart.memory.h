@@ -38,10 +38,702 @@
 #define SMART_MEMORY_H
 
 #include <malloc.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+
+#include "smart.memory.t.h"
 
 #define Malloc(pSize)              malloc(pSize)
 #define Calloc(pSize)              calloc(1, pSize)
 #define Realloc(pObjHandle, pSize) realloc(pObjHandle, pSize)
 #define Free(pObjHandle)           free(pObjHandle)
 
+#define MEMORY_NATURAL_ALIGNMENT   _Alignof(max_align_t)           /* alignment of every Malloc() block */
+
+#define AlignSize(pSize, pAlignment) (((pSize) + (pAlignment) - 1) & ~((pAlignment) - 1))
+
+#define MEMORY_PREFAULT_STRIDE     ((size_t) 4096)                  /* smallest hardware page of the supported platforms */
+
+#if defined _WIN32 || defined _WIN64
+
+#include <windows.h>
+
+#define AlignedMalloc(pSize, pAlignment) _aligned_malloc(pSize, pAlignment)
+#define AlignedFree(pObjHandle)          _aligned_free(pObjHandle)
+
+#define PageSize() GetPageSize()
+
+#else
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define AlignedMalloc(pSize, pAlignment) AlignedAllocate(pSize, pAlignment)
+#define AlignedFree(pObjHandle)          free(pObjHandle)
+
+#define PageMap(pSize)              mmap(NULL, pSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)
+#define PageUnmap(pPages, pSize)    munmap(pPages, pSize)
+#define PageMapFailed(pPages)       (MAP_FAILED == (pPages))
+
+#define PageSize()                  ((size_t) sysconf(_SC_PAGESIZE))
+
+#endif
+
+/*----------------------------------------------------------------------------
+  Thread cache defines
+  ----------------------------------------------------------------------------*/
+
+#define CACHE_MINIMUM_BLOCK_SHIFT 4                                 /* 16 byte blocks */
+#define CACHE_MAXIMUM_BLOCK_SHIFT 10                                /* 1K byte blocks */
+
+#define CACHE_MINIMUM_BLOCK_SIZE  ((size_t) 1 << CACHE_MINIMUM_BLOCK_SHIFT)
+#define CACHE_MAXIMUM_BLOCK_SIZE  ((size_t) 1 << CACHE_MAXIMUM_BLOCK_SHIFT)
+
+#define CACHE_CLASSES             (CACHE_MAXIMUM_BLOCK_SHIFT - CACHE_MINIMUM_BLOCK_SHIFT + 1)
+
+#define CACHE_BATCH_BYTES         ((size_t) 8 * 1024)               /* bytes moved per refill or drain */
+#define CACHE_SPAN_SIZE           ((size_t) 64 * 1024)              /* bytes mapped per backend refill */
+
+/*----------------------------------------------------------------------------
+  Thread cache data types
+  ----------------------------------------------------------------------------*/
+
+typedef struct memoryCacheBlock {
+    struct memoryCacheBlock * next;
+} memoryCacheBlock;
+
+typedef struct memoryCacheList {
+    memoryCacheBlock * head;
+    unsigned long count;
+} memoryCacheList;
+
+typedef struct memoryThreadCache {
+    memoryCacheList lists[CACHE_CLASSES];
+
+    Bool registered;
+} memoryThreadCache;
+
+typedef struct memoryCacheBackend {
+    mtx_t lock;
+
+    memoryCacheList lists[CACHE_CLASSES];
+
+    size_t memoryAllocated;
+} memoryCacheBackend;
+
+/*----------------------------------------------------------------------------
+  Deferred free defines
+  ----------------------------------------------------------------------------*/
+
+#define DEFERRED_BATCH_BLOCKS 256                                   /* blocks handed to the reclaimer at once */
+
+/*----------------------------------------------------------------------------
+  Deferred free data types
+  ----------------------------------------------------------------------------
+  Each thread collects the blocks it frees in a batch of its own. A full
+  batch is queued for the reclaimer thread, or freed in place when there is
+  no reclaimer, so the lock is taken once per batch rather than per block.
+  ----------------------------------------------------------------------------*/
+
+typedef struct memoryDeferredBatch {
+    struct memoryDeferredBatch * next;
+
+    unsigned long count;
+
+    void * blocks[DEFERRED_BATCH_BLOCKS];
+} memoryDeferredBatch;
+
+typedef struct memoryDeferredReclaimer {
+    mtx_t lock;
+    cnd_t wake;
+
+    memoryDeferredBatch * queue;
+
+    thrd_t thread;
+    Bool running;
+
+    atomic_bool enabled;
+    atomic_size_t pending;
+} memoryDeferredReclaimer;
+
+/*----------------------------------------------------------------------------
+  Counter defines
+  ----------------------------------------------------------------------------*/
+
+#define COUNTER_SHARDS     16                                       /* a power of two */
+#define COUNTER_LINE_SIZE  64                                       /* shard stride, one cache line */
+#define COUNTER_GRANT_SIZE ((size_t) 16 * 1024)                     /* headroom a shard takes at once */
+
+#define BUDGET_PRESSURE_RETRIES 16                                  /* pressure calls per reservation */
+
+/*----------------------------------------------------------------------------
+  Counter data types
+  ----------------------------------------------------------------------------
+  The counter keeps the bytes charged against the maximum in one central
+  value. Each shard holds headroom (slack) taken from the central value in
+  grants, so most reservations and releases only touch the shard of the
+  calling thread. The counter value is the central value less the slack of
+  every shard.
+  ----------------------------------------------------------------------------*/
+
+typedef struct memoryCounterShard {
+    atomic_size_t slack;
+
+    char padding[COUNTER_LINE_SIZE - sizeof(atomic_size_t)];
+} memoryCounterShard;
+
+typedef struct memoryCounter {
+    atomic_size_t granted;
+
+    size_t maximum;
+
+    unsigned int shardCount;                                        /* zero for an unsharded counter */
+
+    char padding[COUNTER_LINE_SIZE - sizeof(atomic_size_t) - sizeof(size_t) - sizeof(unsigned int)];
+
+    memoryCounterShard shards[COUNTER_SHARDS];                      /* left off an unsharded counter */
+} memoryCounter;
+
+typedef memoryCounter * smartCounterHandle;
+
+/*----------------------------------------------------------------------------
+  Budget data types
+  ----------------------------------------------------------------------------
+  A budget is a counter chained to the budget of its parent (such as the
+  tenant owning a container, and in turn the process). Every byte charged to
+  a budget is also charged to each of its ancestors. The counter comes last
+  so that an unsharded budget is allocated without its shards.
+  ----------------------------------------------------------------------------*/
+
+typedef struct memoryBudget {
+    struct memoryBudget * parent;
+
+    Bool (* pressureFunction)(void * pContext, size_t pShortfall);
+    void * pressureContext;
+
+    smartAllocatorHandle allocator;
+    size_t allocated;                                               /* zero when from SafeMalloc() */
+
+    memoryCounter counter;
+} memoryBudget;
+
+#define BUDGET_UNSHARDED_SIZE offsetof(memoryBudget, counter.shards)
+
+typedef memoryBudget * smartBudgetHandle;
+
+/*----------------------------------------------------------------------------
+  Profile defines and data types
+  ----------------------------------------------------------------------------
+  Allocations and deallocations that carry a size (the Smart and
+  SafeAllocator functions) are recorded. The call site is set by the public
+  macros immediately before the call and consumed by the record.
+  ----------------------------------------------------------------------------*/
+
+#ifdef SMART_MEMORY_PROFILE
+
+#define PROFILE_SITE_SLOTS 1024                                     /* a power of two */
+
+#define ProfileAllocate(pSize)             ProfileRecord(pSize, 0, TRUE)
+#define ProfileReallocate(pOldSize, pSize) ProfileRecord(pSize, pOldSize, TRUE)
+#define ProfileDeallocate(pSize)           ProfileRecord(0, pSize, FALSE)
+
+typedef struct memoryProfileSite {
+    _Atomic(const char *) file;
+    int line;
+
+    atomic_ullong allocations;
+    atomic_ullong bytes;
+} memoryProfileSite;
+
+typedef struct memoryProfile {
+    atomic_ullong allocations;
+    atomic_ullong deallocations;
+    atomic_ullong bytesAllocated;
+
+    atomic_size_t currentBytes;
+    atomic_size_t peakBytes;
+
+    atomic_ullong histogram[SMART_MEMORY_PROFILE_BUCKETS];
+
+    mtx_t siteLock;
+
+    memoryProfileSite sites[PROFILE_SITE_SLOTS];
+
+    atomic_ullong unknownSiteAllocations;
+    atomic_ullong unknownSiteBytes;
+
+    struct timespec resetTime;
+} memoryProfile;
+
+#else
+
+#define ProfileAllocate(pSize)
+#define ProfileReallocate(pOldSize, pSize)
+#define ProfileDeallocate(pSize)
+
+#endif
+
+/*----------------------------------------------------------------------------
+  Private function prototypes
+  ----------------------------------------------------------------------------*/
+
+#ifdef SMART_MEMORY_PROFILE
+
+/*----------------------------------------------------------------------------
+  ProfileInitialize()
+  ----------------------------------------------------------------------------
+  Construct the profile lock and start the profile clock (called once).
+  ----------------------------------------------------------------------------*/
+
+static void ProfileInitialize
+(
+    void
+);
+
+/*----------------------------------------------------------------------------
+  ProfileRecord()
+  ----------------------------------------------------------------------------
+  Record an allocation (pIsAllocation TRUE) of pSize bytes that replaces
+  pOldSize bytes, or a deallocation of pOldSize bytes, against the call site
+  set by the calling thread.
+  ----------------------------------------------------------------------------*/
+
+static void ProfileRecord
+(
+    size_t pSize,
+    size_t pOldSize,
+    Bool pIsAllocation
+);
+
+/*----------------------------------------------------------------------------
+  ProfileSizeBucket()
+  ----------------------------------------------------------------------------
+  Map a size onto its histogram bucket: bucket n holds sizes from 2^(n-1)+1
+  to 2^n bytes, the last bucket holds everything larger.
+  ----------------------------------------------------------------------------*/
+
+static unsigned int ProfileSizeBucket
+(
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  ProfileGetSite()
+  ----------------------------------------------------------------------------
+  Get the slot of a call site, claiming a free slot the first time the site
+  is seen. Returns NULL when the table is full.
+  ----------------------------------------------------------------------------*/
+
+static memoryProfileSite * ProfileGetSite
+(
+    const char * pFile,
+    int pLine
+);
+
+/*----------------------------------------------------------------------------
+  ProfileCompareSites()
+  ----------------------------------------------------------------------------
+  Order call sites by descending allocation count (for qsort()).
+  ----------------------------------------------------------------------------*/
+
+static int ProfileCompareSites
+(
+    const void * pSite1,
+    const void * pSite2
+);
+
+/*----------------------------------------------------------------------------
+  ProfileDumpString()
+  ----------------------------------------------------------------------------
+  Write a string as a JSON string literal, or null for a NULL string.
+  ----------------------------------------------------------------------------*/
+
+static void ProfileDumpString
+(
+    FILE * pFile,
+    const char * pString
+);
+
+#endif
+
+/*----------------------------------------------------------------------------
+  CounterInitialize()
+  ----------------------------------------------------------------------------
+  Initialize an empty counter with the passed maximum and number of shards,
+  zero for an unsharded counter charged straight to its central value.
+  ----------------------------------------------------------------------------*/
+
+static void CounterInitialize
+(
+    memoryCounter * pCounter,
+    size_t pMemoryMaximum,
+    unsigned int pShardCount
+);
+
+/*----------------------------------------------------------------------------
+  CounterShardIndex()
+  ----------------------------------------------------------------------------
+  Get the shard of the calling thread. Threads are dealt shards round robin
+  the first time they touch any counter.
+  ----------------------------------------------------------------------------*/
+
+static unsigned int CounterShardIndex
+(
+    void
+);
+
+/*----------------------------------------------------------------------------
+  CounterGrant()
+  ----------------------------------------------------------------------------
+  Charge pSize bytes to the central value of a counter.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The bytes were charged
+
+  False - Charging the bytes would exceed the counter maximum
+  ----------------------------------------------------------------------------*/
+
+static Bool CounterGrant
+(
+    memoryCounter * pCounter,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  CounterReclaim()
+  ----------------------------------------------------------------------------
+  Return the slack of every shard of a counter to the central value.
+  ----------------------------------------------------------------------------*/
+
+static void CounterReclaim
+(
+    memoryCounter * pCounter
+);
+
+/*----------------------------------------------------------------------------
+  BudgetReserve()
+  ----------------------------------------------------------------------------
+  Reserve bytes against a budget and each of its ancestors up to (but not
+  including) pStop, releasing any levels already reserved when a level
+  refuses. A level that refuses and has a pressure function is given the
+  chance to free memory and is retried.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The bytes were reserved at every level
+
+  False - A level would have exceeded its maximum
+  ----------------------------------------------------------------------------*/
+
+static Bool BudgetReserve
+(
+    memoryBudget * pBudget,
+    size_t pSize,
+    memoryBudget * pStop
+);
+
+/*----------------------------------------------------------------------------
+  BudgetRelease()
+  ----------------------------------------------------------------------------
+  Release bytes from a budget and each of its ancestors up to (but not
+  including) pStop.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  BudgetReserveLevel()
+  ----------------------------------------------------------------------------
+  Reserve bytes against the counter of one budget, calling its pressure
+  function with the shortfall and retrying while the function reports that
+  it freed memory.
+  ----------------------------------------------------------------------------*/
+
+static Bool BudgetReserveLevel
+(
+    memoryBudget * pBudget,
+    size_t pSize
+);
+
+static void BudgetRelease
+(
+    memoryBudget * pBudget,
+    size_t pSize,
+    memoryBudget * pStop
+);
+
+/*----------------------------------------------------------------------------
+  BudgetCommonAncestor()
+  ----------------------------------------------------------------------------
+  Get the nearest budget that is an ancestor of (or is) both budgets, NULL
+  when they share none.
+  ----------------------------------------------------------------------------*/
+
+static memoryBudget * BudgetCommonAncestor
+(
+    memoryBudget * pBudget1,
+    memoryBudget * pBudget2
+);
+
+/*----------------------------------------------------------------------------
+  CacheClassIndex()
+  ----------------------------------------------------------------------------
+  Map a request size onto the index of the smallest cache size class that
+  holds it.
+  ----------------------------------------------------------------------------*/
+
+static unsigned int CacheClassIndex
+(
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  CacheBatchCount()
+  ----------------------------------------------------------------------------
+  The number of blocks of a size class moved between a thread cache and the
+  shared backend at a time.
+  ----------------------------------------------------------------------------*/
+
+static unsigned long CacheBatchCount
+(
+    unsigned int pClassIndex
+);
+
+/*----------------------------------------------------------------------------
+  CacheInitialize()
+  ----------------------------------------------------------------------------
+  Construct the shared backend and the thread exit hook (called once).
+  ----------------------------------------------------------------------------*/
+
+static void CacheInitialize
+(
+    void
+);
+
+/*----------------------------------------------------------------------------
+  CacheGetThreadCache()
+  ----------------------------------------------------------------------------
+  Get the cache of the calling thread, registering it to be drained when the
+  thread exits.
+  ----------------------------------------------------------------------------*/
+
+static memoryThreadCache * CacheGetThreadCache
+(
+    void
+);
+
+/*----------------------------------------------------------------------------
+  CacheRefill()
+  ----------------------------------------------------------------------------
+  Move a batch of blocks from the shared backend to a thread cache list,
+  carving a new span of blocks when the backend list is empty.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - At least one block was moved
+
+  False - The backend list was empty and a span could not be mapped
+  ----------------------------------------------------------------------------*/
+
+static Bool CacheRefill
+(
+    memoryCacheList * pList,
+    unsigned int pClassIndex
+);
+
+/*----------------------------------------------------------------------------
+  CacheDrain()
+  ----------------------------------------------------------------------------
+  Move up to pCount blocks from a thread cache list to the shared backend
+  under a single acquisition of the backend lock.
+  ----------------------------------------------------------------------------*/
+
+static void CacheDrain
+(
+    memoryCacheList * pList,
+    unsigned int pClassIndex,
+    unsigned long pCount
+);
+
+/*----------------------------------------------------------------------------
+  CacheThreadExit()
+  ----------------------------------------------------------------------------
+  Thread exit hook that returns every block of a thread cache to the shared
+  backend.
+  ----------------------------------------------------------------------------*/
+
+static void CacheThreadExit
+(
+    void * pThreadCache
+);
+
+/*----------------------------------------------------------------------------
+  CacheAllocate(), CacheAllocateZeroed(), CacheAllocateAligned(),
+  CacheReallocate(), CacheDeallocate()
+  ----------------------------------------------------------------------------
+  The thread cache allocator table functions. Requests larger than the
+  largest cache size class are passed to Malloc().
+
+  Blocks of a size class are carved from page aligned spans at multiples of
+  the class size, so an aligned request that fits a size class is served
+  from the cache. Larger aligned requests are passed to AlignedMalloc(),
+  except on Windows, where CacheDeallocate() could not release them.
+  ----------------------------------------------------------------------------*/
+
+static void * CacheAllocate
+(
+    void * pContext,
+    size_t pSize
+);
+
+static void * CacheAllocateZeroed
+(
+    void * pContext,
+    size_t pSize
+);
+
+static void * CacheAllocateAligned
+(
+    void * pContext,
+    size_t pSize,
+    size_t pAlignment
+);
+
+static void * CacheReallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pOldSize,
+    size_t pSize
+);
+
+static void CacheDeallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  DeferredInitialize()
+  ----------------------------------------------------------------------------
+  Create the reclaimer lock and condition and the thread exit hook that
+  hands a thread's last batch over. Run once through call_once().
+  ----------------------------------------------------------------------------*/
+
+static void DeferredInitialize
+(
+    void
+);
+
+/*----------------------------------------------------------------------------
+  DeferredRelease()
+  ----------------------------------------------------------------------------
+  Free a C runtime library block, adding it to the batch of the calling
+  thread instead while deferred freeing is enabled
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pBlock - (I) The block
+  ----------------------------------------------------------------------------
+  Notes:
+
+  When a batch cannot be allocated the block is freed in place.
+  ----------------------------------------------------------------------------*/
+
+static void DeferredRelease
+(
+    void * pBlock
+);
+
+/*----------------------------------------------------------------------------
+  DeferredSubmit()
+  ----------------------------------------------------------------------------
+  Queue a batch for the reclaimer thread, or free its blocks in place when
+  no reclaimer is running
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pBatch - (I) The batch (NULL is ignored)
+  ----------------------------------------------------------------------------*/
+
+static void DeferredSubmit
+(
+    memoryDeferredBatch * pBatch
+);
+
+/*----------------------------------------------------------------------------
+  DeferredReclaim()
+  ----------------------------------------------------------------------------
+  Free the blocks of a list of batches and then the batches themselves
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pBatch - (I) The first batch of the list
+  ----------------------------------------------------------------------------*/
+
+static void DeferredReclaim
+(
+    memoryDeferredBatch * pBatch
+);
+
+/*----------------------------------------------------------------------------
+  DeferredReclaimer()
+  ----------------------------------------------------------------------------
+  The reclaimer thread. Sleeps until batches are queued, takes the whole
+  queue and frees it outside the lock, until asked to stop.
+  ----------------------------------------------------------------------------*/
+
+static int DeferredReclaimer
+(
+    void * pUnused
+);
+
+/*----------------------------------------------------------------------------
+  DeferredThreadExit()
+  ----------------------------------------------------------------------------
+  Thread exit hook, submits the last batch of the exiting thread.
+  ----------------------------------------------------------------------------*/
+
+static void DeferredThreadExit
+(
+    void * pBatch
+);
+
+#if defined _WIN32 || defined _WIN64
+
+/*----------------------------------------------------------------------------
+  GetPageSize()
+  ----------------------------------------------------------------------------
+  Return the virtual memory allocation granularity of the platform.
+  ----------------------------------------------------------------------------*/
+
+static size_t GetPageSize
+(
+    void
+);
+
+#else
+
+/*----------------------------------------------------------------------------
+  AlignedAllocate()
+  ----------------------------------------------------------------------------
+  Return a block of pSize bytes aligned to pAlignment from posix_memalign(),
+  or NULL. The block is released by free().
+  ----------------------------------------------------------------------------*/
+
+static void * AlignedAllocate
+(
+    size_t pSize,
+    size_t pAlignment
+);
+
+#endif
+
 #endif
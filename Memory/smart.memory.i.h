@@ -281,4 +281,1767 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartFree
     size_t * pMemoryUsed
 );
 
+/*----------------------------------------------------------------------------
+  SafeAlignedMalloc()
+  ----------------------------------------------------------------------------
+  Allocates a block of memory whose address is a multiple of the requested
+  alignment, such as a cache line or the width of a SIMD register.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pBuffer     - (I/O) The address of a memory pointer to hold the result of
+                      the allocation
+  pSize       - (I)   The number of bytes to allocate.
+  pAlignment  - (I)   The required alignment, a power of two, or zero for the
+                      alignment of Malloc()
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully allocated
+
+  False - Memory was not successfully allocated due to one of the following:
+
+          1. The buffer pointer pointer was NULL.
+          2. The buffer pointer pointed to be the buffer pointer pointer was
+             not initialized to NULL.
+          3. Zero or fewer bytes were requested to be allocated.
+          4. The alignment was not a power of two.
+          5. AlignedMalloc() failed.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The same NULL initialized buffer pointer requirement as SafeMalloc()
+  applies.
+
+  Blocks must be released with SafeAlignedFree(), the C runtime library of
+  Windows cannot release them with free().
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeAlignedMalloc
+(
+    void ** pBuffer,
+    size_t  pSize,
+    size_t  pAlignment
+);
+
+/*----------------------------------------------------------------------------
+  SafeAlignedFree()
+  ----------------------------------------------------------------------------
+  Deallocates a block of memory allocated by SafeAlignedMalloc(), setting
+  the memory pointer to NULL.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pBuffer     - (I/O) The address of a memory pointer to the memory block
+                      being deallocated by AlignedFree().
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully deallocated
+
+  False - Memory was not successfully deallocated due to one of the following:
+
+          1. The buffer pointer pointer was NULL.
+          2. The buffer pointer pointed to be the buffer pointer pointer was
+             NULL.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeAlignedFree
+(
+    void ** pBuffer
+);
+
+/*----------------------------------------------------------------------------
+  SmartAlignedMalloc()
+  ----------------------------------------------------------------------------
+  Allocates an aligned block of memory and then adds the size value to a
+  memory management variable.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pBuffer     - (I/O) The address of a memory pointer to hold the result of
+                      the SafeAlignedMalloc()
+  pSize       - (I)   The number of bytes to allocate.
+  pAlignment  - (I)   The required alignment, a power of two, or zero for the
+                      alignment of Malloc()
+  pMemoryUsed - (I/O) A pointer to a memory management variable.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully allocated
+
+  False - Memory was not successfully allocated due to one of the following:
+
+          1. The memory management variable pointer was NULL.
+          2. Zero or fewer bytes were requested to be allocated.
+          3. SafeAlignedMalloc() failed.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The same NULL initialized buffer pointer requirement as SafeMalloc()
+  applies. Only the bytes requested are added, not any padding the C
+  runtime library uses to align the block.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartAlignedMalloc
+(
+    void **  pBuffer,
+    size_t   pSize,
+    size_t   pAlignment,
+    size_t * pMemoryUsed
+);
+
+/*----------------------------------------------------------------------------
+  SmartAlignedFree()
+  ----------------------------------------------------------------------------
+  Deallocates a block of memory allocated by SmartAlignedMalloc(), setting
+  the memory pointer to NULL and then subtracts the passed size value from
+  the memory management variable.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pBuffer     - (I/O) The address of a memory pointer to the memory block
+                      being deallocated by SafeAlignedFree().
+  pSize       - (I)   The number of bytes being deallocated.
+  pMemoryUsed - (I/O) A pointer to a memory management variable.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully deallocated
+
+  False - Memory was not successfully deallocated due to one of the following:
+
+          1. The memory management variable pointer was NULL.
+          2. Zero or fewer bytes were requested to be deallocated.
+          3. SafeAlignedFree() failed.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartAlignedFree
+(
+    void **  pBuffer,
+    size_t   pSize,
+    size_t * pMemoryUsed
+);
+
+/*----------------------------------------------------------------------------
+  SafeAllocatorMalloc()
+  ----------------------------------------------------------------------------
+  Allocates a block of memory from an allocator.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pAllocator  - (I)   The allocator handle (NULL selects Malloc())
+  pBuffer     - (I/O) The address of a memory pointer to hold the result of
+                      the allocation
+  pSize       - (I)   The number of bytes to allocate.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully allocated
+
+  False - Memory was not successfully allocated due to one of the following:
+
+          1. The buffer pointer pointer was NULL.
+          2. The buffer pointer pointed to be the buffer pointer pointer was
+             not initialized to NULL.
+          3. Zero or fewer bytes were requested to be allocated.
+          4. The allocator failed.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The same NULL initialized buffer pointer requirement as SafeMalloc()
+  applies.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeAllocatorMalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize
+);
+
+/*----------------------------------------------------------------------------
+  SafeAllocatorCalloc()
+  ----------------------------------------------------------------------------
+  Allocates and initializes a block of memory to zeros from an allocator.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pAllocator  - (I)   The allocator handle (NULL selects Calloc())
+  pBuffer     - (I/O) The address of a memory pointer to hold the result of
+                      the allocation
+  pSize       - (I)   The number of bytes to allocate.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully allocated
+
+  False - Memory was not successfully allocated due to one of the following:
+
+          1. The buffer pointer pointer was NULL.
+          2. The buffer pointer pointed to be the buffer pointer pointer was
+             not initialized to NULL.
+          3. Zero or fewer bytes were requested to be allocated.
+          4. The allocator failed.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeAllocatorCalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize
+);
+
+/*----------------------------------------------------------------------------
+  SafeAllocatorRealloc()
+  ----------------------------------------------------------------------------
+  Reallocates a block of memory from an allocator leaving the current
+  contents unchanged.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pAllocator  - (I)   The allocator handle (NULL selects Realloc())
+  pBuffer     - (I/O) The address of a memory pointer to hold the result of
+                      the reallocation
+  pOldSize    - (I)   The number of bytes currently allocated.
+  pSize       - (I)   The number of bytes to allocate.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully reallocated
+
+  False - Memory was not successfully reallocated due to one of the following:
+
+          1. The buffer pointer pointer was NULL.
+          2. Zero or fewer bytes were requested to be allocated.
+          3. The allocator failed, in which case the original block is left
+             allocated and unchanged.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeAllocatorRealloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pOldSize,
+    size_t               pSize
+);
+
+/*----------------------------------------------------------------------------
+  SafeAllocatorFree()
+  ----------------------------------------------------------------------------
+  Returns a block of memory to an allocator, setting the memory pointer to
+  NULL.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pAllocator  - (I)   The allocator handle (NULL selects Free())
+  pBuffer     - (I/O) The address of a memory pointer to the memory block
+                      being deallocated.
+  pSize       - (I)   The number of bytes that were allocated.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully deallocated
+
+  False - Memory was not successfully deallocated due to one of the following:
+
+          1. The buffer pointer pointer was NULL.
+          2. The buffer pointer pointed to be the buffer pointer pointer was
+             NULL.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The block is not returned when the allocator has no deallocate function
+  (a region allocator), only the memory pointer is set to NULL.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeAllocatorFree
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize
+);
+
+/*----------------------------------------------------------------------------
+  SafeAllocatorAlignedMalloc()
+  ----------------------------------------------------------------------------
+  Allocates a block of memory whose address is a multiple of the requested
+  alignment from an allocator.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pAllocator  - (I)   The allocator handle (NULL selects AlignedMalloc())
+  pBuffer     - (I/O) The address of a memory pointer to hold the result of
+                      the allocation
+  pSize       - (I)   The number of bytes to allocate.
+  pAlignment  - (I)   The required alignment, a power of two, or zero for the
+                      alignment of Malloc()
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully allocated
+
+  False - Memory was not successfully allocated due to one of the following:
+
+          1. The buffer pointer pointer was NULL.
+          2. The buffer pointer pointed to be the buffer pointer pointer was
+             not initialized to NULL.
+          3. Zero or fewer bytes were requested to be allocated.
+          4. The alignment was not a power of two.
+          5. The allocator has no allocateAligned function.
+          6. The allocator failed.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The same NULL initialized buffer pointer requirement as SafeMalloc()
+  applies.
+
+  An alignment no greater than that of Malloc() is an ordinary
+  SafeAllocatorMalloc(). Otherwise the size is rounded up to a multiple of
+  the alignment before it is handed to the allocator.
+
+  Blocks must be released with SafeAllocatorAlignedFree() passing the same
+  size and alignment.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeAllocatorAlignedMalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    size_t               pAlignment
+);
+
+/*----------------------------------------------------------------------------
+  SafeAllocatorAlignedFree()
+  ----------------------------------------------------------------------------
+  Returns a block of memory allocated by SafeAllocatorAlignedMalloc() to its
+  allocator, setting the memory pointer to NULL.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pAllocator  - (I)   The allocator handle (NULL selects AlignedFree())
+  pBuffer     - (I/O) The address of a memory pointer to the memory block
+                      being deallocated
+  pSize       - (I)   The number of bytes that were allocated.
+  pAlignment  - (I)   The alignment that was requested
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully deallocated
+
+  False - Memory was not successfully deallocated due to one of the following:
+
+          1. The buffer pointer pointer was NULL.
+          2. The buffer pointer pointed to be the buffer pointer pointer was
+             NULL.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeAllocatorAlignedFree
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    size_t               pAlignment
+);
+
+/*----------------------------------------------------------------------------
+  SmartAllocatorMalloc()
+  ----------------------------------------------------------------------------
+  Allocates a block of memory from an allocator and then adds the size value
+  to a memory management variable.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pAllocator  - (I)   The allocator handle (NULL selects Malloc())
+  pBuffer     - (I/O) The address of a memory pointer to hold the result of
+                      the SafeAllocatorMalloc()
+  pSize       - (I)   The number of bytes to allocate.
+  pMemoryUsed - (I/O) A pointer to a memory management variable.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully allocated
+
+  False - Memory was not successfully allocated due to one of the following:
+
+          1. The memory management variable pointer was NULL.
+          2. Zero or fewer bytes were requested to be allocated.
+          3. SafeAllocatorMalloc() failed.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartAllocatorMalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    size_t *             pMemoryUsed
+);
+
+/*----------------------------------------------------------------------------
+  SmartAllocatorCalloc()
+  ----------------------------------------------------------------------------
+  Allocates and initializes a block of memory to zeros from an allocator and
+  then adds the size value to a memory management variable.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pAllocator  - (I)   The allocator handle (NULL selects Calloc())
+  pBuffer     - (I/O) The address of a memory pointer to hold the result of
+                      the SafeAllocatorCalloc()
+  pSize       - (I)   The number of bytes to allocate.
+  pMemoryUsed - (I/O) A pointer to a memory management variable.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully allocated
+
+  False - Memory was not successfully allocated due to one of the following:
+
+          1. The memory management variable pointer was NULL.
+          2. Zero or fewer bytes were requested to be allocated.
+          3. SafeAllocatorCalloc() failed.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartAllocatorCalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    size_t *             pMemoryUsed
+);
+
+/*----------------------------------------------------------------------------
+  SmartAllocatorFree()
+  ----------------------------------------------------------------------------
+  Returns a block of memory to an allocator, setting the memory pointer to
+  NULL and then subtracts the passed size value from the memory management
+  variable.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pAllocator  - (I)   The allocator handle (NULL selects Free())
+  pBuffer     - (I/O) The address of a memory pointer to the memory block
+                      being deallocated by SafeAllocatorFree().
+  pSize       - (I)   The number of bytes being deallocated.
+  pMemoryUsed - (I/O) A pointer to a memory management variable.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully deallocated
+
+  False - Memory was not successfully deallocated due to one of the following:
+
+          1. The memory management variable pointer was NULL.
+          2. Zero or fewer bytes were requested to be deallocated.
+          3. SafeAllocatorFree() failed.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartAllocatorFree
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    size_t *             pMemoryUsed
+);
+
+/*----------------------------------------------------------------------------
+  SafePageAlloc()
+  ----------------------------------------------------------------------------
+  Maps a contiguous run of zero filled pages directly from the operating
+  system.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pBuffer     - (I/O) The address of a memory pointer to hold the address of
+                      the first page of the run
+  pSize       - (I)   The number of bytes to map (rounded up to whole pages)
+  pAlignment  - (I)   The required alignment of the run, a power of two, or
+                      zero for page alignment
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The pages were succesfully mapped
+
+  False - The pages were not successfully mapped due to one of the following:
+
+          1. The buffer pointer pointer was NULL.
+          2. The buffer pointer pointed to be the buffer pointer pointer was
+             not initialized to NULL.
+          3. Zero or fewer bytes were requested to be mapped.
+          4. The alignment was not a power of two.
+          5. The operating system refused the mapping.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Runs must be released with SafePageFree() passing the same size.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafePageAlloc
+(
+    void ** pBuffer,
+    size_t  pSize,
+    size_t  pAlignment
+);
+
+/*----------------------------------------------------------------------------
+  SafePageFree()
+  ----------------------------------------------------------------------------
+  Returns a run of pages mapped by SafePageAlloc() to the operating system,
+  setting the memory pointer to NULL.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pBuffer     - (I/O) The address of a memory pointer to the run of pages
+  pSize       - (I)   The number of bytes that were mapped
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The pages were succesfully unmapped
+
+  False - The pages were not successfully unmapped due to one of the
+          following:
+
+          1. The buffer pointer pointer was NULL.
+          2. The buffer pointer pointed to be the buffer pointer pointer was
+             NULL.
+          3. The operating system refused to unmap the pages.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafePageFree
+(
+    void ** pBuffer,
+    size_t  pSize
+);
+
+/*----------------------------------------------------------------------------
+  SafePageDecommit()
+  ----------------------------------------------------------------------------
+  Returns the physical memory behind part of a run of pages mapped by
+  SafePageAlloc() to the operating system, keeping the addresses mapped.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pPages      - (I) The address of the first page to decommit
+  pSize       - (I) The number of bytes to decommit (rounded up to whole
+                    pages)
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The pages were succesfully decommitted
+
+  False - The pages were not successfully decommitted due to one of the
+          following:
+
+          1. The page pointer was NULL or not on a page boundary.
+          2. Zero bytes were requested to be decommitted.
+          3. The operating system refused to decommit the pages.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The pages must be recommitted with SafePageRecommit() before they are
+  used again, after which they are zero filled. On POSIX systems the pages
+  are released with madvise(MADV_DONTNEED), on Windows they are decommitted
+  with VirtualFree(MEM_DECOMMIT).
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafePageDecommit
+(
+    void * pPages,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SafePageRecommit()
+  ----------------------------------------------------------------------------
+  Backs pages decommitted by SafePageDecommit() with memory again.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pPages      - (I) The address of the first page to recommit
+  pSize       - (I) The number of bytes to recommit (rounded up to whole
+                    pages)
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The pages were succesfully recommitted
+
+  False - The pages were not successfully recommitted due to one of the
+          following:
+
+          1. The page pointer was NULL or not on a page boundary.
+          2. Zero bytes were requested to be recommitted.
+          3. The operating system refused to commit the pages.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafePageRecommit
+(
+    void * pPages,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SafePagePrefault()
+  ----------------------------------------------------------------------------
+  Faults in part of a run of pages mapped by SafePageAlloc() so that the
+  first writes to them do not take a page fault.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pPages      - (I) The address of the first page to prefault
+  pSize       - (I) The number of bytes to prefault (rounded up to whole
+                    pages)
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The pages were succesfully prefaulted
+
+  False - The pages were not successfully prefaulted due to one of the
+          following:
+
+          1. The page pointer was NULL or not on a page boundary.
+          2. Zero bytes were requested to be prefaulted.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Where the kernel supports it the pages are populated with
+  madvise(MADV_POPULATE_WRITE), otherwise every page is written back with
+  its own contents. The contents of the pages are unchanged either way.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafePagePrefault
+(
+    void * pPages,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SafePageAdviseHuge()
+  ----------------------------------------------------------------------------
+  Asks the operating system to back part of a run of pages mapped by
+  SafePageAlloc() with transparent huge pages.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pPages      - (I) The address of the first page
+  pSize       - (I) The number of bytes (rounded up to whole pages)
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The advice was succesfully given, or the platform has no such
+          advice
+
+  False - The advice was not successfully given due to one of the
+          following:
+
+          1. The page pointer was NULL or not on a page boundary.
+          2. Zero bytes were passed.
+          3. The operating system refused the advice.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The advice is madvise(MADV_HUGEPAGE) and only helps runs that cover whole
+  huge pages, so the run should be aligned to and a multiple of 2M. It
+  should be given before the pages are first touched.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafePageAdviseHuge
+(
+    void * pPages,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SafePageAdviseSequential()
+  ----------------------------------------------------------------------------
+  Tells the operating system that part of a mapping will be read once from
+  its first byte to its last.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pPages      - (I) The address of the first page
+  pSize       - (I) The number of bytes (rounded up to whole pages)
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The advice was succesfully given, or the platform has no such
+          advice
+
+  False - The advice was not successfully given due to one of the
+          following:
+
+          1. The page pointer was NULL or not on a page boundary.
+          2. Zero bytes were passed.
+          3. The operating system refused the advice.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The advice is madvise(MADV_SEQUENTIAL), under which the pages of a file
+  mapping are read ahead aggressively and dropped soon after they are
+  read. On Windows SafeFileMapRead() asks for sequential reads when it
+  opens the file instead.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafePageAdviseSequential
+(
+    void * pPages,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SafePageSize()
+  ----------------------------------------------------------------------------
+  Returns the size of the pages mapped by SafePageAlloc().
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS size_t CALLING_CONVENTION SafePageSize
+(
+    void
+);
+
+/*----------------------------------------------------------------------------
+  SafeFileMap()
+  ----------------------------------------------------------------------------
+  Maps a file into memory so that writes to the memory are written to the
+  file, creating or extending the file as needed.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pBuffer     - (I/O) The address of a memory pointer to hold the address of
+                      the first byte of the file
+  pPath       - (I)   The path of the file
+  pSize       - (I)   The number of bytes to map (rounded up to whole pages)
+  pAlignment  - (I)   The required alignment of the mapping, a power of two,
+                      or zero for page alignment
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The file was succesfully mapped
+
+  False - The file was not successfully mapped due to one of the following:
+
+          1. The buffer pointer pointer was NULL.
+          2. The buffer pointer pointed to be the buffer pointer pointer was
+             not initialized to NULL.
+          3. The path was NULL.
+          4. Zero bytes were requested to be mapped.
+          5. The alignment was not a power of two.
+          6. The file could not be opened, created or extended.
+          7. The operating system refused the mapping.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  A file shorter than the mapping is extended to its size, sparsely where
+  the file system allows, so its new pages read as zeros and take no disk
+  space until they are written. A longer file is left as it is and only its
+  first pSize bytes are mapped. The mapping is shared, the file closed once
+  it is mapped, and the mapping must be released with SafeFileUnmap()
+  passing the same size.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeFileMap
+(
+    void ** pBuffer,
+    const char * pPath,
+    size_t pSize,
+    size_t pAlignment
+);
+
+/*----------------------------------------------------------------------------
+  SafeFileMapRead()
+  ----------------------------------------------------------------------------
+  Maps the whole of an existing file into memory to be read.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pBuffer     - (I/O) The address of a memory pointer to hold the address of
+                      the first byte of the file
+  pPath       - (I)   The path of the file
+  pSize       - (O)   The number of bytes in the file
+  pAlignment  - (I)   The required alignment of the mapping, a power of two,
+                      or zero for page alignment
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The file was succesfully mapped
+
+  False - The file was not successfully mapped due to one of the following:
+
+          1. The buffer pointer pointer or the size pointer was NULL.
+          2. The buffer pointer pointed to be the buffer pointer pointer was
+             not initialized to NULL.
+          3. The path was NULL.
+          4. The alignment was not a power of two.
+          5. The file could not be opened or its size found.
+          6. The operating system refused the mapping.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The mapping is read only and private, so the file is never written, and
+  the file is closed once it is mapped. An empty file is not mapped: the
+  size is zero and the memory pointer is left NULL. Otherwise the mapping
+  must be released with SafeFileUnmap() passing the size of the file.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeFileMapRead
+(
+    void ** pBuffer,
+    const char * pPath,
+    size_t * pSize,
+    size_t pAlignment
+);
+
+/*----------------------------------------------------------------------------
+  SafeFileUnmap()
+  ----------------------------------------------------------------------------
+  Releases a mapping made by SafeFileMap() or SafeFileMapRead(), setting
+  the memory pointer to NULL.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pBuffer     - (I/O) The address of a memory pointer to the mapping
+  pSize       - (I)   The number of bytes mapped
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The file was succesfully unmapped
+
+  False - The file was not successfully unmapped due to one of the
+          following:
+
+          1. The buffer pointer pointer was NULL.
+          2. The buffer pointer was NULL.
+          3. The operating system refused to unmap the file.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Writes that have not reached the file are still written by the operating
+  system after the mapping is released; call SafeFileSync() first to know
+  they have.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeFileUnmap
+(
+    void ** pBuffer,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SafeFileSync()
+  ----------------------------------------------------------------------------
+  Writes the changed pages of part of a mapping made by SafeFileMap() to
+  the file.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pPages      - (I) The address of the first page to write
+  pSize       - (I) The number of bytes to write (rounded up to whole pages)
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The pages were succesfully written
+
+  False - The pages were not successfully written due to one of the
+          following:
+
+          1. The page pointer was NULL or not on a page boundary.
+          2. Zero bytes were requested to be written.
+          3. The operating system failed to write the pages.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  On POSIX systems the pages are written with msync(MS_SYNC) and are on
+  the device when it returns. On Windows FlushViewOfFile() hands them to
+  the file system cache, which writes them out in its own time.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SafeFileSync
+(
+    void * pPages,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SmartThreadCacheGetAllocator()
+  ----------------------------------------------------------------------------
+  Returns the process wide thread caching allocator. Each thread keeps small
+  free lists per power of two size class (16 to 1024 bytes) that are
+  refilled from and drained to a shared, locked backend in batches, so the
+  common allocate and free calls never take a lock.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  The allocator handle, suitable for SafeAllocatorMalloc(), the
+  SmartAllocator functions and the container constructors that accept an
+  allocator.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The size class is picked from the size passed when a block is freed, so
+  every block must be freed with the size it was allocated with. Blocks may
+  be freed by a thread other than the one that allocated them.
+
+  Requests larger than the largest size class are passed through to the C
+  runtime library.
+
+  A thread's cache is returned to the backend when the thread exits through
+  thrd_exit() or by returning from its start function. Backend memory is
+  retained by the process for reuse.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS smartAllocatorHandle CALLING_CONVENTION SmartThreadCacheGetAllocator
+(
+    void
+);
+
+/*----------------------------------------------------------------------------
+  SmartThreadCacheFlush()
+  ----------------------------------------------------------------------------
+  Returns every block cached by the calling thread to the shared backend.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Always
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartThreadCacheFlush
+(
+    void
+);
+
+/*----------------------------------------------------------------------------
+  SmartThreadCacheGetMemoryAllocated()
+  ----------------------------------------------------------------------------
+  Returns the number of bytes mapped by the shared backend of the thread
+  caching allocator.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartThreadCacheGetMemoryAllocated
+(
+    void
+);
+
+/*----------------------------------------------------------------------------
+  SmartDeferredFreeStart()
+  ----------------------------------------------------------------------------
+  Turns on deferred freeing. Blocks of the C runtime library freed through
+  SafeFree(), SmartFree(), SafeAllocatorFree() and SmartAllocatorFree() with
+  a NULL allocator (and so the nodes of trees and stacks that have no
+  allocator) are no longer freed in the call. Each thread collects them in
+  a batch of its own, and a full batch is handed to a background reclaimer
+  thread or, when there is none, freed at once.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pReclaimer - (I) TRUE to start the reclaimer thread, FALSE to free full
+                   batches on the thread that filled them
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Deferred freeing is on
+
+  False - The reclaimer thread could not be started
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Memory management variables, counters and budgets are updated when the
+  free call is made, not when the block is freed, so maximums are checked
+  against the bytes the containers hold. The process holds up to
+  DEFERRED_BATCH_BLOCKS more blocks per thread than were accounted for.
+
+  Blocks of an allocator table are always returned in the call, since an
+  allocator such as a slab or an arena may only be used by one thread.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartDeferredFreeStart
+(
+    Bool pReclaimer
+);
+
+/*----------------------------------------------------------------------------
+  SmartDeferredFreeFlush()
+  ----------------------------------------------------------------------------
+  Hands the batch of the calling thread to the reclaimer thread, or frees
+  its blocks when there is no reclaimer. Call it at a point where latency
+  does not matter, such as between requests.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The batch was flushed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  A thread's batch is flushed when the thread exits.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartDeferredFreeFlush
+(
+    void
+);
+
+/*----------------------------------------------------------------------------
+  SmartDeferredFreeStop()
+  ----------------------------------------------------------------------------
+  Turns off deferred freeing. The batch of the calling thread and every
+  queued batch are freed and the reclaimer thread is stopped.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Deferred freeing is off
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The batches still held by other threads are freed when those threads
+  flush or exit.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartDeferredFreeStop
+(
+    void
+);
+
+/*----------------------------------------------------------------------------
+  SmartDeferredFreeGetPending()
+  ----------------------------------------------------------------------------
+  Returns the number of blocks freed by the callers that the C runtime
+  library has not yet been given back.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartDeferredFreeGetPending
+(
+    void
+);
+
+/*----------------------------------------------------------------------------
+  SmartCounterConstructSmartCounter()
+  ----------------------------------------------------------------------------
+  Constructs a thread safe memory counter. The counter is sharded so that
+  threads reserving and releasing memory at the same time rarely touch the
+  same cache line, and the shards are summed when the counter is read.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pCounter       - (I/O) The address of a counter handle, which must be
+                         initialized to NULL
+  pMemoryMaximum - (I)   The most bytes that may be reserved at once, zero
+                         for no limit
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The counter was succesfully constructed
+
+  False - The counter was not successfully constructed due to one of the
+          following:
+
+          1. The counter handle pointer was NULL.
+          2. The counter handle was not initialized to NULL.
+          3. SafeMalloc() failed.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartCounterConstructSmartCounter
+(
+    smartCounterHandle * pCounter,
+    size_t pMemoryMaximum
+);
+
+/*----------------------------------------------------------------------------
+  SmartCounterReserve()
+  ----------------------------------------------------------------------------
+  Atomically checks that pSize more bytes fit under the counter maximum and
+  adds them to the counter.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pCounter    - (I)   The counter handle
+  pSize       - (I)   The number of bytes to reserve
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The bytes were reserved
+
+  False - The bytes were not reserved due to one of the following:
+
+          1. The counter handle was NULL.
+          2. The bytes would take the counter over its maximum.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Concurrent reservations never take the counter over its maximum. Each
+  shard holds a little headroom taken from the maximum in advance, and the
+  headroom of every shard is reclaimed before a reservation is refused.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartCounterReserve
+(
+    smartCounterHandle pCounter,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SmartCounterRelease()
+  ----------------------------------------------------------------------------
+  Subtracts bytes reserved by SmartCounterReserve() from the counter.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pCounter    - (I)   The counter handle
+  pSize       - (I)   The number of bytes to release
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The bytes were released
+
+  False - The counter handle was NULL
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartCounterRelease
+(
+    smartCounterHandle pCounter,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SmartCounterGetValue()
+  ----------------------------------------------------------------------------
+  Returns the number of bytes reserved against a counter. The value is exact
+  when no other thread is reserving or releasing at the same time.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartCounterGetValue
+(
+    smartCounterHandle pCounter
+);
+
+/*----------------------------------------------------------------------------
+  SmartCounterGetMaximum()
+  ----------------------------------------------------------------------------
+  Returns the maximum a counter was constructed with.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartCounterGetMaximum
+(
+    smartCounterHandle pCounter
+);
+
+/*----------------------------------------------------------------------------
+  SmartCounterDestructSmartCounter()
+  ----------------------------------------------------------------------------
+  Destructs a counter, setting the counter handle to NULL.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The counter was succesfully destructed
+
+  False - The counter handle pointer or the counter handle was NULL
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartCounterDestructSmartCounter
+(
+    smartCounterHandle * pCounter
+);
+
+/*----------------------------------------------------------------------------
+  SmartCounterMalloc()
+  ----------------------------------------------------------------------------
+  Reserves the passed size value against a counter and then allocates a
+  block of memory from an allocator, releasing the reservation if the
+  allocation fails.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pAllocator  - (I)   The allocator handle (NULL selects Malloc())
+  pBuffer     - (I/O) The address of a memory pointer to hold the address of
+                      the memory block allocated by SafeAllocatorMalloc().
+  pSize       - (I)   The number of bytes requested to be allocated.
+  pCounter    - (I)   The counter handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully allocated
+
+  False - Memory was not successfully allocated due to one of the following:
+
+          1. SmartCounterReserve() failed.
+          2. SafeAllocatorMalloc() failed.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  This is the thread safe counterpart of SmartAllocatorMalloc(), whose
+  memory management variable is updated without synchronization.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartCounterMalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    smartCounterHandle   pCounter
+);
+
+/*----------------------------------------------------------------------------
+  SmartCounterCalloc()
+  ----------------------------------------------------------------------------
+  Reserves the passed size value against a counter and then allocates a
+  zero filled block of memory from an allocator, releasing the reservation
+  if the allocation fails.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pAllocator  - (I)   The allocator handle (NULL selects Calloc())
+  pBuffer     - (I/O) The address of a memory pointer to hold the address of
+                      the memory block allocated by SafeAllocatorCalloc().
+  pSize       - (I)   The number of bytes requested to be allocated.
+  pCounter    - (I)   The counter handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully allocated
+
+  False - Memory was not successfully allocated due to one of the following:
+
+          1. SmartCounterReserve() failed.
+          2. SafeAllocatorCalloc() failed.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartCounterCalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    smartCounterHandle   pCounter
+);
+
+/*----------------------------------------------------------------------------
+  SmartCounterFree()
+  ----------------------------------------------------------------------------
+  Returns a block of memory to an allocator, setting the memory pointer to
+  NULL and then releases the passed size value from a counter.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pAllocator  - (I)   The allocator handle (NULL selects Free())
+  pBuffer     - (I/O) The address of a memory pointer to the memory block
+                      being deallocated by SafeAllocatorFree().
+  pSize       - (I)   The number of bytes being deallocated.
+  pCounter    - (I)   The counter handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully deallocated
+
+  False - Memory was not successfully deallocated due to one of the following:
+
+          1. The counter handle was NULL.
+          2. SafeAllocatorFree() failed.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartCounterFree
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    smartCounterHandle   pCounter
+);
+
+/*----------------------------------------------------------------------------
+  SmartBudgetConstructSmartBudget()
+  ----------------------------------------------------------------------------
+  Constructs a memory budget. Budgets nest: every byte reserved against a
+  budget is also reserved against its parent, its parent's parent and so
+  on, so one budget may cap a container, its parent the tenant owning many
+  containers and the root budget the whole process.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pBudget        - (I/O) The address of a budget handle, which must be
+                         initialized to NULL
+  pMemoryMaximum - (I)   The most bytes that may be reserved against the
+                         budget at once, zero for no limit
+  pParent        - (I)   The parent budget handle, NULL for a root budget
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The budget was succesfully constructed
+
+  False - The budget was not successfully constructed due to one of the
+          following:
+
+          1. The budget handle pointer was NULL.
+          2. The budget handle was not initialized to NULL.
+          3. SafeMalloc() failed.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  A parent budget must outlive its children. Budgets are thread safe and
+  each level is a sharded counter (see SmartCounterConstructSmartCounter()),
+  unlike the unsharded budgets SmartBudgetConstructSmartBudgetWithAllocator()
+  builds.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetConstructSmartBudget
+(
+    smartBudgetHandle * pBudget,
+    size_t pMemoryMaximum,
+    smartBudgetHandle pParent
+);
+
+/*----------------------------------------------------------------------------
+  SmartBudgetConstructSmartBudgetWithAllocator()
+  ----------------------------------------------------------------------------
+  Constructs a memory budget whose control structure is allocated through
+  the passed allocator, such as the budget of a container that allocates
+  through the same allocator.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pBudget        - (I/O) The address of a budget handle, which must be
+                         initialized to NULL
+  pMemoryMaximum - (I)   The most bytes that may be reserved against the
+                         budget at once, zero for no limit
+  pParent        - (I)   The parent budget handle, NULL for a root budget
+  pAllocator     - (I)   The allocator handle, NULL for the C runtime
+                         library
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The budget was succesfully constructed
+
+  False - The budget was not successfully constructed due to one of the
+          following:
+
+          1. The budget handle pointer was NULL.
+          2. The budget handle was not initialized to NULL.
+          3. SafeAllocatorMalloc() failed.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  A budget with neither a maximum nor a parent refuses nothing and only
+  keeps a count, so its counter is unsharded: it is charged straight to its
+  central value and its control structure is a small fraction of the size
+  of a sharded budget. Such a budget suits a container used by one thread
+  at a time; give a budget shared by many threads a maximum or construct it
+  with SmartBudgetConstructSmartBudget().
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetConstructSmartBudgetWithAllocator
+(
+    smartBudgetHandle * pBudget,
+    size_t pMemoryMaximum,
+    smartBudgetHandle pParent,
+    smartAllocatorHandle pAllocator
+);
+
+/*----------------------------------------------------------------------------
+  SmartBudgetReserve()
+  ----------------------------------------------------------------------------
+  Reserves bytes against a budget and all of its ancestors in one call. If
+  any level would exceed its maximum the levels already reserved are
+  released and nothing remains charged.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pBudget     - (I)   The budget handle
+  pSize       - (I)   The number of bytes to reserve
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The bytes were reserved at every level
+
+  False - The bytes were not reserved due to one of the following:
+
+          1. The budget handle was NULL.
+          2. The bytes would take the budget or an ancestor over its
+             maximum.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetReserve
+(
+    smartBudgetHandle pBudget,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SmartBudgetRelease()
+  ----------------------------------------------------------------------------
+  Releases bytes reserved by SmartBudgetReserve() from a budget and all of
+  its ancestors.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pBudget     - (I)   The budget handle
+  pSize       - (I)   The number of bytes to release
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The bytes were released
+
+  False - The budget handle was NULL
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetRelease
+(
+    smartBudgetHandle pBudget,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SmartBudgetTransfer()
+  ----------------------------------------------------------------------------
+  Moves a charge from one budget to another. Ancestors shared by the two
+  budgets keep the charge, so moving memory between containers of the same
+  tenant cannot fail on the tenant's maximum.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pFromBudget - (I)   The budget handle the charge is taken from
+  pToBudget   - (I)   The budget handle the charge is moved to
+  pSize       - (I)   The number of bytes to move
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The charge was moved
+
+  False - The charge was not moved due to one of the following:
+
+          1. A budget handle was NULL.
+          2. The bytes would take the destination budget or one of its
+             ancestors that is not shared over its maximum.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetTransfer
+(
+    smartBudgetHandle pFromBudget,
+    smartBudgetHandle pToBudget,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SmartBudgetGetValue()
+  ----------------------------------------------------------------------------
+  Returns the number of bytes reserved against a budget, including those
+  reserved through its descendants.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartBudgetGetValue
+(
+    smartBudgetHandle pBudget
+);
+
+/*----------------------------------------------------------------------------
+  SmartBudgetGetMaximum()
+  ----------------------------------------------------------------------------
+  Returns the maximum a budget was constructed with.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartBudgetGetMaximum
+(
+    smartBudgetHandle pBudget
+);
+
+/*----------------------------------------------------------------------------
+  SmartBudgetGetParent()
+  ----------------------------------------------------------------------------
+  Returns the parent of a budget, NULL for a root budget.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS smartBudgetHandle CALLING_CONVENTION SmartBudgetGetParent
+(
+    smartBudgetHandle pBudget
+);
+
+/*----------------------------------------------------------------------------
+  SmartBudgetDestructSmartBudget()
+  ----------------------------------------------------------------------------
+  Destructs a budget, setting the budget handle to NULL. Any bytes still
+  reserved against the budget are released from its ancestors.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The budget was succesfully destructed
+
+  False - The budget handle pointer or the budget handle was NULL
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetDestructSmartBudget
+(
+    smartBudgetHandle * pBudget
+);
+
+/*----------------------------------------------------------------------------
+  SmartBudgetMalloc()
+  ----------------------------------------------------------------------------
+  Reserves the passed size value against a budget (and its ancestors) and
+  then allocates a block of memory from an allocator, releasing the
+  reservation if the allocation fails.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pAllocator  - (I)   The allocator handle (NULL selects Malloc())
+  pBuffer     - (I/O) The address of a memory pointer to hold the address of
+                      the memory block allocated by SafeAllocatorMalloc().
+  pSize       - (I)   The number of bytes requested to be allocated.
+  pBudget     - (I)   The budget handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully allocated
+
+  False - Memory was not successfully allocated due to one of the following:
+
+          1. SmartBudgetReserve() failed.
+          2. SafeAllocatorMalloc() failed.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetMalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    smartBudgetHandle    pBudget
+);
+
+/*----------------------------------------------------------------------------
+  SmartBudgetCalloc()
+  ----------------------------------------------------------------------------
+  Reserves the passed size value against a budget (and its ancestors) and
+  then allocates a zero filled block of memory from an allocator, releasing
+  the reservation if the allocation fails.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pAllocator  - (I)   The allocator handle (NULL selects Calloc())
+  pBuffer     - (I/O) The address of a memory pointer to hold the address of
+                      the memory block allocated by SafeAllocatorCalloc().
+  pSize       - (I)   The number of bytes requested to be allocated.
+  pBudget     - (I)   The budget handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully allocated
+
+  False - Memory was not successfully allocated due to one of the following:
+
+          1. SmartBudgetReserve() failed.
+          2. SafeAllocatorCalloc() failed.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetCalloc
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    smartBudgetHandle    pBudget
+);
+
+/*----------------------------------------------------------------------------
+  SmartBudgetFree()
+  ----------------------------------------------------------------------------
+  Returns a block of memory to an allocator, setting the memory pointer to
+  NULL and then releases the passed size value from a budget (and its
+  ancestors).
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pAllocator  - (I)   The allocator handle (NULL selects Free())
+  pBuffer     - (I/O) The address of a memory pointer to the memory block
+                      being deallocated by SafeAllocatorFree().
+  pSize       - (I)   The number of bytes being deallocated.
+  pBudget     - (I)   The budget handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Memory was succesfully deallocated
+
+  False - Memory was not successfully deallocated due to one of the following:
+
+          1. The budget handle was NULL.
+          2. SafeAllocatorFree() failed.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetFree
+(
+    smartAllocatorHandle pAllocator,
+    void **              pBuffer,
+    size_t               pSize,
+    smartBudgetHandle    pBudget
+);
+
+/*----------------------------------------------------------------------------
+  SmartBudgetSetPressureFunction()
+  ----------------------------------------------------------------------------
+  Registers a function that is called when a reservation would take a budget
+  over its maximum, turning the maximum into a self maintaining limit rather
+  than a hard failure.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pBudget           - (I) The budget handle
+  pPressureFunction - (I) The pressure function, NULL to remove it
+  pContext          - (I) A pointer passed back to the pressure function
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The pressure function was registered
+
+  False - The budget handle was NULL
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The pressure function is called with the shortfall from inside the
+  reservation (including those made for a descendant budget). When it
+  returns TRUE the reservation is retried, up to a fixed number of times,
+  and when it returns FALSE the reservation is refused.
+
+  The function may free memory charged to the budget or to any of its
+  descendants, but it must not reserve memory against them. It may be called
+  from any thread that reserves memory against the budget.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartBudgetSetPressureFunction
+(
+    smartBudgetHandle pBudget,
+    smartPressureFunction pPressureFunction,
+    void * pContext
+);
+
+/*----------------------------------------------------------------------------
+  SmartMemoryProfileSetSite()
+  ----------------------------------------------------------------------------
+  Sets the call site that the next allocation made by the calling thread is
+  recorded against. The allocation macros below call this, so it is rarely
+  called directly.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pFile       - (I)   The source file name (a string that is never freed)
+  pLine       - (I)   The source line number
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Always
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartMemoryProfileSetSite
+(
+    const char * pFile,
+    int pLine
+);
+
+/*----------------------------------------------------------------------------
+  SmartMemoryProfileSnapshot()
+  ----------------------------------------------------------------------------
+  Copies the allocation profile counters.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pProfile    - (O)   The profile snapshot
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The snapshot was taken
+
+  False - The snapshot was not taken due to one of the following:
+
+          1. The profile pointer was NULL.
+          2. Smart Memory was not compiled with SMART_MEMORY_PROFILE.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Only allocations and deallocations that carry a size are profiled: the
+  Smart, SafeAllocator, SmartAllocator, SmartCounter and SmartBudget
+  functions (and so every Tree and Stack node). SafeMalloc() and SafeFree()
+  called directly are not.
+
+  Without SMART_MEMORY_PROFILE nothing is recorded and the profile functions
+  cost nothing on the allocation paths.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartMemoryProfileSnapshot
+(
+    smartMemoryProfile * pProfile
+);
+
+/*----------------------------------------------------------------------------
+  SmartMemoryProfileReset()
+  ----------------------------------------------------------------------------
+  Zeroes the allocation profile counters and restarts the profile clock. The
+  current bytes are kept (the memory is still allocated) and become the
+  peak.
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The counters were reset
+
+  False - Smart Memory was not compiled with SMART_MEMORY_PROFILE
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartMemoryProfileReset
+(
+    void
+);
+
+/*----------------------------------------------------------------------------
+  SmartMemoryProfileDump()
+  ----------------------------------------------------------------------------
+  Writes a snapshot of the allocation profile as text or as a single line
+  JSON object.
+  ----------------------------------------------------------------------------
+  Parameters:
+  
+  pFile       - (I)   The output stream
+  pJson       - (I)   TRUE for JSON, FALSE for text
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The profile was written
+
+  False - The profile was not written due to one of the following:
+
+          1. The output stream was NULL.
+          2. Smart Memory was not compiled with SMART_MEMORY_PROFILE.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The C library stream functions are not safe to call from a signal
+  handler. To dump on a signal, have the handler set a flag that the
+  program polls and calls SmartMemoryProfileDump() from.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartMemoryProfileDump
+(
+    FILE * pFile,
+    Bool pJson
+);
+
+/*----------------------------------------------------------------------------
+  Call site capture
+  ----------------------------------------------------------------------------
+  When profiling, the sized allocation functions called from outside Smart
+  Memory record the source file and line of the call.
+  ----------------------------------------------------------------------------*/
+
+#if defined SMART_MEMORY_PROFILE && !defined SMART_MEMORY_H
+
+#define SMART_MEMORY_SITE SmartMemoryProfileSetSite(__FILE__, __LINE__)
+
+#define SmartMalloc(pBuffer, pSize, pMemoryUsed)                    (SMART_MEMORY_SITE, SmartMalloc(pBuffer, pSize, pMemoryUsed))
+#define SmartCalloc(pBuffer, pSize, pMemoryUsed)                    (SMART_MEMORY_SITE, SmartCalloc(pBuffer, pSize, pMemoryUsed))
+#define SmartAlignedMalloc(pBuffer, pSize, pAlignment, pMemoryUsed) (SMART_MEMORY_SITE, SmartAlignedMalloc(pBuffer, pSize, pAlignment, pMemoryUsed))
+
+#define SafeAllocatorMalloc(pAllocator, pBuffer, pSize)             (SMART_MEMORY_SITE, SafeAllocatorMalloc(pAllocator, pBuffer, pSize))
+#define SafeAllocatorCalloc(pAllocator, pBuffer, pSize)             (SMART_MEMORY_SITE, SafeAllocatorCalloc(pAllocator, pBuffer, pSize))
+#define SafeAllocatorRealloc(pAllocator, pBuffer, pOldSize, pSize)  (SMART_MEMORY_SITE, SafeAllocatorRealloc(pAllocator, pBuffer, pOldSize, pSize))
+#define SafeAllocatorAlignedMalloc(pAllocator, pBuffer, pSize, pAlignment) (SMART_MEMORY_SITE, SafeAllocatorAlignedMalloc(pAllocator, pBuffer, pSize, pAlignment))
+
+#define SmartAllocatorMalloc(pAllocator, pBuffer, pSize, pMemoryUsed) (SMART_MEMORY_SITE, SmartAllocatorMalloc(pAllocator, pBuffer, pSize, pMemoryUsed))
+#define SmartAllocatorCalloc(pAllocator, pBuffer, pSize, pMemoryUsed) (SMART_MEMORY_SITE, SmartAllocatorCalloc(pAllocator, pBuffer, pSize, pMemoryUsed))
+
+#define SmartCounterMalloc(pAllocator, pBuffer, pSize, pCounter)    (SMART_MEMORY_SITE, SmartCounterMalloc(pAllocator, pBuffer, pSize, pCounter))
+#define SmartCounterCalloc(pAllocator, pBuffer, pSize, pCounter)    (SMART_MEMORY_SITE, SmartCounterCalloc(pAllocator, pBuffer, pSize, pCounter))
+
+#define SmartBudgetMalloc(pAllocator, pBuffer, pSize, pBudget)      (SMART_MEMORY_SITE, SmartBudgetMalloc(pAllocator, pBuffer, pSize, pBudget))
+#define SmartBudgetCalloc(pAllocator, pBuffer, pSize, pBudget)      (SMART_MEMORY_SITE, SmartBudgetCalloc(pAllocator, pBuffer, pSize, pBudget))
+
+#endif
+
 #endif
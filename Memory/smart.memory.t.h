@@ -0,0 +1,156 @@
+/*----------------------------------------------------------------------------
+  Smart Memory
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Memory application programmer's types (APT) header file
+  ----------------------------------------------------------------------------*/
+
+#ifndef SMART_MEMORY_T_H
+#define SMART_MEMORY_T_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/*----------------------------------------------------------------------------
+  Allocator interface
+  ----------------------------------------------------------------------------
+  An allocator is a table of memory management functions along with a
+  context pointer that is passed back to each of the functions. Containers
+  that are bound to an allocator obtain and release all of their memory
+  through it. A NULL allocator handle selects the C runtime library.
+
+  allocate        - Return a block of at least pSize bytes or NULL
+  allocateZeroed  - Return a zero filled block of at least pSize bytes or NULL
+  allocateAligned - Return a block of at least pSize bytes at an address that
+                    is a multiple of pAlignment (a power of two that divides
+                    pSize) or NULL. The block is released by deallocate with
+                    the same pSize. An allocator that cannot align blocks
+                    beyond the C runtime library alignment sets it to NULL.
+  reallocate      - Resize a block from pOldSize to pSize bytes returning the
+                    (possibly moved) block or NULL leaving the block unchanged
+  deallocate      - Release a block of pSize bytes
+  context         - Allocator private state passed to each of the functions
+
+  Because the size of the block is handed to deallocate() an allocator is not
+  required to keep a header with each block.
+
+  A region allocator, whose blocks are all released together when the region
+  is destroyed, sets deallocate to NULL. Freeing one of its blocks only clears
+  the pointer and containers bound to it skip visiting their nodes when they
+  are destructed.
+  ----------------------------------------------------------------------------*/
+
+typedef struct smartAllocator {
+    void * (* allocate)(void * pContext, size_t pSize);
+    void * (* allocateZeroed)(void * pContext, size_t pSize);
+    void * (* allocateAligned)(void * pContext, size_t pSize, size_t pAlignment);
+    void * (* reallocate)(void * pContext, void * pBuffer, size_t pOldSize, size_t pSize);
+    void   (* deallocate)(void * pContext, void * pBuffer, size_t pSize);
+
+    void * context;
+} smartAllocator;
+
+typedef smartAllocator * smartAllocatorHandle;
+
+/*----------------------------------------------------------------------------
+  Memory pressure function
+  ----------------------------------------------------------------------------
+  Called with the number of bytes by which a reservation exceeds the maximum
+  of a budget (the shortfall). The function should free memory charged to
+  the budget, such as by destructing the oldest nodes of a container, and
+  return TRUE to have the reservation retried or FALSE to have it refused.
+  ----------------------------------------------------------------------------*/
+
+typedef Bool (* smartPressureFunction)(void * pContext, size_t pShortfall);
+
+/*----------------------------------------------------------------------------
+  Memory profile
+  ----------------------------------------------------------------------------
+  A snapshot of the counters kept when Smart Memory is compiled with
+  SMART_MEMORY_PROFILE defined.
+
+  allocations    - Number of allocations (and reallocations) recorded
+  deallocations  - Number of deallocations recorded
+  bytesAllocated - Sum of the sizes of all allocations recorded
+  currentBytes   - Bytes allocated and not yet deallocated
+  peakBytes      - Highest value of currentBytes
+  seconds        - Seconds since the counters were last reset
+  histogram      - Allocation counts by size, histogram[n] counting sizes
+                   from 2^(n-1)+1 to 2^n bytes (the last bucket counting all
+                   larger sizes)
+  siteCount      - Number of call sites in sites[] (the most recorded when
+                   there are more than SMART_MEMORY_PROFILE_SITES)
+  sites          - Allocation counts and bytes per source file and line, a
+                   NULL file gathering calls made without a call site
+  ----------------------------------------------------------------------------*/
+
+#define SMART_MEMORY_PROFILE_BUCKETS 32
+#define SMART_MEMORY_PROFILE_SITES   256
+
+typedef struct smartMemoryProfileSite {
+    const char * file;
+    int line;
+
+    unsigned long long allocations;
+    unsigned long long bytes;
+} smartMemoryProfileSite;
+
+typedef struct smartMemoryProfile {
+    unsigned long long allocations;
+    unsigned long long deallocations;
+    unsigned long long bytesAllocated;
+
+    size_t currentBytes;
+    size_t peakBytes;
+
+    double seconds;
+
+    unsigned long long histogram[SMART_MEMORY_PROFILE_BUCKETS];
+
+    unsigned long siteCount;
+
+    smartMemoryProfileSite sites[SMART_MEMORY_PROFILE_SITES];
+} smartMemoryProfile;
+
+#ifndef SMART_MEMORY_H
+
+/*----------------------------------------------------------------------------
+  Abstracted Smart Counter and Smart Budget object handle data types
+  ----------------------------------------------------------------------------*/
+
+typedef void * smartCounterHandle;
+
+typedef void * smartBudgetHandle;
+
+#endif
+
+#endif
@@ -0,0 +1,1129 @@
+/*----------------------------------------------------------------------------
+  Smart Memory test application
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Memory test program implementation file
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Standard libraries
+  ----------------------------------------------------------------------------*/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+
+/*----------------------------------------------------------------------------
+  Public data types
+  ----------------------------------------------------------------------------*/
+
+#include "compilation.t.h"
+#include "types.t.h"
+
+#include "smart.memory.t.h"
+
+/*----------------------------------------------------------------------------
+  Public functions
+  ----------------------------------------------------------------------------*/
+
+#include "smart.memory.i.h"
+
+/*----------------------------------------------------------------------------
+  Private defines, data types and function prototypes
+  ----------------------------------------------------------------------------*/
+
+#include "smart.memory.test.h"
+
+/*----------------------------------------------------------------------------
+  <Eeek> Globals </Eeek>
+  ----------------------------------------------------------------------------*/
+
+void * gBlocks[TEST_BLOCKS];
+
+smartAllocator gTestAllocator = {TestAllocate, TestAllocateZeroed, NULL, TestReallocate, TestDeallocate, NULL};
+
+size_t gMemoryUsed;
+
+smartCounterHandle gCounter;
+
+/*----------------------------------------------------------------------------
+  Main
+  ----------------------------------------------------------------------------*/
+
+void main
+(
+    void
+)
+{
+    int lOption;
+
+    srand(TEST_SEED);
+
+    do
+    {
+        printf("Option: ");
+
+        do
+        {
+            lOption = toupper(fgetc(stdin));
+        }
+        while (!isprint(lOption)); /* eat carriage returns (etc) */
+
+        switch ((char) lOption)
+        {
+            case '?':
+            {
+                DisplayOptions();
+                break;
+            }
+
+            case 'Q':
+            {
+                break;
+            }
+
+            case '1':
+            {
+                AllocatorIndirectionPerformanceTest();
+                break;
+            }
+
+            case '2':
+            {
+                ThreadCachePerformanceTest();
+                break;
+            }
+
+            case '3':
+            {
+                CounterTest();
+                break;
+            }
+
+            case '4':
+            {
+                BudgetTest();
+                break;
+            }
+
+            case '5':
+            {
+                ProfileTest();
+                break;
+            }
+
+            case '6':
+            {
+                AlignedTest();
+                break;
+            }
+
+            case '7':
+            {
+                DeferredFreeTest();
+                break;
+            }
+
+            default:
+            {
+                printf("Valid options are 1,2,3,4,5,6,7,Q,?\n");
+                break;
+            }
+        }
+    }
+    while ('Q' != lOption);
+}
+
+void DisplayOptions
+(
+    void
+)
+{
+    printf("\n"
+           "Options:\n"
+           "(1) Allocator indirection performance test\n"
+           "(2) Thread cache performance test\n"
+           "(3) Shared memory counter test\n"
+           "(4) Nested memory budget test\n"
+           "(5) Allocation profile test\n"
+           "(6) Aligned allocation test\n"
+           "(7) Deferred free latency test\n\n"
+           "(Q) Quit\n"
+           "(?) Display this option list\n"
+           "\n");
+}
+
+void AllocatorIndirectionPerformanceTest
+(
+    void
+)
+{
+    static const char * lMethodNames[] = {"SmartMalloc (macros)", "SmartAllocatorMalloc (NULL)", "SmartAllocatorMalloc (table)"};
+
+    unsigned long lIterations;
+    unsigned long lIteration;
+
+    int lMethod;
+
+    unsigned long lBlockIndex;
+
+    size_t * lSizes = NULL;
+
+    double lSeconds[3] = {0, 0, 0};
+
+    printf("\n");
+    printf("Iterations: ");
+    scanf("%ld", &lIterations);
+
+    if (!SafeMalloc((void **) &lSizes, TEST_BLOCKS * sizeof(size_t)))
+    {
+        return;
+    }
+
+    /*
+    ** a fixed mix of node sized requests shared by every method
+    */
+
+    for (lBlockIndex = 0; lBlockIndex < TEST_BLOCKS; lBlockIndex++)
+    {
+        lSizes[lBlockIndex] = (size_t) (8 + rand() % 120);
+    }
+
+    for (lIteration = 1; lIteration <= lIterations; lIteration++)
+    {
+        printf("Iteration : %ld ", lIteration);
+
+        for (lMethod = 0; lMethod < 3; lMethod++)
+        {
+            lSeconds[lMethod] += AllocatorPass(lMethod, lSizes);
+
+            printf(".");
+        }
+
+        printf("\r");
+    }
+
+    printf("\n\n");
+
+    for (lMethod = 0; lMethod < 3; lMethod++)
+    {
+        printf("%-30s %9.3f secs %12.0f blocks/sec %7.2f%%\n", lMethodNames[lMethod], lSeconds[lMethod], ((double) (lIterations * TEST_BLOCKS)) / lSeconds[lMethod], 100.0 * lSeconds[lMethod] / lSeconds[0]);
+    }
+
+    printf("\n");
+
+    SafeFree((void **) &lSizes);
+}
+
+double AllocatorPass
+(
+    int pMethod,
+    size_t * pSizes
+)
+{
+    unsigned long lBlockIndex;
+
+    size_t lMemoryUsed = 0;
+
+    clock_t lStartTime;
+
+    memset(gBlocks, 0, sizeof(gBlocks));
+
+    lStartTime = clock();
+
+    for (lBlockIndex = 0; lBlockIndex < TEST_BLOCKS; lBlockIndex++)
+    {
+        switch (pMethod)
+        {
+        case 0:
+            SmartMalloc(&gBlocks[lBlockIndex], pSizes[lBlockIndex], &lMemoryUsed);
+            break;
+        case 1:
+            SmartAllocatorMalloc(NULL, &gBlocks[lBlockIndex], pSizes[lBlockIndex], &lMemoryUsed);
+            break;
+        case 2:
+            SmartAllocatorMalloc(&gTestAllocator, &gBlocks[lBlockIndex], pSizes[lBlockIndex], &lMemoryUsed);
+            break;
+        }
+    }
+
+    for (lBlockIndex = 0; lBlockIndex < TEST_BLOCKS; lBlockIndex++)
+    {
+        switch (pMethod)
+        {
+        case 0:
+            SmartFree(&gBlocks[lBlockIndex], pSizes[lBlockIndex], &lMemoryUsed);
+            break;
+        case 1:
+            SmartAllocatorFree(NULL, &gBlocks[lBlockIndex], pSizes[lBlockIndex], &lMemoryUsed);
+            break;
+        case 2:
+            SmartAllocatorFree(&gTestAllocator, &gBlocks[lBlockIndex], pSizes[lBlockIndex], &lMemoryUsed);
+            break;
+        }
+    }
+
+    if (0 != lMemoryUsed)
+    {
+        printf("Memory accounting disagreement: %ld bytes remain\n", lMemoryUsed);
+    }
+
+    return(((double) (clock() - lStartTime)) / CLOCKS_PER_SEC);
+}
+
+void ThreadCachePerformanceTest
+(
+    void
+)
+{
+    static const char * lMethodNames[] = {"SafeMalloc", "SmartThreadCacheGetAllocator"};
+
+    unsigned long lThreads;
+    unsigned long lThreadCount;
+
+    int lMethod;
+
+    double lSeconds[2];
+
+    printf("\n");
+    printf("Threads (maximum %d): ", TEST_THREADS);
+    scanf("%ld", &lThreads);
+
+    if (TEST_THREADS < lThreads)
+    {
+        lThreads = TEST_THREADS;
+    }
+
+    printf("\n%-8s", "Threads");
+
+    for (lMethod = 0; lMethod < 2; lMethod++)
+    {
+        printf(" %28s", lMethodNames[lMethod]);
+    }
+
+    printf(" %8s\n", "Speedup");
+
+    for (lThreadCount = 1; lThreadCount <= lThreads; lThreadCount++)
+    {
+        printf("%-8ld", lThreadCount);
+
+        for (lMethod = 0; lMethod < 2; lMethod++)
+        {
+            lSeconds[lMethod] = ThreadCachePass(lMethod, lThreadCount);
+
+            printf(" %18.0f blocks/sec", ((double) (lThreadCount * TEST_THREAD_ROUNDS * TEST_THREAD_BLOCKS)) / lSeconds[lMethod]);
+        }
+
+        printf(" %7.2fx\n", lSeconds[0] / lSeconds[1]);
+    }
+
+    printf("\nBackend memory: %ld bytes\n\n", SmartThreadCacheGetMemoryAllocated());
+}
+
+double ThreadCachePass
+(
+    int pMethod,
+    unsigned long pThreads
+)
+{
+    thrd_t lThreads[TEST_THREADS];
+
+    int lMethods[TEST_THREADS];
+
+    unsigned long lThreadIndex;
+
+    struct timespec lStartTime;
+    struct timespec lEndTime;
+
+    timespec_get(&lStartTime, TIME_UTC);
+
+    for (lThreadIndex = 0; lThreadIndex < pThreads; lThreadIndex++)
+    {
+        lMethods[lThreadIndex] = pMethod;
+
+        thrd_create(&lThreads[lThreadIndex], ThreadCacheWorker, &lMethods[lThreadIndex]);
+    }
+
+    for (lThreadIndex = 0; lThreadIndex < pThreads; lThreadIndex++)
+    {
+        thrd_join(lThreads[lThreadIndex], NULL);
+    }
+
+    timespec_get(&lEndTime, TIME_UTC);
+
+    return((double) (lEndTime.tv_sec - lStartTime.tv_sec) + ((double) (lEndTime.tv_nsec - lStartTime.tv_nsec)) / 1e9);
+}
+
+int ThreadCacheWorker
+(
+    void * pMethod
+)
+{
+    smartAllocatorHandle lAllocator = SmartThreadCacheGetAllocator();
+
+    void * lBlocks[TEST_THREAD_BLOCKS];
+
+    size_t lSizes[TEST_THREAD_BLOCKS];
+
+    unsigned long lRound;
+    unsigned long lBlockIndex;
+
+    unsigned int lSeed = (unsigned int) (size_t) &lRound;
+
+    int lMethod = *((int *) pMethod);
+
+    /*
+    ** a per thread mix of node sized requests (rand() is not thread safe)
+    */
+
+    for (lBlockIndex = 0; lBlockIndex < TEST_THREAD_BLOCKS; lBlockIndex++)
+    {
+        lSeed = lSeed * 1103515245 + 12345;
+
+        lSizes[lBlockIndex] = (size_t) (8 + (lSeed >> 16) % 120);
+
+        lBlocks[lBlockIndex] = NULL;
+    }
+
+    for (lRound = 0; lRound < TEST_THREAD_ROUNDS; lRound++)
+    {
+        for (lBlockIndex = 0; lBlockIndex < TEST_THREAD_BLOCKS; lBlockIndex++)
+        {
+            if (0 == lMethod)
+            {
+                SafeMalloc(&lBlocks[lBlockIndex], lSizes[lBlockIndex]);
+            }
+            else
+            {
+                SafeAllocatorMalloc(lAllocator, &lBlocks[lBlockIndex], lSizes[lBlockIndex]);
+            }
+        }
+
+        for (lBlockIndex = 0; lBlockIndex < TEST_THREAD_BLOCKS; lBlockIndex++)
+        {
+            if (0 == lMethod)
+            {
+                SafeFree(&lBlocks[lBlockIndex]);
+            }
+            else
+            {
+                SafeAllocatorFree(lAllocator, &lBlocks[lBlockIndex], lSizes[lBlockIndex]);
+            }
+        }
+    }
+
+    return(0);
+}
+
+void CounterTest
+(
+    void
+)
+{
+    static const char * lMethodNames[] = {"SmartAllocatorMalloc (size_t)", "SmartCounterMalloc"};
+
+    unsigned long lThreads;
+
+    int lMethod;
+
+    double lSeconds;
+
+    unsigned long lReserved;
+
+    printf("\n");
+    printf("Threads (maximum %d): ", TEST_THREADS);
+    scanf("%ld", &lThreads);
+
+    if (TEST_THREADS < lThreads)
+    {
+        lThreads = TEST_THREADS;
+    }
+
+    printf("\n");
+
+    /*
+    ** every thread allocates and frees against one shared count, which must
+    ** return to zero
+    */
+
+    for (lMethod = 0; lMethod < 2; lMethod++)
+    {
+        gMemoryUsed = 0;
+
+        gCounter = NULL;
+
+        SmartCounterConstructSmartCounter(&gCounter, 0);
+
+        lSeconds = CounterPass(lMethod, lThreads, CounterWorker);
+
+        printf("%-30s %9.3f secs %12.0f blocks/sec, %ld bytes remain\n", lMethodNames[lMethod], lSeconds, ((double) (lThreads * TEST_THREAD_ROUNDS * TEST_THREAD_BLOCKS)) / lSeconds, 0 == lMethod ? gMemoryUsed : SmartCounterGetValue(gCounter));
+
+        SmartCounterDestructSmartCounter(&gCounter);
+    }
+
+    /*
+    ** every thread reserves against one shared maximum until refused, the
+    ** reservations granted must fit the maximum exactly
+    */
+
+    gCounter = NULL;
+
+    SmartCounterConstructSmartCounter(&gCounter, TEST_COUNTER_MAXIMUM);
+
+    CounterPass(1, lThreads, CounterReserveWorker);
+
+    lReserved = (unsigned long) SmartCounterGetValue(gCounter);
+
+    printf("\nReserved %ld of %ld bytes: %s\n\n", lReserved, (unsigned long) TEST_COUNTER_MAXIMUM, TEST_COUNTER_MAXIMUM - TEST_COUNTER_BLOCK < lReserved && TEST_COUNTER_MAXIMUM >= lReserved ? "OK" : "FAILED");
+
+    SmartCounterDestructSmartCounter(&gCounter);
+}
+
+double CounterPass
+(
+    int pMethod,
+    unsigned long pThreads,
+    int (* pWorker)(void * pMethod)
+)
+{
+    thrd_t lThreads[TEST_THREADS];
+
+    int lMethods[TEST_THREADS];
+
+    unsigned long lThreadIndex;
+
+    struct timespec lStartTime;
+    struct timespec lEndTime;
+
+    timespec_get(&lStartTime, TIME_UTC);
+
+    for (lThreadIndex = 0; lThreadIndex < pThreads; lThreadIndex++)
+    {
+        lMethods[lThreadIndex] = pMethod;
+
+        thrd_create(&lThreads[lThreadIndex], pWorker, &lMethods[lThreadIndex]);
+    }
+
+    for (lThreadIndex = 0; lThreadIndex < pThreads; lThreadIndex++)
+    {
+        thrd_join(lThreads[lThreadIndex], NULL);
+    }
+
+    timespec_get(&lEndTime, TIME_UTC);
+
+    return((double) (lEndTime.tv_sec - lStartTime.tv_sec) + ((double) (lEndTime.tv_nsec - lStartTime.tv_nsec)) / 1e9);
+}
+
+int CounterWorker
+(
+    void * pMethod
+)
+{
+    void * lBlocks[TEST_THREAD_BLOCKS];
+
+    unsigned long lRound;
+    unsigned long lBlockIndex;
+
+    int lMethod = *((int *) pMethod);
+
+    memset(lBlocks, 0, sizeof(lBlocks));
+
+    for (lRound = 0; lRound < TEST_THREAD_ROUNDS; lRound++)
+    {
+        for (lBlockIndex = 0; lBlockIndex < TEST_THREAD_BLOCKS; lBlockIndex++)
+        {
+            if (0 == lMethod)
+            {
+                SmartAllocatorMalloc(NULL, &lBlocks[lBlockIndex], TEST_COUNTER_BLOCK, &gMemoryUsed);
+            }
+            else
+            {
+                SmartCounterMalloc(NULL, &lBlocks[lBlockIndex], TEST_COUNTER_BLOCK, gCounter);
+            }
+        }
+
+        for (lBlockIndex = 0; lBlockIndex < TEST_THREAD_BLOCKS; lBlockIndex++)
+        {
+            if (0 == lMethod)
+            {
+                SmartAllocatorFree(NULL, &lBlocks[lBlockIndex], TEST_COUNTER_BLOCK, &gMemoryUsed);
+            }
+            else
+            {
+                SmartCounterFree(NULL, &lBlocks[lBlockIndex], TEST_COUNTER_BLOCK, gCounter);
+            }
+        }
+    }
+
+    return(0);
+}
+
+int CounterReserveWorker
+(
+    void * pMethod
+)
+{
+    (void) pMethod;
+
+    while (SmartCounterReserve(gCounter, TEST_COUNTER_BLOCK))
+    {
+    }
+
+    return(0);
+}
+
+void BudgetTest
+(
+    void
+)
+{
+    smartBudgetHandle lProcess = NULL;
+    smartBudgetHandle lTenants[TEST_BUDGET_TENANTS];
+    smartBudgetHandle lContainers[TEST_BUDGET_TENANTS][TEST_BUDGET_CONTAINERS];
+
+    unsigned long lTenantIndex;
+    unsigned long lContainerIndex;
+    unsigned long lBlocks[TEST_BUDGET_TENANTS][TEST_BUDGET_CONTAINERS];
+
+    Bool lPassed = TRUE;
+
+    /*
+    ** a process cap smaller than the sum of the tenant caps, each of which is
+    ** smaller than the sum of its container caps
+    */
+
+    SmartBudgetConstructSmartBudget(&lProcess, TEST_BUDGET_PROCESS, NULL);
+
+    for (lTenantIndex = 0; lTenantIndex < TEST_BUDGET_TENANTS; lTenantIndex++)
+    {
+        lTenants[lTenantIndex] = NULL;
+
+        SmartBudgetConstructSmartBudget(&lTenants[lTenantIndex], TEST_BUDGET_TENANT, lProcess);
+
+        for (lContainerIndex = 0; lContainerIndex < TEST_BUDGET_CONTAINERS; lContainerIndex++)
+        {
+            lContainers[lTenantIndex][lContainerIndex] = NULL;
+
+            SmartBudgetConstructSmartBudget(&lContainers[lTenantIndex][lContainerIndex], TEST_BUDGET_CONTAINER, lTenants[lTenantIndex]);
+
+            lBlocks[lTenantIndex][lContainerIndex] = 0;
+        }
+    }
+
+    /*
+    ** fill the containers in turn until every one of them is refused
+    */
+
+    for (lTenantIndex = 0; lTenantIndex < TEST_BUDGET_TENANTS; lTenantIndex++)
+    {
+        for (lContainerIndex = 0; lContainerIndex < TEST_BUDGET_CONTAINERS; lContainerIndex++)
+        {
+            while (SmartBudgetReserve(lContainers[lTenantIndex][lContainerIndex], TEST_COUNTER_BLOCK))
+            {
+                lBlocks[lTenantIndex][lContainerIndex]++;
+            }
+        }
+    }
+
+    printf("\n");
+
+    for (lTenantIndex = 0; lTenantIndex < TEST_BUDGET_TENANTS; lTenantIndex++)
+    {
+        printf("Tenant %ld: %8ld of %8ld bytes, containers:", lTenantIndex, SmartBudgetGetValue(lTenants[lTenantIndex]), SmartBudgetGetMaximum(lTenants[lTenantIndex]));
+
+        for (lContainerIndex = 0; lContainerIndex < TEST_BUDGET_CONTAINERS; lContainerIndex++)
+        {
+            printf(" %7ld", SmartBudgetGetValue(lContainers[lTenantIndex][lContainerIndex]));
+
+            if (SmartBudgetGetValue(lContainers[lTenantIndex][lContainerIndex]) != lBlocks[lTenantIndex][lContainerIndex] * TEST_COUNTER_BLOCK ||
+                SmartBudgetGetValue(lContainers[lTenantIndex][lContainerIndex]) > TEST_BUDGET_CONTAINER)
+            {
+                lPassed = FALSE;
+            }
+        }
+
+        printf("\n");
+
+        if (SmartBudgetGetValue(lTenants[lTenantIndex]) > TEST_BUDGET_TENANT)
+        {
+            lPassed = FALSE;
+        }
+    }
+
+    printf("Process : %8ld of %8ld bytes\n", SmartBudgetGetValue(lProcess), SmartBudgetGetMaximum(lProcess));
+
+    if (SmartBudgetGetValue(lProcess) > TEST_BUDGET_PROCESS || SmartBudgetGetValue(lProcess) + TEST_COUNTER_BLOCK <= TEST_BUDGET_PROCESS)
+    {
+        lPassed = FALSE;
+    }
+
+    /*
+    ** moving a charge between containers of one tenant leaves the tenant alone
+    */
+
+    SmartBudgetRelease(lContainers[0][1], TEST_COUNTER_BLOCK);
+
+    if (!SmartBudgetTransfer(lContainers[0][0], lContainers[0][1], TEST_COUNTER_BLOCK) || SmartBudgetGetValue(lContainers[0][0]) != (lBlocks[0][0] - 1) * TEST_COUNTER_BLOCK)
+    {
+        lPassed = FALSE;
+    }
+
+    SmartBudgetReserve(lContainers[0][0], TEST_COUNTER_BLOCK);
+
+    /*
+    ** destructing the budgets returns their charges, leaving the process empty
+    */
+
+    for (lTenantIndex = 0; lTenantIndex < TEST_BUDGET_TENANTS; lTenantIndex++)
+    {
+        for (lContainerIndex = 0; lContainerIndex < TEST_BUDGET_CONTAINERS; lContainerIndex++)
+        {
+            SmartBudgetDestructSmartBudget(&lContainers[lTenantIndex][lContainerIndex]);
+        }
+
+        SmartBudgetDestructSmartBudget(&lTenants[lTenantIndex]);
+    }
+
+    if (0 != SmartBudgetGetValue(lProcess))
+    {
+        lPassed = FALSE;
+    }
+
+    SmartBudgetDestructSmartBudget(&lProcess);
+
+    printf("\nBudget test: %s\n\n", lPassed ? "OK" : "FAILED");
+}
+
+void ProfileTest
+(
+    void
+)
+{
+    unsigned long lBlockIndex;
+
+    size_t * lSizes = NULL;
+
+    size_t lMemoryUsed = 0;
+
+    if (!SmartMemoryProfileReset())
+    {
+        printf("\nCompile with SMART_MEMORY_PROFILE defined to profile allocations\n\n");
+        return;
+    }
+
+    if (!SafeMalloc((void **) &lSizes, TEST_BLOCKS * sizeof(size_t)))
+    {
+        return;
+    }
+
+    memset(gBlocks, 0, sizeof(gBlocks));
+
+    /*
+    ** node sized blocks from one call site and page sized blocks from
+    ** another, half of which are freed before the dump
+    */
+
+    for (lBlockIndex = 0; lBlockIndex < TEST_BLOCKS; lBlockIndex++)
+    {
+        if (0 == lBlockIndex % 100)
+        {
+            lSizes[lBlockIndex] = (size_t) (2048 + rand() % 4096);
+
+            SmartMalloc(&gBlocks[lBlockIndex], lSizes[lBlockIndex], &lMemoryUsed);
+        }
+        else
+        {
+            lSizes[lBlockIndex] = (size_t) (8 + rand() % 120);
+
+            SmartAllocatorMalloc(&gTestAllocator, &gBlocks[lBlockIndex], lSizes[lBlockIndex], &lMemoryUsed);
+        }
+    }
+
+    for (lBlockIndex = 0; lBlockIndex < TEST_BLOCKS; lBlockIndex++)
+    {
+        if (0 == lBlockIndex % 2)
+        {
+            ProfileTestFree(lBlockIndex, lSizes, &lMemoryUsed);
+        }
+    }
+
+    printf("\n");
+
+    SmartMemoryProfileDump(stdout, FALSE);
+    SmartMemoryProfileDump(stdout, TRUE);
+
+    printf("\n");
+
+    for (lBlockIndex = 0; lBlockIndex < TEST_BLOCKS; lBlockIndex++)
+    {
+        if (NULL != gBlocks[lBlockIndex])
+        {
+            ProfileTestFree(lBlockIndex, lSizes, &lMemoryUsed);
+        }
+    }
+
+    SafeFree((void **) &lSizes);
+}
+
+void ProfileTestFree
+(
+    unsigned long pBlockIndex,
+    size_t * pSizes,
+    size_t * pMemoryUsed
+)
+{
+    if (0 == pBlockIndex % 100)
+    {
+        SmartFree(&gBlocks[pBlockIndex], pSizes[pBlockIndex], pMemoryUsed);
+    }
+    else
+    {
+        SmartAllocatorFree(&gTestAllocator, &gBlocks[pBlockIndex], pSizes[pBlockIndex], pMemoryUsed);
+    }
+}
+
+void AlignedTest
+(
+    void
+)
+{
+    unsigned long lBlockIndex;
+
+    unsigned int lShift;
+
+    size_t * lSizes = NULL;
+
+    size_t lMemoryUsed = 0;
+
+    void * lBuffer = NULL;
+
+    Bool lValid = TRUE;
+
+    if (!SafeMalloc((void **) &lSizes, TEST_ALIGNED_BLOCKS * sizeof(size_t)))
+    {
+        return;
+    }
+
+    for (lBlockIndex = 0; lBlockIndex < TEST_ALIGNED_BLOCKS; lBlockIndex++)
+    {
+        lSizes[lBlockIndex] = (size_t) (1 + rand() % TEST_ALIGNED_MAXIMUM_SIZE);
+    }
+
+    printf("\n");
+
+    /*
+    ** the C runtime library with and without an allocator handle
+    */
+
+    for (lShift = 0; lShift <= TEST_ALIGNED_MAXIMUM_SHIFT; lShift++)
+    {
+        memset(gBlocks, 0, TEST_ALIGNED_BLOCKS * sizeof(void *));
+
+        for (lBlockIndex = 0; lBlockIndex < TEST_ALIGNED_BLOCKS; lBlockIndex++)
+        {
+            if (!SmartAlignedMalloc(&gBlocks[lBlockIndex], lSizes[lBlockIndex], (size_t) 1 << lShift, &lMemoryUsed)
+                || 0 != ((size_t) gBlocks[lBlockIndex] & (((size_t) 1 << lShift) - 1)))
+            {
+                lValid = FALSE;
+            }
+        }
+
+        for (lBlockIndex = 0; lBlockIndex < TEST_ALIGNED_BLOCKS; lBlockIndex++)
+        {
+            SmartAlignedFree(&gBlocks[lBlockIndex], lSizes[lBlockIndex], &lMemoryUsed);
+        }
+    }
+
+    printf("SmartAlignedMalloc:             %s\n", lValid && 0 == lMemoryUsed ? "OK" : "FAILED");
+
+    lValid = TRUE;
+
+    for (lShift = 0; lShift <= TEST_ALIGNED_MAXIMUM_SHIFT; lShift++)
+    {
+        lValid = AlignedPass(NULL, (size_t) 1 << lShift, lSizes) && lValid;
+    }
+
+    printf("SafeAllocatorAlignedMalloc:     %s\n", lValid ? "OK" : "FAILED");
+
+    /*
+    ** the thread cache serves aligned blocks from its size classes
+    */
+
+    lValid = TRUE;
+
+    for (lShift = 0; lShift <= TEST_ALIGNED_MAXIMUM_SHIFT; lShift++)
+    {
+        lValid = AlignedPass(SmartThreadCacheGetAllocator(), (size_t) 1 << lShift, lSizes) && lValid;
+    }
+
+    SmartThreadCacheFlush();
+
+    printf("Thread cache aligned blocks:    %s\n", lValid ? "OK" : "FAILED");
+
+    /*
+    ** an allocator without allocateAligned only serves the natural alignment
+    */
+
+    lValid = SafeAllocatorAlignedMalloc(&gTestAllocator, &lBuffer, 100, 8) && SafeAllocatorAlignedFree(&gTestAllocator, &lBuffer, 100, 8);
+
+    lValid = lValid && !SafeAllocatorAlignedMalloc(&gTestAllocator, &lBuffer, 100, 64) && NULL == lBuffer;
+
+    printf("Unaligned allocator refusal:    %s\n\n", lValid ? "OK" : "FAILED");
+
+    SafeFree((void **) &lSizes);
+}
+
+Bool AlignedPass
+(
+    smartAllocatorHandle pAllocator,
+    size_t pAlignment,
+    size_t * pSizes
+)
+{
+    unsigned long lBlockIndex;
+
+    Bool lValid = TRUE;
+
+    memset(gBlocks, 0, TEST_ALIGNED_BLOCKS * sizeof(void *));
+
+    for (lBlockIndex = 0; lBlockIndex < TEST_ALIGNED_BLOCKS; lBlockIndex++)
+    {
+        if (!SafeAllocatorAlignedMalloc(pAllocator, &gBlocks[lBlockIndex], pSizes[lBlockIndex], pAlignment))
+        {
+            lValid = FALSE;
+            continue;
+        }
+
+        if (0 != ((size_t) gBlocks[lBlockIndex] & (pAlignment - 1)))
+        {
+            lValid = FALSE;
+        }
+
+        /*
+        ** touch the whole block so that overlapping blocks are caught
+        */
+
+        memset(gBlocks[lBlockIndex], (int) lBlockIndex, pSizes[lBlockIndex]);
+    }
+
+    for (lBlockIndex = 0; lBlockIndex < TEST_ALIGNED_BLOCKS; lBlockIndex++)
+    {
+        if (NULL != gBlocks[lBlockIndex])
+        {
+            if ((unsigned char) lBlockIndex != ((unsigned char *) gBlocks[lBlockIndex])[pSizes[lBlockIndex] - 1])
+            {
+                lValid = FALSE;
+            }
+
+            SafeAllocatorAlignedFree(pAllocator, &gBlocks[lBlockIndex], pSizes[lBlockIndex], pAlignment);
+        }
+    }
+
+    return(lValid);
+}
+
+void DeferredFreeTest
+(
+    void
+)
+{
+    static const char * lMethodNames[] = {"SmartFree", "Deferred, flushed", "Deferred, reclaimer"};
+
+    unsigned long lBlockIndex;
+
+    int lMethod;
+
+    size_t * lSizes = NULL;
+
+    double lSeconds;
+    double lWorstBurst;
+
+    if (!SafeMalloc((void **) &lSizes, TEST_BLOCKS * sizeof(size_t)))
+    {
+        return;
+    }
+
+    /*
+    ** mostly node sized blocks with a few that are large enough to be
+    ** mapped, freeing those unmaps them which is where the spikes come from
+    */
+
+    for (lBlockIndex = 0; lBlockIndex < TEST_BLOCKS; lBlockIndex++)
+    {
+        lSizes[lBlockIndex] = (0 == lBlockIndex % 100) ? TEST_DEFERRED_LARGE : (size_t) (16 + rand() % 240);
+    }
+
+    printf("\n%-20s %14s %20s\n", "Method", "Free time", "Worst burst");
+
+    for (lMethod = 0; lMethod < 3; lMethod++)
+    {
+        lSeconds = DeferredFreePass(lMethod, lSizes, &lWorstBurst);
+
+        printf("%-20s %10.3f sec %13.3f msec\n", lMethodNames[lMethod], lSeconds, lWorstBurst * 1000.0);
+    }
+
+    printf("\nPending blocks after stop: %ld\n\n", SmartDeferredFreeGetPending());
+
+    SafeFree((void **) &lSizes);
+}
+
+double DeferredFreePass
+(
+    int pMethod,
+    size_t * pSizes,
+    double * pWorstBurst
+)
+{
+    unsigned long lBlockIndex;
+    unsigned long lBurstIndex;
+
+    size_t lMemoryUsed = 0;
+
+    double lSeconds = 0;
+    double lBurst;
+
+    struct timespec lStartTime;
+    struct timespec lEndTime;
+
+    memset(gBlocks, 0, sizeof(gBlocks));
+
+    for (lBlockIndex = 0; lBlockIndex < TEST_BLOCKS; lBlockIndex++)
+    {
+        SmartMalloc(&gBlocks[lBlockIndex], pSizes[lBlockIndex], &lMemoryUsed);
+
+        /*
+        ** touch the block so that the pages of a mapped block are resident
+        */
+
+        memset(gBlocks[lBlockIndex], 0, pSizes[lBlockIndex]);
+    }
+
+    if (0 < pMethod)
+    {
+        SmartDeferredFreeStart(2 == pMethod);
+    }
+
+    *pWorstBurst = 0;
+
+    for (lBlockIndex = 0; lBlockIndex < TEST_BLOCKS; lBlockIndex += TEST_DEFERRED_BURST)
+    {
+        timespec_get(&lStartTime, TIME_UTC);
+
+        for (lBurstIndex = lBlockIndex; lBurstIndex < lBlockIndex + TEST_DEFERRED_BURST && lBurstIndex < TEST_BLOCKS; lBurstIndex++)
+        {
+            SmartFree(&gBlocks[lBurstIndex], pSizes[lBurstIndex], &lMemoryUsed);
+        }
+
+        timespec_get(&lEndTime, TIME_UTC);
+
+        lBurst = (double) (lEndTime.tv_sec - lStartTime.tv_sec) + ((double) (lEndTime.tv_nsec - lStartTime.tv_nsec)) / 1e9;
+
+        lSeconds += lBurst;
+
+        if (*pWorstBurst < lBurst)
+        {
+            *pWorstBurst = lBurst;
+        }
+    }
+
+    /*
+    ** the accounting is settled before the blocks are
+    */
+
+    if (0 != lMemoryUsed)
+    {
+        printf("Memory accounting disagreement: %ld bytes remain\n", lMemoryUsed);
+    }
+
+    if (0 < pMethod)
+    {
+        SmartDeferredFreeStop();
+    }
+
+    return(lSeconds);
+}
+
+/*----------------------------------------------------------------------------
+  A C runtime library allocator reached through the allocator table
+  ----------------------------------------------------------------------------*/
+
+void * TestAllocate
+(
+    void * pContext,
+    size_t pSize
+)
+{
+    (void) pContext;
+
+    return(malloc(pSize));
+}
+
+void * TestAllocateZeroed
+(
+    void * pContext,
+    size_t pSize
+)
+{
+    (void) pContext;
+
+    return(calloc(1, pSize));
+}
+
+void * TestReallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pOldSize,
+    size_t pSize
+)
+{
+    (void) pContext;
+    (void) pOldSize;
+
+    return(realloc(pBuffer, pSize));
+}
+
+void TestDeallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pSize
+)
+{
+    (void) pContext;
+    (void) pSize;
+
+    free(pBuffer);
+}
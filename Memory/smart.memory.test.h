@@ -0,0 +1,190 @@
+/*----------------------------------------------------------------------------
+  Smart Memory test application
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Memory test program header file
+  ----------------------------------------------------------------------------*/
+
+#ifndef SMART_MEMORY_TEST_H
+#define SMART_MEMORY_TEST_H
+
+#define TEST_BLOCKS 100000
+
+#define TEST_SEED 1
+
+#define TEST_THREADS       16
+#define TEST_THREAD_BLOCKS 1000
+#define TEST_THREAD_ROUNDS 1000
+
+#define TEST_COUNTER_BLOCK   100
+#define TEST_COUNTER_MAXIMUM (1024 * 1024)
+
+#define TEST_BUDGET_TENANTS    3
+#define TEST_BUDGET_CONTAINERS 4
+#define TEST_BUDGET_CONTAINER  (64 * 1024)
+#define TEST_BUDGET_TENANT     (200 * 1024)
+#define TEST_BUDGET_PROCESS    (500 * 1024)
+
+#define TEST_ALIGNED_BLOCKS          1000
+#define TEST_ALIGNED_MAXIMUM_SIZE    2048
+#define TEST_ALIGNED_MAXIMUM_SHIFT   12                             /* 4K byte alignment */
+
+#define TEST_DEFERRED_BURST     1000                                /* frees timed together */
+#define TEST_DEFERRED_LARGE     (256 * 1024)                        /* mapped, so freeing unmaps */
+
+/*----------------------------------------------------------------------------
+  Private function prototypes
+  ----------------------------------------------------------------------------*/
+
+void DisplayOptions
+(
+    void
+);
+
+void AllocatorIndirectionPerformanceTest
+(
+    void
+);
+
+double AllocatorPass
+(
+    int pMethod,
+    size_t * pSizes
+);
+
+void ThreadCachePerformanceTest
+(
+    void
+);
+
+double ThreadCachePass
+(
+    int pMethod,
+    unsigned long pThreads
+);
+
+int ThreadCacheWorker
+(
+    void * pMethod
+);
+
+void CounterTest
+(
+    void
+);
+
+double CounterPass
+(
+    int pMethod,
+    unsigned long pThreads,
+    int (* pWorker)(void * pMethod)
+);
+
+int CounterWorker
+(
+    void * pMethod
+);
+
+int CounterReserveWorker
+(
+    void * pMethod
+);
+
+void BudgetTest
+(
+    void
+);
+
+void ProfileTest
+(
+    void
+);
+
+void ProfileTestFree
+(
+    unsigned long pBlockIndex,
+    size_t * pSizes,
+    size_t * pMemoryUsed
+);
+
+void AlignedTest
+(
+    void
+);
+
+Bool AlignedPass
+(
+    smartAllocatorHandle pAllocator,
+    size_t pAlignment,
+    size_t * pSizes
+);
+
+void DeferredFreeTest
+(
+    void
+);
+
+double DeferredFreePass
+(
+    int pMethod,
+    size_t * pSizes,
+    double * pWorstBurst
+);
+
+void * TestAllocate
+(
+    void * pContext,
+    size_t pSize
+);
+
+void * TestAllocateZeroed
+(
+    void * pContext,
+    size_t pSize
+);
+
+void * TestReallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pOldSize,
+    size_t pSize
+);
+
+void TestDeallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pSize
+);
+
+#endif
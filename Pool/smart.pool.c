@@ -1,2 +1,3385 @@
+/*----------------------------------------------------------------------------
+  Smart Pool
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Pool application programmer's interface (API) implementation file
+  ----------------------------------------------------------------------------*/
+
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+
+#include "compilation.t.h"
+#include "types.t.h"
+#include "smart.memory.t.h"
+#include "smart.memory.i.h"
+
+/*----------------------------------------------------------------------------
+  Private defines, data types and function prototypes
+  ----------------------------------------------------------------------------*/
+
 #include "smart.pool.h"
-#include "smart.pool.i.h"
\ No newline at end of file
+
+/*----------------------------------------------------------------------------
+  Public function prototypes
+  ----------------------------------------------------------------------------*/
+
+#include "smart.pool.i.h"
+
+/*----------------------------------------------------------------------------
+  Public functions
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructSmartPool
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pMemoryMaximum
+)
+{
+    return(SmartPoolConstructSmartPoolWithBudget(pPool, pObjectSize, pChunkSize, pMemoryMaximum, NULL));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructSmartPoolWithBudget
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pMemoryMaximum,
+    smartBudgetHandle pBudget
+)
+{
+    return(PoolConstruct(pPool, pObjectSize, pChunkSize, pMemoryMaximum, pBudget, FALSE));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructConcurrentSmartPool
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pMemoryMaximum
+)
+{
+    return(PoolConstruct(pPool, pObjectSize, pChunkSize, pMemoryMaximum, NULL, TRUE));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructConcurrentSmartPoolWithBudget
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pMemoryMaximum,
+    smartBudgetHandle pBudget
+)
+{
+    return(PoolConstruct(pPool, pObjectSize, pChunkSize, pMemoryMaximum, pBudget, TRUE));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructBitmapSmartPool
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pMemoryMaximum
+)
+{
+    return(SmartPoolConstructBitmapSmartPoolWithBudget(pPool, pObjectSize, pChunkSize, pMemoryMaximum, NULL));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructBitmapSmartPoolWithBudget
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pMemoryMaximum,
+    smartBudgetHandle pBudget
+)
+{
+    if (!PoolConstruct(pPool, pObjectSize, pChunkSize, pMemoryMaximum, pBudget, FALSE))
+    {
+        return(FALSE);
+    }
+
+    PoolBitmapLayout(*pPool);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructFileSmartPool
+(
+    smartPoolHandle * pPool,
+    const char * pPath,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pFileSize
+)
+{
+    return(SmartPoolConstructFileSmartPoolWithBudget(pPool, pPath, pObjectSize, pChunkSize, pFileSize, NULL));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructFileSmartPoolWithBudget
+(
+    smartPoolHandle * pPool,
+    const char * pPath,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pFileSize,
+    smartBudgetHandle pBudget
+)
+{
+    smartPoolFileHeader * lHeader;
+
+    unsigned long lChunks;
+
+    if (NULL == pPath)
+    {
+        return(FALSE);
+    }
+
+    if (!PoolConstruct(pPool, pObjectSize, pChunkSize, (size_t) 0, pBudget, FALSE))
+    {
+        return(FALSE);
+    }
+
+    PoolBitmapLayout(*pPool);
+
+    /*
+    ** the chunks are pages of the file and stay mapped with it
+    */
+
+    (* pPool)->persistent = TRUE;
+    (* pPool)->trimRetain = ULONG_MAX;
+
+    (* pPool)->fileSize = pFileSize & ~((* pPool)->chunkSize - 1);
+
+    lChunks = (unsigned long) ((* pPool)->fileSize / (* pPool)->chunkSize);
+
+    if (2 > lChunks)
+    {
+        SmartPoolDestructSmartPool(pPool);
+
+        return(FALSE);
+    }
+
+    /*
+    ** the ordered array is sized for every chunk the file holds, so taking
+    ** up a chunk never has to grow it
+    */
+
+    if (!SmartBudgetReserve((* pPool)->budget, (lChunks - 1) * sizeof(smartPoolChunk *)))
+    {
+        SmartPoolDestructSmartPool(pPool);
+
+        return(FALSE);
+    }
+
+    if (!SafeMalloc((void **) &(* pPool)->ordered, (lChunks - 1) * sizeof(smartPoolChunk *)))
+    {
+        SmartBudgetRelease((* pPool)->budget, (lChunks - 1) * sizeof(smartPoolChunk *));
+
+        SmartPoolDestructSmartPool(pPool);
+
+        return(FALSE);
+    }
+
+    (* pPool)->orderedCapacity = lChunks - 1;
+
+    if (!SafeFileMap((void **) &(* pPool)->header, pPath, (* pPool)->fileSize, (* pPool)->chunkSize))
+    {
+        SmartPoolDestructSmartPool(pPool);
+
+        return(FALSE);
+    }
+
+    lHeader = (* pPool)->header;
+
+    /*
+    ** a new file reads as zeros, an old one must have been written by a pool
+    ** of the same shape
+    */
+
+    if (0 == lHeader->magic)
+    {
+        lHeader->magic = POOL_FILE_MAGIC;
+        lHeader->version = POOL_FILE_VERSION;
+
+        lHeader->objectSize = (* pPool)->objectSize;
+        lHeader->chunkSize = (* pPool)->chunkSize;
+
+        lHeader->chunkCount = 0;
+
+        lHeader->root = SMART_POOL_NULL_OFFSET;
+    }
+    else if (POOL_FILE_MAGIC != lHeader->magic || POOL_FILE_VERSION != lHeader->version || (* pPool)->objectSize != lHeader->objectSize || (* pPool)->chunkSize != lHeader->chunkSize || lChunks - 1 < lHeader->chunkCount)
+    {
+        SmartPoolDestructSmartPool(pPool);
+
+        return(FALSE);
+    }
+
+    if (!PoolFileRecover(*pPool))
+    {
+        SmartPoolDestructSmartPool(pPool);
+
+        return(FALSE);
+    }
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructSlotSmartPool
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pMemoryMaximum
+)
+{
+    return(SmartPoolConstructSlotSmartPoolWithBudget(pPool, pObjectSize, pMemoryMaximum, NULL));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructSlotSmartPoolWithBudget
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pMemoryMaximum,
+    smartBudgetHandle pBudget
+)
+{
+    if (!PoolConstruct(pPool, pObjectSize, (size_t) 0, pMemoryMaximum, pBudget, FALSE))
+    {
+        return(FALSE);
+    }
+
+    (* pPool)->slotted = TRUE;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolAcquire
+(
+    smartPoolHandle pPool,
+    void ** pObject
+)
+{
+    smartPoolChunk * lChunk;
+
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(FALSE);
+    }
+
+    if (NULL == pObject || NULL != *pObject || pPool->slotted)
+    {
+        return(FALSE);
+    }
+
+    if (pPool->concurrent)
+    {
+        if (0 != pPool->magazineCapacity)
+        {
+            return(PoolMagazineAcquire(pPool, pObject));
+        }
+
+        return(PoolConcurrentAcquire(pPool, pObject));
+    }
+
+    lChunk = pPool->partial;
+
+    if (NULL == lChunk)
+    {
+        lChunk = PoolChunkConstruct(pPool);
+
+        if (NULL == lChunk)
+        {
+            return(FALSE);
+        }
+    }
+
+    /*
+    ** reuse a released object before carving a new one
+    */
+
+    if (pPool->bitmapped)
+    {
+        PoolBitmapAcquire(pPool, lChunk, pObject);
+    }
+    else if (NULL != lChunk->free)
+    {
+        *pObject = lChunk->free;
+
+        lChunk->free = PoolObjectLink(pPool, lChunk->free)->next;
+    }
+    else
+    {
+        /*
+        ** an object of an object cache is constructed when it is first
+        ** carved and keeps that state from then on
+        */
+
+        if (NULL != pPool->constructor && !pPool->constructor(pPool->callbackContext, lChunk->unused))
+        {
+            return(FALSE);
+        }
+
+        *pObject = lChunk->unused;
+
+        lChunk->unused += pPool->objectStride;
+    }
+
+    if (0 == lChunk->used++)
+    {
+        pPool->emptyCount--;
+    }
+
+    pPool->objectCount++;
+
+    if (pPool->objectsPerChunk == lChunk->used)
+    {
+        PoolListRemove(&pPool->partial, lChunk);
+        PoolListInsert(&pPool->full, lChunk);
+    }
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolRelease
+(
+    smartPoolHandle pPool,
+    void ** pObject
+)
+{
+    smartPoolChunk * lChunk;
+    smartPoolObject * lObject;
+
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(FALSE);
+    }
+
+    if (NULL == pObject || NULL == *pObject || pPool->slotted)
+    {
+        return(FALSE);
+    }
+
+    lChunk = PoolChunkOf(pPool, *pObject);
+
+    if (pPool != lChunk->pool)
+    {
+        return(FALSE);
+    }
+
+    if (pPool->concurrent)
+    {
+        if (0 != pPool->magazineCapacity)
+        {
+            PoolMagazineRelease(pPool, lChunk, *pObject);
+        }
+        else
+        {
+            PoolConcurrentRelease(pPool, lChunk, *pObject);
+        }
+
+        *pObject = NULL;
+
+        return(TRUE);
+    }
+
+    if (pPool->bitmapped && !PoolBitmapRelease(pPool, lChunk, *pObject))
+    {
+        return(FALSE);
+    }
+
+    if (pPool->objectsPerChunk == lChunk->used)
+    {
+        PoolListRemove(&pPool->full, lChunk);
+        PoolListInsert(&pPool->partial, lChunk);
+    }
+
+    if (!pPool->bitmapped)
+    {
+        lObject = (smartPoolObject *) *pObject;
+
+        PoolObjectLink(pPool, lObject)->next = lChunk->free;
+        lChunk->free = lObject;
+    }
+
+    lChunk->used--;
+
+    pPool->objectCount--;
+
+    *pObject = NULL;
+
+    if (0 == lChunk->used)
+    {
+        return(PoolChunkEmptied(pPool, lChunk));
+    }
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolSetObjectCallbacks
+(
+    smartPoolHandle pPool,
+    smartPoolConstructor pConstructor,
+    smartPoolDestructor pDestructor,
+    void * pContext
+)
+{
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(FALSE);
+    }
+
+    if (pPool->concurrent || pPool->slotted || pPool->bitmapped || 0 != pPool->chunkCount)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** the free list link of a cached object follows the object so that
+    ** releasing it leaves its constructed state alone
+    */
+
+    if ((NULL != pConstructor || NULL != pDestructor) && 0 == pPool->linkOffset)
+    {
+        pPool->linkOffset = pPool->objectSize;
+        pPool->objectStride = PoolAlign(pPool->objectSize + sizeof(smartPoolObject));
+
+        while (pPool->chunkSize < POOL_CHUNK_HEADER_SIZE + pPool->objectStride)
+        {
+            pPool->chunkSize <<= 1;
+        }
+
+        pPool->objectsPerChunk = (unsigned long) ((pPool->chunkSize - POOL_CHUNK_HEADER_SIZE) / pPool->objectStride);
+    }
+
+    pPool->constructor = pConstructor;
+    pPool->destructor = pDestructor;
+    pPool->callbackContext = pContext;
+
+    if (PoolIsCache(pPool))
+    {
+        pPool->trimRetain = ULONG_MAX;
+    }
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolReclaim
+(
+    smartPoolHandle pPool
+)
+{
+    smartPoolChunk * lChunk;
+    smartPoolChunk * lNext;
+
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(FALSE);
+    }
+
+    if (pPool->concurrent || pPool->slotted || pPool->persistent)
+    {
+        return(TRUE);
+    }
+
+    for (lChunk = pPool->partial; NULL != lChunk; lChunk = lNext)
+    {
+        lNext = lChunk->next;
+
+        if (0 == lChunk->used && !PoolChunkTrim(pPool, lChunk))
+        {
+            return(FALSE);
+        }
+    }
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolSetTrimPolicy
+(
+    smartPoolHandle pPool,
+    unsigned long pRetainChunks,
+    unsigned long pIdleMilliseconds
+)
+{
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(FALSE);
+    }
+
+    if (pPool->concurrent || pPool->slotted || pPool->persistent)
+    {
+        return(FALSE);
+    }
+
+    pPool->trimRetain = pRetainChunks;
+    pPool->trimIdle = pIdleMilliseconds;
+
+    /*
+    ** give back the empty chunks the new policy does not keep
+    */
+
+    return(PoolTrimExcess(pPool));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolTick
+(
+    smartPoolHandle pPool
+)
+{
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(FALSE);
+    }
+
+    if (pPool->concurrent || pPool->slotted || pPool->persistent || pPool->walking || 0 == pPool->trimIdle)
+    {
+        return(TRUE);
+    }
+
+    /*
+    ** the chunks kept in hand go back once they have been idle too long,
+    ** whether or not the pool has seen any traffic since
+    */
+
+    return(PoolTrimIdle(pPool, PoolMilliseconds()));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolReserve
+(
+    smartPoolHandle pPool,
+    unsigned long pObjects,
+    Bool pPrefault
+)
+{
+    smartPoolChunk * lChunk;
+
+    void * lObject;
+
+    unsigned long lAvailable;
+    unsigned long lConstructed;
+
+    char * lEnd;
+
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(FALSE);
+    }
+
+    if (pPool->slotted)
+    {
+        while (pPool->slotCapacity - pPool->denseCount < pObjects)
+        {
+            if (!PoolSlotGrow(pPool))
+            {
+                return(FALSE);
+            }
+        }
+
+        if (pPrefault && pPool->denseCount < pPool->slotCapacity)
+        {
+            memset(pPool->dense + pPool->denseCount * pPool->objectSize, 0, (pPool->slotCapacity - pPool->denseCount) * pPool->objectSize);
+            memset(pPool->denseSlots + pPool->denseCount, 0, (pPool->slotCapacity - pPool->denseCount) * sizeof(uint32_t));
+        }
+
+        return(TRUE);
+    }
+
+    if (pPool->concurrent)
+    {
+        /*
+        ** objects held in magazines count as in use, so the reservation
+        ** errs on the side of an extra chunk
+        */
+
+        for (;;)
+        {
+            lAvailable = atomic_load(&pPool->tableCount) * pPool->objectsPerChunk - atomic_load(&pPool->concurrentObjectCount);
+
+            if (lAvailable >= pObjects)
+            {
+                return(TRUE);
+            }
+
+            lObject = NULL;
+
+            if (!PoolConcurrentGrow(pPool, &lObject, pPrefault))
+            {
+                return(FALSE);
+            }
+
+            atomic_fetch_add_explicit(&pPool->concurrentObjectCount, 1, memory_order_relaxed);
+
+            PoolConcurrentRelease(pPool, PoolChunkOf(pPool, lObject), lObject);
+        }
+    }
+
+    lAvailable = 0;
+
+    for (lChunk = pPool->partial; NULL != lChunk; lChunk = lChunk->next)
+    {
+        lAvailable += pPool->objectsPerChunk - lChunk->used;
+    }
+
+    while (lAvailable < pObjects)
+    {
+        if (NULL == PoolChunkConstruct(pPool))
+        {
+            return(FALSE);
+        }
+
+        lAvailable += pPool->objectsPerChunk;
+    }
+
+    /*
+    ** the reserved chunks are kept whatever the trim policy
+    */
+
+    if (pPool->trimRetain < pPool->emptyCount)
+    {
+        pPool->trimRetain = pPool->emptyCount;
+    }
+
+    lConstructed = 0;
+
+    for (lChunk = pPool->partial; NULL != lChunk; lChunk = lChunk->next)
+    {
+        if (pPrefault)
+        {
+            SafePagePrefault(lChunk, pPool->chunkSize);
+        }
+
+        /*
+        ** an object cache constructs the reserved objects now rather than
+        ** on their first acquire, threading them onto the free list
+        */
+
+        if (NULL == pPool->constructor)
+        {
+            continue;
+        }
+
+        lEnd = (char *) lChunk + POOL_CHUNK_HEADER_SIZE + pPool->objectsPerChunk * pPool->objectStride;
+
+        lConstructed += (unsigned long) ((lChunk->unused - ((char *) lChunk + POOL_CHUNK_HEADER_SIZE)) / pPool->objectStride) - lChunk->used;
+
+        while (lConstructed < pObjects && lChunk->unused < lEnd)
+        {
+            if (!pPool->constructor(pPool->callbackContext, lChunk->unused))
+            {
+                return(FALSE);
+            }
+
+            PoolObjectLink(pPool, lChunk->unused)->next = lChunk->free;
+
+            lChunk->free = (smartPoolObject *) lChunk->unused;
+
+            lChunk->unused += pPool->objectStride;
+
+            lConstructed++;
+        }
+    }
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolSetHugePages
+(
+    smartPoolHandle pPool,
+    Bool pHugePages
+)
+{
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(FALSE);
+    }
+
+    if (pPool->slotted || pPool->persistent || (pHugePages && 0 != (pPool->chunkSize & (POOL_HUGE_PAGE_SIZE - 1))))
+    {
+        return(FALSE);
+    }
+
+    pPool->hugePages = pHugePages;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolForEachObject
+(
+    smartPoolHandle pPool,
+    smartPoolVisitor pVisitor,
+    void * pContext
+)
+{
+    smartPoolChunk * lChunk;
+
+    uint64_t * lBitmap;
+    uint64_t lBits;
+
+    char * lObjects;
+
+    unsigned long lIndex;
+    unsigned long lWord;
+
+    Bool lContinue = TRUE;
+
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(FALSE);
+    }
+
+    if (!pPool->bitmapped || NULL == pVisitor)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** a word is copied before its objects are visited, so the visitor may
+    ** release the object it is given, and the chunks it empties are only
+    ** trimmed once the walk is over
+    */
+
+    pPool->walking = TRUE;
+
+    for (lIndex = 0; lIndex < pPool->orderedCount && lContinue; lIndex++)
+    {
+        lChunk = pPool->ordered[lIndex];
+
+        if (0 == lChunk->used)
+        {
+            continue;
+        }
+
+        lBitmap = PoolChunkBitmap(lChunk);
+        lObjects = (char *) lChunk + pPool->objectOffset;
+
+        for (lWord = 0; lWord < pPool->bitmapWords && lContinue; lWord++)
+        {
+            for (lBits = lBitmap[lWord]; 0 != lBits && lContinue; lBits &= lBits - 1)
+            {
+                lContinue = pVisitor(pContext, lObjects + ((size_t) lWord * POOL_BITMAP_WORD_BITS + PoolCountTrailingZeros(lBits)) * pPool->objectStride);
+            }
+        }
+    }
+
+    pPool->walking = FALSE;
+
+    return(PoolTrimExcess(pPool));
+}
+
+STORAGE_CLASS smartPoolOffset CALLING_CONVENTION SmartPoolFileGetOffset
+(
+    smartPoolHandle pPool,
+    void * pObject
+)
+{
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(SMART_POOL_NULL_OFFSET);
+    }
+
+    if (!pPool->persistent || NULL == pObject || NULL == SmartPoolFileGetObject(pPool, (smartPoolOffset) ((char *) pObject - (char *) pPool->header)))
+    {
+        return(SMART_POOL_NULL_OFFSET);
+    }
+
+    return((smartPoolOffset) ((char *) pObject - (char *) pPool->header));
+}
+
+STORAGE_CLASS void * CALLING_CONVENTION SmartPoolFileGetObject
+(
+    smartPoolHandle pPool,
+    smartPoolOffset pOffset
+)
+{
+    smartPoolChunk * lChunk;
+
+    unsigned long lIndex;
+
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(NULL);
+    }
+
+    /*
+    ** the offset must fall in a chunk in use and on an object in use
+    */
+
+    if (!pPool->persistent || pPool->chunkSize > pOffset || (pPool->header->chunkCount + 1) * pPool->chunkSize <= pOffset)
+    {
+        return(NULL);
+    }
+
+    lChunk = PoolChunkOf(pPool, (char *) pPool->header + pOffset);
+
+    if (!PoolBitmapIndexOf(pPool, lChunk, (char *) pPool->header + pOffset, &lIndex))
+    {
+        return(NULL);
+    }
+
+    return((char *) pPool->header + pOffset);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolFileSetRoot
+(
+    smartPoolHandle pPool,
+    smartPoolOffset pOffset
+)
+{
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(FALSE);
+    }
+
+    if (!pPool->persistent || (SMART_POOL_NULL_OFFSET != pOffset && NULL == SmartPoolFileGetObject(pPool, pOffset)))
+    {
+        return(FALSE);
+    }
+
+    pPool->header->root = pOffset;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS smartPoolOffset CALLING_CONVENTION SmartPoolFileGetRoot
+(
+    smartPoolHandle pPool
+)
+{
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool || !pPool->persistent)
+    {
+        return(SMART_POOL_NULL_OFFSET);
+    }
+
+    return(pPool->header->root);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolFileSync
+(
+    smartPoolHandle pPool
+)
+{
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(FALSE);
+    }
+
+    if (!pPool->persistent)
+    {
+        return(FALSE);
+    }
+
+    return(SafeFileSync(pPool->header, (size_t) (pPool->header->chunkCount + 1) * pPool->chunkSize));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolSlotAcquire
+(
+    smartPoolHandle pPool,
+    smartPoolSlot * pSlot
+)
+{
+    uint32_t lIndex;
+
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(FALSE);
+    }
+
+    if (NULL == pSlot || SMART_POOL_NULL_SLOT != *pSlot || !pPool->slotted)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** reuse the slot released longest ago before handing out a new one
+    */
+
+    if (POOL_SLOT_NONE != pPool->freeSlot)
+    {
+        lIndex = pPool->freeSlot;
+
+        pPool->freeSlot = pPool->slots[lIndex].dense;
+
+        if (POOL_SLOT_NONE == pPool->freeSlot)
+        {
+            pPool->freeSlotTail = POOL_SLOT_NONE;
+        }
+    }
+    else
+    {
+        if (pPool->slotCapacity == pPool->slotCount && !PoolSlotGrow(pPool))
+        {
+            return(FALSE);
+        }
+
+        lIndex = (uint32_t) pPool->slotCount++;
+
+        pPool->slots[lIndex].generation = 1;
+    }
+
+    pPool->slots[lIndex].dense = (uint32_t) pPool->denseCount;
+    pPool->denseSlots[pPool->denseCount] = lIndex;
+
+    pPool->denseCount++;
+
+    *pSlot = PoolSlotMake(pPool->slots[lIndex].generation, lIndex);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolSlotRelease
+(
+    smartPoolHandle pPool,
+    smartPoolSlot * pSlot
+)
+{
+    smartPoolSlotEntry * lEntry;
+
+    uint32_t lIndex;
+    uint32_t lDense;
+    uint32_t lLast;
+
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(FALSE);
+    }
+
+    if (NULL == pSlot || NULL == SmartPoolSlotGetObject(pPool, *pSlot))
+    {
+        return(FALSE);
+    }
+
+    lIndex = PoolSlotIndex(*pSlot);
+
+    lEntry = &pPool->slots[lIndex];
+
+    lDense = lEntry->dense;
+    lLast = (uint32_t) (pPool->denseCount - 1);
+
+    /*
+    ** fill the hole with the last object to keep the dense array packed
+    */
+
+    if (lDense != lLast)
+    {
+        memcpy(pPool->dense + lDense * pPool->objectSize, pPool->dense + lLast * pPool->objectSize, pPool->objectSize);
+
+        pPool->denseSlots[lDense] = pPool->denseSlots[lLast];
+        pPool->slots[pPool->denseSlots[lDense]].dense = lDense;
+    }
+
+    pPool->denseCount--;
+
+    /*
+    ** moving the slot on a generation makes every handle to it stale
+    */
+
+    lEntry->generation = (POOL_SLOT_GENERATION_MASK == lEntry->generation) ? 1 : lEntry->generation + 1;
+
+    /*
+    ** the free list is first in first out, so that a slot is not reused
+    ** (and its generations not run through) while other slots are free
+    */
+
+    lEntry->dense = POOL_SLOT_NONE;
+
+    if (POOL_SLOT_NONE == pPool->freeSlotTail)
+    {
+        pPool->freeSlot = lIndex;
+    }
+    else
+    {
+        pPool->slots[pPool->freeSlotTail].dense = lIndex;
+    }
+
+    pPool->freeSlotTail = lIndex;
+
+    *pSlot = SMART_POOL_NULL_SLOT;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS void * CALLING_CONVENTION SmartPoolSlotGetObject
+(
+    smartPoolHandle pPool,
+    smartPoolSlot pSlot
+)
+{
+    uint32_t lIndex = PoolSlotIndex(pSlot);
+
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool || !pPool->slotted)
+    {
+        return(NULL);
+    }
+
+    if (pPool->slotCount <= lIndex || pPool->slots[lIndex].generation != PoolSlotGeneration(pSlot))
+    {
+        return(NULL);
+    }
+
+    return(pPool->dense + pPool->slots[lIndex].dense * pPool->objectSize);
+}
+
+STORAGE_CLASS void * CALLING_CONVENTION SmartPoolSlotGetObjectAt
+(
+    smartPoolHandle pPool,
+    unsigned long pIndex
+)
+{
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool || !pPool->slotted)
+    {
+        return(NULL);
+    }
+
+    if (pPool->denseCount <= pIndex)
+    {
+        return(NULL);
+    }
+
+    return(pPool->dense + pIndex * pPool->objectSize);
+}
+
+STORAGE_CLASS smartPoolSlot CALLING_CONVENTION SmartPoolSlotGetSlotAt
+(
+    smartPoolHandle pPool,
+    unsigned long pIndex
+)
+{
+    uint32_t lIndex;
+
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool || !pPool->slotted)
+    {
+        return(SMART_POOL_NULL_SLOT);
+    }
+
+    if (pPool->denseCount <= pIndex)
+    {
+        return(SMART_POOL_NULL_SLOT);
+    }
+
+    lIndex = pPool->denseSlots[pIndex];
+
+    return(PoolSlotMake(pPool->slots[lIndex].generation, lIndex));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolSetMagazines
+(
+    smartPoolHandle pPool,
+    unsigned long pMagazineCapacity,
+    unsigned long pDepotMaximum
+)
+{
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(FALSE);
+    }
+
+    if (!pPool->concurrent || 0 != pPool->magazineCapacity || 0 == pMagazineCapacity)
+    {
+        return(FALSE);
+    }
+
+    if (thrd_success != mtx_init(&pPool->depotLock, mtx_plain))
+    {
+        return(FALSE);
+    }
+
+    if (thrd_success != tss_create(&pPool->magazineKey, PoolMagazineThreadExit))
+    {
+        mtx_destroy(&pPool->depotLock);
+
+        return(FALSE);
+    }
+
+    pPool->depotMaximum = pDepotMaximum;
+    pPool->magazineCapacity = pMagazineCapacity;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolFlushMagazines
+(
+    smartPoolHandle pPool
+)
+{
+    smartPoolThreadMagazines * lThread;
+
+    smartPoolMagazine * lMagazine;
+
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(FALSE);
+    }
+
+    if (0 == pPool->magazineCapacity)
+    {
+        return(TRUE);
+    }
+
+    lThread = (smartPoolThreadMagazines *) tss_get(pPool->magazineKey);
+
+    if (NULL != lThread)
+    {
+        PoolMagazineEmpty(pPool, lThread->loaded);
+        PoolMagazineEmpty(pPool, lThread->spare);
+    }
+
+    mtx_lock(&pPool->depotLock);
+
+    while (NULL != pPool->depotFull)
+    {
+        lMagazine = pPool->depotFull;
+
+        pPool->depotFull = lMagazine->next;
+        pPool->depotFullCount--;
+
+        PoolMagazineEmpty(pPool, lMagazine);
+
+        lMagazine->next = pPool->depotEmpty;
+
+        pPool->depotEmpty = lMagazine;
+        pPool->depotEmptyCount++;
+    }
+
+    mtx_unlock(&pPool->depotLock);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolGetMagazineStatistics
+(
+    smartPoolHandle pPool,
+    smartPoolMagazineStatistics * pStatistics
+)
+{
+    smartPoolThreadMagazines * lThread;
+
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool || NULL == pStatistics)
+    {
+        return(FALSE);
+    }
+
+    if (0 == pPool->magazineCapacity)
+    {
+        return(FALSE);
+    }
+
+    mtx_lock(&pPool->depotLock);
+
+    *pStatistics = pPool->statistics;
+
+    for (lThread = pPool->threads; NULL != lThread; lThread = lThread->next)
+    {
+        pStatistics->acquires += atomic_load_explicit(&lThread->acquires, memory_order_relaxed);
+        pStatistics->acquireHits += atomic_load_explicit(&lThread->acquireHits, memory_order_relaxed);
+        pStatistics->releases += atomic_load_explicit(&lThread->releases, memory_order_relaxed);
+        pStatistics->releaseHits += atomic_load_explicit(&lThread->releaseHits, memory_order_relaxed);
+    }
+
+    pStatistics->depotFull = pPool->depotFullCount;
+    pStatistics->depotEmpty = pPool->depotEmptyCount;
+
+    pStatistics->threads = pPool->threadCount;
+
+    mtx_unlock(&pPool->depotLock);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS smartAllocatorHandle CALLING_CONVENTION SmartPoolGetAllocator
+(
+    smartPoolHandle pPool
+)
+{
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool || pPool->slotted || pPool->persistent)
+    {
+        return(NULL);
+    }
+
+    return(&pPool->allocator);
+}
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartPoolGetObjectSize
+(
+    smartPoolHandle pPool
+)
+{
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(0);
+    }
+
+    return(pPool->objectSize);
+}
+
+STORAGE_CLASS unsigned long CALLING_CONVENTION SmartPoolGetObjectCount
+(
+    smartPoolHandle pPool
+)
+{
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(0);
+    }
+
+    if (pPool->concurrent)
+    {
+        return(atomic_load_explicit(&pPool->concurrentObjectCount, memory_order_relaxed));
+    }
+
+    if (pPool->slotted)
+    {
+        return(pPool->denseCount);
+    }
+
+    return(pPool->objectCount);
+}
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartPoolGetMemoryAllocated
+(
+    smartPoolHandle pPool
+)
+{
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(0);
+    }
+
+    return(SmartBudgetGetValue(pPool->budget));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolDestructSmartPool
+(
+    smartPoolHandle * pPool
+)
+{
+    smartPoolChunk * lChunk;
+
+    smartPoolThreadMagazines * lThread;
+
+    smartPoolMagazine * lMagazine;
+
+    unsigned long lIndex;
+
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool || NULL == *pPool)
+    {
+        return(TRUE);
+    }
+
+    /*
+    ** return the chunks to the operating system
+    */
+
+    if (0 != (* pPool)->magazineCapacity)
+    {
+        /*
+        ** the objects in the magazines go with the chunks, the charges of
+        ** the magazines go with the budget
+        */
+
+        tss_delete((* pPool)->magazineKey);
+
+        while (NULL != (* pPool)->threads)
+        {
+            lThread = (* pPool)->threads;
+
+            (* pPool)->threads = lThread->next;
+
+            SafeFree((void **) &lThread->loaded);
+            SafeFree((void **) &lThread->spare);
+
+            SafeFree((void **) &lThread);
+        }
+
+        while (NULL != (* pPool)->depotFull)
+        {
+            lMagazine = (* pPool)->depotFull;
+
+            (* pPool)->depotFull = lMagazine->next;
+
+            SafeFree((void **) &lMagazine);
+        }
+
+        while (NULL != (* pPool)->depotEmpty)
+        {
+            lMagazine = (* pPool)->depotEmpty;
+
+            (* pPool)->depotEmpty = lMagazine->next;
+
+            SafeFree((void **) &lMagazine);
+        }
+
+        mtx_destroy(&(* pPool)->depotLock);
+    }
+
+    if ((* pPool)->concurrent)
+    {
+        for (lIndex = 0; lIndex < (* pPool)->tableSize && lIndex < atomic_load(&(* pPool)->tableCount); lIndex++)
+        {
+            lChunk = atomic_load_explicit(&(* pPool)->table[lIndex], memory_order_relaxed);
+
+            if (NULL == lChunk)
+            {
+                continue;
+            }
+
+            if (!SafePageFree((void **) &lChunk, (* pPool)->chunkSize))
+            {
+                return(FALSE);
+            }
+
+            atomic_store_explicit(&(* pPool)->table[lIndex], NULL, memory_order_relaxed);
+
+            SmartBudgetRelease((* pPool)->budget, (* pPool)->chunkSize);
+        }
+
+        SafeFree((void **) &(* pPool)->table);
+    }
+
+    if ((* pPool)->slotted && 0 != (* pPool)->slotCapacity)
+    {
+        SafeFree((void **) &(* pPool)->slots);
+        SafeFree((void **) &(* pPool)->dense);
+        SafeFree((void **) &(* pPool)->denseSlots);
+    }
+
+    /*
+    ** the chunks of a file pool go with the file, which keeps their objects
+    */
+
+    if ((* pPool)->persistent)
+    {
+        (* pPool)->partial = NULL;
+        (* pPool)->full = NULL;
+
+        if (NULL != (* pPool)->header && !SafeFileUnmap((void **) &(* pPool)->header, (* pPool)->fileSize))
+        {
+            return(FALSE);
+        }
+    }
+
+    while (NULL != (* pPool)->decommitted)
+    {
+        lChunk = (* pPool)->decommitted;
+
+        PoolListRemove(&(* pPool)->decommitted, lChunk);
+
+        if (!SafePageFree((void **) &lChunk, (* pPool)->chunkSize))
+        {
+            return(FALSE);
+        }
+
+        (* pPool)->chunkCount--;
+        (* pPool)->decommittedCount--;
+
+        SmartBudgetRelease((* pPool)->budget, SafePageSize());
+    }
+
+    while (NULL != (* pPool)->partial)
+    {
+        if (!PoolChunkDestruct(*pPool, (* pPool)->partial, &(* pPool)->partial))
+        {
+            return(FALSE);
+        }
+    }
+
+    while (NULL != (* pPool)->full)
+    {
+        if (!PoolChunkDestruct(*pPool, (* pPool)->full, &(* pPool)->full))
+        {
+            return(FALSE);
+        }
+    }
+
+    if (0 != (* pPool)->orderedCapacity)
+    {
+        SafeFree((void **) &(* pPool)->ordered);
+    }
+
+    SmartBudgetDestructSmartBudget(&(* pPool)->budget);
+
+    SafeFree(pPool);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolIsValid
+(
+    smartPoolHandle pPool
+)
+{
+    smartPoolChunk * lChunk;
+
+    unsigned long lChunkCount = 0;
+    unsigned long lObjectCount = 0;
+    unsigned long lEmptyCount = 0;
+    unsigned long lDecommittedCount = 0;
+
+    unsigned long lIndex;
+
+    /*
+    ** there is no pool
+    */
+
+    if (NULL == pPool)
+    {
+        return(TRUE);
+    }
+
+    if (pPool->concurrent)
+    {
+        return(PoolConcurrentIsValid(pPool));
+    }
+
+    if (pPool->slotted)
+    {
+        return(PoolSlotIsValid(pPool));
+    }
+
+    for (lChunk = pPool->partial; NULL != lChunk; lChunk = lChunk->next)
+    {
+        if (!PoolChunkIsValid(pPool, lChunk) || pPool->objectsPerChunk == lChunk->used)
+        {
+            return(FALSE); // set breakpoint here for debugging
+        }
+
+        if (0 == lChunk->used)
+        {
+            lEmptyCount++;
+        }
+
+        lChunkCount++;
+        lObjectCount += lChunk->used;
+    }
+
+    for (lChunk = pPool->full; NULL != lChunk; lChunk = lChunk->next)
+    {
+        if (!PoolChunkIsValid(pPool, lChunk) || pPool->objectsPerChunk != lChunk->used)
+        {
+            return(FALSE); // set breakpoint here for debugging
+        }
+
+        lChunkCount++;
+        lObjectCount += lChunk->used;
+    }
+
+    for (lChunk = pPool->decommitted; NULL != lChunk; lChunk = lChunk->next)
+    {
+        if (0 != ((size_t) lChunk & (pPool->chunkSize - 1)) || pPool != lChunk->pool || 0 != lChunk->used)
+        {
+            return(FALSE); // set breakpoint here for debugging
+        }
+
+        lDecommittedCount++;
+    }
+
+    if (pPool->chunkCount != lChunkCount + lDecommittedCount || pPool->objectCount != lObjectCount)
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    if (pPool->emptyCount != lEmptyCount || pPool->decommittedCount != lDecommittedCount)
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    /*
+    ** a bitmap pool orders every chunk it has mapped by address
+    */
+
+    if (pPool->bitmapped)
+    {
+        if (pPool->orderedCount != pPool->chunkCount || pPool->orderedCount > pPool->orderedCapacity)
+        {
+            return(FALSE); // set breakpoint here for debugging
+        }
+
+        if (pPool->persistent && pPool->header->chunkCount != pPool->chunkCount)
+        {
+            return(FALSE); // set breakpoint here for debugging
+        }
+
+        for (lIndex = 1; lIndex < pPool->orderedCount; lIndex++)
+        {
+            if (pPool->ordered[lIndex - 1] >= pPool->ordered[lIndex])
+            {
+                return(FALSE); // set breakpoint here for debugging
+            }
+        }
+    }
+
+    if (sizeof(smartPool) + lChunkCount * pPool->chunkSize + lDecommittedCount * SafePageSize() + pPool->orderedCapacity * sizeof(smartPoolChunk *) != SmartBudgetGetValue(pPool->budget))
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    return(TRUE);
+}
+
+/*----------------------------------------------------------------------------
+  Private functions
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolConstruct
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pMemoryMaximum,
+    smartBudgetHandle pBudget,
+    Bool pConcurrent
+)
+{
+    size_t lChunkSize = SafePageSize();
+
+    unsigned long lTableSize;
+
+    /*
+    ** there is no pool handle
+    */
+
+    if (NULL == pPool)
+    {
+        return(FALSE);
+    }
+
+    if (0 == pObjectSize)
+    {
+        return(FALSE);
+    }
+
+    if (0 == pChunkSize)
+    {
+        pChunkSize = POOL_DEFAULT_CHUNK_SIZE;
+    }
+
+    pObjectSize = PoolAlign(pObjectSize);
+
+    /*
+    ** a chunk is a power of two so that it can be aligned to its size
+    */
+
+    while (lChunkSize < pChunkSize || lChunkSize < POOL_CHUNK_HEADER_SIZE + pObjectSize)
+    {
+        lChunkSize <<= 1;
+    }
+
+    if (!SafeMalloc(pPool, sizeof(smartPool)))
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** initialize the allocator interface
+    */
+
+    (* pPool)->allocator.allocate = PoolAllocate;
+    (* pPool)->allocator.allocateZeroed = PoolAllocateZeroed;
+    (* pPool)->allocator.allocateAligned = NULL;
+    (* pPool)->allocator.reallocate = PoolReallocate;
+    (* pPool)->allocator.deallocate = PoolDeallocate;
+    (* pPool)->allocator.context = *pPool;
+
+    (* pPool)->partial = NULL;
+    (* pPool)->full = NULL;
+
+    (* pPool)->objectSize = pObjectSize;
+    (* pPool)->objectStride = pObjectSize;
+    (* pPool)->linkOffset = 0;
+    (* pPool)->chunkSize = lChunkSize;
+
+    (* pPool)->objectsPerChunk = (unsigned long) ((lChunkSize - POOL_CHUNK_HEADER_SIZE) / pObjectSize);
+
+    (* pPool)->chunkCount = 0;
+    (* pPool)->objectCount = 0;
+
+    (* pPool)->budget = NULL;
+
+    (* pPool)->constructor = NULL;
+    (* pPool)->destructor = NULL;
+    (* pPool)->callbackContext = NULL;
+
+    (* pPool)->decommitted = NULL;
+
+    (* pPool)->emptyCount = 0;
+    (* pPool)->decommittedCount = 0;
+
+    (* pPool)->trimRetain = 1;
+    (* pPool)->trimIdle = 0;
+
+    (* pPool)->hugePages = FALSE;
+
+    (* pPool)->bitmapped = FALSE;
+    (* pPool)->walking = FALSE;
+
+    (* pPool)->objectOffset = POOL_CHUNK_HEADER_SIZE;
+    (* pPool)->bitmapWords = 0;
+
+    (* pPool)->ordered = NULL;
+    (* pPool)->orderedCount = 0;
+    (* pPool)->orderedCapacity = 0;
+
+    (* pPool)->persistent = FALSE;
+
+    (* pPool)->header = NULL;
+    (* pPool)->fileSize = 0;
+
+    if (!SmartBudgetConstructSmartBudget(&(* pPool)->budget, pMemoryMaximum, pBudget) || !SmartBudgetReserve((* pPool)->budget, sizeof(smartPool)))
+    {
+        SmartBudgetDestructSmartBudget(&(* pPool)->budget);
+
+        SafeFree(pPool);
+
+        return(FALSE);
+    }
+
+    (* pPool)->concurrent = pConcurrent;
+
+    (* pPool)->table = NULL;
+    (* pPool)->tableSize = 0;
+
+    (* pPool)->referenceShift = 0;
+
+    atomic_init(&(* pPool)->head, (uint64_t) 0);
+    atomic_init(&(* pPool)->concurrentObjectCount, 0UL);
+    atomic_init(&(* pPool)->tableCount, 0UL);
+
+    (* pPool)->magazineCapacity = 0;
+    (* pPool)->depotMaximum = 0;
+
+    (* pPool)->depotFull = NULL;
+    (* pPool)->depotEmpty = NULL;
+
+    (* pPool)->depotFullCount = 0;
+    (* pPool)->depotEmptyCount = 0;
+
+    (* pPool)->threads = NULL;
+
+    (* pPool)->magazineCount = 0;
+    (* pPool)->threadCount = 0;
+
+    memset(&(* pPool)->statistics, 0, sizeof(smartPoolMagazineStatistics));
+
+    (* pPool)->slotted = FALSE;
+
+    (* pPool)->slots = NULL;
+    (* pPool)->freeSlot = POOL_SLOT_NONE;
+    (* pPool)->freeSlotTail = POOL_SLOT_NONE;
+
+    (* pPool)->dense = NULL;
+    (* pPool)->denseSlots = NULL;
+
+    (* pPool)->slotCount = 0;
+    (* pPool)->slotCapacity = 0;
+    (* pPool)->denseCount = 0;
+
+    if (!pConcurrent)
+    {
+        return(TRUE);
+    }
+
+    /*
+    ** size the chunk table for the maximum and the references
+    */
+
+    while (((unsigned long) 1 << (* pPool)->referenceShift) < (* pPool)->objectsPerChunk)
+    {
+        (* pPool)->referenceShift++;
+    }
+
+    lTableSize = (0 == pMemoryMaximum) ? POOL_CONCURRENT_MAXIMUM_CHUNKS : (unsigned long) (pMemoryMaximum / lChunkSize);
+
+    if ((unsigned long) (UINT32_MAX >> (* pPool)->referenceShift) - 1 < lTableSize)
+    {
+        lTableSize = (unsigned long) (UINT32_MAX >> (* pPool)->referenceShift) - 1;
+    }
+
+    if (0 == lTableSize || !SmartBudgetReserve((* pPool)->budget, lTableSize * sizeof(smartPoolChunk *)) || !SafeCalloc((void **) &(* pPool)->table, lTableSize * sizeof(smartPoolChunk *)))
+    {
+        SmartBudgetDestructSmartBudget(&(* pPool)->budget);
+
+        SafeFree(pPool);
+
+        return(FALSE);
+    }
+
+    (* pPool)->tableSize = lTableSize;
+
+    return(TRUE);
+}
+
+static smartPoolChunk * PoolChunkConstruct
+(
+    smartPoolHandle pPool
+)
+{
+    smartPoolChunk * lChunk = NULL;
+
+    size_t lPageSize = SafePageSize();
+
+    /*
+    ** a decommitted chunk only needs its pages back
+    */
+
+    if (NULL != pPool->decommitted)
+    {
+        lChunk = pPool->decommitted;
+
+        if (!SmartBudgetReserve(pPool->budget, pPool->chunkSize - lPageSize))
+        {
+            return(NULL);
+        }
+
+        if (!SafePageRecommit((char *) lChunk + lPageSize, pPool->chunkSize - lPageSize))
+        {
+            SmartBudgetRelease(pPool->budget, pPool->chunkSize - lPageSize);
+
+            return(NULL);
+        }
+
+        PoolListRemove(&pPool->decommitted, lChunk);
+
+        pPool->decommittedCount--;
+    }
+    else
+    {
+        if (!SmartBudgetReserve(pPool->budget, pPool->chunkSize))
+        {
+            return(NULL);
+        }
+
+        if (!PoolChunkMap(pPool, &lChunk))
+        {
+            SmartBudgetRelease(pPool->budget, pPool->chunkSize);
+
+            return(NULL);
+        }
+
+        if (pPool->bitmapped && !PoolOrderedInsert(pPool, lChunk))
+        {
+            SafePageFree((void **) &lChunk, pPool->chunkSize);
+
+            SmartBudgetRelease(pPool->budget, pPool->chunkSize);
+
+            return(NULL);
+        }
+
+        pPool->chunkCount++;
+    }
+
+    lChunk->pool = pPool;
+
+    lChunk->free = NULL;
+    lChunk->unused = (char *) lChunk + POOL_CHUNK_HEADER_SIZE;
+
+    lChunk->used = 0;
+
+    lChunk->index = 0;
+
+    lChunk->emptied = 0;
+
+    if (pPool->bitmapped)
+    {
+        memset(PoolChunkBitmap(lChunk), 0, pPool->bitmapWords * sizeof(uint64_t));
+    }
+
+    PoolListInsert(&pPool->partial, lChunk);
+
+    pPool->emptyCount++;
+
+    return(lChunk);
+}
+
+static Bool PoolChunkMap
+(
+    smartPoolHandle pPool,
+    smartPoolChunk ** pChunk
+)
+{
+    /*
+    ** a file pool takes the next chunk of its file while the file has one
+    */
+
+    if (pPool->persistent)
+    {
+        if (pPool->fileSize < (pPool->header->chunkCount + 2) * pPool->chunkSize)
+        {
+            return(FALSE);
+        }
+
+        *pChunk = PoolFileChunk(pPool, pPool->header->chunkCount);
+
+        pPool->header->chunkCount++;
+
+        return(TRUE);
+    }
+
+    if (!SafePageAlloc((void **) pChunk, pPool->chunkSize, pPool->chunkSize))
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** the advice has to come before the first page of the chunk is touched
+    */
+
+    if (pPool->hugePages)
+    {
+        SafePageAdviseHuge(*pChunk, pPool->chunkSize);
+    }
+
+    return(TRUE);
+}
+
+static Bool PoolChunkDestruct
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk,
+    smartPoolChunk ** pList
+)
+{
+    PoolListRemove(pList, pChunk);
+
+    PoolChunkDestructObjects(pPool, pChunk);
+
+    if (0 == pChunk->used)
+    {
+        pPool->emptyCount--;
+    }
+
+    pPool->objectCount -= pChunk->used;
+
+    if (!SafePageFree((void **) &pChunk, pPool->chunkSize))
+    {
+        return(FALSE);
+    }
+
+    pPool->chunkCount--;
+
+    return(SmartBudgetRelease(pPool->budget, pPool->chunkSize));
+}
+
+static void PoolChunkDestructObjects
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk
+)
+{
+    char * lObject;
+
+    /*
+    ** every object that was ever carved from the chunk was constructed
+    */
+
+    if (NULL != pPool->destructor)
+    {
+        for (lObject = (char *) pChunk + POOL_CHUNK_HEADER_SIZE; lObject < pChunk->unused; lObject += pPool->objectStride)
+        {
+            pPool->destructor(pPool->callbackContext, lObject);
+        }
+    }
+}
+
+static Bool PoolChunkTrim
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk
+)
+{
+    size_t lPageSize = SafePageSize();
+
+    if (POOL_DECOMMIT_CHUNK_SIZE > pPool->chunkSize)
+    {
+        if (pPool->bitmapped)
+        {
+            PoolOrderedRemove(pPool, pChunk);
+        }
+
+        return(PoolChunkDestruct(pPool, pChunk, &pPool->partial));
+    }
+
+    /*
+    ** keep the mapping (and its alignment) of a large chunk, and the page
+    ** holding its header, but give back the rest of its memory
+    */
+
+    PoolChunkDestructObjects(pPool, pChunk);
+
+    if (!SafePageDecommit((char *) pChunk + lPageSize, pPool->chunkSize - lPageSize))
+    {
+        return(FALSE);
+    }
+
+    PoolListRemove(&pPool->partial, pChunk);
+    PoolListInsert(&pPool->decommitted, pChunk);
+
+    pChunk->free = NULL;
+    pChunk->unused = (char *) pChunk + POOL_CHUNK_HEADER_SIZE;
+
+    pPool->emptyCount--;
+    pPool->decommittedCount++;
+
+    return(SmartBudgetRelease(pPool->budget, pPool->chunkSize - lPageSize));
+}
+
+static Bool PoolChunkEmptied
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk
+)
+{
+    unsigned long long lNow;
+
+    pPool->emptyCount++;
+
+    if (pPool->walking)
+    {
+        pChunk->emptied = PoolMilliseconds();
+
+        return(TRUE);
+    }
+
+    /*
+    ** past the chunks kept in hand the chunk goes straight back
+    */
+
+    if (pPool->trimRetain < pPool->emptyCount)
+    {
+        return(PoolChunkTrim(pPool, pChunk));
+    }
+
+    if (0 == pPool->trimIdle)
+    {
+        return(TRUE);
+    }
+
+    /*
+    ** the chunks kept in hand go back once they have been idle too long
+    */
+
+    lNow = PoolMilliseconds();
+
+    pChunk->emptied = lNow;
+
+    return(PoolTrimIdle(pPool, lNow));
+}
+
+static Bool PoolTrimIdle
+(
+    smartPoolHandle pPool,
+    unsigned long long pNow
+)
+{
+    smartPoolChunk * lChunk;
+    smartPoolChunk * lNext;
+
+    for (lChunk = pPool->partial; NULL != lChunk; lChunk = lNext)
+    {
+        lNext = lChunk->next;
+
+        if (0 == lChunk->used && pPool->trimIdle <= pNow - lChunk->emptied && !PoolChunkTrim(pPool, lChunk))
+        {
+            return(FALSE);
+        }
+    }
+
+    return(TRUE);
+}
+
+static Bool PoolTrimExcess
+(
+    smartPoolHandle pPool
+)
+{
+    smartPoolChunk * lChunk;
+    smartPoolChunk * lNext;
+
+    for (lChunk = pPool->partial; NULL != lChunk && pPool->trimRetain < pPool->emptyCount; lChunk = lNext)
+    {
+        lNext = lChunk->next;
+
+        if (0 == lChunk->used && !PoolChunkTrim(pPool, lChunk))
+        {
+            return(FALSE);
+        }
+    }
+
+    return(TRUE);
+}
+
+static unsigned long long PoolMilliseconds
+(
+    void
+)
+{
+    struct timespec lTime;
+
+    timespec_get(&lTime, TIME_UTC);
+
+    return((unsigned long long) lTime.tv_sec * 1000 + (unsigned long long) lTime.tv_nsec / 1000000);
+}
+
+static void PoolListInsert
+(
+    smartPoolChunk ** pList,
+    smartPoolChunk * pChunk
+)
+{
+    pChunk->previous = NULL;
+    pChunk->next = *pList;
+
+    if (NULL != *pList)
+    {
+        (* pList)->previous = pChunk;
+    }
+
+    *pList = pChunk;
+}
+
+static void PoolListRemove
+(
+    smartPoolChunk ** pList,
+    smartPoolChunk * pChunk
+)
+{
+    if (NULL == pChunk->previous)
+    {
+        *pList = pChunk->next;
+    }
+    else
+    {
+        pChunk->previous->next = pChunk->next;
+    }
+
+    if (NULL != pChunk->next)
+    {
+        pChunk->next->previous = pChunk->previous;
+    }
+}
+
+static Bool PoolChunkIsValid
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk
+)
+{
+    smartPoolObject * lObject;
+
+    char * lFirst = (char *) pChunk + POOL_CHUNK_HEADER_SIZE;
+    char * lLimit = lFirst + pPool->objectsPerChunk * pPool->objectStride;
+
+    unsigned long lFreeCount = 0;
+
+    if (0 != ((size_t) pChunk & (pPool->chunkSize - 1)) || pPool != pChunk->pool)
+    {
+        return(FALSE);
+    }
+
+    if (pPool->bitmapped)
+    {
+        return(PoolBitmapIsValid(pPool, pChunk));
+    }
+
+    if (pChunk->unused < lFirst || pChunk->unused > lLimit || 0 != (size_t) (pChunk->unused - lFirst) % pPool->objectStride)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** released objects lie below the unused portion on object boundaries
+    ** (the count bounds the walk should the list have become a cycle)
+    */
+
+    for (lObject = pChunk->free; NULL != lObject; lObject = PoolObjectLink(pPool, lObject)->next)
+    {
+        if ((char *) lObject < lFirst || (char *) lObject >= pChunk->unused || 0 != (size_t) ((char *) lObject - lFirst) % pPool->objectStride)
+        {
+            return(FALSE);
+        }
+
+        if (pPool->objectsPerChunk < ++lFreeCount)
+        {
+            return(FALSE);
+        }
+    }
+
+    return(pPool->objectsPerChunk == lFreeCount + pChunk->used + (unsigned long) ((size_t) (lLimit - pChunk->unused) / pPool->objectStride));
+}
+
+static void PoolBitmapLayout
+(
+    smartPoolHandle pPool
+)
+{
+    unsigned long lObjects;
+
+    for (;;)
+    {
+        lObjects = (unsigned long) ((pPool->chunkSize - POOL_CHUNK_HEADER_SIZE) * 8 / (pPool->objectStride * 8 + 1));
+
+        while (0 < lObjects && pPool->chunkSize < POOL_CHUNK_HEADER_SIZE + PoolAlign(PoolBitmapWords(lObjects) * sizeof(uint64_t)) + lObjects * pPool->objectStride)
+        {
+            lObjects--;
+        }
+
+        if (0 < lObjects)
+        {
+            break;
+        }
+
+        pPool->chunkSize <<= 1;
+    }
+
+    pPool->bitmapped = TRUE;
+
+    pPool->objectsPerChunk = lObjects;
+    pPool->bitmapWords = PoolBitmapWords(lObjects);
+    pPool->objectOffset = POOL_CHUNK_HEADER_SIZE + PoolAlign(pPool->bitmapWords * sizeof(uint64_t));
+}
+
+static void PoolBitmapAcquire
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk,
+    void ** pObject
+)
+{
+    uint64_t * lBitmap = PoolChunkBitmap(pChunk);
+
+    unsigned long lWord = pChunk->index;
+
+    unsigned int lBit;
+
+    while (UINT64_MAX == lBitmap[lWord])
+    {
+        lWord++;
+    }
+
+    lBit = PoolCountTrailingZeros(~lBitmap[lWord]);
+
+    lBitmap[lWord] |= (uint64_t) 1 << lBit;
+
+    pChunk->index = lWord;
+
+    *pObject = (char *) pChunk + pPool->objectOffset + ((size_t) lWord * POOL_BITMAP_WORD_BITS + lBit) * pPool->objectStride;
+}
+
+static Bool PoolBitmapRelease
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk,
+    void * pObject
+)
+{
+    unsigned long lObjectIndex;
+    unsigned long lWord;
+
+    /*
+    ** an object released twice is refused rather than handed out twice
+    */
+
+    if (!PoolBitmapIndexOf(pPool, pChunk, pObject, &lObjectIndex))
+    {
+        return(FALSE);
+    }
+
+    lWord = lObjectIndex / POOL_BITMAP_WORD_BITS;
+
+    PoolChunkBitmap(pChunk)[lWord] &= ~((uint64_t) 1 << (lObjectIndex % POOL_BITMAP_WORD_BITS));
+
+    if (pChunk->index > lWord)
+    {
+        pChunk->index = lWord;
+    }
+
+    return(TRUE);
+}
+
+static Bool PoolBitmapIndexOf
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk,
+    void * pObject,
+    unsigned long * pIndex
+)
+{
+    size_t lOffset;
+
+    if ((char *) pObject < (char *) pChunk + pPool->objectOffset)
+    {
+        return(FALSE);
+    }
+
+    lOffset = (size_t) ((char *) pObject - ((char *) pChunk + pPool->objectOffset));
+
+    if (0 != lOffset % pPool->objectStride || pPool->objectsPerChunk <= lOffset / pPool->objectStride)
+    {
+        return(FALSE);
+    }
+
+    *pIndex = (unsigned long) (lOffset / pPool->objectStride);
+
+    return(0 != (PoolChunkBitmap(pChunk)[*pIndex / POOL_BITMAP_WORD_BITS] & ((uint64_t) 1 << (*pIndex % POOL_BITMAP_WORD_BITS))));
+}
+
+static Bool PoolBitmapIsValid
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk
+)
+{
+    uint64_t * lBitmap = PoolChunkBitmap(pChunk);
+
+    unsigned long lWord;
+    unsigned long lUsed = 0;
+    unsigned long lTail = pPool->objectsPerChunk % POOL_BITMAP_WORD_BITS;
+
+    if (pChunk->index >= pPool->bitmapWords)
+    {
+        return(FALSE);
+    }
+
+    for (lWord = 0; lWord < pPool->bitmapWords; lWord++)
+    {
+        if (lWord < pChunk->index && UINT64_MAX != lBitmap[lWord])
+        {
+            return(FALSE);
+        }
+
+        lUsed += PoolPopulationCount(lBitmap[lWord]);
+    }
+
+    /*
+    ** no bit is set past the last object
+    */
+
+    if (0 != lTail && 0 != (lBitmap[pPool->bitmapWords - 1] >> lTail))
+    {
+        return(FALSE);
+    }
+
+    return(lUsed == pChunk->used);
+}
+
+static Bool PoolFileRecover
+(
+    smartPoolHandle pPool
+)
+{
+    smartPoolChunk * lChunk;
+
+    uint64_t * lBitmap;
+
+    unsigned long lIndex;
+    unsigned long lWord;
+    unsigned long lTail = pPool->objectsPerChunk % POOL_BITMAP_WORD_BITS;
+
+    if (!SmartBudgetReserve(pPool->budget, (size_t) pPool->header->chunkCount * pPool->chunkSize))
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** the chunks follow one another in the file, so they are taken up in
+    ** address order
+    */
+
+    for (lIndex = 0; lIndex < pPool->header->chunkCount; lIndex++)
+    {
+        lChunk = PoolFileChunk(pPool, lIndex);
+        lBitmap = PoolChunkBitmap(lChunk);
+
+        if (0 != lTail && 0 != (lBitmap[pPool->bitmapWords - 1] >> lTail))
+        {
+            return(FALSE);
+        }
+
+        lChunk->pool = pPool;
+
+        lChunk->free = NULL;
+        lChunk->unused = (char *) lChunk + POOL_CHUNK_HEADER_SIZE;
+
+        lChunk->used = 0;
+
+        lChunk->index = pPool->bitmapWords - 1;
+
+        lChunk->emptied = 0;
+
+        for (lWord = pPool->bitmapWords; 0 < lWord; lWord--)
+        {
+            lChunk->used += PoolPopulationCount(lBitmap[lWord - 1]);
+
+            if (UINT64_MAX != lBitmap[lWord - 1])
+            {
+                lChunk->index = lWord - 1;
+            }
+        }
+
+        if (pPool->objectsPerChunk == lChunk->used)
+        {
+            PoolListInsert(&pPool->full, lChunk);
+        }
+        else
+        {
+            PoolListInsert(&pPool->partial, lChunk);
+        }
+
+        if (0 == lChunk->used)
+        {
+            pPool->emptyCount++;
+        }
+
+        pPool->objectCount += lChunk->used;
+
+        pPool->ordered[pPool->orderedCount++] = lChunk;
+
+        pPool->chunkCount++;
+    }
+
+    return(TRUE);
+}
+
+static Bool PoolOrderedInsert
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk
+)
+{
+    unsigned long lCapacity;
+    unsigned long lIndex;
+
+    void * lOrdered = pPool->ordered;
+
+    if (pPool->orderedCount == pPool->orderedCapacity)
+    {
+        lCapacity = (0 == pPool->orderedCapacity) ? 16 : 2 * pPool->orderedCapacity;
+
+        if (!SmartBudgetReserve(pPool->budget, (lCapacity - pPool->orderedCapacity) * sizeof(smartPoolChunk *)))
+        {
+            return(FALSE);
+        }
+
+        /*
+        ** SafeRealloc() clears the pointer it is passed when it fails
+        */
+
+        if (!SafeRealloc(&lOrdered, lCapacity * sizeof(smartPoolChunk *)))
+        {
+            SmartBudgetRelease(pPool->budget, (lCapacity - pPool->orderedCapacity) * sizeof(smartPoolChunk *));
+
+            return(FALSE);
+        }
+
+        pPool->ordered = (smartPoolChunk **) lOrdered;
+        pPool->orderedCapacity = lCapacity;
+    }
+
+    lIndex = PoolOrderedSearch(pPool, pChunk);
+
+    memmove(&pPool->ordered[lIndex + 1], &pPool->ordered[lIndex], (pPool->orderedCount - lIndex) * sizeof(smartPoolChunk *));
+
+    pPool->ordered[lIndex] = pChunk;
+    pPool->orderedCount++;
+
+    return(TRUE);
+}
+
+static void PoolOrderedRemove
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk
+)
+{
+    unsigned long lIndex = PoolOrderedSearch(pPool, pChunk);
+
+    if (lIndex < pPool->orderedCount && pChunk == pPool->ordered[lIndex])
+    {
+        pPool->orderedCount--;
+
+        memmove(&pPool->ordered[lIndex], &pPool->ordered[lIndex + 1], (pPool->orderedCount - lIndex) * sizeof(smartPoolChunk *));
+    }
+}
+
+static unsigned long PoolOrderedSearch
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk
+)
+{
+    unsigned long lLow = 0;
+    unsigned long lHigh = pPool->orderedCount;
+    unsigned long lMiddle;
+
+    while (lLow < lHigh)
+    {
+        lMiddle = lLow + (lHigh - lLow) / 2;
+
+        if (pPool->ordered[lMiddle] < pChunk)
+        {
+            lLow = lMiddle + 1;
+        }
+        else
+        {
+            lHigh = lMiddle;
+        }
+    }
+
+    return(lLow);
+}
+
+static Bool PoolConcurrentAcquire
+(
+    smartPoolHandle pPool,
+    void ** pObject
+)
+{
+    smartPoolConcurrentObject * lObject;
+
+    uint64_t lHead = atomic_load_explicit(&pPool->head, memory_order_acquire);
+    uint64_t lNext;
+
+    do
+    {
+        if (0 == PoolReference(lHead))
+        {
+            if (!PoolConcurrentGrow(pPool, pObject, FALSE))
+            {
+                return(FALSE);
+            }
+
+            atomic_fetch_add_explicit(&pPool->concurrentObjectCount, 1, memory_order_relaxed);
+
+            return(TRUE);
+        }
+
+        lObject = PoolConcurrentObjectOf(pPool, PoolReference(lHead));
+
+        lNext = PoolTagged(PoolTag(lHead) + 1, atomic_load_explicit(&lObject->next, memory_order_relaxed));
+    }
+    while (!atomic_compare_exchange_weak_explicit(&pPool->head, &lHead, lNext, memory_order_acquire, memory_order_acquire));
+
+    atomic_fetch_add_explicit(&pPool->concurrentObjectCount, 1, memory_order_relaxed);
+
+    *pObject = lObject;
+
+    return(TRUE);
+}
+
+static void PoolConcurrentRelease
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk,
+    void * pObject
+)
+{
+    smartPoolConcurrentObject * lObject = (smartPoolConcurrentObject *) pObject;
+
+    uint32_t lReference = PoolConcurrentReferenceOf(pPool, pChunk, pObject);
+
+    uint64_t lHead = atomic_load_explicit(&pPool->head, memory_order_relaxed);
+
+    atomic_fetch_sub_explicit(&pPool->concurrentObjectCount, 1, memory_order_relaxed);
+
+    do
+    {
+        atomic_store_explicit(&lObject->next, PoolReference(lHead), memory_order_relaxed);
+    }
+    while (!atomic_compare_exchange_weak_explicit(&pPool->head, &lHead, PoolTagged(PoolTag(lHead) + 1, lReference), memory_order_release, memory_order_relaxed));
+}
+
+static Bool PoolConcurrentGrow
+(
+    smartPoolHandle pPool,
+    void ** pObject,
+    Bool pPrefault
+)
+{
+    smartPoolChunk * lChunk = NULL;
+
+    smartPoolConcurrentObject * lFirst;
+    smartPoolConcurrentObject * lLast;
+
+    unsigned long lIndex;
+    unsigned long lObjectIndex;
+
+    uint64_t lHead;
+
+    if (!SmartBudgetReserve(pPool->budget, pPool->chunkSize))
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** slots are handed out in order and only past the end of the table is a
+    ** slot given back, so the slots in use never have a gap
+    */
+
+    lIndex = atomic_fetch_add(&pPool->tableCount, 1);
+
+    if (pPool->tableSize <= lIndex)
+    {
+        atomic_fetch_sub(&pPool->tableCount, 1);
+
+        SmartBudgetRelease(pPool->budget, pPool->chunkSize);
+
+        return(FALSE);
+    }
+
+    if (!PoolChunkMap(pPool, &lChunk))
+    {
+        SmartBudgetRelease(pPool->budget, pPool->chunkSize);
+
+        return(FALSE);
+    }
+
+    /*
+    ** the pages are written back while no other thread can reach them
+    */
+
+    if (pPrefault)
+    {
+        SafePagePrefault(lChunk, pPool->chunkSize);
+    }
+
+    lChunk->pool = pPool;
+    lChunk->index = lIndex;
+
+    lChunk->free = NULL;
+    lChunk->unused = (char *) lChunk + POOL_CHUNK_HEADER_SIZE + pPool->objectsPerChunk * pPool->objectStride;
+
+    lChunk->used = 0;
+
+    /*
+    ** publish the chunk before any reference into it can be seen
+    */
+
+    atomic_store_explicit(&pPool->table[lIndex], lChunk, memory_order_release);
+
+    *pObject = (char *) lChunk + POOL_CHUNK_HEADER_SIZE;
+
+    if (1 == pPool->objectsPerChunk)
+    {
+        return(TRUE);
+    }
+
+    /*
+    ** link the remaining objects in address order and push them at once
+    */
+
+    for (lObjectIndex = 1; lObjectIndex < pPool->objectsPerChunk - 1; lObjectIndex++)
+    {
+        lLast = (smartPoolConcurrentObject *) ((char *) *pObject + lObjectIndex * pPool->objectStride);
+
+        atomic_init(&lLast->next, (uint32_t) (((lIndex + 1) << pPool->referenceShift) | (lObjectIndex + 1)));
+    }
+
+    lFirst = (smartPoolConcurrentObject *) ((char *) *pObject + pPool->objectStride);
+    lLast = (smartPoolConcurrentObject *) ((char *) *pObject + (pPool->objectsPerChunk - 1) * pPool->objectStride);
+
+    lHead = atomic_load_explicit(&pPool->head, memory_order_relaxed);
+
+    do
+    {
+        atomic_store_explicit(&lLast->next, PoolReference(lHead), memory_order_relaxed);
+    }
+    while (!atomic_compare_exchange_weak_explicit(&pPool->head, &lHead, PoolTagged(PoolTag(lHead) + 1, PoolConcurrentReferenceOf(pPool, lChunk, lFirst)), memory_order_release, memory_order_relaxed));
+
+    return(TRUE);
+}
+
+static smartPoolConcurrentObject * PoolConcurrentObjectOf
+(
+    smartPoolHandle pPool,
+    uint32_t pReference
+)
+{
+    smartPoolChunk * lChunk = atomic_load_explicit(&pPool->table[(pReference >> pPool->referenceShift) - 1], memory_order_relaxed);
+
+    return((smartPoolConcurrentObject *) ((char *) lChunk + POOL_CHUNK_HEADER_SIZE + (pReference & ((1U << pPool->referenceShift) - 1)) * pPool->objectStride));
+}
+
+static uint32_t PoolConcurrentReferenceOf
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk,
+    void * pObject
+)
+{
+    size_t lObjectIndex = (size_t) ((char *) pObject - ((char *) pChunk + POOL_CHUNK_HEADER_SIZE)) / pPool->objectStride;
+
+    return((uint32_t) (((pChunk->index + 1) << pPool->referenceShift) | lObjectIndex));
+}
+
+static Bool PoolConcurrentIsValid
+(
+    smartPoolHandle pPool
+)
+{
+    smartPoolChunk * lChunk;
+
+    uint32_t lReference;
+
+    unsigned long lIndex;
+    unsigned long lChunkIndex;
+
+    unsigned long lChunkCount = 0;
+    unsigned long lFreeCount = 0;
+
+    unsigned long lTableCount = atomic_load(&pPool->tableCount);
+
+    if (pPool->tableSize < lTableCount)
+    {
+        lTableCount = pPool->tableSize;
+    }
+
+    for (lIndex = 0; lIndex < lTableCount; lIndex++)
+    {
+        lChunk = atomic_load(&pPool->table[lIndex]);
+
+        if (NULL == lChunk)
+        {
+            continue;
+        }
+
+        if (0 != ((size_t) lChunk & (pPool->chunkSize - 1)) || pPool != lChunk->pool || lIndex != lChunk->index)
+        {
+            return(FALSE); // set breakpoint here for debugging
+        }
+
+        lChunkCount++;
+    }
+
+    /*
+    ** every free reference must name an object of a mapped chunk (the count
+    ** bounds the walk should the list have become a cycle)
+    */
+
+    for (lReference = PoolReference(atomic_load(&pPool->head)); 0 != lReference; lReference = atomic_load(&PoolConcurrentObjectOf(pPool, lReference)->next))
+    {
+        lChunkIndex = (unsigned long) (lReference >> pPool->referenceShift);
+
+        if (0 == lChunkIndex || lTableCount < lChunkIndex || NULL == atomic_load(&pPool->table[lChunkIndex - 1]))
+        {
+            return(FALSE); // set breakpoint here for debugging
+        }
+
+        if (pPool->objectsPerChunk <= (unsigned long) (lReference & ((1U << pPool->referenceShift) - 1)))
+        {
+            return(FALSE); // set breakpoint here for debugging
+        }
+
+        if (lChunkCount * pPool->objectsPerChunk < ++lFreeCount)
+        {
+            return(FALSE); // set breakpoint here for debugging
+        }
+    }
+
+    if (lChunkCount * pPool->objectsPerChunk != lFreeCount + atomic_load(&pPool->concurrentObjectCount))
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    if (sizeof(smartPool) + pPool->tableSize * sizeof(smartPoolChunk *) + lChunkCount * pPool->chunkSize + pPool->magazineCount * PoolMagazineSize(pPool->magazineCapacity) + pPool->threadCount * sizeof(smartPoolThreadMagazines) != SmartBudgetGetValue(pPool->budget))
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    return(TRUE);
+}
+
+static Bool PoolMagazineAcquire
+(
+    smartPoolHandle pPool,
+    void ** pObject
+)
+{
+    smartPoolThreadMagazines * lThread = PoolMagazineThread(pPool);
+
+    smartPoolMagazine * lMagazine;
+
+    if (NULL == lThread)
+    {
+        return(PoolConcurrentAcquire(pPool, pObject));
+    }
+
+    PoolMagazineCount(lThread->acquires);
+
+    if (0 == lThread->loaded->rounds)
+    {
+        if (0 != lThread->spare->rounds)
+        {
+            lMagazine = lThread->loaded; lThread->loaded = lThread->spare; lThread->spare = lMagazine;
+        }
+        else
+        {
+            /*
+            ** trade the empty spare for a full magazine from the depot
+            */
+
+            mtx_lock(&pPool->depotLock);
+
+            pPool->statistics.depotRequests++;
+
+            if (NULL == pPool->depotFull)
+            {
+                mtx_unlock(&pPool->depotLock);
+
+                return(PoolConcurrentAcquire(pPool, pObject));
+            }
+
+            pPool->statistics.depotHits++;
+
+            lMagazine = pPool->depotFull;
+
+            pPool->depotFull = lMagazine->next;
+            pPool->depotFullCount--;
+
+            lThread->spare->next = pPool->depotEmpty;
+
+            pPool->depotEmpty = lThread->spare;
+            pPool->depotEmptyCount++;
+
+            mtx_unlock(&pPool->depotLock);
+
+            lThread->spare = lThread->loaded;
+            lThread->loaded = lMagazine;
+        }
+    }
+
+    PoolMagazineCount(lThread->acquireHits);
+
+    *pObject = lThread->loaded->objects[--lThread->loaded->rounds];
+
+    return(TRUE);
+}
+
+static void PoolMagazineRelease
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk,
+    void * pObject
+)
+{
+    smartPoolThreadMagazines * lThread = PoolMagazineThread(pPool);
+
+    smartPoolMagazine * lMagazine;
+
+    if (NULL == lThread)
+    {
+        PoolConcurrentRelease(pPool, pChunk, pObject);
+
+        return;
+    }
+
+    PoolMagazineCount(lThread->releases);
+
+    if (pPool->magazineCapacity == lThread->loaded->rounds)
+    {
+        if (pPool->magazineCapacity != lThread->spare->rounds)
+        {
+            lMagazine = lThread->loaded; lThread->loaded = lThread->spare; lThread->spare = lMagazine;
+        }
+        else
+        {
+            /*
+            ** trade the full spare for an empty magazine from the depot
+            */
+
+            mtx_lock(&pPool->depotLock);
+
+            pPool->statistics.depotRequests++;
+
+            lMagazine = NULL;
+
+            if (pPool->depotMaximum > pPool->depotFullCount)
+            {
+                if (NULL != pPool->depotEmpty)
+                {
+                    lMagazine = pPool->depotEmpty;
+
+                    pPool->depotEmpty = lMagazine->next;
+                    pPool->depotEmptyCount--;
+                }
+                else
+                {
+                    lMagazine = PoolMagazineConstruct(pPool);
+                }
+            }
+
+            if (NULL == lMagazine)
+            {
+                mtx_unlock(&pPool->depotLock);
+
+                PoolConcurrentRelease(pPool, pChunk, pObject);
+
+                return;
+            }
+
+            pPool->statistics.depotHits++;
+
+            lThread->spare->next = pPool->depotFull;
+
+            pPool->depotFull = lThread->spare;
+            pPool->depotFullCount++;
+
+            mtx_unlock(&pPool->depotLock);
+
+            lThread->spare = lThread->loaded;
+            lThread->loaded = lMagazine;
+        }
+    }
+
+    PoolMagazineCount(lThread->releaseHits);
+
+    lThread->loaded->objects[lThread->loaded->rounds++] = pObject;
+}
+
+static smartPoolThreadMagazines * PoolMagazineThread
+(
+    smartPoolHandle pPool
+)
+{
+    smartPoolThreadMagazines * lThread = (smartPoolThreadMagazines *) tss_get(pPool->magazineKey);
+
+    if (NULL != lThread)
+    {
+        return(lThread);
+    }
+
+    if (!SmartBudgetReserve(pPool->budget, sizeof(smartPoolThreadMagazines)))
+    {
+        return(NULL);
+    }
+
+    if (!SafeMalloc((void **) &lThread, sizeof(smartPoolThreadMagazines)))
+    {
+        SmartBudgetRelease(pPool->budget, sizeof(smartPoolThreadMagazines));
+
+        return(NULL);
+    }
+
+    lThread->pool = pPool;
+
+    atomic_init(&lThread->acquires, 0ULL);
+    atomic_init(&lThread->acquireHits, 0ULL);
+    atomic_init(&lThread->releases, 0ULL);
+    atomic_init(&lThread->releaseHits, 0ULL);
+
+    mtx_lock(&pPool->depotLock);
+
+    lThread->loaded = PoolMagazineConstruct(pPool);
+    lThread->spare = PoolMagazineConstruct(pPool);
+
+    if (NULL == lThread->loaded || NULL == lThread->spare)
+    {
+        if (NULL != lThread->loaded)
+        {
+            SafeFree((void **) &lThread->loaded);
+
+            SmartBudgetRelease(pPool->budget, PoolMagazineSize(pPool->magazineCapacity));
+
+            pPool->magazineCount--;
+        }
+
+        mtx_unlock(&pPool->depotLock);
+
+        SafeFree((void **) &lThread);
+
+        SmartBudgetRelease(pPool->budget, sizeof(smartPoolThreadMagazines));
+
+        return(NULL);
+    }
+
+    lThread->previous = NULL;
+    lThread->next = pPool->threads;
+
+    if (NULL != pPool->threads)
+    {
+        pPool->threads->previous = lThread;
+    }
+
+    pPool->threads = lThread;
+    pPool->threadCount++;
+
+    mtx_unlock(&pPool->depotLock);
+
+    tss_set(pPool->magazineKey, lThread);
+
+    return(lThread);
+}
+
+static void PoolMagazineThreadExit
+(
+    void * pThread
+)
+{
+    smartPoolThreadMagazines * lThread = (smartPoolThreadMagazines *) pThread;
+
+    smartPoolHandle lPool = lThread->pool;
+
+    PoolMagazineEmpty(lPool, lThread->loaded);
+    PoolMagazineEmpty(lPool, lThread->spare);
+
+    mtx_lock(&lPool->depotLock);
+
+    /*
+    ** keep the counters of the thread and the magazines for other threads
+    */
+
+    lPool->statistics.acquires += atomic_load_explicit(&lThread->acquires, memory_order_relaxed);
+    lPool->statistics.acquireHits += atomic_load_explicit(&lThread->acquireHits, memory_order_relaxed);
+    lPool->statistics.releases += atomic_load_explicit(&lThread->releases, memory_order_relaxed);
+    lPool->statistics.releaseHits += atomic_load_explicit(&lThread->releaseHits, memory_order_relaxed);
+
+    lThread->loaded->next = lThread->spare;
+    lThread->spare->next = lPool->depotEmpty;
+
+    lPool->depotEmpty = lThread->loaded;
+    lPool->depotEmptyCount += 2;
+
+    if (NULL == lThread->previous)
+    {
+        lPool->threads = lThread->next;
+    }
+    else
+    {
+        lThread->previous->next = lThread->next;
+    }
+
+    if (NULL != lThread->next)
+    {
+        lThread->next->previous = lThread->previous;
+    }
+
+    lPool->threadCount--;
+
+    mtx_unlock(&lPool->depotLock);
+
+    SafeFree((void **) &lThread);
+
+    SmartBudgetRelease(lPool->budget, sizeof(smartPoolThreadMagazines));
+}
+
+static smartPoolMagazine * PoolMagazineConstruct
+(
+    smartPoolHandle pPool
+)
+{
+    smartPoolMagazine * lMagazine = NULL;
+
+    if (!SmartBudgetReserve(pPool->budget, PoolMagazineSize(pPool->magazineCapacity)))
+    {
+        return(NULL);
+    }
+
+    if (!SafeMalloc((void **) &lMagazine, PoolMagazineSize(pPool->magazineCapacity)))
+    {
+        SmartBudgetRelease(pPool->budget, PoolMagazineSize(pPool->magazineCapacity));
+
+        return(NULL);
+    }
+
+    lMagazine->next = NULL;
+    lMagazine->rounds = 0;
+
+    pPool->magazineCount++;
+
+    return(lMagazine);
+}
+
+static void PoolMagazineEmpty
+(
+    smartPoolHandle pPool,
+    smartPoolMagazine * pMagazine
+)
+{
+    void * lObject;
+
+    while (0 != pMagazine->rounds)
+    {
+        lObject = pMagazine->objects[--pMagazine->rounds];
+
+        PoolConcurrentRelease(pPool, PoolChunkOf(pPool, lObject), lObject);
+    }
+}
+
+static Bool PoolSlotGrow
+(
+    smartPoolHandle pPool
+)
+{
+    unsigned long lCapacity = (0 == pPool->slotCapacity) ? POOL_SLOT_INITIAL : 2 * pPool->slotCapacity;
+
+    void * lSlots = pPool->slots;
+    void * lDense = pPool->dense;
+    void * lDenseSlots = pPool->denseSlots;
+
+    if (POOL_SLOT_MAXIMUM < lCapacity)
+    {
+        lCapacity = POOL_SLOT_MAXIMUM;
+    }
+
+    if (pPool->slotCapacity == lCapacity)
+    {
+        return(FALSE);
+    }
+
+    if (!SmartBudgetReserve(pPool->budget, (lCapacity - pPool->slotCapacity) * PoolSlotEntrySize(pPool->objectSize)))
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** an array is only replaced once it has been grown, SafeRealloc() clears
+    ** the pointer it is passed when it fails
+    */
+
+    if (SafeRealloc(&lSlots, lCapacity * sizeof(smartPoolSlotEntry)))
+    {
+        pPool->slots = (smartPoolSlotEntry *) lSlots;
+
+        if (SafeRealloc(&lDense, lCapacity * pPool->objectSize))
+        {
+            pPool->dense = (char *) lDense;
+
+            if (SafeRealloc(&lDenseSlots, lCapacity * sizeof(uint32_t)))
+            {
+                pPool->denseSlots = (uint32_t *) lDenseSlots;
+
+                pPool->slotCapacity = lCapacity;
+
+                return(TRUE);
+            }
+        }
+    }
+
+    SmartBudgetRelease(pPool->budget, (lCapacity - pPool->slotCapacity) * PoolSlotEntrySize(pPool->objectSize));
+
+    return(FALSE);
+}
+
+static Bool PoolSlotIsValid
+(
+    smartPoolHandle pPool
+)
+{
+    unsigned long lIndex;
+
+    unsigned long lFreeCount = 0;
+
+    uint32_t lSlot;
+
+    if (pPool->slotCapacity < pPool->slotCount || pPool->slotCount < pPool->denseCount)
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    /*
+    ** every object refers to a live slot that refers back to it
+    */
+
+    for (lIndex = 0; lIndex < pPool->denseCount; lIndex++)
+    {
+        lSlot = pPool->denseSlots[lIndex];
+
+        if (pPool->slotCount <= lSlot || lIndex != pPool->slots[lSlot].dense)
+        {
+            return(FALSE); // set breakpoint here for debugging
+        }
+
+        if (0 == pPool->slots[lSlot].generation || POOL_SLOT_GENERATION_MASK < pPool->slots[lSlot].generation)
+        {
+            return(FALSE); // set breakpoint here for debugging
+        }
+    }
+
+    /*
+    ** the count bounds the walk should the free list have become a cycle
+    */
+
+    for (lSlot = pPool->freeSlot; POOL_SLOT_NONE != lSlot; lSlot = pPool->slots[lSlot].dense)
+    {
+        if (pPool->slotCount <= lSlot || pPool->slotCount < ++lFreeCount)
+        {
+            return(FALSE); // set breakpoint here for debugging
+        }
+
+        /*
+        ** the list ends at its tail
+        */
+
+        if (POOL_SLOT_NONE == pPool->slots[lSlot].dense && lSlot != pPool->freeSlotTail)
+        {
+            return(FALSE); // set breakpoint here for debugging
+        }
+    }
+
+    if ((POOL_SLOT_NONE == pPool->freeSlot) != (POOL_SLOT_NONE == pPool->freeSlotTail))
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    if (pPool->slotCount != lFreeCount + pPool->denseCount)
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    if (sizeof(smartPool) + pPool->slotCapacity * PoolSlotEntrySize(pPool->objectSize) != SmartBudgetGetValue(pPool->budget))
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    return(TRUE);
+}
+
+static void * PoolAllocate
+(
+    void * pContext,
+    size_t pSize
+)
+{
+    smartPoolHandle lPool = (smartPoolHandle) pContext;
+
+    void * lObject = NULL;
+
+    /*
+    ** large requests bypass the pool
+    */
+
+    if (lPool->objectSize < pSize)
+    {
+        SafeMalloc(&lObject, pSize);
+
+        return(lObject);
+    }
+
+    SmartPoolAcquire(lPool, &lObject);
+
+    return(lObject);
+}
+
+static void * PoolAllocateZeroed
+(
+    void * pContext,
+    size_t pSize
+)
+{
+    void * lObject = PoolAllocate(pContext, pSize);
+
+    if (NULL != lObject)
+    {
+        memset(lObject, 0, pSize);
+    }
+
+    return(lObject);
+}
+
+static void * PoolReallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pOldSize,
+    size_t pSize
+)
+{
+    smartPoolHandle lPool = (smartPoolHandle) pContext;
+
+    void * lObject;
+
+    if (NULL == pBuffer)
+    {
+        return(PoolAllocate(pContext, pSize));
+    }
+
+    /*
+    ** the object already has the capacity
+    */
+
+    if (lPool->objectSize >= pOldSize && lPool->objectSize >= pSize)
+    {
+        return(pBuffer);
+    }
+
+    if (lPool->objectSize < pOldSize && lPool->objectSize < pSize)
+    {
+        if (!SafeRealloc(&pBuffer, pSize))
+        {
+            return(NULL);
+        }
+
+        return(pBuffer);
+    }
+
+    /*
+    ** move the block into or out of the pool
+    */
+
+    lObject = PoolAllocate(pContext, pSize);
+
+    if (NULL != lObject)
+    {
+        memcpy(lObject, pBuffer, (pOldSize < pSize) ? pOldSize : pSize);
+
+        PoolDeallocate(pContext, pBuffer, pOldSize);
+    }
+
+    return(lObject);
+}
+
+static void PoolDeallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pSize
+)
+{
+    smartPoolHandle lPool = (smartPoolHandle) pContext;
+
+    if (lPool->objectSize < pSize)
+    {
+        SafeFree(&pBuffer);
+
+        return;
+    }
+
+    SmartPoolRelease(lPool, &pBuffer);
+}
@@ -1,4 +1,1117 @@
-#ifndef POOL_H
-#define POOL_H
+/*----------------------------------------------------------------------------
+  Smart Pool
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
 
-#endif
\ No newline at end of file
+/*----------------------------------------------------------------------------
+  Smart Pool internal header file
+  ----------------------------------------------------------------------------*/
+
+#ifndef SMART_POOL_H
+#define SMART_POOL_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <threads.h>
+
+#include "smart.pool.t.h"
+
+/*----------------------------------------------------------------------------
+  Private defines
+  ----------------------------------------------------------------------------*/
+
+#define POOL_OBJECT_ALIGNMENT    ((size_t) 16)
+#define POOL_DEFAULT_CHUNK_SIZE  ((size_t) 64 * 1024)
+#define POOL_DECOMMIT_CHUNK_SIZE ((size_t) 1024 * 1024)             /* trimmed chunks this large stay mapped */
+#define POOL_HUGE_PAGE_SIZE      ((size_t) 2 * 1024 * 1024)         /* transparent huge page */
+
+#define PoolAlign(pSize) (((pSize) + POOL_OBJECT_ALIGNMENT - 1) & ~(POOL_OBJECT_ALIGNMENT - 1))
+
+/*
+** chunks are aligned to their size so the chunk of an object is found by
+** masking its address
+*/
+
+#define PoolChunkOf(pPool, pObject) ((smartPoolChunk *) ((size_t) (pObject) & ~((pPool)->chunkSize - 1)))
+
+/*
+** the free list link of an object, at its start or (in an object cache)
+** just past it
+*/
+
+#define PoolIsCache(pPool) (0 != (pPool)->linkOffset)
+
+#define PoolObjectLink(pPool, pObject) ((smartPoolObject *) ((char *) (pObject) + (pPool)->linkOffset))
+
+/*
+** a bitmap pool marks its objects in use in a bitmap between the chunk
+** header and the first object, the chunk index holding the first word that
+** may have a clear bit
+*/
+
+#define POOL_BITMAP_WORD_BITS 64
+
+#define PoolChunkBitmap(pChunk) ((uint64_t *) ((char *) (pChunk) + POOL_CHUNK_HEADER_SIZE))
+
+#define PoolBitmapWords(pObjects) (((pObjects) + POOL_BITMAP_WORD_BITS - 1) / POOL_BITMAP_WORD_BITS)
+
+#if defined _MSC_VER
+
+#include <intrin.h>
+
+#define PoolCountTrailingZeros(pWord) PoolBitScanForward(pWord)
+#define PoolPopulationCount(pWord)    ((unsigned int) __popcnt64(pWord))
+
+static __inline unsigned int PoolBitScanForward(uint64_t pWord)
+{
+    unsigned long lIndex;
+
+    _BitScanForward64(&lIndex, pWord);
+
+    return((unsigned int) lIndex);
+}
+
+#else
+
+#define PoolCountTrailingZeros(pWord) ((unsigned int) __builtin_ctzll(pWord))
+#define PoolPopulationCount(pWord)    ((unsigned int) __builtin_popcountll(pWord))
+
+#endif
+
+/*
+** a file pool is a bitmap pool whose chunks follow a header chunk in a
+** mapped file, chunk n at n times the chunk size
+*/
+
+#define POOL_FILE_MAGIC   ((uint64_t) 0x4C4F4F5054524D53)           /* "SMRTPOOL" */
+#define POOL_FILE_VERSION 1
+
+#define PoolFileChunk(pPool, pIndex) ((smartPoolChunk *) ((char *) (pPool)->header + ((size_t) (pIndex) + 1) * (pPool)->chunkSize))
+
+/*
+** the free list of a concurrent pool links objects by a 32 bit reference,
+** the chunk table index plus one above the object index within the chunk,
+** so that the head and a modification tag fit a single 64 bit word
+*/
+
+#define POOL_CONCURRENT_MAXIMUM_CHUNKS ((unsigned long) 16384)      /* 1G of 64K chunks */
+#define POOL_LINE_SIZE                 64
+
+#define PoolTagged(pTag, pReference) (((uint64_t) (pTag) << 32) | (uint64_t) (pReference))
+#define PoolTag(pTagged)             ((uint32_t) ((pTagged) >> 32))
+#define PoolReference(pTagged)       ((uint32_t) (pTagged))
+
+/*
+** the slots of a slot pool are handed out by index, the generation of a
+** slot runs from 1 to 1023 so that no handle is SMART_POOL_NULL_SLOT
+*/
+
+#define POOL_SLOT_INDEX_BITS      22
+#define POOL_SLOT_GENERATION_MASK ((uint32_t) 0x3FF)
+#define POOL_SLOT_MAXIMUM         ((unsigned long) 1 << POOL_SLOT_INDEX_BITS)
+#define POOL_SLOT_INITIAL         ((unsigned long) 64)
+#define POOL_SLOT_NONE            UINT32_MAX                        /* end of the free slot list */
+
+#define PoolSlotMake(pGeneration, pIndex) ((smartPoolSlot) (((uint32_t) (pGeneration) << POOL_SLOT_INDEX_BITS) | (uint32_t) (pIndex)))
+#define PoolSlotIndex(pSlot)              ((uint32_t) (pSlot) & (uint32_t) (POOL_SLOT_MAXIMUM - 1))
+#define PoolSlotGeneration(pSlot)         ((uint32_t) (pSlot) >> POOL_SLOT_INDEX_BITS)
+
+#define PoolSlotEntrySize(pObjectSize) (sizeof(smartPoolSlotEntry) + (pObjectSize) + sizeof(uint32_t))
+
+#define PoolMagazineSize(pCapacity) (sizeof(smartPoolMagazine) + (pCapacity) * sizeof(void *))
+
+/*
+** a magazine counter is only written by its own thread, so it is bumped
+** without a locked instruction and read by others as a snapshot
+*/
+
+#define PoolMagazineCount(pCounter) atomic_store_explicit(&(pCounter), atomic_load_explicit(&(pCounter), memory_order_relaxed) + 1, memory_order_relaxed)
+
+/*----------------------------------------------------------------------------
+  Private data types
+  ----------------------------------------------------------------------------*/
+
+typedef struct smartPoolObject {
+    struct smartPoolObject * next;
+} smartPoolObject;
+
+typedef struct smartPoolConcurrentObject {
+    _Atomic uint32_t next;                                          /* reference of the next free object */
+} smartPoolConcurrentObject;
+
+typedef struct smartPoolChunk {
+    struct smartPoolChunk * next;
+    struct smartPoolChunk * previous;
+
+    struct smartPool * pool;
+
+    smartPoolObject * free;                                         /* released objects */
+    char * unused;                                                  /* objects never handed out */
+
+    unsigned long used;
+
+    unsigned long index;                                            /* chunk table slot (concurrent pools), first bitmap word with a clear bit (bitmap pools) */
+
+    unsigned long long emptied;                                     /* milliseconds, when used fell to zero */
+} smartPoolChunk;
+
+#define POOL_CHUNK_HEADER_SIZE PoolAlign(sizeof(smartPoolChunk))
+
+/*
+** the header of a file pool, whose fields are fixed width so that the file
+** reads the same to every build on a platform
+*/
+
+typedef struct smartPoolFileHeader {
+    uint64_t magic;
+    uint64_t version;
+
+    uint64_t objectSize;
+    uint64_t chunkSize;
+
+    uint64_t chunkCount;                                            /* chunks in use after the header chunk */
+
+    smartPoolOffset root;
+} smartPoolFileHeader;
+
+typedef struct smartPoolSlotEntry {
+    uint32_t dense;                                                 /* dense index, or next free slot */
+    uint32_t generation;
+} smartPoolSlotEntry;
+
+typedef struct smartPoolMagazine {
+    struct smartPoolMagazine * next;                                /* depot list */
+
+    unsigned long rounds;                                           /* objects held */
+
+    void * objects[];
+} smartPoolMagazine;
+
+typedef struct smartPoolThreadMagazines {
+    struct smartPoolThreadMagazines * next;                         /* threads of the pool */
+    struct smartPoolThreadMagazines * previous;
+
+    struct smartPool * pool;
+
+    smartPoolMagazine * loaded;                                     /* serves acquires and releases */
+    smartPoolMagazine * spare;                                      /* exchanged with loaded first */
+
+    atomic_ullong acquires;
+    atomic_ullong acquireHits;
+    atomic_ullong releases;
+    atomic_ullong releaseHits;
+} smartPoolThreadMagazines;
+
+typedef struct smartPool {
+    smartAllocator allocator;
+
+    smartPoolChunk * partial;                                       /* chunks with an object to hand out */
+    smartPoolChunk * full;
+    smartPoolChunk * decommitted;                                   /* trimmed large chunks */
+
+    size_t objectSize;
+    size_t objectStride;                                            /* object and its link in a chunk */
+    size_t linkOffset;
+    size_t chunkSize;
+
+    unsigned long objectsPerChunk;
+
+    unsigned long chunkCount;                                       /* mapped, including decommitted */
+    unsigned long objectCount;
+
+    unsigned long emptyCount;                                       /* partial chunks with no object in use */
+    unsigned long decommittedCount;
+
+    unsigned long trimRetain;                                       /* empty chunks kept in hand */
+    unsigned long trimIdle;                                         /* milliseconds, zero for never */
+
+    Bool hugePages;                                                 /* advise new chunks */
+
+    /*
+    ** a bitmap pool marks its objects in use in a bitmap in each chunk
+    ** instead of a free list, and keeps its chunks in address order so that
+    ** the objects in use can be walked
+    */
+
+    Bool bitmapped;
+    Bool walking;                                                   /* trimming waits for the walk to end */
+
+    size_t objectOffset;                                            /* of the first object in a chunk */
+    unsigned long bitmapWords;
+
+    smartPoolChunk ** ordered;
+    unsigned long orderedCount;
+    unsigned long orderedCapacity;
+
+    /*
+    ** a file pool maps its header and chunks from a file, its chunks are
+    ** never unmapped on their own
+    */
+
+    Bool persistent;
+
+    smartPoolFileHeader * header;                                   /* start of the mapping */
+    size_t fileSize;
+
+    smartBudgetHandle budget;
+
+    smartPoolConstructor constructor;                               /* object caches only */
+    smartPoolDestructor destructor;
+    void * callbackContext;
+
+    /*
+    ** concurrent pools keep one lock free list instead of the chunk lists,
+    ** the hot words are kept off the lines of the read mostly fields
+    */
+
+    Bool concurrent;
+
+    _Atomic(smartPoolChunk *) * table;
+    unsigned long tableSize;
+
+    unsigned int referenceShift;
+
+    /*
+    ** the magazine layer of a concurrent pool, the depot and its counters
+    ** are guarded by the depot lock
+    */
+
+    unsigned long magazineCapacity;                                 /* zero when there are no magazines */
+    unsigned long depotMaximum;
+
+    tss_t magazineKey;
+
+    mtx_t depotLock;
+
+    smartPoolMagazine * depotFull;
+    smartPoolMagazine * depotEmpty;
+
+    unsigned long depotFullCount;
+    unsigned long depotEmptyCount;
+
+    smartPoolThreadMagazines * threads;
+
+    unsigned long magazineCount;
+    unsigned long threadCount;
+
+    smartPoolMagazineStatistics statistics;                         /* depot and exited thread counters */
+
+    /*
+    ** a slot pool keeps its objects packed in a dense array, each with the
+    ** index of the slot that refers to it
+    */
+
+    Bool slotted;
+
+    smartPoolSlotEntry * slots;
+    uint32_t freeSlot;                                              /* the oldest released slot, reused first */
+    uint32_t freeSlotTail;                                          /* the newest released slot */
+
+    char * dense;
+    uint32_t * denseSlots;
+
+    unsigned long slotCount;                                        /* slots ever handed out */
+    unsigned long slotCapacity;                                     /* of the slots and dense arrays */
+    unsigned long denseCount;
+
+    char leadingPadding[POOL_LINE_SIZE];
+
+    _Atomic uint64_t head;                                          /* tagged reference of the first free object */
+    atomic_ulong concurrentObjectCount;
+    atomic_ulong tableCount;
+
+    char trailingPadding[POOL_LINE_SIZE];
+} smartPool;
+
+typedef smartPool * smartPoolHandle;
+
+/*----------------------------------------------------------------------------
+  Private function prototypes
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  PoolConstruct()
+  ----------------------------------------------------------------------------
+  Construct a pool for SmartPoolConstructSmartPoolWithBudget() and
+  SmartPoolConstructConcurrentSmartPoolWithBudget()
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool          - (I/O) Pointer to recieve the pool handle
+  pObjectSize    - (I)   The number of bytes in each object
+  pChunkSize     - (I)   The number of bytes in each chunk (zero selects 64K)
+  pMemoryMaximum - (I)   The most bytes the pool may map, zero for no limit
+  pBudget        - (I)   The parent budget handle, NULL for none
+  pConcurrent    - (I)   Construct a pool that threads may share
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  See SmartPoolConstructSmartPool()
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolConstruct
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pMemoryMaximum,
+    smartBudgetHandle pBudget,
+    Bool pConcurrent
+);
+
+/*----------------------------------------------------------------------------
+  PoolChunkConstruct()
+  ----------------------------------------------------------------------------
+  Map a new chunk (or recommit a decommitted one), charge it to the budget
+  of the pool and make it the first chunk of the partial list
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I) The pool handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  NULL - The budget refused the chunk or it could not be mapped
+
+  smartPoolChunk * - The chunk
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The objects of a new chunk are not threaded onto its free list, they are
+  handed out from the unused portion of the chunk in address order so that
+  only the pages that are used are touched.
+  ----------------------------------------------------------------------------*/
+
+static smartPoolChunk * PoolChunkConstruct
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  PoolChunkMap()
+  ----------------------------------------------------------------------------
+  Map the pages of a new chunk aligned to the chunk size, advising huge
+  pages for them when the pool asks for it
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool  - (I) The pool handle
+  pChunk - (O) The address of a chunk pointer (which must be NULL) to hold
+               the chunk
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The chunk was mapped
+
+  False - The chunk could not be mapped
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolChunkMap
+(
+    smartPoolHandle pPool,
+    smartPoolChunk ** pChunk
+);
+
+/*----------------------------------------------------------------------------
+  PoolChunkDestruct()
+  ----------------------------------------------------------------------------
+  Unlink a chunk from its list, destruct the objects of an object cache,
+  return the chunk to the operating system and release its charge from the
+  budget of the pool
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool  - (I) The pool handle
+  pChunk - (I) The chunk
+  pList  - (I) The head of the list the chunk is linked into
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The chunk was destructed
+
+  False - SafePageFree() failed
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolChunkDestruct
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk,
+    smartPoolChunk ** pList
+);
+
+/*----------------------------------------------------------------------------
+  PoolChunkDestructObjects()
+  ----------------------------------------------------------------------------
+  Run the destructor of an object cache over every object carved from a
+  chunk
+  ----------------------------------------------------------------------------*/
+
+static void PoolChunkDestructObjects
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk
+);
+
+/*----------------------------------------------------------------------------
+  PoolChunkTrim()
+  ----------------------------------------------------------------------------
+  Return the memory of an empty partial chunk to the operating system
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool  - (I) The pool handle
+  pChunk - (I) The chunk
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The chunk was trimmed
+
+  False - SafePageFree() or SafePageDecommit() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  A chunk smaller than POOL_DECOMMIT_CHUNK_SIZE is destructed. A larger
+  chunk keeps its mapping and the page holding its header, the rest of its
+  pages are decommitted and it moves to the decommitted list, from which
+  PoolChunkConstruct() takes it before mapping a new chunk. Either way the
+  memory returned is released from the budget of the pool.
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolChunkTrim
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk
+);
+
+/*----------------------------------------------------------------------------
+  PoolChunkEmptied()
+  ----------------------------------------------------------------------------
+  Apply the trim policy of a pool when the last object of a chunk is
+  released
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool  - (I) The pool handle
+  pChunk - (I) The chunk that has become empty
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The policy was applied
+
+  False - PoolChunkTrim() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The chunk is trimmed at once when the pool holds more empty chunks than
+  it keeps in hand, otherwise it is stamped and, with an idle threshold,
+  every empty chunk that has been idle past the threshold is trimmed.
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolChunkEmptied
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk
+);
+
+/*----------------------------------------------------------------------------
+  PoolTrimExcess()
+  ----------------------------------------------------------------------------
+  Trim the empty chunks of a pool past the number its trim policy retains
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I) The pool handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The pool holds no more empty chunks than it retains
+
+  False - Trimming a chunk failed
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolTrimExcess
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  PoolTrimIdle()
+  ----------------------------------------------------------------------------
+  Trim the empty chunks of a pool that have been idle past its threshold
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I) The pool handle
+  pNow  - (I) The time from PoolMilliseconds() to measure idleness against
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - No empty chunk has been idle past the threshold
+
+  False - Trimming a chunk failed
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolTrimIdle
+(
+    smartPoolHandle pPool,
+    unsigned long long pNow
+);
+
+/*----------------------------------------------------------------------------
+  PoolMilliseconds()
+  ----------------------------------------------------------------------------
+  The time in milliseconds from an arbitrary start, for idle stamps
+  ----------------------------------------------------------------------------*/
+
+static unsigned long long PoolMilliseconds
+(
+    void
+);
+
+/*----------------------------------------------------------------------------
+  PoolListInsert(), PoolListRemove()
+  ----------------------------------------------------------------------------
+  Link a chunk in at the head of a chunk list or unlink it from a list
+  ----------------------------------------------------------------------------*/
+
+static void PoolListInsert
+(
+    smartPoolChunk ** pList,
+    smartPoolChunk * pChunk
+);
+
+static void PoolListRemove
+(
+    smartPoolChunk ** pList,
+    smartPoolChunk * pChunk
+);
+
+/*----------------------------------------------------------------------------
+  PoolChunkIsValid()
+  ----------------------------------------------------------------------------
+  Check the placement and the object tally of a chunk
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool  - (I) The pool handle
+  pChunk - (I) The chunk
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The chunk is consistent
+
+  False - The chunk is misaligned, belongs to another pool, has a free
+          object that is not on an object boundary within the chunk, or its
+          free, unused and used objects do not add up to a chunk
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolChunkIsValid
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk
+);
+
+/*----------------------------------------------------------------------------
+  PoolBitmapLayout()
+  ----------------------------------------------------------------------------
+  Lay out the chunks of a bitmap pool, fitting as many objects as there is
+  room for with a bit each and doubling a chunk too small to hold the
+  bitmap and an object
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I/O) The pool handle
+  ----------------------------------------------------------------------------*/
+
+static void PoolBitmapLayout
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  PoolBitmapAcquire()
+  ----------------------------------------------------------------------------
+  Take the lowest object of a chunk of a bitmap pool whose bit is clear
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool   - (I) The pool handle
+  pChunk  - (I) A chunk with an object to hand out
+  pObject - (O) The address of a memory pointer to hold the object
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The search starts at the word the chunk index holds, all the words below
+  it are full, and finds the clear bit within a word by counting the
+  trailing zeros of its complement.
+  ----------------------------------------------------------------------------*/
+
+static void PoolBitmapAcquire
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk,
+    void ** pObject
+);
+
+/*----------------------------------------------------------------------------
+  PoolBitmapRelease()
+  ----------------------------------------------------------------------------
+  Clear the bit of an object of a chunk of a bitmap pool
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool   - (I) The pool handle
+  pChunk  - (I) The chunk of the object
+  pObject - (I) The object
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The bit was cleared
+
+  False - The pointer was not to an object of the chunk, or the object was
+          not in use
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolBitmapRelease
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk,
+    void * pObject
+);
+
+/*----------------------------------------------------------------------------
+  PoolBitmapIndexOf()
+  ----------------------------------------------------------------------------
+  Find the index within its chunk of an object of a bitmap pool
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool   - (I) The pool handle
+  pChunk  - (I) The chunk of the object
+  pObject - (I) The object
+  pIndex  - (O) The index of the object
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The object is in use
+
+  False - The pointer was not to an object of the chunk, or the object was
+          not in use
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolBitmapIndexOf
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk,
+    void * pObject,
+    unsigned long * pIndex
+);
+
+/*----------------------------------------------------------------------------
+  PoolBitmapIsValid()
+  ----------------------------------------------------------------------------
+  Check that the bitmap of a chunk of a bitmap pool agrees with its count
+  of objects in use and its first word with a clear bit
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolBitmapIsValid
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk
+);
+
+/*----------------------------------------------------------------------------
+  PoolFileRecover()
+  ----------------------------------------------------------------------------
+  Rebuild the chunk lists of a file pool from the chunks in its file
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I/O) The pool handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The chunks were taken up by the pool
+
+  False - The budget refused the chunks or a bitmap had a bit set past the
+          last object of its chunk
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Only the header and the bitmap of each chunk are read. The rest of a
+  chunk header holds addresses from the last time the file was mapped and
+  is written afresh, the count of objects in use and the first word with a
+  clear bit are taken from the bitmap.
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolFileRecover
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  PoolOrderedInsert(), PoolOrderedRemove()
+  ----------------------------------------------------------------------------
+  Add a chunk to, or remove it from, the address ordered chunk array of a
+  bitmap pool. The array doubles when it is full and its growth is charged
+  to the budget of the pool; PoolOrderedInsert() returns FALSE if the
+  budget refuses it or the array cannot grow.
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolOrderedInsert
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk
+);
+
+static void PoolOrderedRemove
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk
+);
+
+/*----------------------------------------------------------------------------
+  PoolOrderedSearch()
+  ----------------------------------------------------------------------------
+  Return the index of the first chunk in the address ordered chunk array of
+  a bitmap pool that is not below a chunk
+  ----------------------------------------------------------------------------*/
+
+static unsigned long PoolOrderedSearch
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk
+);
+
+/*----------------------------------------------------------------------------
+  PoolConcurrentAcquire()
+  ----------------------------------------------------------------------------
+  Pop the first object from the free list of a concurrent pool, growing the
+  pool when the list is empty
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool   - (I)   The pool handle
+  pObject - (I/O) The address of a memory pointer to hold the object
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - An object was acquired
+
+  False - The free list was empty and PoolConcurrentGrow() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The link of the first object is read before the head is swapped, by which
+  time another thread may have taken the object and written over the link.
+  Chunks stay mapped until the pool is destructed, so the read is harmless,
+  and the tag bumped by every swap makes the swap fail when the head has
+  moved on and come back to the same object (ABA).
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolConcurrentAcquire
+(
+    smartPoolHandle pPool,
+    void ** pObject
+);
+
+/*----------------------------------------------------------------------------
+  PoolConcurrentRelease()
+  ----------------------------------------------------------------------------
+  Push an object onto the free list of a concurrent pool
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool   - (I) The pool handle
+  pChunk  - (I) The chunk of the object
+  pObject - (I) The object
+  ----------------------------------------------------------------------------*/
+
+static void PoolConcurrentRelease
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk,
+    void * pObject
+);
+
+/*----------------------------------------------------------------------------
+  PoolConcurrentGrow()
+  ----------------------------------------------------------------------------
+  Map a chunk into the next slot of the chunk table of a concurrent pool,
+  keep its first object and push the rest onto the free list
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool     - (I/O) The pool handle
+  pObject   - (O)   The address of a memory pointer to hold the object
+  pPrefault - (I)   Whether to fault in the pages of the chunk before any
+                    of its objects are published
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - A chunk was added and an object acquired from it
+
+  False - The budget refused the chunk, the table was full or the chunk
+          could not be mapped
+  ----------------------------------------------------------------------------
+  Notes:
+
+  No lock is held while the chunk is mapped, so threads that find the free
+  list empty at the same time each add a chunk rather than wait for one.
+  A slot whose chunk could not be mapped is left empty.
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolConcurrentGrow
+(
+    smartPoolHandle pPool,
+    void ** pObject,
+    Bool pPrefault
+);
+
+/*----------------------------------------------------------------------------
+  PoolConcurrentObjectOf(), PoolConcurrentReferenceOf()
+  ----------------------------------------------------------------------------
+  Convert between a free list reference and the object it refers to
+  ----------------------------------------------------------------------------*/
+
+static smartPoolConcurrentObject * PoolConcurrentObjectOf
+(
+    smartPoolHandle pPool,
+    uint32_t pReference
+);
+
+static uint32_t PoolConcurrentReferenceOf
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk,
+    void * pObject
+);
+
+/*----------------------------------------------------------------------------
+  PoolConcurrentIsValid()
+  ----------------------------------------------------------------------------
+  The SmartPoolIsValid() check of a concurrent pool
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolConcurrentIsValid
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  PoolMagazineAcquire()
+  ----------------------------------------------------------------------------
+  Take an object from the magazines of the calling thread, exchanging an
+  empty magazine for a full one at the depot when both are empty
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool   - (I)   The pool handle
+  pObject - (I/O) The address of a memory pointer to hold the object
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  See PoolConcurrentAcquire(), which serves the acquire when the depot has
+  no full magazine
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolMagazineAcquire
+(
+    smartPoolHandle pPool,
+    void ** pObject
+);
+
+/*----------------------------------------------------------------------------
+  PoolMagazineRelease()
+  ----------------------------------------------------------------------------
+  Put an object in the magazines of the calling thread, exchanging a full
+  magazine for an empty one at the depot when both are full
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool   - (I) The pool handle
+  pChunk  - (I) The chunk of the object
+  pObject - (I) The object
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The object goes to PoolConcurrentRelease() when the depot already holds
+  its maximum of full magazines or an empty magazine cannot be had.
+  ----------------------------------------------------------------------------*/
+
+static void PoolMagazineRelease
+(
+    smartPoolHandle pPool,
+    smartPoolChunk * pChunk,
+    void * pObject
+);
+
+/*----------------------------------------------------------------------------
+  PoolMagazineThread()
+  ----------------------------------------------------------------------------
+  Get the magazines of the calling thread, giving the thread a pair of empty
+  magazines on its first call
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I) The pool handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  NULL - The budget refused the magazines or they could not be allocated,
+         the thread uses the pool without magazines
+
+  smartPoolThreadMagazines * - The magazines of the thread
+  ----------------------------------------------------------------------------*/
+
+static smartPoolThreadMagazines * PoolMagazineThread
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  PoolMagazineThreadExit()
+  ----------------------------------------------------------------------------
+  The thread specific storage destructor, returning the objects held by an
+  exiting thread to the pool and its magazines to the depot
+  ----------------------------------------------------------------------------*/
+
+static void PoolMagazineThreadExit
+(
+    void * pThread
+);
+
+/*----------------------------------------------------------------------------
+  PoolMagazineConstruct()
+  ----------------------------------------------------------------------------
+  Allocate an empty magazine charged to the budget of the pool
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I) The pool handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  NULL - The budget refused the magazine or it could not be allocated
+
+  smartPoolMagazine * - The magazine
+  ----------------------------------------------------------------------------*/
+
+static smartPoolMagazine * PoolMagazineConstruct
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  PoolMagazineEmpty()
+  ----------------------------------------------------------------------------
+  Release every object held by a magazine to the pool
+  ----------------------------------------------------------------------------*/
+
+static void PoolMagazineEmpty
+(
+    smartPoolHandle pPool,
+    smartPoolMagazine * pMagazine
+);
+
+/*----------------------------------------------------------------------------
+  PoolSlotGrow()
+  ----------------------------------------------------------------------------
+  Double the capacity of the slot and dense arrays of a slot pool
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I/O) The pool handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The arrays were grown
+
+  False - The pool holds the most slots a handle can index, the budget
+          refused the growth or SafeRealloc() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Growing may move the dense array, so it invalidates the object pointers
+  returned by SmartPoolSlotGetObject().
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolSlotGrow
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  PoolSlotIsValid()
+  ----------------------------------------------------------------------------
+  The SmartPoolIsValid() check of a slot pool
+  ----------------------------------------------------------------------------*/
+
+static Bool PoolSlotIsValid
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  PoolAllocate(), PoolAllocateZeroed(), PoolReallocate(), PoolDeallocate()
+  ----------------------------------------------------------------------------
+  The pool allocator table functions. Requests of up to the object size of
+  the pool are served with SmartPoolAcquire() and SmartPoolRelease(),
+  larger requests are passed to SafeMalloc().
+  ----------------------------------------------------------------------------*/
+
+static void * PoolAllocate
+(
+    void * pContext,
+    size_t pSize
+);
+
+static void * PoolAllocateZeroed
+(
+    void * pContext,
+    size_t pSize
+);
+
+static void * PoolReallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pOldSize,
+    size_t pSize
+);
+
+static void PoolDeallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pSize
+);
+
+#endif
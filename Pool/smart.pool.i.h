@@ -1,4 +1,1359 @@
-#ifndef POOL_I_H
-#define POOL_I_H
+/*----------------------------------------------------------------------------
+  Smart Pool
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
 
-#endif
\ No newline at end of file
+/*----------------------------------------------------------------------------
+  Smart Pool application programmer's interface (API) header file
+  ----------------------------------------------------------------------------*/
+
+#ifndef SMART_POOL_I_H
+#define SMART_POOL_I_H
+
+/*----------------------------------------------------------------------------
+  SmartPoolConstructSmartPool()
+  ----------------------------------------------------------------------------
+  Construct an empty pool of fixed size objects.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool          - (I/O) Pointer to recieve the pool handle
+  pObjectSize    - (I)   The number of bytes in each object
+  pChunkSize     - (I)   The number of bytes in each chunk (zero selects 64K)
+  pMemoryMaximum - (I)   The most bytes the pool may map, zero for no limit
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Pool was succesfully constructed
+
+  False - Pool was not successfully constructed due to:
+
+          1. The pool handle pointer was NULL
+          2. The object size was zero
+          3. The memory maximum was too small for the pool control structure
+          4. The SafeMalloc() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  This function requires the contents of the pPool handle to be initialized
+  to NULL prior to calling this function.
+
+  Objects are carved from chunks obtained with SafePageAlloc(). The object
+  size is rounded up to a multiple of 16 bytes, and the chunk size is
+  rounded up to a power of two no smaller than a page that holds at least
+  one object. Each chunk is aligned to its size, so the chunk that a
+  released object belongs to is found from the object's address and both
+  SmartPoolAcquire() and SmartPoolRelease() take constant time.
+
+  The whole chunk is charged against the maximum when it is mapped, so the
+  memory allocated by a pool is its control structure plus its chunks.
+
+  A pool is not thread safe, it is intended to be used by a single thread
+  (or to be guarded by the caller).
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructSmartPool
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pMemoryMaximum
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolConstructSmartPoolWithBudget()
+  ----------------------------------------------------------------------------
+  Construct an empty pool of fixed size objects whose chunks are also
+  charged to a parent memory budget.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool          - (I/O) Pointer to recieve the pool handle
+  pObjectSize    - (I)   The number of bytes in each object
+  pChunkSize     - (I)   The number of bytes in each chunk (zero selects 64K)
+  pMemoryMaximum - (I)   The most bytes the pool may map, zero for no limit
+  pBudget        - (I)   The parent budget handle, NULL for none
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  See SmartPoolConstructSmartPool()
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructSmartPoolWithBudget
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pMemoryMaximum,
+    smartBudgetHandle pBudget
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolConstructConcurrentSmartPool()
+  ----------------------------------------------------------------------------
+  Construct an empty pool of fixed size objects that threads may share.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool          - (I/O) Pointer to recieve the pool handle
+  pObjectSize    - (I)   The number of bytes in each object
+  pChunkSize     - (I)   The number of bytes in each chunk (zero selects 64K)
+  pMemoryMaximum - (I)   The most bytes the pool may map, zero for no limit
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Pool was succesfully constructed
+
+  False - Pool was not successfully constructed due to:
+
+          1. The pool handle pointer was NULL
+          2. The object size was zero
+          3. The memory maximum was too small for the pool control structure
+             and its chunk table
+          4. The SafeMalloc() or SafeCalloc() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  This function requires the contents of the pPool handle to be initialized
+  to NULL prior to calling this function.
+
+  SmartPoolAcquire() and SmartPoolRelease() may be called on a concurrent
+  pool by any number of threads at once without a lock. The objects that
+  are free form a single lock free list whose head is swapped with a
+  compare and exchange. The head carries a tag that changes on every swap,
+  so a thread that was delayed between reading the head and swapping it
+  cannot install a stale link (the ABA problem).
+
+  When the list is empty the acquiring thread maps a new chunk into the
+  next slot of the chunk table and pushes its objects onto the list, other
+  threads carry on with the list meanwhile. The table is sized when the
+  pool is constructed, from the memory maximum or for 16384 chunks when
+  there is none, and is charged to the pool along with its chunks.
+
+  Chunks are not returned to the operating system until the pool is
+  destructed.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructConcurrentSmartPool
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pMemoryMaximum
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolConstructConcurrentSmartPoolWithBudget()
+  ----------------------------------------------------------------------------
+  Construct an empty pool of fixed size objects that threads may share and
+  whose chunks are also charged to a parent memory budget.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool          - (I/O) Pointer to recieve the pool handle
+  pObjectSize    - (I)   The number of bytes in each object
+  pChunkSize     - (I)   The number of bytes in each chunk (zero selects 64K)
+  pMemoryMaximum - (I)   The most bytes the pool may map, zero for no limit
+  pBudget        - (I)   The parent budget handle, NULL for none
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  See SmartPoolConstructConcurrentSmartPool()
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructConcurrentSmartPoolWithBudget
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pMemoryMaximum,
+    smartBudgetHandle pBudget
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolConstructBitmapSmartPool()
+  ----------------------------------------------------------------------------
+  Construct an empty pool of fixed size objects whose objects in use can be
+  walked.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool          - (I/O) Pointer to recieve the pool handle
+  pObjectSize    - (I)   The number of bytes in each object
+  pChunkSize     - (I)   The number of bytes in each chunk (zero selects 64K)
+  pMemoryMaximum - (I)   The most bytes the pool may map, zero for no limit
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Pool was succesfully constructed
+
+  False - Pool was not successfully constructed due to:
+
+          1. The pool handle pointer was NULL
+          2. The object size was zero
+          3. The memory maximum was too small for the pool control structure
+          4. The SafeMalloc() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  This function requires the contents of the pPool handle to be initialized
+  to NULL prior to calling this function.
+
+  A bitmap pool is acquired from and released to like any other pool, but
+  each chunk marks its objects in use with a bit each in a bitmap ahead of
+  its objects rather than linking its free objects into a list. An acquire
+  takes the lowest free object of a chunk by counting the trailing zeros of
+  a bitmap word, and a release that finds the bit of its object already
+  clear is refused. The pool keeps its chunks in address order, so
+  SmartPoolForEachObject() visits the objects in use in address order
+  without the caller keeping a list of them.
+
+  The bitmap costs a bit per object. Object callbacks cannot be set on a
+  bitmap pool.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructBitmapSmartPool
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pMemoryMaximum
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolConstructBitmapSmartPoolWithBudget()
+  ----------------------------------------------------------------------------
+  Construct an empty bitmap pool whose chunks are also charged to a parent
+  memory budget.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool          - (I/O) Pointer to recieve the pool handle
+  pObjectSize    - (I)   The number of bytes in each object
+  pChunkSize     - (I)   The number of bytes in each chunk (zero selects 64K)
+  pMemoryMaximum - (I)   The most bytes the pool may map, zero for no limit
+  pBudget        - (I)   The parent budget handle, NULL for none
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  See SmartPoolConstructBitmapSmartPool()
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructBitmapSmartPoolWithBudget
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pMemoryMaximum,
+    smartBudgetHandle pBudget
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolConstructFileSmartPool()
+  ----------------------------------------------------------------------------
+  Construct a bitmap pool whose chunks live in a file, or take up the
+  objects a pool left in the file before.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool       - (I/O) Pointer to recieve the pool handle
+  pPath       - (I)   The path of the file, which is created if need be
+  pObjectSize - (I)   The number of bytes in each object
+  pChunkSize  - (I)   The number of bytes in each chunk (zero selects 64K)
+  pFileSize   - (I)   The number of bytes of the file to map, which bounds
+                      the objects the pool can hold
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Pool was succesfully constructed
+
+  False - Pool was not successfully constructed due to:
+
+          1. The pool handle pointer was NULL
+          2. The path was NULL
+          3. The object size was zero
+          4. The file size was less than two chunks
+          5. The file could not be mapped
+          6. The file was written by a pool with a different object or
+             chunk size, holds more chunks than the file size maps, or is
+             not a pool file
+          7. The SafeMalloc() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  This function requires the contents of the pPool handle to be initialized
+  to NULL prior to calling this function.
+
+  The file holds a small header in its first chunk and the chunks of the
+  pool after it. When the pool is destructed its objects stay in the file,
+  and constructing a file pool on the same file with the same object and
+  chunk sizes brings them back as they were. Only the header and the
+  bitmap of each chunk are read to do so, the objects themselves are paged
+  in as they are used. The file is extended sparsely to the file size, and
+  may be mapped with a larger file size later to give the pool more room.
+
+  The file is mapped at a different address each time, so objects should
+  refer to one another by the offsets of SmartPoolFileGetOffset() rather
+  than by pointer. SmartPoolFileSetRoot() records an offset in the header
+  for finding the objects again. The pool behaves as a bitmap pool in every
+  other respect, except that its chunks are never trimmed (the file keeps
+  them) and it has no allocator interface.
+
+  The operating system writes changes to the file in its own time, after
+  the pool is destructed or the process exits if need be. Call
+  SmartPoolFileSync() to know they have reached the device. A file left by
+  a machine failure holds whatever had been written, with no guarantee of
+  consistency between its objects. Only one pool may map a file at a time.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructFileSmartPool
+(
+    smartPoolHandle * pPool,
+    const char * pPath,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pFileSize
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolConstructFileSmartPoolWithBudget()
+  ----------------------------------------------------------------------------
+  Construct a file pool whose chunks are also charged to a parent memory
+  budget.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool       - (I/O) Pointer to recieve the pool handle
+  pPath       - (I)   The path of the file, which is created if need be
+  pObjectSize - (I)   The number of bytes in each object
+  pChunkSize  - (I)   The number of bytes in each chunk (zero selects 64K)
+  pFileSize   - (I)   The number of bytes of the file to map
+  pBudget     - (I)   The parent budget handle, NULL for none
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  See SmartPoolConstructFileSmartPool(); the pool is also not constructed
+  if the budget refuses the chunks found in the file.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructFileSmartPoolWithBudget
+(
+    smartPoolHandle * pPool,
+    const char * pPath,
+    size_t pObjectSize,
+    size_t pChunkSize,
+    size_t pFileSize,
+    smartBudgetHandle pBudget
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolConstructSlotSmartPool()
+  ----------------------------------------------------------------------------
+  Construct an empty pool of fixed size objects that are referred to by
+  slot handles.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool          - (I/O) Pointer to recieve the pool handle
+  pObjectSize    - (I)   The number of bytes in each object
+  pMemoryMaximum - (I)   The most bytes the pool may allocate, zero for no
+                         limit
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Pool was succesfully constructed
+
+  False - Pool was not successfully constructed due to:
+
+          1. The pool handle pointer was NULL
+          2. The object size was zero
+          3. The memory maximum was too small for the pool control structure
+          4. The SafeMalloc() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  This function requires the contents of the pPool handle to be initialized
+  to NULL prior to calling this function.
+
+  The objects of a slot pool are acquired with SmartPoolSlotAcquire(),
+  which returns a 32 bit smartPoolSlot rather than a pointer, and are
+  released with SmartPoolSlotRelease(). SmartPoolAcquire(),
+  SmartPoolRelease() and SmartPoolGetAllocator() fail on a slot pool.
+
+  A handle indexes a table of slots, each of which holds the position of
+  its object in one dense array, so SmartPoolSlotGetObject() takes constant
+  time. Releasing an object moves the last object of the array into its
+  place and moves its slot on a generation, so a stale handle is detected
+  by comparing generations and the live objects can be visited in order
+  with SmartPoolSlotGetObjectAt(). A pool holds at most 4194304 slots.
+
+  Since objects move, a pointer from SmartPoolSlotGetObject() is only good
+  until the next acquire or release; hold the handle instead. Released
+  slots are reused in the order they were released, so a slot is only
+  reused once every slot released before it has been, and a stale handle
+  only matches again after its slot has been released 1023 more times.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructSlotSmartPool
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pMemoryMaximum
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolConstructSlotSmartPoolWithBudget()
+  ----------------------------------------------------------------------------
+  Construct an empty slot pool whose arrays are also charged to a parent
+  memory budget.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool          - (I/O) Pointer to recieve the pool handle
+  pObjectSize    - (I)   The number of bytes in each object
+  pMemoryMaximum - (I)   The most bytes the pool may allocate, zero for no
+                         limit
+  pBudget        - (I)   The parent budget handle, NULL for none
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  See SmartPoolConstructSlotSmartPool()
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolConstructSlotSmartPoolWithBudget
+(
+    smartPoolHandle * pPool,
+    size_t pObjectSize,
+    size_t pMemoryMaximum,
+    smartBudgetHandle pBudget
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolAcquire()
+  ----------------------------------------------------------------------------
+  Take an object from a pool.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool   - (I)   Pool handle
+  pObject - (I/O) The address of a memory pointer to hold the object
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - An object was acquired
+
+  False - An object was not acquired due to one of the following:
+
+          1. The pool handle was NULL
+          2. The object pointer pointer was NULL
+          3. The object pointer was not initialized to NULL
+          4. A new chunk would take the pool over its maximum
+          5. A new chunk could not be mapped
+          6. The pool is a slot pool
+          7. The constructor of an object cache failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The contents of the object are undefined. The most recently released
+  object of the most recently used chunk is handed out first (of a
+  concurrent pool, the most recently released object).
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolAcquire
+(
+    smartPoolHandle pPool,
+    void ** pObject
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolRelease()
+  ----------------------------------------------------------------------------
+  Return an object to its pool, setting the memory pointer to NULL.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool   - (I)   Pool handle
+  pObject - (I/O) The address of a memory pointer to the object
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The object was released
+
+  False - The object was not released due to one of the following:
+
+          1. The pool handle was NULL
+          2. The object pointer pointer was NULL
+          3. The object pointer was NULL
+          4. The object does not lie within a chunk of the pool
+          5. The pool is a slot pool
+          6. The pool is a bitmap pool and the object is not in use
+  ----------------------------------------------------------------------------
+  Notes:
+
+  When the last object of a chunk is released the chunk is kept or its
+  memory returned to the operating system as the trim policy of the pool
+  decides (see SmartPoolSetTrimPolicy()). By default one empty chunk is
+  kept so that acquiring and releasing a single object does not map and
+  unmap a chunk each time. The chunks of a concurrent pool are kept until
+  the pool is destructed.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolRelease
+(
+    smartPoolHandle pPool,
+    void ** pObject
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolSetObjectCallbacks()
+  ----------------------------------------------------------------------------
+  Make a pool an object cache, whose objects keep their constructed state
+  from one acquire to the next.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool        - (I) Pool handle
+  pConstructor - (I) The function that prepares an object, NULL for none
+  pDestructor  - (I) The function that undoes the constructor, NULL for none
+  pContext     - (I) Passed to both functions
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The callbacks were set
+
+  False - The callbacks were not set due to one of the following:
+
+          1. The pool handle was NULL
+          2. The pool is a concurrent, a slot or a bitmap pool
+          3. The pool has already mapped a chunk
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The constructor runs once per object, when the object is first carved
+  from a new chunk, and the destructor runs once per object when its chunk
+  is returned to the operating system. Neither runs on an ordinary acquire
+  or release, so an object comes back in the state it was released in and the
+  caller should release objects in their constructed state, such as with
+  their embedded buffers still allocated and their tables cleared.
+
+  An object cache keeps every chunk when its last object is released, so
+  its objects stay constructed, until SmartPoolReclaim() or
+  SmartPoolDestructSmartPool() returns it (or a trim policy set after this
+  function says otherwise). An acquire fails if the
+  constructor returns FALSE. Objects still in use when the pool is
+  destructed are destructed with it.
+
+  To leave the object untouched while it is free, the free list link of an
+  object cache is kept after the object, which adds 16 bytes to each
+  object in a chunk.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolSetObjectCallbacks
+(
+    smartPoolHandle pPool,
+    smartPoolConstructor pConstructor,
+    smartPoolDestructor pDestructor,
+    void * pContext
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolReclaim()
+  ----------------------------------------------------------------------------
+  Return the chunks of a pool that hold no objects in use to the operating
+  system.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I) Pool handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The empty chunks were returned (a concurrent, slot or file pool
+          has none to return)
+
+  False - The chunks were not returned due to one of the following:
+
+          1. The pool handle was NULL
+          2. A SafePageFree() or SafePageDecommit() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  This is the explicit trim of a pool, whatever its trim policy. Chunks of
+  less than 1M are unmapped, larger chunks keep their addresses and the
+  page holding their header while the rest of their pages are decommitted
+  with SafePageDecommit(), to be recommitted when the pool next needs a
+  chunk. The memory returned is deducted from the memory allocated by the
+  pool. The objects of an object cache are destructed with their chunk.
+  Call this function when memory is short, such as from a memory pressure
+  function, or when a burst of use is over.
+
+  Concurrent, slot and file pools never trim: their chunks stay mapped until
+  the pool is destructed, and this function returns True for them without
+  returning any memory.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolReclaim
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolSetTrimPolicy()
+  ----------------------------------------------------------------------------
+  Set when a pool returns the memory of its empty chunks to the operating
+  system.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool             - (I) Pool handle
+  pRetainChunks     - (I) The most empty chunks the pool keeps in hand
+  pIdleMilliseconds - (I) How long an empty chunk is kept in hand, zero to
+                          keep it until the pool is trimmed or destructed
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The policy was set
+
+  False - The policy was not set due to one of the following:
+
+          1. The pool handle was NULL
+          2. The pool is a concurrent, a slot or a file pool
+          3. Trimming the empty chunks past the new limit failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The chunks kept in hand are the hysteresis between growing and
+  shrinking: a pool that swings back and forth across a chunk boundary
+  reuses the chunks it has rather than mapping and unmapping one on every
+  swing. An empty chunk beyond the retained count is trimmed as soon as its
+  last object is released. A retained chunk is trimmed once it has been
+  empty for the idle time, which is checked whenever a chunk of the pool
+  becomes empty and whenever SmartPoolTick() is called; call SmartPoolTick()
+  periodically so that a pool that has gone quiet gives its chunks back.
+  Chunks are trimmed as SmartPoolReclaim() describes.
+
+  The default policy keeps one empty chunk and has no idle time, an object
+  cache keeps every empty chunk.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolSetTrimPolicy
+(
+    smartPoolHandle pPool,
+    unsigned long pRetainChunks,
+    unsigned long pIdleMilliseconds
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolTick()
+  ----------------------------------------------------------------------------
+  Trim the empty chunks of a pool that have been idle past the idle time of
+  its trim policy.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I) Pool handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The idle chunks were returned (a pool without an idle time, or a
+          concurrent, slot or file pool, has none to return)
+
+  False - The chunks were not returned due to one of the following:
+
+          1. The pool handle was NULL
+          2. A SafePageFree() or SafePageDecommit() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The idle time is otherwise only checked when a chunk becomes empty, so a
+  pool that sees no more releases would keep its chunks in hand. Call this
+  function from a timer or the idle loop of the thread that owns the pool;
+  it does not depend on any acquire or release since the chunks emptied.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolTick
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolReserve()
+  ----------------------------------------------------------------------------
+  Map the chunks a pool needs to hand out a number of objects ahead of the
+  acquires that will take them.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool     - (I) Pool handle
+  pObjects  - (I) The number of objects that can be acquired afterwards
+                  without mapping a chunk
+  pPrefault - (I) Whether to fault in the pages of the chunks as well
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The objects were reserved
+
+  False - The objects were not reserved due to one of the following:
+
+          1. The pool handle was NULL
+          2. The budget of the pool refused a chunk
+          3. A chunk could not be mapped, or a slot pool could not grow
+          4. The constructor of an object cache returned FALSE
+  ----------------------------------------------------------------------------
+  Notes:
+
+  A fresh chunk costs a page fault for every page an acquire first touches,
+  which a service pays on its first requests after it starts. Reserving
+  with pPrefault set moves both the mapping and the faults to start up, so
+  the first acquires run as fast as the steady state ones. Pages are
+  faulted in with madvise(MADV_POPULATE_WRITE), the equivalent of
+  MAP_POPULATE, where the kernel has it and by writing to them otherwise.
+
+  The reserved chunks count against the memory maximum of the pool, and
+  the empty chunks a trim policy retains is raised to cover them so that
+  they are not trimmed before they are used (an idle time still applies).
+  An object cache constructs the reserved objects too. On a concurrent
+  pool only the chunks this function maps are prefaulted, and on a slot
+  pool the arrays grow to hold the objects.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolReserve
+(
+    smartPoolHandle pPool,
+    unsigned long pObjects,
+    Bool pPrefault
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolSetHugePages()
+  ----------------------------------------------------------------------------
+  Set whether the chunks a pool maps from now on are backed by transparent
+  huge pages.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool      - (I) Pool handle
+  pHugePages - (I) Whether to ask for huge pages
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The setting was made
+
+  False - The setting was not made due to one of the following:
+
+          1. The pool handle was NULL
+          2. The pool is a slot or a file pool
+          3. Huge pages were asked for and the chunk size is not a
+             multiple of 2M
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Each new chunk is advised with madvise(MADV_HUGEPAGE) before it is
+  touched, which suits large pools whose chunks are faulted in by
+  SmartPoolReserve(): a 2M chunk then costs one fault and one TLB entry
+  rather than 512. The advice is a hint, platforms without it (and kernels
+  with transparent huge pages disabled) use ordinary pages. Chunks already
+  mapped are left as they are.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolSetHugePages
+(
+    smartPoolHandle pPool,
+    Bool pHugePages
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolForEachObject()
+  ----------------------------------------------------------------------------
+  Call a function for each object in use in a bitmap pool, in address
+  order.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool    - (I) Pool handle
+  pVisitor - (I) The function to call, which returns FALSE to end the walk
+  pContext - (I) Passed to the function
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The objects were walked (or the visitor ended the walk)
+
+  False - The objects were not walked due to one of the following:
+
+          1. The pool handle was NULL
+          2. The pool is not a bitmap pool
+          3. The visitor was NULL
+          4. Trimming the chunks emptied during the walk failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The walk reads the chunks in address order and a bitmap word at a time,
+  skipping empty chunks and clear bits, so it costs little more than
+  reading the objects in use.
+
+  The visitor may release the object it is given, for example to expire
+  it. A chunk it empties is trimmed as the trim policy says once the walk
+  is over. It must not acquire an object or release any other object
+  during the walk.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolForEachObject
+(
+    smartPoolHandle pPool,
+    smartPoolVisitor pVisitor,
+    void * pContext
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolFileGetOffset()
+  ----------------------------------------------------------------------------
+  Return the offset in its file of an object of a file pool.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool   - (I) Pool handle
+  pObject - (I) The object
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  smartPoolOffset        - The offset of the object
+
+  SMART_POOL_NULL_OFFSET - The pool handle was NULL, the pool is not a file
+                           pool or the object is not in use in it
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS smartPoolOffset CALLING_CONVENTION SmartPoolFileGetOffset
+(
+    smartPoolHandle pPool,
+    void * pObject
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolFileGetObject()
+  ----------------------------------------------------------------------------
+  Return the object at an offset in the file of a file pool.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool   - (I) Pool handle
+  pOffset - (I) The offset of the object
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  void * - The object
+
+  NULL   - The pool handle was NULL, the pool is not a file pool, or there is
+           no object in use at the offset
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The pointer is good until the pool is destructed, an offset is good for
+  as long as the object is in use, across any number of mappings.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS void * CALLING_CONVENTION SmartPoolFileGetObject
+(
+    smartPoolHandle pPool,
+    smartPoolOffset pOffset
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolFileSetRoot()
+  ----------------------------------------------------------------------------
+  Record the offset of an object in the header of the file of a file pool.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool   - (I) Pool handle
+  pOffset - (I) The offset of the object, SMART_POOL_NULL_OFFSET for none
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The root was recorded
+
+  False - The root was not recorded due to one of the following:
+
+          1. The pool handle was NULL
+          2. The pool is not a file pool
+          3. There is no object in use at the offset
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The root is where a process that maps the file again starts to find its
+  objects, such as the top object of an index. It is not cleared when its
+  object is released.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolFileSetRoot
+(
+    smartPoolHandle pPool,
+    smartPoolOffset pOffset
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolFileGetRoot()
+  ----------------------------------------------------------------------------
+  Return the offset recorded by SmartPoolFileSetRoot() in the file of a
+  file pool, SMART_POOL_NULL_OFFSET if there is none or the pool is not a
+  file pool.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS smartPoolOffset CALLING_CONVENTION SmartPoolFileGetRoot
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolFileSync()
+  ----------------------------------------------------------------------------
+  Write the changed pages of a file pool to its file.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I) Pool handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The pages were written
+
+  False - The pages were not written due to one of the following:
+
+          1. The pool handle was NULL
+          2. The pool is not a file pool
+          3. The SafeFileSync() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  See SafeFileSync() for how far the pages get on each platform.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolFileSync
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolSlotAcquire()
+  ----------------------------------------------------------------------------
+  Take an object from a slot pool.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I)   Pool handle
+  pSlot - (I/O) The address of a slot handle to hold the handle of the
+                object
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - An object was acquired
+
+  False - An object was not acquired due to one of the following:
+
+          1. The pool handle was NULL
+          2. The slot handle pointer was NULL
+          3. The slot handle was not initialized to SMART_POOL_NULL_SLOT
+          4. The pool is not a slot pool
+          5. The pool holds the most slots a handle can index
+          6. Growing the arrays would take the pool over its maximum
+          7. The SafeRealloc() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The contents of the object are undefined. The object is added at the end
+  of the dense array.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolSlotAcquire
+(
+    smartPoolHandle pPool,
+    smartPoolSlot * pSlot
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolSlotRelease()
+  ----------------------------------------------------------------------------
+  Return an object to its slot pool, setting the slot handle to
+  SMART_POOL_NULL_SLOT.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I)   Pool handle
+  pSlot - (I/O) The address of the slot handle of the object
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The object was released
+
+  False - The object was not released due to one of the following:
+
+          1. The pool handle was NULL
+          2. The slot handle pointer was NULL
+          3. The slot handle was stale or did not belong to the pool
+          4. The pool is not a slot pool
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The last object of the dense array is moved into the place of the
+  released object.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolSlotRelease
+(
+    smartPoolHandle pPool,
+    smartPoolSlot * pSlot
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolSlotGetObject()
+  ----------------------------------------------------------------------------
+  Get the object a slot handle refers to.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I) Pool handle
+  pSlot - (I) The slot handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  NULL - The slot handle was stale (or SMART_POOL_NULL_SLOT), or the pool
+         is not a slot pool
+
+  void * - The object, good until the next acquire or release
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS void * CALLING_CONVENTION SmartPoolSlotGetObject
+(
+    smartPoolHandle pPool,
+    smartPoolSlot pSlot
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolSlotGetObjectAt(), SmartPoolSlotGetSlotAt()
+  ----------------------------------------------------------------------------
+  Get the object at a position of the dense array of a slot pool, or the
+  slot handle of that object.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool  - (I) Pool handle
+  pIndex - (I) The position, from zero to SmartPoolGetObjectCount() - 1
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  NULL (SMART_POOL_NULL_SLOT) - The position was past the last object, or
+                                the pool is not a slot pool
+
+  void * (smartPoolSlot) - The object (its slot handle)
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The objects are packed, so visiting the positions in order walks memory
+  sequentially. Releasing the object at a position moves another object
+  into it.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS void * CALLING_CONVENTION SmartPoolSlotGetObjectAt
+(
+    smartPoolHandle pPool,
+    unsigned long pIndex
+);
+
+STORAGE_CLASS smartPoolSlot CALLING_CONVENTION SmartPoolSlotGetSlotAt
+(
+    smartPoolHandle pPool,
+    unsigned long pIndex
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolSetMagazines()
+  ----------------------------------------------------------------------------
+  Put a magazine layer in front of a concurrent pool.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool             - (I) Pool handle
+  pMagazineCapacity - (I) The number of objects a magazine holds
+  pDepotMaximum     - (I) The most full magazines the depot may hold
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The pool has a magazine layer
+
+  False - The magazine layer was not added due to one of the following:
+
+          1. The pool handle was NULL
+          2. The pool is not a concurrent pool
+          3. The pool already has a magazine layer
+          4. The magazine capacity was zero
+          5. The depot lock or thread specific storage key could not be
+             created
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Call this function before the pool is shared with other threads.
+
+  Each thread that uses the pool is given a loaded and a spare magazine, a
+  small stack of objects that only the thread touches. SmartPoolAcquire()
+  pops the loaded magazine and SmartPoolRelease() pushes it, swapping in
+  the spare when the loaded magazine is empty (or full). Only when both are
+  empty (or full) does the thread take the depot lock to trade a magazine
+  for a full (or empty) one, so most acquires and releases stay out of the
+  shared free list. An acquire the depot cannot serve goes to the free
+  list, as does a release once the depot holds its maximum of full
+  magazines, which bounds the objects the depot keeps from other threads.
+
+  The magazines and the thread records are charged to the pool, and the
+  objects in them count as in use until they are flushed back to the free
+  list. When a thread exits its objects are released to the pool and its
+  magazines are kept by the depot for other threads.
+
+  Every pool with a magazine layer takes a thread specific storage key,
+  of which there are a limited number.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolSetMagazines
+(
+    smartPoolHandle pPool,
+    unsigned long pMagazineCapacity,
+    unsigned long pDepotMaximum
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolFlushMagazines()
+  ----------------------------------------------------------------------------
+  Release the objects in the magazines of the calling thread and in the
+  full magazines of the depot to the pool.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I) Pool handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The magazines were flushed (or the pool has no magazine layer)
+
+  False - The pool handle was NULL
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The magazines of other threads are not touched.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolFlushMagazines
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolGetMagazineStatistics()
+  ----------------------------------------------------------------------------
+  Get the counters of the magazine layer of a pool.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool       - (I) Pool handle
+  pStatistics - (O) The counters
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The counters were copied
+
+  False - The counters were not copied due to one of the following:
+
+          1. The pool handle was NULL
+          2. The statistics pointer was NULL
+          3. The pool has no magazine layer
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The depot hit rate is depotHits / depotRequests and the magazine hit rate
+  is acquireHits / acquires. The counters of threads that are running are a
+  snapshot.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolGetMagazineStatistics
+(
+    smartPoolHandle pPool,
+    smartPoolMagazineStatistics * pStatistics
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolGetAllocator()
+  ----------------------------------------------------------------------------
+  Get the allocator interface of a pool.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I) Pool handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  NULL - There is no pool, or the pool is a slot or a file pool
+
+  smartAllocatorHandle - The allocator to pass to SmartAllocatorMalloc(),
+                         SmartAllocatorFree() or a container constructor
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Requests of up to the object size are served from the pool, larger ones
+  are passed through to SafeMalloc(). The size passed to
+  SmartAllocatorFree() must be the size that was allocated.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS smartAllocatorHandle CALLING_CONVENTION SmartPoolGetAllocator
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolGetObjectSize()
+  ----------------------------------------------------------------------------
+  Get the size of the objects of a pool.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I) Pool handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  The object size after rounding, zero when there is no pool
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartPoolGetObjectSize
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolGetObjectCount()
+  ----------------------------------------------------------------------------
+  Get the number of objects acquired from a pool and not yet released.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I) Pool handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  The number of objects in use, zero when there is no pool
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The count of a concurrent pool in use by other threads is only a snapshot.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS unsigned long CALLING_CONVENTION SmartPoolGetObjectCount
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolGetMemoryAllocated()
+  ----------------------------------------------------------------------------
+  Get the number of bytes mapped by a pool.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I) Pool handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  The number of bytes in the chunks and control structure of the pool
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartPoolGetMemoryAllocated
+(
+    smartPoolHandle pPool
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolDestructSmartPool()
+  ----------------------------------------------------------------------------
+  Destruct a pool, returning all of its chunks to the operating system.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I/O) Pointer to the pool handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Pool was succesfully destructed
+
+  False - Pool was not successfully destructed due to:
+
+          1. A SafePageFree() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Every object acquired from the pool becomes invalid.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolDestructSmartPool
+(
+    smartPoolHandle * pPool
+);
+
+/*----------------------------------------------------------------------------
+  SmartPoolIsValid()
+  ----------------------------------------------------------------------------
+  Test every chunk within a pool to assure that the structure is correct.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pPool - (I) Pool handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Pool passed the validity check
+
+  False - Pool did not pass the validity check due to one of the following:
+
+          1. A chunk failed its own check (see PoolChunkIsValid())
+          2. A chunk on the full list had an object to hand out, or one on
+             the partial list had none
+          3. The objects in use or the chunks did not match the tallies of
+             the pool
+          4. The memory allocated did not match the chunks
+          5. A free object of a concurrent pool did not lie in a chunk of
+             its table, or the free and used objects did not add up
+          6. An object of a slot pool and its slot did not refer to each
+             other, or the free and used slots did not add up
+  ----------------------------------------------------------------------------
+  Notes:
+
+  A concurrent pool must not be in use by other threads while it is checked.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartPoolIsValid
+(
+    smartPoolHandle pPool
+);
+
+#endif
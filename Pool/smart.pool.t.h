@@ -0,0 +1,128 @@
+/*----------------------------------------------------------------------------
+  Smart Pool
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Pool application programmer's types (APT) header file
+  ----------------------------------------------------------------------------*/
+
+#ifndef SMART_POOL_T_H
+#define SMART_POOL_T_H
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+  Slot handle
+  ----------------------------------------------------------------------------
+  The handle of an object of a slot pool, a 22 bit slot index below a 10
+  bit generation. A handle is stale once its object is released, since the
+  release moves the slot on to its next generation. No live handle is zero.
+  ----------------------------------------------------------------------------*/
+
+typedef uint32_t smartPoolSlot;
+
+#define SMART_POOL_NULL_SLOT ((smartPoolSlot) 0)
+
+/*----------------------------------------------------------------------------
+  File offset
+  ----------------------------------------------------------------------------
+  The position of an object of a file pool from the start of its file,
+  which stays the same wherever the file is mapped. No object lies at zero.
+  ----------------------------------------------------------------------------*/
+
+typedef uint64_t smartPoolOffset;
+
+#define SMART_POOL_NULL_OFFSET ((smartPoolOffset) 0)
+
+/*----------------------------------------------------------------------------
+  Object cache functions
+  ----------------------------------------------------------------------------
+  The constructor prepares an object before the pool first hands it out and
+  returns FALSE if it cannot, the destructor undoes the constructor before
+  the chunk holding the object is returned to the operating system. Both are
+  passed the context given to SmartPoolSetObjectCallbacks().
+  ----------------------------------------------------------------------------*/
+
+typedef Bool (* smartPoolConstructor)(void * pContext, void * pObject);
+
+typedef void (* smartPoolDestructor)(void * pContext, void * pObject);
+
+/*----------------------------------------------------------------------------
+  Object visitor
+  ----------------------------------------------------------------------------
+  Called by SmartPoolForEachObject() for each object in use in a bitmap
+  pool, with the context given to it. Returns FALSE to end the walk.
+  ----------------------------------------------------------------------------*/
+
+typedef Bool (* smartPoolVisitor)(void * pContext, void * pObject);
+
+/*----------------------------------------------------------------------------
+  Magazine statistics
+  ----------------------------------------------------------------------------
+  The counters of the magazine layer of a concurrent pool.
+
+  acquires        - Number of objects acquired
+  acquireHits     - Acquires served from a magazine of the thread
+  releases        - Number of objects released
+  releaseHits     - Releases taken by a magazine of the thread
+  depotRequests   - Magazine exchanges asked of the depot
+  depotHits       - Exchanges the depot could make
+  depotFull       - Full magazines held by the depot
+  depotEmpty      - Empty magazines held by the depot
+  threads         - Threads holding a pair of magazines
+  ----------------------------------------------------------------------------*/
+
+typedef struct smartPoolMagazineStatistics {
+    unsigned long long acquires;
+    unsigned long long acquireHits;
+    unsigned long long releases;
+    unsigned long long releaseHits;
+
+    unsigned long long depotRequests;
+    unsigned long long depotHits;
+
+    unsigned long depotFull;
+    unsigned long depotEmpty;
+
+    unsigned long threads;
+} smartPoolMagazineStatistics;
+
+#ifndef SMART_POOL_H
+
+/*----------------------------------------------------------------------------
+  Abstracted Smart Pool object handle data types
+  ----------------------------------------------------------------------------*/
+
+typedef void * smartPoolHandle;
+
+#endif
+
+#endif
@@ -0,0 +1,1591 @@
+/*----------------------------------------------------------------------------
+  Smart Pool
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Pool test program implementation file
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Standard libraries
+  ----------------------------------------------------------------------------*/
+
+#include <ctype.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+
+/*----------------------------------------------------------------------------
+  Public data types
+  ----------------------------------------------------------------------------*/
+
+#include "compilation.t.h"
+#include "types.t.h"
+
+#include "smart.memory.t.h"
+#include "smart.pool.t.h"
+
+/*----------------------------------------------------------------------------
+  Public functions
+  ----------------------------------------------------------------------------*/
+
+#include "smart.memory.i.h"
+
+#include "smart.pool.i.h"
+
+/*----------------------------------------------------------------------------
+  Private defines, data types and function prototypes
+  ----------------------------------------------------------------------------*/
+
+#include "smart.pool.test.h"
+
+/*----------------------------------------------------------------------------
+  <Eeek> Globals </Eeek>
+  ----------------------------------------------------------------------------*/
+
+smartPoolHandle gPool;
+
+smartPoolHandle gConcurrentPool;
+smartPoolHandle gMagazinePool;
+smartPoolHandle gLockedPool;
+
+mtx_t gLockedPoolLock;
+
+void * gObjects[TEST_OBJECTS];
+
+unsigned long gConstructed;
+unsigned long gDestructed;
+
+smartPoolSlot gSlots[TEST_OBJECTS];
+smartPoolSlot gStaleSlots[TEST_OBJECTS];
+
+/*----------------------------------------------------------------------------
+  Main
+  ----------------------------------------------------------------------------*/
+
+void main
+(
+    void
+)
+{
+    int lOption;
+
+    srand(TEST_SEED);
+
+    SmartPoolConstructSmartPool(&gPool, TEST_OBJECT_SIZE, (size_t) 0, (size_t) 0);
+
+    do
+    {
+        printf("Option: ");
+
+        do
+        {
+            lOption = toupper(fgetc(stdin));
+        }
+        while (!isprint(lOption)); /* eat carriage returns (etc) */
+
+        switch ((char) lOption)
+        {
+            case '?':
+            {
+                DisplayOptions();
+                break;
+            }
+
+            case 'Q':
+            {
+                SmartPoolDestructSmartPool(&gPool);
+                break;
+            }
+
+            case 'P':
+            {
+                IteratedObjectPerformanceTest();
+                break;
+            }
+
+            case 'T':
+            {
+                IteratedRandomSelfTest();
+                break;
+            }
+
+            case 'M':
+            {
+                MemoryMaximumTest();
+                break;
+            }
+
+            case 'S':
+            {
+                IteratedRandomSlotTest();
+                break;
+            }
+
+            case 'B':
+            {
+                IteratedRandomBitmapTest();
+                break;
+            }
+
+            case 'F':
+            {
+                FileTest();
+                break;
+            }
+
+            case 'O':
+            {
+                ObjectCacheTest();
+                break;
+            }
+
+            case 'R':
+            {
+                TrimTest();
+                break;
+            }
+
+            case 'W':
+            {
+                WarmUpTest();
+                break;
+            }
+
+            case 'C':
+            {
+                ConcurrentScalingTest();
+                break;
+            }
+
+            case 'I':
+            {
+                OutputPoolInformation(stdout);
+                break;
+            }
+
+            default:
+            {
+                printf("Valid options are P,T,M,S,B,F,O,R,W,C,I,Q,?\n");
+                break;
+            }
+        }
+    }
+    while ('Q' != lOption);
+}
+
+void DisplayOptions
+(
+    void
+)
+{
+    printf("\n"
+           "Options:\n"
+           "(P) Iterated object acquire/release performance test (SafeMalloc vs pool)\n"
+           "(T) Iterated random thorough test\n"
+           "(M) Memory maximum test\n"
+           "(S) Iterated random slot pool test\n"
+           "(B) Iterated random bitmap pool test (walks and expiry)\n"
+           "(F) File pool test (build, remap and resume)\n"
+           "(O) Object cache test (initialize on acquire vs constructed objects)\n"
+           "(R) Trim policy test\n"
+           "(W) Warm up test (first acquire latency with and without reserving)\n"
+           "(C) Concurrent scaling test (mutex guarded vs lock free vs magazine pool)\n\n"
+           "(I) Display pool information\n\n"
+           "(Q) Quit\n"
+           "(?) Display this option list\n"
+           "\n");
+}
+
+void OutputPoolInformation
+(
+    FILE * pFile
+)
+{
+    fprintf(pFile, "Pool Valid = %s\n", SmartPoolIsValid(gPool) ? "Yes" : "No");
+    fprintf(pFile, "Object Size = %ld\n", SmartPoolGetObjectSize(gPool));
+    fprintf(pFile, "Object Count = %ld\n", SmartPoolGetObjectCount(gPool));
+    fprintf(pFile, "Memory Allocated = %ld\n\n", SmartPoolGetMemoryAllocated(gPool));
+}
+
+void IteratedObjectPerformanceTest
+(
+    void
+)
+{
+    unsigned long lIterations;
+    unsigned long lIteration;
+
+    double lMallocSeconds = 0, lPoolSeconds = 0;
+
+    printf("\n");
+    printf("Iterations: ");
+    scanf("%ld", &lIterations);
+
+    for (lIteration = 1; lIteration <= lIterations; lIteration++)
+    {
+        printf("Iteration : %ld ", lIteration);
+
+        lMallocSeconds += ObjectPass(NULL);
+
+        printf(">");
+
+        lPoolSeconds += ObjectPass(gPool);
+
+        printf("<");
+
+        printf("\r");
+    }
+
+    printf("\n\n");
+
+    printf("SafeMalloc Timer: %9.3f secs %12.0f objects/sec\n", lMallocSeconds, ((double) (lIterations * TEST_OBJECTS)) / lMallocSeconds);
+    printf("Pool Timer:       %9.3f secs %12.0f objects/sec\n", lPoolSeconds, ((double) (lIterations * TEST_OBJECTS)) / lPoolSeconds);
+    printf("\n");
+}
+
+double ObjectPass
+(
+    smartPoolHandle pPool
+)
+{
+    unsigned long lObjectIndex;
+    unsigned long lSwapIndex;
+
+    void * lSwap;
+
+    clock_t lStartTime;
+
+    memset(gObjects, 0, sizeof(gObjects));
+
+    lStartTime = clock();
+
+    for (lObjectIndex = 0; lObjectIndex < TEST_OBJECTS; lObjectIndex++)
+    {
+        if (NULL == pPool)
+        {
+            SafeMalloc(&gObjects[lObjectIndex], TEST_OBJECT_SIZE);
+        }
+        else
+        {
+            SmartPoolAcquire(pPool, &gObjects[lObjectIndex]);
+        }
+
+        * (long *) gObjects[lObjectIndex] = (long) lObjectIndex;
+    }
+
+    /*
+    ** release them in a shuffled order
+    */
+
+    for (lObjectIndex = TEST_OBJECTS - 1; 0 < lObjectIndex; lObjectIndex--)
+    {
+        lSwapIndex = rand() % (lObjectIndex + 1);
+
+        lSwap = gObjects[lObjectIndex]; gObjects[lObjectIndex] = gObjects[lSwapIndex]; gObjects[lSwapIndex] = lSwap;
+    }
+
+    for (lObjectIndex = 0; lObjectIndex < TEST_OBJECTS; lObjectIndex++)
+    {
+        if (NULL == pPool)
+        {
+            SafeFree(&gObjects[lObjectIndex]);
+        }
+        else
+        {
+            SmartPoolRelease(pPool, &gObjects[lObjectIndex]);
+        }
+    }
+
+    if (NULL != pPool && 0 != SmartPoolGetObjectCount(pPool))
+    {
+        printf("Object count disagreement: %ld objects remain\n", SmartPoolGetObjectCount(pPool));
+    }
+
+    return(((double) (clock() - lStartTime)) / CLOCKS_PER_SEC);
+}
+
+void IteratedRandomSelfTest
+(
+    void
+)
+{
+    unsigned long lIterations;
+    unsigned long lIteration;
+
+    unsigned long lIndex;
+    unsigned long lByte;
+
+    unsigned long lObjectCount = 0;
+
+    printf("\n");
+    printf("Iterations: ");
+    scanf("%ld", &lIterations);
+
+    memset(gObjects, 0, sizeof(gObjects));
+
+    for (lIteration = 1; lIteration <= lIterations; lIteration++)
+    {
+        printf("Iteration : %ld ", lIteration);
+
+        for (lIndex = 0; lIndex < TEST_OBJECTS; lIndex++)
+        {
+            /*
+            ** release and verify an object or acquire and fill an object
+            */
+
+            if (NULL != gObjects[lIndex] && 0 == rand() % 2)
+            {
+                for (lByte = 0; lByte < TEST_OBJECT_SIZE; lByte++)
+                {
+                    if ((unsigned char) (lIndex + lByte) != ((unsigned char *) gObjects[lIndex])[lByte])
+                    {
+                        printf("Object content disagreement: object %ld byte %ld\n", lIndex, lByte);
+                        break;
+                    }
+                }
+
+                if (!SmartPoolRelease(gPool, &gObjects[lIndex]))
+                {
+                    printf("Release failed: object %ld\n", lIndex);
+                }
+
+                lObjectCount--;
+            }
+            else if (NULL == gObjects[lIndex] && 0 == rand() % 2)
+            {
+                if (!SmartPoolAcquire(gPool, &gObjects[lIndex]))
+                {
+                    printf("Acquire failed: object %ld\n", lIndex);
+                    continue;
+                }
+
+                lObjectCount++;
+
+                for (lByte = 0; lByte < TEST_OBJECT_SIZE; lByte++)
+                {
+                    ((unsigned char *) gObjects[lIndex])[lByte] = (unsigned char) (lIndex + lByte);
+                }
+            }
+        }
+
+        if (!SmartPoolIsValid(gPool))
+        {
+            printf("Pool self validation failed.\n");
+        }
+
+        if (lObjectCount != SmartPoolGetObjectCount(gPool))
+        {
+            printf("Object count disagreement: %ld expected %ld counted\n", lObjectCount, SmartPoolGetObjectCount(gPool));
+        }
+
+        printf("\r");
+    }
+
+    for (lIndex = 0; lIndex < TEST_OBJECTS; lIndex++)
+    {
+        if (NULL != gObjects[lIndex])
+        {
+            SmartPoolRelease(gPool, &gObjects[lIndex]);
+        }
+    }
+
+    if (0 != SmartPoolGetObjectCount(gPool))
+    {
+        printf("Object count disagreement: %ld objects remain\n", SmartPoolGetObjectCount(gPool));
+    }
+
+    printf("\n\n");
+}
+
+void MemoryMaximumTest
+(
+    void
+)
+{
+    smartPoolHandle lPool = NULL;
+
+    void * lObject = NULL;
+
+    unsigned long lAcquired = 0;
+
+    unsigned long lIndex;
+
+    if (!SmartPoolConstructSmartPool(&lPool, TEST_OBJECT_SIZE, (size_t) 0, TEST_MEMORY_MAXIMUM))
+    {
+        printf("Pool construction failed.\n");
+        return;
+    }
+
+    memset(gObjects, 0, sizeof(gObjects));
+
+    /*
+    ** acquire until the budget refuses another chunk
+    */
+
+    for (lIndex = 0; lIndex < TEST_OBJECTS; lIndex++)
+    {
+        if (!SmartPoolAcquire(lPool, &gObjects[lIndex]))
+        {
+            break;
+        }
+
+        lAcquired++;
+    }
+
+    printf("\n");
+    printf("Objects Acquired = %ld\n", lAcquired);
+    printf("Memory Allocated = %ld of %ld\n", SmartPoolGetMemoryAllocated(lPool), TEST_MEMORY_MAXIMUM);
+
+    if (TEST_MEMORY_MAXIMUM < SmartPoolGetMemoryAllocated(lPool))
+    {
+        printf("Memory maximum exceeded.\n");
+    }
+
+    if (TEST_OBJECTS == lAcquired)
+    {
+        printf("Memory maximum not enforced.\n");
+    }
+
+    /*
+    ** a released object can be acquired again at the maximum
+    */
+
+    if (0 < lAcquired)
+    {
+        SmartPoolRelease(lPool, &gObjects[0]);
+
+        if (!SmartPoolAcquire(lPool, &lObject) || !SmartPoolRelease(lPool, &lObject))
+        {
+            printf("Reacquire at the memory maximum failed.\n");
+        }
+    }
+
+    if (!SmartPoolIsValid(lPool))
+    {
+        printf("Pool self validation failed.\n");
+    }
+
+    for (lIndex = 1; lIndex < lAcquired; lIndex++)
+    {
+        SmartPoolRelease(lPool, &gObjects[lIndex]);
+    }
+
+    SmartPoolDestructSmartPool(&lPool);
+
+    printf("\n");
+}
+
+void IteratedRandomSlotTest
+(
+    void
+)
+{
+    smartPoolHandle lPool = NULL;
+
+    unsigned long lIterations;
+    unsigned long lIteration;
+
+    unsigned long lIndex;
+    unsigned long lObjectCount = 0;
+
+    void * lObject;
+
+    printf("\n");
+    printf("Iterations: ");
+    scanf("%ld", &lIterations);
+
+    if (!SmartPoolConstructSlotSmartPool(&lPool, TEST_OBJECT_SIZE, (size_t) 0))
+    {
+        printf("Pool construction failed.\n");
+        return;
+    }
+
+    memset(gSlots, 0, sizeof(gSlots));
+    memset(gStaleSlots, 0, sizeof(gStaleSlots));
+
+    for (lIteration = 1; lIteration <= lIterations; lIteration++)
+    {
+        printf("Iteration : %ld ", lIteration);
+
+        for (lIndex = 0; lIndex < TEST_OBJECTS; lIndex++)
+        {
+            /*
+            ** release and verify an object, keeping its stale handle, or
+            ** acquire and stamp an object
+            */
+
+            if (SMART_POOL_NULL_SLOT != gSlots[lIndex] && 0 == rand() % 2)
+            {
+                lObject = SmartPoolSlotGetObject(lPool, gSlots[lIndex]);
+
+                if (NULL == lObject || lIndex != * (unsigned long *) lObject)
+                {
+                    printf("Object content disagreement: object %ld\n", lIndex);
+                }
+
+                gStaleSlots[lIndex] = gSlots[lIndex];
+
+                if (!SmartPoolSlotRelease(lPool, &gSlots[lIndex]))
+                {
+                    printf("Release failed: object %ld\n", lIndex);
+                }
+
+                lObjectCount--;
+            }
+            else if (SMART_POOL_NULL_SLOT == gSlots[lIndex] && 0 == rand() % 2)
+            {
+                if (!SmartPoolSlotAcquire(lPool, &gSlots[lIndex]))
+                {
+                    printf("Acquire failed: object %ld\n", lIndex);
+                    continue;
+                }
+
+                lObjectCount++;
+
+                * (unsigned long *) SmartPoolSlotGetObject(lPool, gSlots[lIndex]) = lIndex;
+            }
+
+            if (SMART_POOL_NULL_SLOT != gStaleSlots[lIndex] && (NULL != SmartPoolSlotGetObject(lPool, gStaleSlots[lIndex]) || SmartPoolSlotRelease(lPool, &gStaleSlots[lIndex])))
+            {
+                printf("Stale handle disagreement: object %ld\n", lIndex);
+            }
+        }
+
+        /*
+        ** every object of the dense array names the handle that refers to it
+        */
+
+        for (lIndex = 0; lIndex < SmartPoolGetObjectCount(lPool); lIndex++)
+        {
+            lObject = SmartPoolSlotGetObjectAt(lPool, lIndex);
+
+            if (gSlots[* (unsigned long *) lObject] != SmartPoolSlotGetSlotAt(lPool, lIndex))
+            {
+                printf("Dense array disagreement: position %ld\n", lIndex);
+                break;
+            }
+        }
+
+        if (!SmartPoolIsValid(lPool))
+        {
+            printf("Pool self validation failed.\n");
+        }
+
+        if (lObjectCount != SmartPoolGetObjectCount(lPool))
+        {
+            printf("Object count disagreement: %ld expected %ld counted\n", lObjectCount, SmartPoolGetObjectCount(lPool));
+        }
+
+        printf("\r");
+    }
+
+    printf("\n\n");
+    printf("Objects = %ld, handle bytes = %ld (pointer bytes = %ld)\n", lObjectCount, lObjectCount * sizeof(smartPoolSlot), lObjectCount * sizeof(void *));
+    printf("Memory Allocated = %ld\n\n", SmartPoolGetMemoryAllocated(lPool));
+
+    SmartPoolDestructSmartPool(&lPool);
+}
+
+void IteratedRandomBitmapTest
+(
+    void
+)
+{
+    smartPoolHandle lPool = NULL;
+
+    unsigned long lIterations;
+    unsigned long lIteration;
+
+    unsigned long lIndex;
+    unsigned long lObjectCount = 0;
+
+    testWalk lWalk;
+
+    clock_t lStartTime;
+
+    double lSeconds;
+
+    printf("\n");
+    printf("Iterations: ");
+    scanf("%ld", &lIterations);
+
+    if (!SmartPoolConstructBitmapSmartPool(&lPool, TEST_OBJECT_SIZE, (size_t) 0, (size_t) 0))
+    {
+        printf("Pool construction failed.\n");
+        return;
+    }
+
+    memset(gObjects, 0, sizeof(gObjects));
+
+    for (lIteration = 1; lIteration <= lIterations; lIteration++)
+    {
+        printf("Iteration : %ld ", lIteration);
+
+        for (lIndex = 0; lIndex < TEST_OBJECTS; lIndex++)
+        {
+            if (NULL != gObjects[lIndex] && 0 == rand() % 2)
+            {
+                if (lIndex != * (unsigned long *) gObjects[lIndex])
+                {
+                    printf("Object content disagreement: object %ld\n", lIndex);
+                }
+
+                if (!SmartPoolRelease(lPool, &gObjects[lIndex]))
+                {
+                    printf("Release failed: object %ld\n", lIndex);
+                }
+
+                lObjectCount--;
+            }
+            else if (NULL == gObjects[lIndex] && 0 == rand() % 2)
+            {
+                if (!SmartPoolAcquire(lPool, &gObjects[lIndex]))
+                {
+                    printf("Acquire failed: object %ld\n", lIndex);
+                    continue;
+                }
+
+                lObjectCount++;
+
+                * (unsigned long *) gObjects[lIndex] = lIndex;
+            }
+        }
+
+        /*
+        ** the walk visits every object in use once in address order, then
+        ** a second walk expires some of them as it goes
+        */
+
+        memset(&lWalk, 0, sizeof(lWalk));
+
+        lWalk.pool = lPool;
+        lWalk.ordered = TRUE;
+        lWalk.agreed = TRUE;
+
+        SmartPoolForEachObject(lPool, WalkObject, &lWalk);
+
+        if (lObjectCount != lWalk.visited || !lWalk.ordered || !lWalk.agreed)
+        {
+            printf("Walk disagreement: %ld expected %ld visited\n", lObjectCount, lWalk.visited);
+        }
+
+        memset(&lWalk, 0, sizeof(lWalk));
+
+        lWalk.pool = lPool;
+        lWalk.ordered = TRUE;
+        lWalk.agreed = TRUE;
+        lWalk.expireKey = lIteration % TEST_EXPIRE_PERIOD + 1;
+
+        SmartPoolForEachObject(lPool, WalkObject, &lWalk);
+
+        lObjectCount -= lWalk.expired;
+
+        if (!SmartPoolIsValid(lPool))
+        {
+            printf("Pool self validation failed.\n");
+        }
+
+        if (lObjectCount != SmartPoolGetObjectCount(lPool))
+        {
+            printf("Object count disagreement: %ld expected %ld counted\n", lObjectCount, SmartPoolGetObjectCount(lPool));
+        }
+
+        printf("\r");
+    }
+
+    /*
+    ** time walks of whatever is left in the pool
+    */
+
+    memset(&lWalk, 0, sizeof(lWalk));
+
+    lWalk.pool = lPool;
+
+    lStartTime = clock();
+
+    for (lIndex = 0; lIndex < TEST_WALKS; lIndex++)
+    {
+        SmartPoolForEachObject(lPool, WalkObject, &lWalk);
+    }
+
+    lSeconds = ((double) (clock() - lStartTime)) / CLOCKS_PER_SEC;
+
+    printf("\n\n");
+    printf("Objects = %ld, walked %12.0f objects/sec\n", lObjectCount, ((double) lWalk.visited) / lSeconds);
+    printf("Memory Allocated = %ld\n\n", SmartPoolGetMemoryAllocated(lPool));
+
+    for (lIndex = 0; lIndex < TEST_OBJECTS; lIndex++)
+    {
+        if (NULL != gObjects[lIndex])
+        {
+            SmartPoolRelease(lPool, &gObjects[lIndex]);
+        }
+    }
+
+    SmartPoolDestructSmartPool(&lPool);
+}
+
+Bool WalkObject
+(
+    void * pContext,
+    void * pObject
+)
+{
+    testWalk * lWalk = (testWalk *) pContext;
+
+    unsigned long lIndex = * (unsigned long *) pObject;
+
+    if (NULL != lWalk->previous && (char *) lWalk->previous >= (char *) pObject)
+    {
+        lWalk->ordered = FALSE;
+    }
+
+    if (TEST_OBJECTS <= lIndex || pObject != gObjects[lIndex])
+    {
+        lWalk->agreed = FALSE;
+
+        return(FALSE);
+    }
+
+    lWalk->previous = pObject;
+    lWalk->visited++;
+
+    /*
+    ** expire the object in hand, as a maintenance sweep would
+    */
+
+    if (0 != lWalk->expireKey && 0 == (lIndex + lWalk->expireKey) % TEST_EXPIRE_PERIOD)
+    {
+        if (!SmartPoolRelease(lWalk->pool, &gObjects[lIndex]))
+        {
+            printf("Release failed: object %ld\n", lIndex);
+        }
+
+        lWalk->expired++;
+    }
+
+    return(TRUE);
+}
+
+void FileTest
+(
+    void
+)
+{
+    smartPoolHandle lPool = NULL;
+
+    testFileObject * lObject = NULL;
+    testFileObject * lPrevious = NULL;
+
+    unsigned long lIndex;
+    unsigned long lCount;
+
+    clock_t lStartTime;
+
+    double lBuildSeconds;
+    double lMapSeconds;
+
+    remove(TEST_FILE);
+
+    /*
+    ** build a list of objects linked by offset, rooted in the header
+    */
+
+    lStartTime = clock();
+
+    if (!SmartPoolConstructFileSmartPool(&lPool, TEST_FILE, sizeof(testFileObject), (size_t) 0, TEST_FILE_SIZE))
+    {
+        printf("Pool construction failed.\n");
+        return;
+    }
+
+    for (lIndex = 0; lIndex < TEST_OBJECTS; lIndex++)
+    {
+        lObject = NULL;
+
+        if (!SmartPoolAcquire(lPool, (void **) &lObject))
+        {
+            printf("Acquire failed: object %ld\n", lIndex);
+            break;
+        }
+
+        lObject->next = SMART_POOL_NULL_OFFSET;
+        lObject->index = lIndex;
+
+        if (NULL == lPrevious)
+        {
+            SmartPoolFileSetRoot(lPool, SmartPoolFileGetOffset(lPool, lObject));
+        }
+        else
+        {
+            lPrevious->next = SmartPoolFileGetOffset(lPool, lObject);
+        }
+
+        lPrevious = lObject;
+    }
+
+    SmartPoolDestructSmartPool(&lPool);
+
+    lBuildSeconds = ((double) (clock() - lStartTime)) / CLOCKS_PER_SEC;
+
+    /*
+    ** map the file again and follow the list, then release every other
+    ** object and map it once more
+    */
+
+    lStartTime = clock();
+
+    if (!SmartPoolConstructFileSmartPool(&lPool, TEST_FILE, sizeof(testFileObject), (size_t) 0, TEST_FILE_SIZE))
+    {
+        printf("Pool reconstruction failed.\n");
+        return;
+    }
+
+    lMapSeconds = ((double) (clock() - lStartTime)) / CLOCKS_PER_SEC;
+
+    lCount = FileListCheck(lPool, 1);
+
+    if (TEST_OBJECTS != lCount || TEST_OBJECTS != SmartPoolGetObjectCount(lPool))
+    {
+        printf("Object count disagreement: %d expected %ld followed %ld counted\n", TEST_OBJECTS, lCount, SmartPoolGetObjectCount(lPool));
+    }
+
+    lObject = SmartPoolFileGetObject(lPool, SmartPoolFileGetRoot(lPool));
+
+    while (NULL != lObject)
+    {
+        lPrevious = lObject;
+
+        lObject = SmartPoolFileGetObject(lPool, lObject->next);
+
+        if (NULL == lObject)
+        {
+            break;
+        }
+
+        lPrevious->next = lObject->next;
+
+        SmartPoolRelease(lPool, (void **) &lObject);
+
+        lObject = SmartPoolFileGetObject(lPool, lPrevious->next);
+    }
+
+    if (!SmartPoolFileSync(lPool))
+    {
+        printf("Pool sync failed.\n");
+    }
+
+    SmartPoolDestructSmartPool(&lPool);
+
+    if (!SmartPoolConstructFileSmartPool(&lPool, TEST_FILE, sizeof(testFileObject), (size_t) 0, TEST_FILE_SIZE))
+    {
+        printf("Pool reconstruction failed.\n");
+        return;
+    }
+
+    lCount = FileListCheck(lPool, 2);
+
+    if ((TEST_OBJECTS + 1) / 2 != lCount || lCount != SmartPoolGetObjectCount(lPool))
+    {
+        printf("Object count disagreement: %d expected %ld followed %ld counted\n", (TEST_OBJECTS + 1) / 2, lCount, SmartPoolGetObjectCount(lPool));
+    }
+
+    /*
+    ** a pool of another shape must not take up the file
+    */
+
+    lObject = NULL;
+
+    if (SmartPoolConstructFileSmartPool((smartPoolHandle *) &lObject, TEST_FILE, 2 * sizeof(testFileObject), (size_t) 0, TEST_FILE_SIZE))
+    {
+        printf("Mismatched pool constructed.\n");
+    }
+
+    printf("\n");
+    printf("Build and write:  %9.3f secs\n", lBuildSeconds);
+    printf("Map and resume:   %9.3f secs (%ld objects)\n", lMapSeconds, SmartPoolGetObjectCount(lPool));
+    printf("Memory Allocated = %ld\n\n", SmartPoolGetMemoryAllocated(lPool));
+
+    SmartPoolDestructSmartPool(&lPool);
+
+    remove(TEST_FILE);
+}
+
+unsigned long FileListCheck
+(
+    smartPoolHandle pPool,
+    unsigned long pStep
+)
+{
+    testFileObject * lObject;
+
+    unsigned long lCount = 0;
+
+    if (!SmartPoolIsValid(pPool))
+    {
+        printf("Pool self validation failed.\n");
+    }
+
+    for (lObject = SmartPoolFileGetObject(pPool, SmartPoolFileGetRoot(pPool)); NULL != lObject; lObject = SmartPoolFileGetObject(pPool, lObject->next))
+    {
+        if (lCount * pStep != lObject->index)
+        {
+            printf("Object content disagreement: object %ld\n", lCount * pStep);
+            break;
+        }
+
+        lCount++;
+    }
+
+    return(lCount);
+}
+
+void ObjectCacheTest
+(
+    void
+)
+{
+    smartPoolHandle lPool = NULL;
+    smartPoolHandle lCache = NULL;
+
+    double lSeconds;
+    double lCachedSeconds;
+
+    if (!SmartPoolConstructSmartPool(&lPool, sizeof(testCachedObject), (size_t) 0, (size_t) 0) ||
+        !SmartPoolConstructSmartPool(&lCache, sizeof(testCachedObject), (size_t) 0, (size_t) 0) ||
+        !SmartPoolSetObjectCallbacks(lCache, CachedObjectConstruct, CachedObjectDestruct, NULL))
+    {
+        printf("Pool construction failed.\n");
+
+        SmartPoolDestructSmartPool(&lPool);
+        SmartPoolDestructSmartPool(&lCache);
+
+        return;
+    }
+
+    lSeconds = ObjectCachePass(lPool, FALSE);
+
+    gConstructed = 0;
+    gDestructed = 0;
+
+    lCachedSeconds = ObjectCachePass(lCache, TRUE);
+
+    printf("\n");
+    printf("Initialize on acquire: %9.3f secs %12.0f objects/sec\n", lSeconds, ((double) TEST_CACHE_ROUNDS * TEST_CACHE_OBJECTS) / lSeconds);
+    printf("Object cache:          %9.3f secs %12.0f objects/sec\n", lCachedSeconds, ((double) TEST_CACHE_ROUNDS * TEST_CACHE_OBJECTS) / lCachedSeconds);
+    printf("Constructed = %ld\n", gConstructed);
+
+    if (!SmartPoolIsValid(lCache))
+    {
+        printf("Pool self validation failed.\n");
+    }
+
+    /*
+    ** every object is released, so reclaiming destructs them all
+    */
+
+    SmartPoolReclaim(lCache);
+
+    printf("Destructed =  %ld\n", gDestructed);
+    printf("Memory Allocated = %ld\n\n", SmartPoolGetMemoryAllocated(lCache));
+
+    SmartPoolDestructSmartPool(&lPool);
+    SmartPoolDestructSmartPool(&lCache);
+
+    if (gConstructed != gDestructed || TEST_CACHE_OBJECTS > gConstructed || TEST_CACHE_OBJECTS + TEST_CACHE_OBJECTS / 10 < gConstructed)
+    {
+        printf("Constructor and destructor disagreement.\n\n");
+    }
+}
+
+double ObjectCachePass
+(
+    smartPoolHandle pPool,
+    Bool pCached
+)
+{
+    testCachedObject * lObject;
+
+    unsigned long lRound;
+    unsigned long lObjectIndex;
+    unsigned long lEntry;
+
+    clock_t lStartTime;
+
+    memset(gObjects, 0, sizeof(gObjects));
+
+    lStartTime = clock();
+
+    for (lRound = 0; lRound < TEST_CACHE_ROUNDS; lRound++)
+    {
+        for (lObjectIndex = 0; lObjectIndex < TEST_CACHE_OBJECTS; lObjectIndex++)
+        {
+            SmartPoolAcquire(pPool, &gObjects[lObjectIndex]);
+
+            lObject = (testCachedObject *) gObjects[lObjectIndex];
+
+            if (!pCached)
+            {
+                CachedObjectConstruct(NULL, lObject);
+            }
+
+            /*
+            ** a cached object must come back the way it was constructed
+            */
+
+            for (lEntry = 0; lEntry < TEST_CACHE_TABLE; lEntry++)
+            {
+                if (0 != lObject->table[lEntry])
+                {
+                    printf("Object content disagreement: object %ld entry %ld\n", lObjectIndex, lEntry);
+                    break;
+                }
+            }
+
+            lEntry = (lRound + lObjectIndex) % TEST_CACHE_TABLE;
+
+            lObject->table[lEntry] = lObjectIndex;
+            lObject->buffer[lEntry] = (unsigned char) lObjectIndex;
+        }
+
+        for (lObjectIndex = 0; lObjectIndex < TEST_CACHE_OBJECTS; lObjectIndex++)
+        {
+            lObject = (testCachedObject *) gObjects[lObjectIndex];
+
+            lObject->table[(lRound + lObjectIndex) % TEST_CACHE_TABLE] = 0;
+
+            if (!pCached)
+            {
+                CachedObjectDestruct(NULL, lObject);
+            }
+
+            SmartPoolRelease(pPool, &gObjects[lObjectIndex]);
+        }
+    }
+
+    return(((double) (clock() - lStartTime)) / CLOCKS_PER_SEC);
+}
+
+Bool CachedObjectConstruct
+(
+    void * pContext,
+    void * pObject
+)
+{
+    testCachedObject * lObject = (testCachedObject *) pObject;
+
+    (void) pContext;
+
+    lObject->buffer = NULL;
+
+    if (!SafeCalloc((void **) &lObject->buffer, TEST_CACHE_BUFFER))
+    {
+        return(FALSE);
+    }
+
+    memset(lObject->table, 0, sizeof(lObject->table));
+
+    gConstructed++;
+
+    return(TRUE);
+}
+
+void CachedObjectDestruct
+(
+    void * pContext,
+    void * pObject
+)
+{
+    testCachedObject * lObject = (testCachedObject *) pObject;
+
+    (void) pContext;
+
+    SafeFree((void **) &lObject->buffer);
+
+    gDestructed++;
+}
+
+void TrimTest
+(
+    void
+)
+{
+    smartPoolHandle lPool = NULL;
+    smartPoolHandle lLargePool = NULL;
+
+    if (!SmartPoolConstructSmartPool(&lPool, TEST_OBJECT_SIZE, (size_t) 0, (size_t) 0) ||
+        !SmartPoolConstructSmartPool(&lLargePool, TEST_OBJECT_SIZE, TEST_TRIM_LARGE, (size_t) 0))
+    {
+        printf("Pool construction failed.\n");
+
+        SmartPoolDestructSmartPool(&lPool);
+
+        return;
+    }
+
+    printf("\n");
+
+    TrimPass(lPool, "64K chunks (unmapped)");
+    TrimPass(lLargePool, "2M chunks (decommitted)");
+
+    SmartPoolDestructSmartPool(&lPool);
+    SmartPoolDestructSmartPool(&lLargePool);
+}
+
+void TrimPass
+(
+    smartPoolHandle pPool,
+    const char * pName
+)
+{
+    unsigned long lIndex;
+
+    size_t lBase = SmartPoolGetMemoryAllocated(pPool);
+    size_t lPeak;
+
+    struct timespec lIdle = {0, 2 * TEST_TRIM_IDLE * 1000000L};
+
+    printf("%s\n", pName);
+
+    /*
+    ** a spike followed by a full release keeps only the retained chunks
+    */
+
+    SmartPoolSetTrimPolicy(pPool, TEST_TRIM_RETAIN, 0);
+
+    memset(gObjects, 0, sizeof(gObjects));
+
+    for (lIndex = 0; lIndex < TEST_OBJECTS; lIndex++)
+    {
+        SmartPoolAcquire(pPool, &gObjects[lIndex]);
+    }
+
+    lPeak = SmartPoolGetMemoryAllocated(pPool);
+
+    for (lIndex = 0; lIndex < TEST_OBJECTS; lIndex++)
+    {
+        SmartPoolRelease(pPool, &gObjects[lIndex]);
+    }
+
+    printf("  Spike:     %10ld bytes, released to %10ld bytes (retaining %d chunks)\n", lPeak, SmartPoolGetMemoryAllocated(pPool), TEST_TRIM_RETAIN);
+
+    /*
+    ** with everything retained the chunks go once they have been idle
+    */
+
+    SmartPoolSetTrimPolicy(pPool, ULONG_MAX, TEST_TRIM_IDLE);
+
+    for (lIndex = 0; lIndex < TEST_OBJECTS; lIndex++)
+    {
+        SmartPoolAcquire(pPool, &gObjects[lIndex]);
+    }
+
+    for (lIndex = 0; lIndex < TEST_OBJECTS; lIndex++)
+    {
+        SmartPoolRelease(pPool, &gObjects[lIndex]);
+    }
+
+    printf("  Retained:  %10ld bytes\n", SmartPoolGetMemoryAllocated(pPool));
+
+    lPeak = SmartPoolGetMemoryAllocated(pPool);
+
+    thrd_sleep(&lIdle, NULL);
+
+    SmartPoolTick(pPool);
+
+    printf("  Idle:      %10ld bytes\n", SmartPoolGetMemoryAllocated(pPool));
+
+    if (SmartPoolGetMemoryAllocated(pPool) >= lPeak)
+    {
+        printf("Idle chunks were not trimmed: %ld bytes\n", SmartPoolGetMemoryAllocated(pPool));
+    }
+
+    /*
+    ** an explicit trim returns the rest, and the pool grows again after it
+    */
+
+    SmartPoolReclaim(pPool);
+
+    printf("  Reclaimed: %10ld bytes (control structure %ld bytes)\n", SmartPoolGetMemoryAllocated(pPool), lBase);
+
+    for (lIndex = 0; lIndex < TEST_OBJECTS; lIndex++)
+    {
+        if (!SmartPoolAcquire(pPool, &gObjects[lIndex]))
+        {
+            printf("Acquire after trim failed: object %ld\n", lIndex);
+            break;
+        }
+
+        * (unsigned long *) gObjects[lIndex] = lIndex;
+    }
+
+    for (lIndex = 0; lIndex < TEST_OBJECTS && NULL != gObjects[lIndex]; lIndex++)
+    {
+        if (lIndex != * (unsigned long *) gObjects[lIndex])
+        {
+            printf("Object content disagreement: object %ld\n", lIndex);
+        }
+
+        SmartPoolRelease(pPool, &gObjects[lIndex]);
+    }
+
+    if (!SmartPoolIsValid(pPool))
+    {
+        printf("Pool self validation failed.\n");
+    }
+
+    printf("\n");
+}
+
+void WarmUpTest
+(
+    void
+)
+{
+    printf("\n");
+    printf("                             Warm up    First %d acquires    Worst acquire\n", TEST_OBJECTS);
+
+    WarmUpPass("Cold",                  (size_t) 0,      FALSE, FALSE, FALSE);
+    WarmUpPass("Reserved",              (size_t) 0,      TRUE,  FALSE, FALSE);
+    WarmUpPass("Reserved and prefault", (size_t) 0,      TRUE,  TRUE,  FALSE);
+    WarmUpPass("2M chunks cold",        TEST_HUGE_CHUNK, FALSE, FALSE, TRUE);
+    WarmUpPass("2M chunks prefault",    TEST_HUGE_CHUNK, TRUE,  TRUE,  TRUE);
+
+    printf("\n");
+}
+
+void WarmUpPass
+(
+    const char * pName,
+    size_t pChunkSize,
+    Bool pReserve,
+    Bool pPrefault,
+    Bool pHugePages
+)
+{
+    smartPoolHandle lPool = NULL;
+
+    unsigned long lIndex;
+
+    struct timespec lStartTime;
+    struct timespec lAcquireTime;
+    struct timespec lEndTime;
+
+    double lWarmUpSeconds;
+    double lSeconds = 0;
+    double lWorstSeconds = 0;
+    double lAcquireSeconds;
+
+    if (!SmartPoolConstructSmartPool(&lPool, TEST_OBJECT_SIZE, pChunkSize, (size_t) 0))
+    {
+        printf("Pool construction failed.\n");
+
+        return;
+    }
+
+    /*
+    ** huge pages are only a hint, a kernel without them just runs slower
+    */
+
+    if (pHugePages && !SmartPoolSetHugePages(lPool, TRUE))
+    {
+        printf("Huge pages refused.\n");
+    }
+
+    memset(gObjects, 0, sizeof(gObjects));
+
+    timespec_get(&lStartTime, TIME_UTC);
+
+    if (pReserve && !SmartPoolReserve(lPool, TEST_OBJECTS, pPrefault))
+    {
+        printf("Reserve failed.\n");
+    }
+
+    timespec_get(&lEndTime, TIME_UTC);
+
+    lWarmUpSeconds = (double) (lEndTime.tv_sec - lStartTime.tv_sec) + ((double) (lEndTime.tv_nsec - lStartTime.tv_nsec)) / 1e9;
+
+    /*
+    ** each object is written as a caller would, which is when a cold page
+    ** takes its fault
+    */
+
+    for (lIndex = 0; lIndex < TEST_OBJECTS; lIndex++)
+    {
+        timespec_get(&lAcquireTime, TIME_UTC);
+
+        if (!SmartPoolAcquire(lPool, &gObjects[lIndex]))
+        {
+            printf("Acquire failed: object %ld\n", lIndex);
+            break;
+        }
+
+        memset(gObjects[lIndex], (int) lIndex, TEST_OBJECT_SIZE);
+
+        timespec_get(&lEndTime, TIME_UTC);
+
+        lAcquireSeconds = (double) (lEndTime.tv_sec - lAcquireTime.tv_sec) + ((double) (lEndTime.tv_nsec - lAcquireTime.tv_nsec)) / 1e9;
+
+        lSeconds += lAcquireSeconds;
+
+        if (lWorstSeconds < lAcquireSeconds)
+        {
+            lWorstSeconds = lAcquireSeconds;
+        }
+    }
+
+    printf("%-24s %9.3f ms %19.3f ms %13.1f us\n", pName, lWarmUpSeconds * 1e3, lSeconds * 1e3, lWorstSeconds * 1e6);
+
+    if (!SmartPoolIsValid(lPool))
+    {
+        printf("Pool self validation failed.\n");
+    }
+
+    for (lIndex = 0; lIndex < TEST_OBJECTS && NULL != gObjects[lIndex]; lIndex++)
+    {
+        SmartPoolRelease(lPool, &gObjects[lIndex]);
+    }
+
+    SmartPoolDestructSmartPool(&lPool);
+}
+
+void ConcurrentScalingTest
+(
+    void
+)
+{
+    static const char * lMethodNames[] = {"Mutex guarded pool", "Lock free pool", "Magazine pool"};
+
+    unsigned long lThreads;
+    unsigned long lThreadCount;
+
+    unsigned long lDisagreements = 0;
+
+    int lMethod;
+
+    double lSeconds[3];
+
+    smartPoolMagazineStatistics lStatistics;
+
+    printf("\n");
+    printf("Threads (maximum %d): ", TEST_THREADS);
+    scanf("%ld", &lThreads);
+
+    if (TEST_THREADS < lThreads)
+    {
+        lThreads = TEST_THREADS;
+    }
+
+    gConcurrentPool = NULL;
+    gMagazinePool = NULL;
+    gLockedPool = NULL;
+
+    if (!SmartPoolConstructConcurrentSmartPool(&gConcurrentPool, TEST_OBJECT_SIZE, (size_t) 0, (size_t) 0) ||
+        !SmartPoolConstructConcurrentSmartPool(&gMagazinePool, TEST_OBJECT_SIZE, (size_t) 0, (size_t) 0) ||
+        !SmartPoolSetMagazines(gMagazinePool, TEST_MAGAZINE_CAPACITY, TEST_DEPOT_MAXIMUM) ||
+        !SmartPoolConstructSmartPool(&gLockedPool, TEST_OBJECT_SIZE, (size_t) 0, (size_t) 0))
+    {
+        printf("Pool construction failed.\n");
+
+        SmartPoolDestructSmartPool(&gConcurrentPool);
+        SmartPoolDestructSmartPool(&gMagazinePool);
+
+        return;
+    }
+
+    mtx_init(&gLockedPoolLock, mtx_plain);
+
+    printf("\n%-8s", "Threads");
+
+    for (lMethod = 0; lMethod < 3; lMethod++)
+    {
+        printf(" %26s", lMethodNames[lMethod]);
+    }
+
+    printf(" %8s %8s\n", "Speedup", "Speedup");
+
+    for (lThreadCount = 1; lThreadCount <= lThreads; lThreadCount++)
+    {
+        printf("%-8ld", lThreadCount);
+
+        for (lMethod = 0; lMethod < 3; lMethod++)
+        {
+            lSeconds[lMethod] = ConcurrentPass(lMethod, lThreadCount, &lDisagreements);
+
+            printf(" %15.0f objects/sec", ((double) (lThreadCount * TEST_THREAD_ROUNDS * TEST_THREAD_OBJECTS)) / lSeconds[lMethod]);
+        }
+
+        printf(" %7.2fx %7.2fx\n", lSeconds[0] / lSeconds[1], lSeconds[0] / lSeconds[2]);
+    }
+
+    printf("\n");
+
+    if (0 != lDisagreements)
+    {
+        printf("Object content disagreement: %ld objects were handed out twice\n", lDisagreements);
+    }
+
+    /*
+    ** the exited threads left their objects with the depot
+    */
+
+    SmartPoolFlushMagazines(gMagazinePool);
+
+    if (!SmartPoolIsValid(gConcurrentPool) || !SmartPoolIsValid(gMagazinePool) || !SmartPoolIsValid(gLockedPool))
+    {
+        printf("Pool self validation failed.\n");
+    }
+
+    if (0 != SmartPoolGetObjectCount(gConcurrentPool) || 0 != SmartPoolGetObjectCount(gMagazinePool) || 0 != SmartPoolGetObjectCount(gLockedPool))
+    {
+        printf("Object count disagreement: %ld, %ld and %ld objects remain\n", SmartPoolGetObjectCount(gLockedPool), SmartPoolGetObjectCount(gConcurrentPool), SmartPoolGetObjectCount(gMagazinePool));
+    }
+
+    SmartPoolGetMagazineStatistics(gMagazinePool, &lStatistics);
+
+    printf("Magazine hit rate: %6.2f%% of %lld acquires, %6.2f%% of %lld releases\n", 100.0 * (double) lStatistics.acquireHits / (double) lStatistics.acquires, lStatistics.acquires, 100.0 * (double) lStatistics.releaseHits / (double) lStatistics.releases, lStatistics.releases);
+    printf("Depot hit rate:    %6.2f%% of %lld exchanges\n", 0 == lStatistics.depotRequests ? 0.0 : 100.0 * (double) lStatistics.depotHits / (double) lStatistics.depotRequests, lStatistics.depotRequests);
+    printf("Depot magazines:   %ld full, %ld empty\n", lStatistics.depotFull, lStatistics.depotEmpty);
+
+    printf("Lock free pool memory: %ld bytes\n", SmartPoolGetMemoryAllocated(gConcurrentPool));
+    printf("Magazine pool memory:  %ld bytes\n\n", SmartPoolGetMemoryAllocated(gMagazinePool));
+
+    mtx_destroy(&gLockedPoolLock);
+
+    SmartPoolDestructSmartPool(&gLockedPool);
+    SmartPoolDestructSmartPool(&gMagazinePool);
+    SmartPoolDestructSmartPool(&gConcurrentPool);
+}
+
+double ConcurrentPass
+(
+    int pMethod,
+    unsigned long pThreads,
+    unsigned long * pDisagreements
+)
+{
+    thrd_t lThreads[TEST_THREADS];
+
+    int lMethods[TEST_THREADS];
+
+    int lDisagreements;
+
+    unsigned long lThreadIndex;
+
+    struct timespec lStartTime;
+    struct timespec lEndTime;
+
+    timespec_get(&lStartTime, TIME_UTC);
+
+    for (lThreadIndex = 0; lThreadIndex < pThreads; lThreadIndex++)
+    {
+        lMethods[lThreadIndex] = pMethod;
+
+        thrd_create(&lThreads[lThreadIndex], ConcurrentWorker, &lMethods[lThreadIndex]);
+    }
+
+    for (lThreadIndex = 0; lThreadIndex < pThreads; lThreadIndex++)
+    {
+        thrd_join(lThreads[lThreadIndex], &lDisagreements);
+
+        *pDisagreements += (unsigned long) lDisagreements;
+    }
+
+    timespec_get(&lEndTime, TIME_UTC);
+
+    return((double) (lEndTime.tv_sec - lStartTime.tv_sec) + ((double) (lEndTime.tv_nsec - lStartTime.tv_nsec)) / 1e9);
+}
+
+int ConcurrentWorker
+(
+    void * pMethod
+)
+{
+    void * lObjects[TEST_THREAD_OBJECTS];
+
+    unsigned long lRound;
+    unsigned long lObjectIndex;
+
+    int lDisagreements = 0;
+
+    int lMethod = *((int *) pMethod);
+
+    memset(lObjects, 0, sizeof(lObjects));
+
+    for (lRound = 0; lRound < TEST_THREAD_ROUNDS; lRound++)
+    {
+        /*
+        ** stamp every object with its owner, an object handed to two threads
+        ** at once loses one of the stamps
+        */
+
+        for (lObjectIndex = 0; lObjectIndex < TEST_THREAD_OBJECTS; lObjectIndex++)
+        {
+            if (0 == lMethod)
+            {
+                mtx_lock(&gLockedPoolLock);
+                SmartPoolAcquire(gLockedPool, &lObjects[lObjectIndex]);
+                mtx_unlock(&gLockedPoolLock);
+            }
+            else
+            {
+                SmartPoolAcquire(1 == lMethod ? gConcurrentPool : gMagazinePool, &lObjects[lObjectIndex]);
+            }
+
+            * (void **) lObjects[lObjectIndex] = &lObjects[lObjectIndex];
+        }
+
+        for (lObjectIndex = 0; lObjectIndex < TEST_THREAD_OBJECTS; lObjectIndex++)
+        {
+            if (* (void **) lObjects[lObjectIndex] != &lObjects[lObjectIndex])
+            {
+                lDisagreements++;
+            }
+
+            if (0 == lMethod)
+            {
+                mtx_lock(&gLockedPoolLock);
+                SmartPoolRelease(gLockedPool, &lObjects[lObjectIndex]);
+                mtx_unlock(&gLockedPoolLock);
+            }
+            else
+            {
+                SmartPoolRelease(1 == lMethod ? gConcurrentPool : gMagazinePool, &lObjects[lObjectIndex]);
+            }
+        }
+    }
+
+    return(lDisagreements);
+}
@@ -0,0 +1,223 @@
+/*----------------------------------------------------------------------------
+  Smart Pool
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Pool test program header file
+  ----------------------------------------------------------------------------*/
+
+#ifndef SMART_POOL_TEST_H
+#define SMART_POOL_TEST_H
+
+#define TEST_OBJECTS 100000
+
+#define TEST_OBJECT_SIZE 72
+
+#define TEST_MEMORY_MAXIMUM ((size_t) 1024 * 1024)
+
+#define TEST_THREADS        16
+#define TEST_THREAD_OBJECTS 1000
+#define TEST_THREAD_ROUNDS  1000
+
+#define TEST_MAGAZINE_CAPACITY 64
+#define TEST_DEPOT_MAXIMUM     64
+
+#define TEST_CACHE_OBJECTS 1000
+#define TEST_CACHE_ROUNDS  1000
+#define TEST_CACHE_TABLE   64
+#define TEST_CACHE_BUFFER  1024
+
+#define TEST_TRIM_RETAIN     2
+#define TEST_TRIM_IDLE       50                                     /* milliseconds */
+#define TEST_TRIM_LARGE      ((size_t) 2 * 1024 * 1024)
+
+#define TEST_HUGE_CHUNK      ((size_t) 2 * 1024 * 1024)
+
+#define TEST_EXPIRE_PERIOD   8                                      /* a walk expires one object in eight */
+#define TEST_WALKS           100
+
+#define TEST_FILE            "smart.pool.test.file"
+#define TEST_FILE_SIZE       ((size_t) 64 * 1024 * 1024)
+
+#define TEST_SEED 1
+
+typedef struct testCachedObject {
+    unsigned char * buffer;
+
+    unsigned long table[TEST_CACHE_TABLE];
+} testCachedObject;
+
+typedef struct testFileObject {
+    smartPoolOffset next;                                           /* the objects form a list in the file */
+
+    unsigned long index;
+} testFileObject;
+
+typedef struct testWalk {
+    smartPoolHandle pool;
+
+    void * previous;                                                /* object visited last */
+
+    unsigned long visited;
+    unsigned long expired;
+    unsigned long expireKey;                                        /* zero walks without expiring */
+
+    Bool ordered;
+    Bool agreed;
+} testWalk;
+
+/*----------------------------------------------------------------------------
+  Private function prototypes
+  ----------------------------------------------------------------------------*/
+
+void DisplayOptions
+(
+    void
+);
+
+void OutputPoolInformation
+(
+    FILE * pFile
+);
+
+void IteratedObjectPerformanceTest
+(
+    void
+);
+
+double ObjectPass
+(
+    smartPoolHandle pPool
+);
+
+void IteratedRandomSelfTest
+(
+    void
+);
+
+void MemoryMaximumTest
+(
+    void
+);
+
+void IteratedRandomSlotTest
+(
+    void
+);
+
+void IteratedRandomBitmapTest
+(
+    void
+);
+
+Bool WalkObject
+(
+    void * pContext,
+    void * pObject
+);
+
+void FileTest
+(
+    void
+);
+
+unsigned long FileListCheck
+(
+    smartPoolHandle pPool,
+    unsigned long pStep
+);
+
+void ObjectCacheTest
+(
+    void
+);
+
+double ObjectCachePass
+(
+    smartPoolHandle pPool,
+    Bool pCached
+);
+
+Bool CachedObjectConstruct
+(
+    void * pContext,
+    void * pObject
+);
+
+void CachedObjectDestruct
+(
+    void * pContext,
+    void * pObject
+);
+
+void TrimTest
+(
+    void
+);
+
+void TrimPass
+(
+    smartPoolHandle pPool,
+    const char * pName
+);
+
+void WarmUpTest
+(
+    void
+);
+
+void WarmUpPass
+(
+    const char * pName,
+    size_t pChunkSize,
+    Bool pReserve,
+    Bool pPrefault,
+    Bool pHugePages
+);
+
+void ConcurrentScalingTest
+(
+    void
+);
+
+double ConcurrentPass
+(
+    int pMethod,
+    unsigned long pThreads,
+    unsigned long * pDisagreements
+);
+
+int ConcurrentWorker
+(
+    void * pMethod
+);
+
+#endif
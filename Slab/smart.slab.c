@@ -0,0 +1,555 @@
+/*----------------------------------------------------------------------------
+  Smart Slab
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Slab application programmer's interface (API) implementation file
+  ----------------------------------------------------------------------------*/
+
+#include <string.h>
+
+#include "compilation.t.h"
+#include "types.t.h"
+#include "smart.memory.t.h"
+#include "smart.memory.i.h"
+
+/*----------------------------------------------------------------------------
+  Private defines, data types and function prototypes
+  ----------------------------------------------------------------------------*/
+
+#include "smart.slab.h"
+
+/*----------------------------------------------------------------------------
+  Public function prototypes
+  ----------------------------------------------------------------------------*/
+
+#include "smart.slab.i.h"
+
+/*----------------------------------------------------------------------------
+  Public functions
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartSlabConstructSmartSlab
+(
+    smartSlabHandle * pSlab,
+    size_t pRunSize
+)
+{
+    unsigned int lClassIndex;
+
+    /*
+    ** there is no slab handle
+    */
+
+    if (NULL == pSlab)
+    {
+        return(FALSE);
+    }
+
+    if (0 == pRunSize)
+    {
+        pRunSize = SLAB_DEFAULT_RUN_SIZE;
+    }
+
+    pRunSize = (pRunSize + SafePageSize() - 1) & ~(SafePageSize() - 1);
+
+    /*
+    ** a run must hold at least one block of the largest size class
+    */
+
+    if (pRunSize < SLAB_RUN_HEADER_SIZE + SLAB_MAXIMUM_BLOCK_SIZE)
+    {
+        return(FALSE);
+    }
+
+    if (!SafeMalloc(pSlab, sizeof(smartSlab)))
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** initialize the allocator interface
+    */
+
+    (* pSlab)->allocator.allocate = SlabAllocate;
+    (* pSlab)->allocator.allocateZeroed = SlabAllocateZeroed;
+    (* pSlab)->allocator.allocateAligned = SlabAllocateAligned;
+    (* pSlab)->allocator.reallocate = SlabReallocate;
+    (* pSlab)->allocator.deallocate = SlabDeallocate;
+    (* pSlab)->allocator.context = *pSlab;
+
+    /*
+    ** initialize the size classes
+    */
+
+    for (lClassIndex = 0; lClassIndex < SLAB_CLASSES; lClassIndex++)
+    {
+        (* pSlab)->classes[lClassIndex].free = NULL;
+        (* pSlab)->classes[lClassIndex].blockSize = SLAB_MINIMUM_BLOCK_SIZE << lClassIndex;
+    }
+
+    (* pSlab)->runs = NULL;
+    (* pSlab)->runSize = pRunSize;
+
+    (* pSlab)->unused = NULL;
+    (* pSlab)->limit = NULL;
+
+    (* pSlab)->memoryAllocated = sizeof(smartSlab);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS smartAllocatorHandle CALLING_CONVENTION SmartSlabGetAllocator
+(
+    smartSlabHandle pSlab
+)
+{
+    /*
+    ** there is no slab
+    */
+
+    if (NULL == pSlab)
+    {
+        return(NULL);
+    }
+
+    return(&pSlab->allocator);
+}
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartSlabGetMemoryAllocated
+(
+    smartSlabHandle pSlab
+)
+{
+    /*
+    ** there is no slab
+    */
+
+    if (NULL == pSlab)
+    {
+        return(0);
+    }
+
+    return(pSlab->memoryAllocated);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartSlabDestructSmartSlab
+(
+    smartSlabHandle * pSlab
+)
+{
+    smartSlabRun * lRun;
+    smartSlabRun * lNextRun;
+
+    /*
+    ** there is no slab
+    */
+
+    if (NULL == pSlab || NULL == *pSlab)
+    {
+        return(TRUE);
+    }
+
+    /*
+    ** return the page runs to the operating system
+    */
+
+    for (lRun = (* pSlab)->runs; NULL != lRun; lRun = lNextRun)
+    {
+        lNextRun = lRun->next;
+
+        if (!SafePageFree(&lRun, (* pSlab)->runSize))
+        {
+            (* pSlab)->runs = lNextRun;
+
+            return(FALSE);
+        }
+    }
+
+    SafeFree(pSlab);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartSlabIsValid
+(
+    smartSlabHandle pSlab
+)
+{
+    smartSlabBlock * lBlock;
+
+    unsigned int lClassIndex;
+
+    /*
+    ** there is no slab
+    */
+
+    if (NULL == pSlab)
+    {
+        return(TRUE);
+    }
+
+    for (lClassIndex = 0; lClassIndex < SLAB_CLASSES; lClassIndex++)
+    {
+        for (lBlock = pSlab->classes[lClassIndex].free; NULL != lBlock; lBlock = lBlock->next)
+        {
+            if (0 != ((size_t) lBlock & (SLAB_MINIMUM_BLOCK_SIZE - 1)))
+            {
+                return(FALSE); // set breakpoint here for debugging
+            }
+
+            if (!SlabContains(pSlab, lBlock))
+            {
+                return(FALSE); // set breakpoint here for debugging
+            }
+        }
+    }
+
+    return(TRUE);
+}
+
+/*----------------------------------------------------------------------------
+  Private functions
+  ----------------------------------------------------------------------------*/
+
+static unsigned int SlabClassIndex
+(
+    size_t pSize
+)
+{
+    unsigned int lClassIndex = 0;
+
+    pSize = (pSize - 1) >> SLAB_MINIMUM_BLOCK_SHIFT;
+
+    while (0 != pSize)
+    {
+        pSize >>= 1;
+
+        lClassIndex++;
+    }
+
+    return(lClassIndex);
+}
+
+static void * SlabAllocate
+(
+    void * pContext,
+    size_t pSize
+)
+{
+    smartSlabHandle lSlab = (smartSlabHandle) pContext;
+    smartSlabClass * lClass;
+    smartSlabBlock * lBlock;
+
+    /*
+    ** large requests bypass the slab
+    */
+
+    if (SLAB_MAXIMUM_BLOCK_SIZE < pSize)
+    {
+        lBlock = NULL;
+
+        SafeMalloc(&lBlock, pSize);
+
+        return(lBlock);
+    }
+
+    lClass = &lSlab->classes[SlabClassIndex(pSize)];
+
+    /*
+    ** reuse a returned block
+    */
+
+    lBlock = lClass->free;
+
+    if (NULL != lBlock)
+    {
+        lClass->free = lBlock->next;
+
+        return(lBlock);
+    }
+
+    return(SlabCarve(lSlab, lClass->blockSize, SLAB_MINIMUM_BLOCK_SIZE));
+}
+
+static void * SlabAllocateZeroed
+(
+    void * pContext,
+    size_t pSize
+)
+{
+    void * lBlock = SlabAllocate(pContext, pSize);
+
+    if (NULL != lBlock)
+    {
+        memset(lBlock, 0, pSize);
+    }
+
+    return(lBlock);
+}
+
+static void * SlabAllocateAligned
+(
+    void * pContext,
+    size_t pSize,
+    size_t pAlignment
+)
+{
+    smartSlabHandle lSlab = (smartSlabHandle) pContext;
+    smartSlabClass * lClass;
+    smartSlabBlock * lBlock;
+
+    /*
+    ** large requests bypass the slab
+    */
+
+    if (SLAB_MAXIMUM_BLOCK_SIZE < pSize)
+    {
+        lBlock = NULL;
+
+#if defined _WIN32 || defined _WIN64
+
+        if (_Alignof(max_align_t) < pAlignment)
+        {
+            return(NULL);
+        }
+
+        SafeMalloc(&lBlock, pSize);
+
+#else
+
+        SafeAlignedMalloc(&lBlock, pSize, pAlignment);
+
+#endif
+
+        return(lBlock);
+    }
+
+    if (pAlignment <= SLAB_MINIMUM_BLOCK_SIZE)
+    {
+        return(SlabAllocate(pContext, pSize));
+    }
+
+    lClass = &lSlab->classes[SlabClassIndex(pSize)];
+
+    /*
+    ** reuse a returned block that is aligned
+    */
+
+    lBlock = lClass->free;
+
+    if (NULL != lBlock && 0 == ((size_t) lBlock & (pAlignment - 1)))
+    {
+        lClass->free = lBlock->next;
+
+        return(lBlock);
+    }
+
+    return(SlabCarve(lSlab, lClass->blockSize, pAlignment));
+}
+
+static void * SlabReallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pOldSize,
+    size_t pSize
+)
+{
+    void * lBlock;
+
+    if (NULL == pBuffer)
+    {
+        return(SlabAllocate(pContext, pSize));
+    }
+
+    /*
+    ** the block already has the capacity
+    */
+
+    if (SLAB_MAXIMUM_BLOCK_SIZE >= pOldSize && SLAB_MAXIMUM_BLOCK_SIZE >= pSize && SlabClassIndex(pOldSize) == SlabClassIndex(pSize))
+    {
+        return(pBuffer);
+    }
+
+    if (SLAB_MAXIMUM_BLOCK_SIZE < pOldSize && SLAB_MAXIMUM_BLOCK_SIZE < pSize)
+    {
+        if (!SafeRealloc(&pBuffer, pSize))
+        {
+            return(NULL);
+        }
+
+        return(pBuffer);
+    }
+
+    /*
+    ** move the block to another size class
+    */
+
+    lBlock = SlabAllocate(pContext, pSize);
+
+    if (NULL != lBlock)
+    {
+        memcpy(lBlock, pBuffer, (pOldSize < pSize) ? pOldSize : pSize);
+
+        SlabDeallocate(pContext, pBuffer, pOldSize);
+    }
+
+    return(lBlock);
+}
+
+static void SlabDeallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pSize
+)
+{
+    smartSlabHandle lSlab = (smartSlabHandle) pContext;
+    smartSlabClass * lClass;
+    smartSlabBlock * lBlock = (smartSlabBlock *) pBuffer;
+
+    if (SLAB_MAXIMUM_BLOCK_SIZE < pSize)
+    {
+        SafeFree(&pBuffer);
+
+        return;
+    }
+
+    lClass = &lSlab->classes[SlabClassIndex(pSize)];
+
+    lBlock->next = lClass->free;
+    lClass->free = lBlock;
+}
+
+static void * SlabCarve
+(
+    smartSlabHandle pSlab,
+    size_t pBlockSize,
+    size_t pAlignment
+)
+{
+    smartSlabRun * lRun = NULL;
+
+    size_t lPadding = (size_t) (0 - (size_t) pSlab->unused) & (pAlignment - 1);
+
+    void * lCarved;
+
+    if ((size_t) (pSlab->limit - pSlab->unused) < lPadding + pBlockSize)
+    {
+        /*
+        ** hand the tail of the exhausted run to the smaller size classes
+        */
+
+        SlabSpill(pSlab, (size_t) (pSlab->limit - pSlab->unused));
+
+        /*
+        ** map a new run
+        */
+
+        if (!SafePageAlloc(&lRun, pSlab->runSize, 0))
+        {
+            return(NULL);
+        }
+
+        lRun->next = pSlab->runs;
+        pSlab->runs = lRun;
+
+        pSlab->unused = (char *) lRun + SLAB_RUN_HEADER_SIZE;
+        pSlab->limit = (char *) lRun + pSlab->runSize;
+
+        pSlab->memoryAllocated += pSlab->runSize;
+
+        lPadding = (size_t) (0 - (size_t) pSlab->unused) & (pAlignment - 1);
+    }
+
+    /*
+    ** hand the gap before the aligned address to the smaller size classes
+    */
+
+    SlabSpill(pSlab, lPadding);
+
+    lCarved = pSlab->unused;
+
+    pSlab->unused += pBlockSize;
+
+    return(lCarved);
+}
+
+static void SlabSpill
+(
+    smartSlabHandle pSlab,
+    size_t pSize
+)
+{
+    smartSlabBlock * lBlock;
+
+    unsigned int lClassIndex;
+
+    /*
+    ** carve each class as many times as it fits so that a tail larger than
+    ** the biggest class is not stranded
+    */
+
+    for (lClassIndex = SLAB_CLASSES; 0 < pSize && 0 < lClassIndex--;)
+    {
+        while (pSlab->classes[lClassIndex].blockSize <= pSize)
+        {
+            lBlock = (smartSlabBlock *) pSlab->unused;
+
+            lBlock->next = pSlab->classes[lClassIndex].free;
+            pSlab->classes[lClassIndex].free = lBlock;
+
+            pSlab->unused += pSlab->classes[lClassIndex].blockSize;
+
+            pSize -= pSlab->classes[lClassIndex].blockSize;
+        }
+    }
+}
+
+static Bool SlabContains
+(
+    smartSlabHandle pSlab,
+    void * pBlock
+)
+{
+    smartSlabRun * lRun;
+
+    for (lRun = pSlab->runs; NULL != lRun; lRun = lRun->next)
+    {
+        if ((char *) pBlock >= (char *) lRun + SLAB_RUN_HEADER_SIZE && (char *) pBlock < (char *) lRun + pSlab->runSize)
+        {
+            return(TRUE);
+        }
+    }
+
+    return(FALSE);
+}
@@ -0,0 +1,298 @@
+/*----------------------------------------------------------------------------
+  Smart Slab
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Slab internal header file
+  ----------------------------------------------------------------------------*/
+
+#ifndef SMART_SLAB_H
+#define SMART_SLAB_H
+
+/*----------------------------------------------------------------------------
+  Private defines
+  ----------------------------------------------------------------------------*/
+
+#define SLAB_MINIMUM_BLOCK_SHIFT 4                                  /* 16 byte blocks */
+#define SLAB_MAXIMUM_BLOCK_SHIFT 8                                  /* 256 byte blocks */
+
+#define SLAB_MINIMUM_BLOCK_SIZE  ((size_t) 1 << SLAB_MINIMUM_BLOCK_SHIFT)
+#define SLAB_MAXIMUM_BLOCK_SIZE  ((size_t) 1 << SLAB_MAXIMUM_BLOCK_SHIFT)
+
+#define SLAB_CLASSES             (SLAB_MAXIMUM_BLOCK_SHIFT - SLAB_MINIMUM_BLOCK_SHIFT + 1)
+
+#define SLAB_DEFAULT_RUN_SIZE    ((size_t) 64 * 1024)
+
+/*----------------------------------------------------------------------------
+  Private data types
+  ----------------------------------------------------------------------------*/
+
+typedef struct smartSlabBlock {
+    struct smartSlabBlock * next;
+} smartSlabBlock;
+
+typedef struct smartSlabRun {
+    struct smartSlabRun * next;
+} smartSlabRun;
+
+#define SLAB_RUN_HEADER_SIZE ((sizeof(smartSlabRun) + SLAB_MINIMUM_BLOCK_SIZE - 1) & ~(SLAB_MINIMUM_BLOCK_SIZE - 1))
+
+typedef struct smartSlabClass {
+    smartSlabBlock * free;
+
+    size_t blockSize;
+} smartSlabClass;
+
+typedef struct smartSlab {
+    smartAllocator allocator;
+
+    smartSlabClass classes[SLAB_CLASSES];
+
+    smartSlabRun * runs;
+    size_t runSize;
+
+    char * unused;
+    char * limit;
+
+    size_t memoryAllocated;
+} smartSlab;
+
+typedef smartSlab * smartSlabHandle;
+
+/*----------------------------------------------------------------------------
+  Private function prototypes
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  SlabClassIndex()
+  ----------------------------------------------------------------------------
+  Map a request size onto the index of the smallest size class that holds it
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pSize - (I) The number of bytes requested (1 to SLAB_MAXIMUM_BLOCK_SIZE)
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  The size class index
+  ----------------------------------------------------------------------------*/
+
+static unsigned int SlabClassIndex
+(
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SlabAllocate()
+  ----------------------------------------------------------------------------
+  Take a block from the free list of its size class, carving a new block
+  from the current page run (mapping a new run when needed) when the free
+  list is empty. Requests larger than the largest size class are passed to
+  SafeMalloc().
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pContext - (I) The slab handle
+  pSize    - (I) The number of bytes requested
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  NULL - No memory was available
+
+  void * - The block
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Blocks are carved from a single page run shared by every size class so
+  that the objects of a node (e.g. a tree node, its key and its data) that
+  are constructed together are placed next to each other in memory.
+  ----------------------------------------------------------------------------*/
+
+static void * SlabAllocate
+(
+    void * pContext,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SlabAllocateZeroed()
+  ----------------------------------------------------------------------------
+  SlabAllocate() followed by zero filling the requested bytes
+  ----------------------------------------------------------------------------*/
+
+static void * SlabAllocateZeroed
+(
+    void * pContext,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SlabAllocateAligned()
+  ----------------------------------------------------------------------------
+  SlabAllocate() for a block whose address is a multiple of pAlignment. The
+  head of the free list of the size class is reused when it happens to be
+  aligned, otherwise the block is carved at the next aligned address of the
+  page run. Requests larger than the largest size class are passed to
+  SafeAlignedMalloc().
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pContext   - (I) The slab handle
+  pSize      - (I) The number of bytes requested, a multiple of pAlignment
+  pAlignment - (I) The required alignment, a power of two
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  NULL - No memory was available
+
+  void * - The block
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Because pSize is a multiple of pAlignment the size class of the block is
+  too, so the block is returned to the free list of its size class like any
+  other and a later aligned request may reuse it.
+
+  On Windows a large block with an alignment beyond that of SafeMalloc() is
+  refused, since SlabDeallocate() releases large blocks with SafeFree().
+  ----------------------------------------------------------------------------*/
+
+static void * SlabAllocateAligned
+(
+    void * pContext,
+    size_t pSize,
+    size_t pAlignment
+);
+
+/*----------------------------------------------------------------------------
+  SlabReallocate()
+  ----------------------------------------------------------------------------
+  Resize a block, keeping the block in place when the old and new sizes fall
+  into the same size class
+  ----------------------------------------------------------------------------*/
+
+static void * SlabReallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pOldSize,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SlabDeallocate()
+  ----------------------------------------------------------------------------
+  Return a block to the free list of its size class. The size class is
+  computed from the size passed, no per block header is consulted.
+  ----------------------------------------------------------------------------*/
+
+static void SlabDeallocate
+(
+    void * pContext,
+    void * pBuffer,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SlabCarve()
+  ----------------------------------------------------------------------------
+  Carve a block from the unused portion of the current page run, mapping a
+  new page run when the current one is exhausted
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pSlab      - (I) The slab handle
+  pBlockSize - (I) The size of the block to carve
+  pAlignment - (I) The alignment of the block, a power of two no greater
+                   than pBlockSize
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  NULL - A new page run could not be mapped
+
+  void * - The block
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The tail of an exhausted run that is too small for the request, and the
+  gap skipped to reach an aligned address, are handed to the free lists of
+  the smaller size classes rather than being wasted.
+  ----------------------------------------------------------------------------*/
+
+static void * SlabCarve
+(
+    smartSlabHandle pSlab,
+    size_t pBlockSize,
+    size_t pAlignment
+);
+
+/*----------------------------------------------------------------------------
+  SlabSpill()
+  ----------------------------------------------------------------------------
+  Hand bytes at the start of the unused portion of the current page run to
+  the free lists of the size classes, largest blocks first
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pSlab - (I) The slab handle
+  pSize - (I) The number of bytes, a multiple of SLAB_MINIMUM_BLOCK_SIZE
+  ----------------------------------------------------------------------------*/
+
+static void SlabSpill
+(
+    smartSlabHandle pSlab,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SlabContains()
+  ----------------------------------------------------------------------------
+  Determine whether a block lies within one of the page runs of the slab
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pSlab  - (I) The slab handle
+  pBlock - (I) The block
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The block lies within a page run
+
+  False - The block does not lie within a page run
+  ----------------------------------------------------------------------------*/
+
+static Bool SlabContains
+(
+    smartSlabHandle pSlab,
+    void * pBlock
+);
+
+#endif
@@ -0,0 +1,188 @@
+/*----------------------------------------------------------------------------
+  Smart Slab
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Slab application programmer's interface (API) header file
+  ----------------------------------------------------------------------------*/
+
+#ifndef SMART_SLAB_I_H
+#define SMART_SLAB_I_H
+
+/*----------------------------------------------------------------------------
+  SmartSlabConstructSmartSlab()
+  ----------------------------------------------------------------------------
+  Construct an empty size class slab allocator.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pSlab    - (I/O) Pointer to recieve the slab handle
+  pRunSize - (I)   The number of bytes in each page run (zero selects 64K)
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Slab was succesfully constructed
+
+  False - Slab was not successfully constructed due to:
+
+          1. The slab handle pointer was NULL
+          2. The run size was too small to hold a largest size class block
+          3. The SafeMalloc() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  This function requires the contents of the pSlab handle to be initialized
+  to NULL prior to calling this function.
+
+  Requests are rounded up to one of the 16, 32, 64, 128 or 256 byte size
+  classes. Blocks of every size class are carved from a contiguous page run
+  obtained with SafePageAlloc() and returned blocks are kept on a free list
+  per size class for reuse. Requests of more than 256 bytes are passed
+  through to SafeMalloc().
+
+  A slab is not thread safe, it is intended to be bound to a single tree or
+  stack (or a set of them used by one thread).
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartSlabConstructSmartSlab
+(
+    smartSlabHandle * pSlab,
+    size_t pRunSize
+);
+
+/*----------------------------------------------------------------------------
+  SmartSlabGetAllocator()
+  ----------------------------------------------------------------------------
+  Get the allocator interface of a slab.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pSlab - (I) Slab handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  NULL - There is no slab
+
+  smartAllocatorHandle - The allocator to pass to SmartAllocatorMalloc(),
+                         SmartAllocatorFree() or a container constructor
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The size passed to SmartAllocatorFree() selects the size class that the
+  block is returned to; it must be the size that was allocated.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS smartAllocatorHandle CALLING_CONVENTION SmartSlabGetAllocator
+(
+    smartSlabHandle pSlab
+);
+
+/*----------------------------------------------------------------------------
+  SmartSlabGetMemoryAllocated()
+  ----------------------------------------------------------------------------
+  Get the number of bytes mapped by a slab.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pSlab - (I) Slab handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  The number of bytes in the page runs and control structure of the slab
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Blocks passed through to SafeMalloc() are not included. The bytes
+  requested by the users of the slab continue to be tallied by the memory
+  management variables passed to SmartAllocatorMalloc() and
+  SmartAllocatorFree().
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartSlabGetMemoryAllocated
+(
+    smartSlabHandle pSlab
+);
+
+/*----------------------------------------------------------------------------
+  SmartSlabDestructSmartSlab()
+  ----------------------------------------------------------------------------
+  Destruct a slab, returning all of its page runs to the operating system.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pSlab - (I/O) Pointer to the slab handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Slab was succesfully destructed
+
+  False - Slab was not successfully destructed due to:
+
+          1. A SafePageFree() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Every block carved from the slab becomes invalid. Blocks of more than 256
+  bytes were passed through to SafeMalloc() and must be freed by their owner
+  before the slab is destructed.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartSlabDestructSmartSlab
+(
+    smartSlabHandle * pSlab
+);
+
+/*----------------------------------------------------------------------------
+  SmartSlabIsValid()
+  ----------------------------------------------------------------------------
+  Test every free block within a slab to assure that the structure is
+  correct.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pSlab - (I) Slab handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Slab passed the validity check
+
+  False - Slab did not pass the validity check due to one of the following:
+
+          1. A free block was not located within a page run of the slab
+          2. A free block was not aligned to the smallest size class
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartSlabIsValid
+(
+    smartSlabHandle pSlab
+);
+
+#endif
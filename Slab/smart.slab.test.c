@@ -0,0 +1,462 @@
+/*----------------------------------------------------------------------------
+  Smart Slab test application
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Slab test program implementation file
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Standard libraries
+  ----------------------------------------------------------------------------*/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*----------------------------------------------------------------------------
+  Public data types
+  ----------------------------------------------------------------------------*/
+
+#include "compilation.t.h"
+#include "types.t.h"
+
+#include "smart.memory.t.h"
+#include "smart.slab.t.h"
+
+/*----------------------------------------------------------------------------
+  Public functions
+  ----------------------------------------------------------------------------*/
+
+#include "smart.memory.i.h"
+
+#include "smart.slab.i.h"
+
+/*----------------------------------------------------------------------------
+  Private defines, data types and function prototypes
+  ----------------------------------------------------------------------------*/
+
+#include "smart.slab.test.h"
+
+/*----------------------------------------------------------------------------
+  <Eeek> Globals </Eeek>
+  ----------------------------------------------------------------------------*/
+
+smartSlabHandle gSlab;
+
+void * gNodes[TEST_NODES];
+void * gKeys[TEST_NODES];
+void * gData[TEST_NODES];
+
+size_t gSizes[TEST_NODES];
+size_t gAlignments[TEST_NODES];
+
+/*----------------------------------------------------------------------------
+  Main
+  ----------------------------------------------------------------------------*/
+
+void main
+(
+    void
+)
+{
+    int lOption;
+
+    srand(TEST_SEED);
+
+    SmartSlabConstructSmartSlab(&gSlab, (size_t) 0);
+
+    do
+    {
+        printf("Option: ");
+
+        do
+        {
+            lOption = toupper(fgetc(stdin));
+        }
+        while (!isprint(lOption)); /* eat carriage returns (etc) */
+
+        switch ((char) lOption)
+        {
+            case '?':
+            {
+                DisplayOptions();
+                break;
+            }
+
+            case 'Q':
+            {
+                SmartSlabDestructSmartSlab(&gSlab);
+                break;
+            }
+
+            case 'P':
+            {
+                IteratedNodePerformanceTest();
+                break;
+            }
+
+            case 'T':
+            {
+                IteratedRandomSelfTest();
+                break;
+            }
+
+            case 'A':
+            {
+                IteratedRandomAlignedTest();
+                break;
+            }
+
+            case 'I':
+            {
+                OutputSlabInformation(stdout);
+                break;
+            }
+
+            default:
+            {
+                printf("Valid options are P,T,A,I,Q,?\n");
+                break;
+            }
+        }
+    }
+    while ('Q' != lOption);
+}
+
+void DisplayOptions
+(
+    void
+)
+{
+    printf("\n"
+           "Options:\n"
+           "(P) Iterated node construction performance test (SmartMalloc vs slab)\n"
+           "(T) Iterated random thorough test\n"
+           "(A) Iterated random aligned allocation test\n\n"
+           "(I) Display slab information\n\n"
+           "(Q) Quit\n"
+           "(?) Display this option list\n"
+           "\n");
+}
+
+void OutputSlabInformation
+(
+    FILE * pFile
+)
+{
+    fprintf(pFile, "Slab Valid = %s\n", SmartSlabIsValid(gSlab) ? "Yes" : "No");
+    fprintf(pFile, "Memory Allocated = %ld\n\n", SmartSlabGetMemoryAllocated(gSlab));
+}
+
+void IteratedNodePerformanceTest
+(
+    void
+)
+{
+    unsigned long lIterations;
+    unsigned long lIteration;
+
+    double lMallocSeconds = 0, lSlabSeconds = 0;
+
+    printf("\n");
+    printf("Iterations: ");
+    scanf("%ld", &lIterations);
+
+    for (lIteration = 1; lIteration <= lIterations; lIteration++)
+    {
+        printf("Iteration : %ld ", lIteration);
+
+        lMallocSeconds += NodePass(NULL);
+
+        printf(">");
+
+        lSlabSeconds += NodePass(SmartSlabGetAllocator(gSlab));
+
+        printf("<");
+
+        printf("\r");
+    }
+
+    printf("\n\n");
+
+    printf("SmartMalloc Timer: %9.3f secs %12.0f nodes/sec\n", lMallocSeconds, ((double) (lIterations * TEST_NODES)) / lMallocSeconds);
+    printf("Slab Timer:        %9.3f secs %12.0f nodes/sec\n", lSlabSeconds, ((double) (lIterations * TEST_NODES)) / lSlabSeconds);
+    printf("\n");
+}
+
+double NodePass
+(
+    smartAllocatorHandle pAllocator
+)
+{
+    unsigned long lNodeIndex;
+    unsigned long lSwapIndex;
+
+    void * lSwap;
+
+    size_t lMemoryUsed = 0;
+
+    clock_t lStartTime;
+
+    memset(gNodes, 0, sizeof(gNodes));
+    memset(gKeys, 0, sizeof(gKeys));
+    memset(gData, 0, sizeof(gData));
+
+    lStartTime = clock();
+
+    /*
+    ** construct nodes the way SmartTreeConstructNode() does
+    */
+
+    for (lNodeIndex = 0; lNodeIndex < TEST_NODES; lNodeIndex++)
+    {
+        SmartAllocatorMalloc(pAllocator, &gNodes[lNodeIndex], NODE_ELEMENT_SIZE, &lMemoryUsed);
+        SmartAllocatorMalloc(pAllocator, &gKeys[lNodeIndex], KEY_ELEMENT_SIZE, &lMemoryUsed);
+        SmartAllocatorMalloc(pAllocator, &gData[lNodeIndex], DATA_ELEMENT_SIZE, &lMemoryUsed);
+
+        * (long *) gKeys[lNodeIndex] = (long) lNodeIndex;
+    }
+
+    /*
+    ** destruct them in a shuffled order
+    */
+
+    for (lNodeIndex = TEST_NODES - 1; 0 < lNodeIndex; lNodeIndex--)
+    {
+        lSwapIndex = rand() % (lNodeIndex + 1);
+
+        lSwap = gNodes[lNodeIndex]; gNodes[lNodeIndex] = gNodes[lSwapIndex]; gNodes[lSwapIndex] = lSwap;
+        lSwap = gKeys[lNodeIndex]; gKeys[lNodeIndex] = gKeys[lSwapIndex]; gKeys[lSwapIndex] = lSwap;
+        lSwap = gData[lNodeIndex]; gData[lNodeIndex] = gData[lSwapIndex]; gData[lSwapIndex] = lSwap;
+    }
+
+    for (lNodeIndex = 0; lNodeIndex < TEST_NODES; lNodeIndex++)
+    {
+        SmartAllocatorFree(pAllocator, &gData[lNodeIndex], DATA_ELEMENT_SIZE, &lMemoryUsed);
+        SmartAllocatorFree(pAllocator, &gKeys[lNodeIndex], KEY_ELEMENT_SIZE, &lMemoryUsed);
+        SmartAllocatorFree(pAllocator, &gNodes[lNodeIndex], NODE_ELEMENT_SIZE, &lMemoryUsed);
+    }
+
+    if (0 != lMemoryUsed)
+    {
+        printf("Memory accounting disagreement: %ld bytes remain\n", lMemoryUsed);
+    }
+
+    return(((double) (clock() - lStartTime)) / CLOCKS_PER_SEC);
+}
+
+void IteratedRandomSelfTest
+(
+    void
+)
+{
+    unsigned long lIterations;
+    unsigned long lIteration;
+
+    unsigned long lIndex;
+    unsigned long lByte;
+
+    size_t lMemoryUsed = 0;
+
+    smartAllocatorHandle lAllocator = SmartSlabGetAllocator(gSlab);
+
+    printf("\n");
+    printf("Iterations: ");
+    scanf("%ld", &lIterations);
+
+    memset(gNodes, 0, sizeof(gNodes));
+
+    for (lIteration = 1; lIteration <= lIterations; lIteration++)
+    {
+        printf("Iteration : %ld ", lIteration);
+
+        for (lIndex = 0; lIndex < TEST_NODES; lIndex++)
+        {
+            /*
+            ** free and verify a block or allocate and fill a block
+            */
+
+            if (NULL != gNodes[lIndex])
+            {
+                for (lByte = 0; lByte < gSizes[lIndex]; lByte++)
+                {
+                    if ((unsigned char) (lIndex + lByte) != ((unsigned char *) gNodes[lIndex])[lByte])
+                    {
+                        printf("Block content disagreement: block %ld byte %ld\n", lIndex, lByte);
+                        break;
+                    }
+                }
+
+                SmartAllocatorFree(lAllocator, &gNodes[lIndex], gSizes[lIndex], &lMemoryUsed);
+            }
+
+            if (0 == rand() % 2)
+            {
+                gSizes[lIndex] = (size_t) (1 + rand() % TEST_MAXIMUM_BLOCK_SIZE);
+
+                if (!SmartAllocatorMalloc(lAllocator, &gNodes[lIndex], gSizes[lIndex], &lMemoryUsed))
+                {
+                    printf("Allocation failed: block %ld\n", lIndex);
+                    continue;
+                }
+
+                for (lByte = 0; lByte < gSizes[lIndex]; lByte++)
+                {
+                    ((unsigned char *) gNodes[lIndex])[lByte] = (unsigned char) (lIndex + lByte);
+                }
+            }
+        }
+
+        if (!SmartSlabIsValid(gSlab))
+        {
+            printf("Slab self validation failed.\n");
+        }
+
+        printf("\r");
+    }
+
+    for (lIndex = 0; lIndex < TEST_NODES; lIndex++)
+    {
+        if (NULL != gNodes[lIndex])
+        {
+            SmartAllocatorFree(lAllocator, &gNodes[lIndex], gSizes[lIndex], &lMemoryUsed);
+        }
+    }
+
+    if (0 != lMemoryUsed)
+    {
+        printf("Memory accounting disagreement: %ld bytes remain\n", lMemoryUsed);
+    }
+
+    printf("\n\n");
+}
+
+void IteratedRandomAlignedTest
+(
+    void
+)
+{
+    unsigned long lIterations;
+    unsigned long lIteration;
+
+    unsigned long lIndex;
+    unsigned long lByte;
+
+    size_t lMemoryUsed = 0;
+
+    smartAllocatorHandle lAllocator = SmartSlabGetAllocator(gSlab);
+
+    printf("\n");
+    printf("Iterations: ");
+    scanf("%ld", &lIterations);
+
+    memset(gNodes, 0, sizeof(gNodes));
+
+    for (lIteration = 1; lIteration <= lIterations; lIteration++)
+    {
+        printf("Iteration : %ld ", lIteration);
+
+        for (lIndex = 0; lIndex < TEST_NODES; lIndex++)
+        {
+            /*
+            ** free and verify a block or allocate, check and fill a block
+            ** aligned to a random power of two
+            */
+
+            if (NULL != gNodes[lIndex])
+            {
+                for (lByte = 0; lByte < gSizes[lIndex]; lByte++)
+                {
+                    if ((unsigned char) (lIndex + lByte) != ((unsigned char *) gNodes[lIndex])[lByte])
+                    {
+                        printf("Block content disagreement: block %ld byte %ld\n", lIndex, lByte);
+                        break;
+                    }
+                }
+
+                SafeAllocatorAlignedFree(lAllocator, &gNodes[lIndex], gSizes[lIndex], gAlignments[lIndex]);
+
+                lMemoryUsed -= gSizes[lIndex];
+            }
+
+            if (0 == rand() % 2)
+            {
+                gSizes[lIndex] = (size_t) (1 + rand() % TEST_MAXIMUM_BLOCK_SIZE);
+                gAlignments[lIndex] = (size_t) 1 << (rand() % (TEST_MAXIMUM_ALIGNMENT_SHIFT + 1));
+
+                if (!SafeAllocatorAlignedMalloc(lAllocator, &gNodes[lIndex], gSizes[lIndex], gAlignments[lIndex]))
+                {
+                    printf("Allocation failed: block %ld\n", lIndex);
+                    continue;
+                }
+
+                lMemoryUsed += gSizes[lIndex];
+
+                if (0 != ((size_t) gNodes[lIndex] & (gAlignments[lIndex] - 1)))
+                {
+                    printf("Alignment disagreement: block %ld is not aligned to %ld\n", lIndex, gAlignments[lIndex]);
+                }
+
+                for (lByte = 0; lByte < gSizes[lIndex]; lByte++)
+                {
+                    ((unsigned char *) gNodes[lIndex])[lByte] = (unsigned char) (lIndex + lByte);
+                }
+            }
+        }
+
+        if (!SmartSlabIsValid(gSlab))
+        {
+            printf("Slab self validation failed.\n");
+        }
+
+        printf("\r");
+    }
+
+    for (lIndex = 0; lIndex < TEST_NODES; lIndex++)
+    {
+        if (NULL != gNodes[lIndex])
+        {
+            SafeAllocatorAlignedFree(lAllocator, &gNodes[lIndex], gSizes[lIndex], gAlignments[lIndex]);
+
+            lMemoryUsed -= gSizes[lIndex];
+        }
+    }
+
+    if (0 != lMemoryUsed)
+    {
+        printf("Memory accounting disagreement: %ld bytes remain\n", lMemoryUsed);
+    }
+
+    printf("\n\n");
+}
@@ -36,6 +36,7 @@
 
 #include "compilation.t.h"
 #include "types.t.h"
+#include "smart.memory.t.h"
 #include "smart.memory.i.h"
 
 /*----------------------------------------------------------------------------
@@ -59,6 +60,27 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackConstructSmartStack
     smartStackHandle * pStack,
 	size_t pMemoryMaximum
 )
+{
+	return(SmartStackConstructSmartStackWithAllocator(pStack, pMemoryMaximum, NULL));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartStackConstructSmartStackWithAllocator
+(
+    smartStackHandle * pStack,
+	size_t pMemoryMaximum,
+	smartAllocatorHandle pAllocator
+)
+{
+	return(SmartStackConstructSmartStackWithBudget(pStack, pMemoryMaximum, NULL, pAllocator));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartStackConstructSmartStackWithBudget
+(
+    smartStackHandle * pStack,
+	size_t pMemoryMaximum,
+	smartBudgetHandle pBudget,
+	smartAllocatorHandle pAllocator
+)
 {
     /*
     ** there is no stack handle
@@ -73,7 +95,7 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackConstructSmartStack
 	** construct the stack
 	*/
 
-    if (!SafeMalloc(pStack, sizeof(smartStack)))
+    if (!SafeAllocatorMalloc(pAllocator, (void **) pStack, sizeof(smartStack)))
 	{
 		return(FALSE);
 	}
@@ -82,11 +104,23 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackConstructSmartStack
 	** initialize the stack control structure
 	*/
 
+    (* pStack)->allocator = pAllocator;
+
     (* pStack)->top = NULL;
     (* pStack)->bottom = NULL;
 
-	(* pStack)->memoryMaximum = pMemoryMaximum;
-	(* pStack)->memoryAllocated = sizeof(smartStack);
+	(* pStack)->budget = NULL;
+
+	if (!SmartBudgetConstructSmartBudgetWithAllocator(&(* pStack)->budget, pMemoryMaximum, pBudget, pAllocator) || !SmartBudgetReserve((* pStack)->budget, sizeof(smartStack)))
+	{
+		SmartBudgetDestructSmartBudget(&(* pStack)->budget);
+
+		SafeAllocatorFree(pAllocator, (void **) pStack, sizeof(smartStack));
+
+		return(FALSE);
+	}
+
+    (* pStack)->nodeAlignment = 0;
 
     (* pStack)->depth = 0;
 
@@ -121,7 +155,12 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackConstructNode
         return(FALSE);
     }
 
-	if (pStack->memoryMaximum > 0 && pStack->memoryMaximum < pStack->memoryAllocated + sizeof(smartStackNode) + pDataSize)
+	/*
+	** reserve the memory for the node and data object at once so that
+	** concurrent constructors cannot take the stack over its maximum
+	*/
+
+	if (!SmartBudgetReserve(pStack->budget, sizeof(smartStackNode) + pDataSize))
 	{
 		return(FALSE);
 	}
@@ -130,8 +169,10 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackConstructNode
 	** allocate memory for the node
 	*/
 
-    if (!SmartMalloc(pNode, sizeof(smartStackNode), &pStack->memoryAllocated))
+    if (!SafeAllocatorMalloc(pStack->allocator, (void **) pNode, sizeof(smartStackNode)))
 	{
+		SmartBudgetRelease(pStack->budget, sizeof(smartStackNode) + pDataSize);
+
 		return(FALSE);
 	}
 
@@ -139,9 +180,11 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackConstructNode
 	** allocate memory for the data object
 	*/
 
-	if (!SmartMalloc(&lData, pDataSize, &pStack->memoryAllocated))
+	if (!SafeAllocatorAlignedMalloc(pStack->allocator, &lData, pDataSize, pStack->nodeAlignment))
 	{
-		SmartFree(pNode, sizeof(smartStackNode), &pStack->memoryAllocated);
+		SafeAllocatorFree(pStack->allocator, (void **) pNode, sizeof(smartStackNode));
+
+		SmartBudgetRelease(pStack->budget, sizeof(smartStackNode) + pDataSize);
 
 		return(FALSE);
 	}
@@ -313,9 +356,10 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackSplit
 )
 {
     smartStackNodeHandle lNode;
-    smartStackNodeHandle lTopStackBottomNode;
+    smartStackNodeHandle lTopStackBottomNode = NULL;
 
 	size_t lTopAllocated = 0;
+	size_t lBottomAllocated;
 
 	unsigned long lTopDepth;
 	unsigned long lNodeIndex;
@@ -348,7 +392,7 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackSplit
 	{
 		for (lNodeIndex = 0; pNode != lNode; lNodeIndex++)
 		{
-			lTopAllocated += lNode->dataSize;
+			lTopAllocated += sizeof(smartStackNode) + lNode->dataSize;
 
 			lTopStackBottomNode = lNode;
 
@@ -368,7 +412,7 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackSplit
 
 		for (lNodeIndex = 0; lTopDepth > lNodeIndex; lNodeIndex++)
 		{
-			lTopAllocated += lNode->dataSize;
+			lTopAllocated += sizeof(smartStackNode) + lNode->dataSize;
 
 			lTopStackBottomNode = lNode;
 
@@ -376,25 +420,47 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackSplit
 		}
 	}
 
-	SmartStackConstructSmartStack(pBottomStack, pTopStack->memoryMaximum);
+	/*
+	** move the charge for the nodes below the split point to the bottom stack
+	*/
+
+	lBottomAllocated = SmartBudgetGetValue(pTopStack->budget) - sizeof(smartStack) - lTopAllocated;
+
+	if (!SmartStackConstructSmartStackWithBudget(pBottomStack, SmartBudgetGetMaximum(pTopStack->budget), SmartBudgetGetParent(pTopStack->budget), pTopStack->allocator))
+	{
+		return(FALSE);
+	}
+
+	if (!SmartBudgetTransfer(pTopStack->budget, (* pBottomStack)->budget, lBottomAllocated))
+	{
+		SmartStackDestructSmartStack(pBottomStack);
+
+		return(FALSE);
+	}
+
+	(* pBottomStack)->nodeAlignment = pTopStack->nodeAlignment;
 
 	(* pBottomStack)->top = lNode;
 	(* pBottomStack)->bottom = pTopStack->bottom;
 	(* pBottomStack)->depth = pTopStack->depth - lTopDepth;
-	(* pBottomStack)->memoryAllocated = pTopStack->memoryAllocated - lTopAllocated;
 
-	if (pTopStack->top = pNode)
+	/*
+	** detach the bottom stack from the nodes left on the top stack
+	*/
+
+	if (pTopStack->top == lNode)
 	{
 		pTopStack->top = NULL;
 		pTopStack->bottom = NULL;
 	}
 	else
 	{
+		lTopStackBottomNode->below = NULL;
+
 		pTopStack->bottom = lTopStackBottomNode;
 	}
 
 	pTopStack->depth = lTopDepth;
-	pTopStack->memoryAllocated = lTopAllocated;
 
 	return(TRUE);
 }
@@ -405,6 +471,8 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackSplice
     smartStackHandle * pBottomStack
 )
 {
+	size_t lBottomAllocated;
+
     /*
     ** there is no top stack
     */
@@ -423,11 +491,31 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackSplice
 		return(FALSE);
 	}
 
+	/*
+	** the nodes of the bottom stack would be released with the wrong alignment
+	*/
+
+	if (pTopStack->nodeAlignment != (* pBottomStack)->nodeAlignment)
+	{
+		return(FALSE);
+	}
+
+	/*
+	** the nodes of the bottom stack would be released by the wrong allocator
+	*/
+
+	if (pTopStack->allocator != (* pBottomStack)->allocator)
+	{
+		return(FALSE);
+	}
+
 	/*
 	** the top stack cannot grow to accomodate the addition of the bottom stack
 	*/
 
-	if (pTopStack->memoryMaximum < pTopStack->memoryAllocated + (* pBottomStack)->memoryAllocated - sizeof(smartStack))
+	lBottomAllocated = SmartBudgetGetValue((* pBottomStack)->budget) - sizeof(smartStack);
+
+	if (!SmartBudgetTransfer((* pBottomStack)->budget, pTopStack->budget, lBottomAllocated))
 	{
 		return(FALSE);
 	}
@@ -436,13 +524,22 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackSplice
 	** attach the bottom stack to the top stack
 	*/
 
-    pTopStack->bottom->below = (* pBottomStack)->top;
-
-	(* pBottomStack)->top = NULL;
+	if (NULL == pTopStack->top)
+	{
+		pTopStack->top = (* pBottomStack)->top;
+	}
+	else
+	{
+		pTopStack->bottom->below = (* pBottomStack)->top;
+	}
 
-    pTopStack->memoryAllocated += (* pBottomStack)->memoryAllocated - sizeof(smartStack);
+	if (NULL != (* pBottomStack)->bottom)
+	{
+		pTopStack->bottom = (* pBottomStack)->bottom;
+	}
 
-	(* pBottomStack)->memoryAllocated = 0;
+	(* pBottomStack)->top = NULL;
+	(* pBottomStack)->bottom = NULL;
 
     pTopStack->depth += (* pBottomStack)->depth;
 
@@ -463,6 +560,8 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackDestructNode
     smartStackNodeHandle * pNode
 )
 {
+	size_t lNodeSize;
+
     /*
     ** there is no stack
     */
@@ -485,17 +584,19 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackDestructNode
 	** destruct the data and node
 	*/
 
-	if (!SmartFree(&(* pNode)->data, (* pNode)->dataSize, &pStack->memoryAllocated))
+	lNodeSize = sizeof(smartStackNode) + (* pNode)->dataSize;
+
+	if (!SafeAllocatorAlignedFree(pStack->allocator, &(* pNode)->data, (* pNode)->dataSize, pStack->nodeAlignment))
 	{
 		return(FALSE);
 	}
 
-	if (!SmartFree(pNode, sizeof(smartStackNode), &pStack->memoryAllocated))
+	if (!SafeAllocatorFree(pStack->allocator, (void **) pNode, sizeof(smartStackNode)))
 	{
 		return(FALSE);
 	}
 
-	return(TRUE);
+	return(SmartBudgetRelease(pStack->budget, lNodeSize));
 }
 
 STORAGE_CLASS Bool CALLING_CONVENTION SmartStackDestructSmartStack
@@ -516,24 +617,30 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackDestructSmartStack
 	}
 
 	/*
-	** destruct all of the nodes in the stack
+	** destruct all of the nodes in the stack (nodes allocated from a region
+	** are released with the region)
 	*/
 
-	for (lNode = (* pStack)->top; NULL != lNode; lNode = lBelowNode)
-    {
-        lBelowNode = lNode->below;
-
-		if (!SmartStackDestructNode(*pStack, &lNode))
+	if (NULL == (* pStack)->allocator || NULL != (* pStack)->allocator->deallocate)
+	{
+		for (lNode = (* pStack)->top; NULL != lNode; lNode = lBelowNode)
 		{
-			return(FALSE);
+			lBelowNode = lNode->below;
+
+			if (!SmartStackDestructNode(*pStack, &lNode))
+			{
+				return(FALSE);
+			}
 		}
-    }
+	}
 
 	/*
 	** destruct the stack control structure
 	*/
 
-    SafeFree(pStack);
+    SmartBudgetDestructSmartBudget(&(* pStack)->budget);
+
+    SafeAllocatorFree((* pStack)->allocator, (void **) pStack, sizeof(smartStack));
 
 	return(TRUE);
 }
@@ -555,6 +662,59 @@ STORAGE_CLASS unsigned long CALLING_CONVENTION SmartStackGetDepth
     return(pStack->depth);
 }
 
+STORAGE_CLASS Bool CALLING_CONVENTION SmartStackSetPressureFunction
+(
+    smartStackHandle pStack,
+	smartPressureFunction pPressureFunction,
+	void * pContext
+)
+{
+    /*
+    ** there is no stack
+    */
+
+    if (NULL == pStack)
+    {
+        return(FALSE);
+    }
+
+    return(SmartBudgetSetPressureFunction(pStack->budget, pPressureFunction, pContext));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartStackSetNodeAlignment
+(
+    smartStackHandle pStack,
+	size_t pAlignment
+)
+{
+    /*
+    ** there is no stack
+    */
+
+    if (NULL == pStack)
+    {
+        return(FALSE);
+    }
+
+	if (0 != (pAlignment & (pAlignment - 1)))
+	{
+		return(FALSE);
+	}
+
+	/*
+	** nodes already constructed were allocated with the old alignment
+	*/
+
+	if (NULL != pStack->top || sizeof(smartStack) != SmartBudgetGetValue(pStack->budget))
+	{
+		return(FALSE);
+	}
+
+    pStack->nodeAlignment = pAlignment;
+
+    return(TRUE);
+}
+
 STORAGE_CLASS size_t CALLING_CONVENTION SmartStackGetMemoryAllocated
 (
     smartStackHandle pStack
@@ -569,7 +729,7 @@ STORAGE_CLASS size_t CALLING_CONVENTION SmartStackGetMemoryAllocated
         return(0);
     }
 
-    return(pStack->memoryAllocated);
+    return(SmartBudgetGetValue(pStack->budget));
 }
 
 STORAGE_CLASS Bool CALLING_CONVENTION SmartStackIsValid
@@ -62,8 +62,11 @@ typedef struct smartStack {
 	smartStackNodeHandle top;
 	smartStackNodeHandle bottom;
 
-	size_t memoryMaximum;
-	size_t memoryAllocated;
+	smartAllocatorHandle allocator;
+
+	smartBudgetHandle budget;
+
+	size_t nodeAlignment;
 
 	unsigned long depth;
 } smartStack ;
@@ -67,6 +67,81 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackConstructSmartStack
 	size_t pMemoryMaximum
 );
 
+/*----------------------------------------------------------------------------
+  SmartStackConstructSmartStackWithAllocator()
+  ----------------------------------------------------------------------------
+  Construct an empty stack whose memory is obtained from an allocator.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pStack         - (I/O) Pointer to recieve the stack handle
+  pMemoryMaximum - (I)   The maximum number of bytes used by the stack
+  pAllocator     - (I)   The allocator handle (NULL selects Malloc())
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Stack was succesfully constructed
+
+  False - Stack was not successfully constructed due to:
+
+          1. The SafeAllocatorMalloc() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  This function behaves as SmartStackConstructSmartStack() except that the
+  stack control structure and every node and data object constructed for the
+  stack are allocated from (and returned to) the allocator. A stack split
+  from this stack is bound to the same allocator. The allocator must outlive
+  the stack.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartStackConstructSmartStackWithAllocator
+(
+    smartStackHandle * pStack,
+	size_t pMemoryMaximum,
+	smartAllocatorHandle pAllocator
+);
+
+/*----------------------------------------------------------------------------
+  SmartStackConstructSmartStackWithBudget()
+  ----------------------------------------------------------------------------
+  Construct an empty stack whose memory is charged to a parent budget as well
+  as to the stack's own maximum.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pStack         - (I/O) Pointer to recieve the stack handle
+  pMemoryMaximum - (I)   The maximum number of bytes used by the stack
+  pBudget        - (I)   The parent budget handle (NULL for none)
+  pAllocator     - (I)   The allocator handle (NULL selects Malloc())
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Stack was succesfully constructed
+
+  False - Stack was not successfully constructed due to:
+
+          1. The SafeAllocatorMalloc() failed
+          2. The stack control structure would exceed the maximum of the
+             stack or of the parent budget (or one of its ancestors)
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Each stack keeps its own budget for pMemoryMaximum whose parent is
+  pBudget, so a node is only constructed when it fits the stack, the tenant
+  budget passed in and every budget above that, all checked with a single
+  reservation. Destructing the stack hands its charge back to the parent
+  budget, which must outlive the stack.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartStackConstructSmartStackWithBudget
+(
+    smartStackHandle * pStack,
+	size_t pMemoryMaximum,
+	smartBudgetHandle pBudget,
+	smartAllocatorHandle pAllocator
+);
+
 /*----------------------------------------------------------------------------
   SmartStackConstructNode()
   ----------------------------------------------------------------------------
@@ -98,6 +173,12 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackConstructSmartStack
   nodes may be reused (without reconstruction) after being popped.
 
   Destructing a stack will destruct all associated nodes and data objects.
+
+  The bytes for the node and data object are reserved against the
+  stack's maximum (and any parent budgets) in one atomic step before anything
+  is allocated, so threads constructing nodes for a shared stack at the same
+  time can neither lose updates to the stack's memory count nor take it over
+  its maximum.
   ----------------------------------------------------------------------------*/
 
 STORAGE_CLASS Bool CALLING_CONVENTION SmartStackConstructNode
@@ -259,6 +340,9 @@ STORAGE_CLASS smartStackDataHandle CALLING_CONVENTION SmartStackGetNodeData
 
   Splitting an empty stack has the effect of creating an empty bottom stack.
 
+  The bottom stack is given the same maximum and parent budget as the top
+  stack, and the charge for the nodes it takes over moves with them.
+
   The created bottom stack has the same the maximum number of bytes as the
   top stack from which it was created.
   ----------------------------------------------------------------------------*/
@@ -289,6 +373,8 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackSplit
           1. The pTopStack handle was NULL
           2. The pBottomStack handle was NULL
 		  3. Would make the top stack exceed its maximum number of bytes
+          4. The node alignments of the stacks differ
+          5. The stacks use different allocators
   ----------------------------------------------------------------------------*/
 	
 STORAGE_CLASS Bool CALLING_CONVENTION SmartStackSplice
@@ -344,6 +430,12 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartStackDestructNode
 		  2. The destruction of a node data object failed
           3. The SafeFree() of a node failed
 		  4. The SafeFree() of the stack failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The nodes of a stack bound to a region allocator (an allocator without a
+  deallocate function such as a Smart Arena) are not visited, they are
+  released all at once with the region.
   ----------------------------------------------------------------------------*/
 
 STORAGE_CLASS Bool CALLING_CONVENTION SmartStackDestructSmartStack
@@ -370,6 +462,81 @@ STORAGE_CLASS unsigned long CALLING_CONVENTION SmartStackGetDepth
     smartStackHandle pStack
 );
 
+/*----------------------------------------------------------------------------
+  SmartStackSetPressureFunction()
+  ----------------------------------------------------------------------------
+  Register a function to be called when constructing a node would take the
+  stack over its maximum number of bytes.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pStack             - (I) The stack handle
+  pPressureFunction - (I) The pressure function, NULL to remove it
+  pContext          - (I) A pointer passed back to the pressure function
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The pressure function was registered
+
+  False - The stack handle was NULL
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The pressure function is called by SmartStackConstructNode() with the
+  number of bytes the stack is short. It may destruct nodes of the stack
+  (for example nodes popped and no longer needed) and return TRUE to have
+  the construction retried, or return FALSE to have it fail. This lets the
+  stack's maximum act as a cache limit.
+
+  The pressure function must not construct nodes itself. A parent budget
+  may register its own pressure function with
+  SmartBudgetSetPressureFunction().
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartStackSetPressureFunction
+(
+    smartStackHandle pStack,
+	smartPressureFunction pPressureFunction,
+	void * pContext
+);
+
+/*----------------------------------------------------------------------------
+  SmartStackSetNodeAlignment()
+  ----------------------------------------------------------------------------
+  Set the alignment of the data objects of the nodes constructed by
+  SmartStackConstructNode().
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pStack     - (I) The stack handle
+  pAlignment - (I) The alignment, a power of two such as 64 for a cache line
+                   or 32 for an AVX register, or zero for the alignment of
+                   the allocator
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The alignment was set
+
+  False - The alignment was not set due to one of the following:
+
+          1. The stack handle was NULL.
+          2. The alignment was not a power of two.
+          3. The stack already has nodes.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The alignment must be set before the first node is constructed, since
+  SmartStackDestructNode() releases the data objects with the same
+  alignment. A stack split from this one by SmartStackSplit() keeps the
+  alignment and SmartStackSplice() refuses stacks whose alignments differ.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartStackSetNodeAlignment
+(
+    smartStackHandle pStack,
+	size_t pAlignment
+);
+
 /*----------------------------------------------------------------------------
   SmartStackGetMemoryAllocated()
   ----------------------------------------------------------------------------
@@ -39,6 +39,7 @@
   ----------------------------------------------------------------------------*/
 
 #include <ctype.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -51,12 +52,15 @@
 #include "compilation.t.h"
 #include "types.t.h"
 
+#include "smart.memory.t.h"
 #include "smart.stack.t.h"
 
 /*----------------------------------------------------------------------------
   Public functions
   ----------------------------------------------------------------------------*/
 
+#include "smart.memory.i.h"
+
 #include "smart.stack.i.h"
 
 /*----------------------------------------------------------------------------
@@ -188,9 +192,33 @@ void main
                 break;
             }
 
+			case 'S':
+			{
+				SplitSpliceTest();
+				break;
+			}
+
+			case 'B':
+			{
+				BudgetTest();
+				break;
+			}
+
+			case 'A':
+			{
+				AllocatorSpliceTest();
+				break;
+			}
+
+			case 'P':
+			{
+				PressureTest();
+				break;
+			}
+
             default:
             {
-                printf("Valid options are +,-,=,>,!,|,*,X,1,2,3,I,9,0,Q,?\n");
+                printf("Valid options are +,-,=,>,!,|,*,X,1,2,3,S,B,A,P,I,9,0,Q,?\n");
                 break;
             }
         }
@@ -216,6 +244,10 @@ void DisplayOptions
 		   "(1) Iterated artificial performance test\n"
 		   "(2) Iterated realistic performance speed test\n"
 		   "(3) Iterated thorough test\n\n"
+		   "(S) Split and splice accounting test\n"
+		   "(B) Budget test\n"
+		   "(A) Splice across allocators test\n"
+		   "(P) Memory pressure test\n\n"
 		   "(I) Display stack information\n"
 		   "(9) Display application stack array\n"
 		   "(0) Display stack contents (pop all)\n\n"
@@ -770,6 +802,7 @@ void IteratedTest3
 
 		SmartStackDestructSmartStack(&gStack);
 		SmartStackConstructSmartStack(&gStack, (size_t) 0);
+		SmartStackSetNodeAlignment(gStack, TEST_NODE_ALIGNMENT);
 
 		ValidateStack(stdout);
 
@@ -786,6 +819,11 @@ void IteratedTest3
 
 			SmartStackConstructNode(gStack, &gNodes[lNodeIndex], &lDataPointer, (size_t) DATA_ELEMENT_SIZE);
 
+			if (0 != ((uintptr_t) lDataPointer & (TEST_NODE_ALIGNMENT - 1)))
+			{
+				fprintf(stdout, "Node data alignment disagreement: node %ld at %p\n", lNodeIndex + 1, lDataPointer);
+			}
+
 			sprintf(lDataPointer, "Entry #%06d", lNodeIndex + 1);
 
 			SmartStackPushNode(gStack, gNodes[lNodeIndex]);
@@ -884,3 +922,534 @@ void ValidateStack
 		fprintf(pFile, "Stack depth disagreement: Application = %d, API = %d\n\n", gNodeCount, lNodeCount);
 	}
 }
+
+void SplitSpliceTest
+(
+	void
+)
+{
+	smartStackHandle lTopStack = NULL;
+	smartStackHandle lBottomStack = NULL;
+
+	smartStackNodeHandle lNode;
+	smartStackNodeHandle lSplitNode = NULL;
+
+	unsigned long lNodeIndex;
+
+	size_t lEmptyAllocated;
+	size_t lFullAllocated;
+	size_t lNodeAllocated;
+
+	Bool lPassed = TRUE;
+
+	if (!SmartStackConstructSmartStack(&lTopStack, (size_t) 0))
+	{
+		return;
+	}
+
+	lEmptyAllocated = SmartStackGetMemoryAllocated(lTopStack);
+
+	for (lNodeIndex = 0; lNodeIndex < TEST_SPLIT_NODES; lNodeIndex++)
+	{
+		lNode = NULL;
+
+		if (!SmartStackConstructNode(lTopStack, &lNode, NULL, (size_t) DATA_ELEMENT_SIZE) || !SmartStackPushNode(lTopStack, lNode))
+		{
+			SmartStackDestructSmartStack(&lTopStack);
+			return;
+		}
+
+		if (TEST_SPLIT_NODES - 1 - TEST_SPLIT_DEPTH == lNodeIndex)
+		{
+			lSplitNode = lNode;
+		}
+	}
+
+	lFullAllocated = SmartStackGetMemoryAllocated(lTopStack);
+	lNodeAllocated = (lFullAllocated - lEmptyAllocated) / TEST_SPLIT_NODES;
+
+	printf("\n");
+	printf("Before split: top %ld bytes\n", lFullAllocated);
+
+	/*
+	** each stack is charged for its own nodes and control structure
+	*/
+
+	if (!SmartStackSplit(lTopStack, lSplitNode, &lBottomStack))
+	{
+		printf("Split at a node failed\n");
+		lPassed = FALSE;
+	}
+	else
+	{
+		printf("After split:  top %ld bytes, bottom %ld bytes\n", SmartStackGetMemoryAllocated(lTopStack), SmartStackGetMemoryAllocated(lBottomStack));
+
+		lPassed &= StackAgrees("Split top", lTopStack, TEST_SPLIT_DEPTH, lEmptyAllocated + TEST_SPLIT_DEPTH * lNodeAllocated);
+		lPassed &= StackAgrees("Split bottom", lBottomStack, TEST_SPLIT_NODES - TEST_SPLIT_DEPTH, lEmptyAllocated + (TEST_SPLIT_NODES - TEST_SPLIT_DEPTH) * lNodeAllocated);
+
+		if (lSplitNode != SmartStackGetTopNode(lBottomStack))
+		{
+			printf("Split node is not the top of the bottom stack\n");
+			lPassed = FALSE;
+		}
+	}
+
+	/*
+	** splicing hands the charge back and releases the bottom stack
+	*/
+
+	if (!SmartStackSplice(lTopStack, &lBottomStack) || NULL != lBottomStack)
+	{
+		printf("Splice failed\n");
+		lPassed = FALSE;
+	}
+	else
+	{
+		printf("After splice: top %ld bytes\n", SmartStackGetMemoryAllocated(lTopStack));
+
+		lPassed &= StackAgrees("Splice", lTopStack, TEST_SPLIT_NODES, lFullAllocated);
+	}
+
+	/*
+	** a split at the middle, then at the top node (which leaves the top stack
+	** empty) followed by a splice onto the empty stack
+	*/
+
+	if (!SmartStackSplit(lTopStack, NULL, &lBottomStack))
+	{
+		printf("Split at the middle failed\n");
+		lPassed = FALSE;
+	}
+	else
+	{
+		lPassed &= StackAgrees("Middle top", lTopStack, TEST_SPLIT_NODES / 2, lEmptyAllocated + (TEST_SPLIT_NODES / 2) * lNodeAllocated);
+		lPassed &= StackAgrees("Middle bottom", lBottomStack, TEST_SPLIT_NODES - TEST_SPLIT_NODES / 2, lEmptyAllocated + (TEST_SPLIT_NODES - TEST_SPLIT_NODES / 2) * lNodeAllocated);
+
+		if (!SmartStackSplice(lTopStack, &lBottomStack))
+		{
+			printf("Splice after a middle split failed\n");
+			lPassed = FALSE;
+		}
+	}
+
+	if (!SmartStackSplit(lTopStack, SmartStackGetTopNode(lTopStack), &lBottomStack))
+	{
+		printf("Split at the top node failed\n");
+		lPassed = FALSE;
+	}
+	else
+	{
+		lPassed &= StackAgrees("Emptied top", lTopStack, 0, lEmptyAllocated);
+		lPassed &= StackAgrees("Whole bottom", lBottomStack, TEST_SPLIT_NODES, lFullAllocated);
+
+		if (!SmartStackSplice(lTopStack, &lBottomStack))
+		{
+			printf("Splice onto an empty stack failed\n");
+			lPassed = FALSE;
+		}
+		else
+		{
+			lPassed &= StackAgrees("Refilled top", lTopStack, TEST_SPLIT_NODES, lFullAllocated);
+		}
+	}
+
+	printf("\n");
+	printf("Split/splice test: %s\n\n", lPassed ? "OK" : "FAILED");
+
+	SmartStackDestructSmartStack(&lBottomStack);
+	SmartStackDestructSmartStack(&lTopStack);
+}
+
+void BudgetTest
+(
+	void
+)
+{
+	smartBudgetHandle lTenant = NULL;
+
+	smartStackHandle lStack = NULL;
+	smartStackHandle lStacks[2] = {NULL, NULL};
+
+	smartStackNodeHandle lNode = NULL;
+
+	unsigned long lNodeIndex;
+	unsigned long lNodeCount = 0;
+
+	size_t lEmptyAllocated;
+	size_t lNodeAllocated;
+
+	Bool lPassed = TRUE;
+
+	/*
+	** measure the charge for a stack and for a node
+	*/
+
+	if (!SmartStackConstructSmartStack(&lStack, (size_t) 0))
+	{
+		return;
+	}
+
+	lEmptyAllocated = SmartStackGetMemoryAllocated(lStack);
+
+	SmartStackConstructNode(lStack, &lNode, NULL, (size_t) DATA_ELEMENT_SIZE);
+	SmartStackPushNode(lStack, lNode);
+
+	lNodeAllocated = SmartStackGetMemoryAllocated(lStack) - lEmptyAllocated;
+
+	SmartStackDestructSmartStack(&lStack);
+
+	printf("\n");
+	printf("Stack: %ld bytes, node %ld bytes\n", lEmptyAllocated, lNodeAllocated);
+
+	/*
+	** a stack with room for a fixed number of nodes refuses the next one,
+	** through the default allocator and through a caller-supplied one
+	*/
+
+	SmartStackConstructSmartStack(&lStack, lEmptyAllocated + TEST_BUDGET_NODES * lNodeAllocated);
+
+	lPassed &= StackFills("Bounded", lStack, lEmptyAllocated + TEST_BUDGET_NODES * lNodeAllocated);
+
+	SmartStackDestructSmartStack(&lStack);
+
+	SmartStackConstructSmartStackWithAllocator(&lStack, lEmptyAllocated + TEST_BUDGET_NODES * lNodeAllocated, SmartThreadCacheGetAllocator());
+
+	lPassed &= StackFills("Bounded allocator", lStack, lEmptyAllocated + TEST_BUDGET_NODES * lNodeAllocated);
+
+	SmartStackDestructSmartStack(&lStack);
+
+	/*
+	** two unlimited stacks sharing a tenant budget are refused together
+	*/
+
+	SmartBudgetConstructSmartBudget(&lTenant, 2 * lEmptyAllocated + TEST_BUDGET_NODES * lNodeAllocated, NULL);
+
+	SmartStackConstructSmartStackWithBudget(&lStacks[0], (size_t) 0, lTenant, NULL);
+	SmartStackConstructSmartStackWithBudget(&lStacks[1], (size_t) 0, lTenant, NULL);
+
+	for (lNodeIndex = 0; lNodeIndex < 2 * TEST_BUDGET_NODES; lNodeIndex++)
+	{
+		lNode = NULL;
+
+		if (!SmartStackConstructNode(lStacks[lNodeIndex % 2], &lNode, NULL, (size_t) DATA_ELEMENT_SIZE))
+		{
+			break;
+		}
+
+		SmartStackPushNode(lStacks[lNodeIndex % 2], lNode);
+
+		lNodeCount++;
+	}
+
+	printf("Tenant: %ld of %ld bytes, %ld nodes\n", SmartBudgetGetValue(lTenant), SmartBudgetGetMaximum(lTenant), lNodeCount);
+
+	if (TEST_BUDGET_NODES != lNodeCount)
+	{
+		printf("Tenant node count disagreement: expected %d, constructed %ld\n", TEST_BUDGET_NODES, lNodeCount);
+		lPassed = FALSE;
+	}
+
+	if (SmartBudgetGetValue(lTenant) != SmartStackGetMemoryAllocated(lStacks[0]) + SmartStackGetMemoryAllocated(lStacks[1]))
+	{
+		printf("Tenant charge disagreement: tenant %ld, stacks %ld\n", SmartBudgetGetValue(lTenant), SmartStackGetMemoryAllocated(lStacks[0]) + SmartStackGetMemoryAllocated(lStacks[1]));
+		lPassed = FALSE;
+	}
+
+	SmartStackDestructSmartStack(&lStacks[0]);
+	SmartStackDestructSmartStack(&lStacks[1]);
+
+	if (0 != SmartBudgetGetValue(lTenant))
+	{
+		printf("Tenant charge remains: %ld bytes\n", SmartBudgetGetValue(lTenant));
+		lPassed = FALSE;
+	}
+
+	SmartBudgetDestructSmartBudget(&lTenant);
+
+	printf("\n");
+	printf("Budget test: %s\n\n", lPassed ? "OK" : "FAILED");
+}
+
+void AllocatorSpliceTest
+(
+	void
+)
+{
+	smartStackHandle lTopStack = NULL;
+	smartStackHandle lBottomStack = NULL;
+	smartStackHandle lBottomHandle;
+
+	smartStackNodeHandle lNode;
+	smartStackNodeHandle lTopNode;
+	smartStackNodeHandle lBottomNode;
+
+	unsigned long lNodeIndex;
+
+	size_t lTopAllocated;
+	size_t lBottomAllocated;
+
+	Bool lPassed = TRUE;
+
+	/*
+	** the top stack allocates through the thread cache, the bottom stack
+	** through the C runtime library
+	*/
+
+	if (!SmartStackConstructSmartStackWithAllocator(&lTopStack, (size_t) 0, SmartThreadCacheGetAllocator()) || !SmartStackConstructSmartStack(&lBottomStack, (size_t) 0))
+	{
+		SmartStackDestructSmartStack(&lTopStack);
+		return;
+	}
+
+	for (lNodeIndex = 0; lNodeIndex < TEST_SPLIT_NODES; lNodeIndex++)
+	{
+		lNode = NULL;
+
+		if (SmartStackConstructNode(lTopStack, &lNode, NULL, (size_t) DATA_ELEMENT_SIZE))
+		{
+			SmartStackPushNode(lTopStack, lNode);
+		}
+
+		lNode = NULL;
+
+		if (SmartStackConstructNode(lBottomStack, &lNode, NULL, (size_t) DATA_ELEMENT_SIZE))
+		{
+			SmartStackPushNode(lBottomStack, lNode);
+		}
+	}
+
+	lTopAllocated = SmartStackGetMemoryAllocated(lTopStack);
+	lBottomAllocated = SmartStackGetMemoryAllocated(lBottomStack);
+
+	lTopNode = SmartStackGetTopNode(lTopStack);
+	lBottomNode = SmartStackGetTopNode(lBottomStack);
+
+	lBottomHandle = lBottomStack;
+
+	/*
+	** the nodes of the bottom stack would be released by the wrong allocator
+	*/
+
+	printf("\n");
+
+	if (SmartStackSplice(lTopStack, &lBottomStack))
+	{
+		printf("Splice across allocators succeeded\n");
+
+		SmartStackDestructSmartStack(&lTopStack);
+
+		printf("\n");
+		printf("Allocator splice test: FAILED\n\n");
+		return;
+	}
+
+	if (lBottomHandle != lBottomStack)
+	{
+		printf("Refused splice changed the bottom stack handle\n");
+		lPassed = FALSE;
+	}
+
+	if (lTopNode != SmartStackGetTopNode(lTopStack) || lBottomNode != SmartStackGetTopNode(lBottomStack))
+	{
+		printf("Refused splice changed the top node of a stack\n");
+		lPassed = FALSE;
+	}
+
+	lPassed &= StackAgrees("Top", lTopStack, TEST_SPLIT_NODES, lTopAllocated);
+	lPassed &= StackAgrees("Bottom", lBottomStack, TEST_SPLIT_NODES, lBottomAllocated);
+
+	printf("Splice refused: top %ld bytes, bottom %ld bytes\n", SmartStackGetMemoryAllocated(lTopStack), SmartStackGetMemoryAllocated(lBottomStack));
+
+	printf("\n");
+	printf("Allocator splice test: %s\n\n", lPassed ? "OK" : "FAILED");
+
+	SmartStackDestructSmartStack(&lBottomStack);
+	SmartStackDestructSmartStack(&lTopStack);
+}
+
+void PressureTest
+(
+	void
+)
+{
+	smartStackHandle lStack = NULL;
+
+	smartStackNodeHandle lNode = NULL;
+
+	unsigned long lNodeIndex;
+	unsigned long lDiscards = 0;
+
+	size_t lEmptyAllocated;
+	size_t lNodeAllocated;
+	size_t lMemoryMaximum;
+
+	Bool lPassed = TRUE;
+
+	/*
+	** measure the charge for a stack and for a node
+	*/
+
+	if (!SmartStackConstructSmartStack(&lStack, (size_t) 0))
+	{
+		return;
+	}
+
+	lEmptyAllocated = SmartStackGetMemoryAllocated(lStack);
+
+	SmartStackConstructNode(lStack, &lNode, NULL, (size_t) DATA_ELEMENT_SIZE);
+	SmartStackPushNode(lStack, lNode);
+
+	lNodeAllocated = SmartStackGetMemoryAllocated(lStack) - lEmptyAllocated;
+
+	SmartStackDestructSmartStack(&lStack);
+
+	/*
+	** a full stack that discards its top node whenever a node would take it
+	** over its maximum
+	*/
+
+	lMemoryMaximum = lEmptyAllocated + TEST_PRESSURE_NODES * lNodeAllocated;
+
+	if (!SmartStackConstructSmartStack(&lStack, lMemoryMaximum))
+	{
+		return;
+	}
+
+	SmartStackSetPressureFunction(lStack, DiscardTopNode, &lStack);
+
+	for (lNodeIndex = 0; lNodeIndex < TEST_NODES; lNodeIndex++)
+	{
+		lNode = NULL;
+
+		if (!SmartStackConstructNode(lStack, &lNode, NULL, (size_t) DATA_ELEMENT_SIZE) || !SmartStackPushNode(lStack, lNode))
+		{
+			printf("Push refused at the maximum: node %ld\n", lNodeIndex + 1);
+			lPassed = FALSE;
+			break;
+		}
+
+		if (lMemoryMaximum < SmartStackGetMemoryAllocated(lStack))
+		{
+			lPassed = FALSE;
+		}
+	}
+
+	lDiscards = lNodeIndex - SmartStackGetDepth(lStack);
+
+	lPassed &= StackAgrees("Pressure", lStack, TEST_PRESSURE_NODES, lMemoryMaximum);
+
+	/*
+	** with nothing left to discard the pressure function gives up and the
+	** construction fails
+	*/
+
+	SmartStackSetPressureFunction(lStack, NULL, NULL);
+
+	lNode = NULL;
+
+	if (SmartStackConstructNode(lStack, &lNode, NULL, (size_t) DATA_ELEMENT_SIZE))
+	{
+		printf("Node constructed past the maximum without a pressure function\n");
+
+		SmartStackDestructNode(lStack, &lNode);
+
+		lPassed = FALSE;
+	}
+
+	printf("\n");
+	printf("Nodes constructed = %ld\n", lNodeIndex);
+	printf("Nodes discarded   = %ld\n", lDiscards);
+	printf("Nodes remaining   = %ld\n", SmartStackGetDepth(lStack));
+	printf("Memory Allocated  = %ld of %ld\n", SmartStackGetMemoryAllocated(lStack), lMemoryMaximum);
+	printf("\n");
+	printf("Pressure test: %s\n\n", lPassed ? "OK" : "FAILED");
+
+	SmartStackDestructSmartStack(&lStack);
+}
+
+Bool DiscardTopNode
+(
+	void * pStack,
+	size_t pShortfall
+)
+{
+	smartStackHandle lStack = * (smartStackHandle *) pStack;
+
+	smartStackNodeHandle lNode = SmartStackPopNode(lStack);
+
+	(void) pShortfall;
+
+	if (NULL == lNode)
+	{
+		return(FALSE);
+	}
+
+	return(SmartStackDestructNode(lStack, &lNode));
+}
+
+Bool StackFills
+(
+	const char * pName,
+	smartStackHandle pStack,
+	size_t pMemoryMaximum
+)
+{
+	smartStackNodeHandle lNode;
+
+	unsigned long lNodeIndex;
+
+	for (lNodeIndex = 0; lNodeIndex < TEST_BUDGET_NODES; lNodeIndex++)
+	{
+		lNode = NULL;
+
+		if (!SmartStackConstructNode(pStack, &lNode, NULL, (size_t) DATA_ELEMENT_SIZE) || !SmartStackPushNode(pStack, lNode))
+		{
+			printf("%s: node %ld refused within the maximum\n", pName, lNodeIndex + 1);
+			return(FALSE);
+		}
+	}
+
+	lNode = NULL;
+
+	if (SmartStackConstructNode(pStack, &lNode, NULL, (size_t) DATA_ELEMENT_SIZE))
+	{
+		printf("%s: node constructed past the maximum\n", pName);
+
+		SmartStackDestructNode(pStack, &lNode);
+
+		return(FALSE);
+	}
+
+	printf("%s: %ld of %ld bytes, push refused\n", pName, SmartStackGetMemoryAllocated(pStack), pMemoryMaximum);
+
+	return(StackAgrees(pName, pStack, TEST_BUDGET_NODES, pMemoryMaximum));
+}
+
+Bool StackAgrees
+(
+	const char * pName,
+	smartStackHandle pStack,
+	unsigned long pDepth,
+	size_t pMemoryAllocated
+)
+{
+	if (!SmartStackIsValid(pStack))
+	{
+		printf("%s: stack self validation failed\n", pName);
+		return(FALSE);
+	}
+
+	if (pDepth != SmartStackGetDepth(pStack))
+	{
+		printf("%s: stack depth disagreement: expected %ld, API = %ld\n", pName, pDepth, SmartStackGetDepth(pStack));
+		return(FALSE);
+	}
+
+	if (pMemoryAllocated != SmartStackGetMemoryAllocated(pStack))
+	{
+		printf("%s: memory allocated disagreement: expected %ld, API = %ld\n", pName, pMemoryAllocated, SmartStackGetMemoryAllocated(pStack));
+		return(FALSE);
+	}
+
+	return(TRUE);
+}
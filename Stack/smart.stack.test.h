@@ -41,6 +41,15 @@
 
 #define DATA_ELEMENT_SIZE 64
 
+#define TEST_NODE_ALIGNMENT 64                              /* a cache line, for the thorough test */
+
+#define TEST_SPLIT_NODES 10
+#define TEST_SPLIT_DEPTH 3                                  /* nodes kept by the top stack */
+
+#define TEST_BUDGET_NODES 3
+
+#define TEST_PRESSURE_NODES 5                               /* nodes the stack holds at its maximum */
+
 /*----------------------------------------------------------------------------
   Private function prototypes
   ----------------------------------------------------------------------------*/
@@ -153,4 +162,45 @@ void ValidateStack
 	FILE * pFile
 );
 
+void SplitSpliceTest
+(
+	void
+);
+
+void BudgetTest
+(
+	void
+);
+
+void AllocatorSpliceTest
+(
+	void
+);
+
+void PressureTest
+(
+	void
+);
+
+Bool DiscardTopNode
+(
+	void * pStack,
+	size_t pShortfall
+);
+
+Bool StackFills
+(
+	const char * pName,
+	smartStackHandle pStack,
+	size_t pMemoryMaximum
+);
+
+Bool StackAgrees
+(
+	const char * pName,
+	smartStackHandle pStack,
+	unsigned long pDepth,
+	size_t pMemoryAllocated
+);
+
 #endif
@@ -1,2 +1,1902 @@
+/*----------------------------------------------------------------------------
+  Smart Tokenizer
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Tokenizer application programmer's interface (API) implementation file
+  ----------------------------------------------------------------------------*/
+
+#include <string.h>
+
+#include "compilation.t.h"
+#include "types.t.h"
+#include "smart.memory.t.h"
+#include "smart.memory.i.h"
+
+/*----------------------------------------------------------------------------
+  Private defines, data types and function prototypes
+  ----------------------------------------------------------------------------*/
+
 #include "smart.tokenizer.h"
-#include "smart.tokenizer.i.h"
\ No newline at end of file
+
+/*----------------------------------------------------------------------------
+  Public function prototypes
+  ----------------------------------------------------------------------------*/
+
+#include "smart.tokenizer.i.h"
+
+/*----------------------------------------------------------------------------
+  Public functions
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerConstructSmartTokenizer
+(
+    smartTokenizerHandle * pTokenizer
+)
+{
+    /*
+    ** there is no tokenizer handle
+    */
+
+    if (NULL == pTokenizer)
+    {
+        return(FALSE);
+    }
+
+    if (!SafeMalloc(pTokenizer, sizeof(smartTokenizer)))
+    {
+        return(FALSE);
+    }
+
+    memset((* pTokenizer)->classes, 0, sizeof((* pTokenizer)->classes));
+
+    TokenizerClassify(*pTokenizer, (const unsigned char *) TOKENIZER_DEFAULT_DELIMITERS, sizeof(TOKENIZER_DEFAULT_DELIMITERS) - 1);
+
+    (* pTokenizer)->escape = SMART_TOKENIZER_NO_ESCAPE;
+
+    TokenizerKernelSupported(SMART_TOKENIZER_KERNEL_AUTO, &(* pTokenizer)->kernel, &(* pTokenizer)->kernelId);
+
+    (* pTokenizer)->buffer = NULL;
+    (* pTokenizer)->size = 0;
+    (* pTokenizer)->position = 0;
+
+    (* pTokenizer)->streaming = FALSE;
+    (* pTokenizer)->carrying = FALSE;
+    (* pTokenizer)->carry = NULL;
+    (* pTokenizer)->carryCapacity = 0;
+
+    (* pTokenizer)->mapping = NULL;
+    (* pTokenizer)->mappingSize = 0;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerDestructSmartTokenizer
+(
+    smartTokenizerHandle * pTokenizer
+)
+{
+    /*
+    ** there is no tokenizer
+    */
+
+    if (NULL == pTokenizer || NULL == *pTokenizer)
+    {
+        return(FALSE);
+    }
+
+    if (!TokenizerUnmap(*pTokenizer))
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    if (NULL != (* pTokenizer)->carry && !SafeFree(&(* pTokenizer)->carry))
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    return(SafeFree(pTokenizer));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerSetDelimiters
+(
+    smartTokenizerHandle pTokenizer,
+    const char * pDelimiters,
+    size_t pLength
+)
+{
+    /*
+    ** there is no tokenizer
+    */
+
+    if (NULL == pTokenizer)
+    {
+        return(FALSE);
+    }
+
+    if (NULL == pDelimiters)
+    {
+        pDelimiters = TOKENIZER_DEFAULT_DELIMITERS;
+        pLength = sizeof(TOKENIZER_DEFAULT_DELIMITERS) - 1;
+    }
+
+    TokenizerClassify(pTokenizer, (const unsigned char *) pDelimiters, pLength);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerSetQuotes
+(
+    smartTokenizerHandle pTokenizer,
+    const char * pQuotes,
+    size_t pLength,
+    int pEscape
+)
+{
+    size_t lIndex;
+
+    /*
+    ** there is no tokenizer
+    */
+
+    if (NULL == pTokenizer)
+    {
+        return(FALSE);
+    }
+
+    if (SMART_TOKENIZER_NO_ESCAPE != pEscape && (0 > pEscape || TOKENIZER_BYTES <= pEscape))
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    for (lIndex = 0; lIndex < TOKENIZER_BYTES; lIndex++)
+    {
+        pTokenizer->classes[lIndex] &= ~TOKENIZER_QUOTE;
+    }
+
+    for (lIndex = 0; NULL != pQuotes && lIndex < pLength; lIndex++)
+    {
+        pTokenizer->classes[(unsigned char) pQuotes[lIndex]] |= TOKENIZER_QUOTE;
+    }
+
+    pTokenizer->escape = pEscape;
+
+    TokenizerCompileSets(pTokenizer);
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerBegin
+(
+    smartTokenizerHandle pTokenizer,
+    const char * pBuffer,
+    size_t pSize
+)
+{
+    /*
+    ** there is no tokenizer
+    */
+
+    if (NULL == pTokenizer)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** there is no buffer
+    */
+
+    if (NULL == pBuffer && 0 != pSize)
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    if (!TokenizerUnmap(pTokenizer))
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    pTokenizer->buffer = (const unsigned char *) pBuffer;
+    pTokenizer->size = pSize;
+    pTokenizer->position = 0;
+
+    pTokenizer->blockValid = FALSE;
+
+    pTokenizer->streaming = FALSE;
+    pTokenizer->carrying = FALSE;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerOpenFile
+(
+    smartTokenizerHandle pTokenizer,
+    const char * pPath,
+    const char ** pBuffer,
+    size_t * pSize
+)
+{
+    /*
+    ** there is no tokenizer, path, buffer pointer or size pointer
+    */
+
+    if (NULL == pTokenizer || NULL == pPath || NULL == pBuffer || NULL == pSize)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** close the file opened before and end any stream
+    */
+
+    if (!SmartTokenizerBegin(pTokenizer, NULL, 0))
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    if (!SafeFileMapRead(&pTokenizer->mapping, pPath, &pTokenizer->mappingSize, TOKENIZER_MAP_ALIGNMENT))
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    /*
+    ** the advice is a hint, the file is tokenized whether or not it is
+    ** taken
+    */
+
+    if (NULL != pTokenizer->mapping)
+    {
+        SafePageAdviseHuge(pTokenizer->mapping, pTokenizer->mappingSize);
+        SafePageAdviseSequential(pTokenizer->mapping, pTokenizer->mappingSize);
+    }
+
+    pTokenizer->buffer = (const unsigned char *) pTokenizer->mapping;
+    pTokenizer->size = pTokenizer->mappingSize;
+
+    *pBuffer = (const char *) pTokenizer->mapping;
+    *pSize = pTokenizer->mappingSize;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerCloseFile
+(
+    smartTokenizerHandle pTokenizer
+)
+{
+    /*
+    ** there is no tokenizer
+    */
+
+    if (NULL == pTokenizer)
+    {
+        return(FALSE);
+    }
+
+    return(SmartTokenizerBegin(pTokenizer, NULL, 0));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerNext
+(
+    smartTokenizerHandle pTokenizer,
+    smartToken * pToken
+)
+{
+    /*
+    ** there is no tokenizer or token
+    */
+
+    if (NULL == pTokenizer || NULL == pToken)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** the tokens of a stream come from SmartTokenizerStreamNext()
+    */
+
+    if (pTokenizer->streaming)
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    return(1 == TokenizerScan(pTokenizer, pToken, 1));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerNextBatch
+(
+    smartTokenizerHandle pTokenizer,
+    smartToken * pTokens,
+    size_t pCapacity,
+    size_t * pCount
+)
+{
+    /*
+    ** there is no tokenizer, token array or count
+    */
+
+    if (NULL == pTokenizer || NULL == pTokens || NULL == pCount)
+    {
+        return(FALSE);
+    }
+
+    if (pTokenizer->streaming)
+    {
+        *pCount = 0;
+
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    *pCount = TokenizerScan(pTokenizer, pTokens, pCapacity);
+
+    return(0 != *pCount);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerBeginStream
+(
+    smartTokenizerHandle pTokenizer,
+    size_t pCarryCapacity
+)
+{
+    /*
+    ** there is no tokenizer
+    */
+
+    if (NULL == pTokenizer)
+    {
+        return(FALSE);
+    }
+
+    if (0 == pCarryCapacity)
+    {
+        pCarryCapacity = TOKENIZER_DEFAULT_CARRY;
+    }
+
+    if (!TokenizerUnmap(pTokenizer))
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    /*
+    ** the carry buffer is kept from stream to stream while its capacity
+    ** stays the same
+    */
+
+    if (pCarryCapacity != pTokenizer->carryCapacity)
+    {
+        if (NULL != pTokenizer->carry && !SafeFree(&pTokenizer->carry))
+        {
+            return(FALSE); // set breakpoint here for debugging
+        }
+
+        pTokenizer->carryCapacity = 0;
+
+        if (!SafeMalloc(&pTokenizer->carry, pCarryCapacity))
+        {
+            return(FALSE); // set breakpoint here for debugging
+        }
+
+        pTokenizer->carryCapacity = pCarryCapacity;
+    }
+
+    pTokenizer->buffer = NULL;
+    pTokenizer->size = 0;
+    pTokenizer->position = 0;
+
+    pTokenizer->blockValid = FALSE;
+
+    pTokenizer->streaming = TRUE;
+    pTokenizer->finished = FALSE;
+    pTokenizer->chunkOffset = 0;
+
+    pTokenizer->carrying = FALSE;
+    pTokenizer->carryLength = 0;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerFeed
+(
+    smartTokenizerHandle pTokenizer,
+    const char * pChunk,
+    size_t pSize
+)
+{
+    /*
+    ** there is no tokenizer
+    */
+
+    if (NULL == pTokenizer)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** there is no chunk
+    */
+
+    if (NULL == pChunk && 0 != pSize)
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    /*
+    ** the stream has not begun or has finished, or the tokens of the
+    ** current chunk have not all been taken
+    */
+
+    if (!pTokenizer->streaming || pTokenizer->finished || pTokenizer->position < pTokenizer->size)
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    pTokenizer->chunkOffset += pTokenizer->size;
+
+    pTokenizer->buffer = (const unsigned char *) pChunk;
+    pTokenizer->size = pSize;
+    pTokenizer->position = 0;
+
+    pTokenizer->blockValid = FALSE;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerFinish
+(
+    smartTokenizerHandle pTokenizer
+)
+{
+    /*
+    ** there is no tokenizer
+    */
+
+    if (NULL == pTokenizer)
+    {
+        return(FALSE);
+    }
+
+    if (!pTokenizer->streaming)
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    pTokenizer->finished = TRUE;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerStreamNext
+(
+    smartTokenizerHandle pTokenizer,
+    smartToken * pToken,
+    const char ** pText
+)
+{
+    size_t lStart;
+    size_t lEnd;
+    size_t lRoom;
+
+    Bool lComplete;
+
+    /*
+    ** there is no tokenizer, token or text pointer
+    */
+
+    if (NULL == pTokenizer || NULL == pToken || NULL == pText)
+    {
+        return(FALSE);
+    }
+
+    if (!pTokenizer->streaming)
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    for (;;)
+    {
+        if (pTokenizer->carrying)
+        {
+            /*
+            ** a token longer than the carry buffer is returned in pieces of
+            ** the same class, each as long as the buffer
+            */
+
+            if (pTokenizer->carryLength == pTokenizer->carryCapacity)
+            {
+                pToken->offset = pTokenizer->carryOffset;
+                pToken->length = pTokenizer->carryLength;
+                pToken->tokenClass = pTokenizer->carryClass;
+
+                *pText = (const char *) pTokenizer->carry;
+
+                pTokenizer->carryOffset += pTokenizer->carryLength;
+                pTokenizer->carryLength = 0;
+
+                return(TRUE);
+            }
+
+            lRoom = pTokenizer->carryCapacity - pTokenizer->carryLength;
+
+            lEnd = TokenizerContinue(pTokenizer, pTokenizer->size - pTokenizer->position < lRoom ? pTokenizer->size : pTokenizer->position + lRoom, &lComplete);
+
+            if (lEnd != pTokenizer->position)
+            {
+                memcpy(pTokenizer->carry + pTokenizer->carryLength, pTokenizer->buffer + pTokenizer->position, lEnd - pTokenizer->position);
+
+                pTokenizer->carryLength += lEnd - pTokenizer->position;
+                pTokenizer->position = lEnd;
+            }
+
+            if (lComplete || (pTokenizer->finished && lEnd == pTokenizer->size))
+            {
+                pTokenizer->carrying = FALSE;
+
+                /*
+                ** the last piece of a token may have ended with the buffer
+                */
+
+                if (0 != pTokenizer->carryLength)
+                {
+                    pToken->offset = pTokenizer->carryOffset;
+                    pToken->length = pTokenizer->carryLength;
+                    pToken->tokenClass = pTokenizer->carryClass;
+
+                    *pText = (const char *) pTokenizer->carry;
+
+                    return(TRUE);
+                }
+            }
+            else if (lEnd == pTokenizer->size)
+            {
+                return(FALSE);
+            }
+
+            continue;
+        }
+
+        if (pTokenizer->position == pTokenizer->size)
+        {
+            return(FALSE);
+        }
+
+        lStart = pTokenizer->position;
+
+        TokenizerScan(pTokenizer, pToken, 1);
+
+        /*
+        ** the token is returned in place unless it reaches the end of the
+        ** chunk and could go on in the next one
+        */
+
+        if (pTokenizer->position < pTokenizer->size || pTokenizer->finished || SMART_TOKEN_PUNCTUATION == pToken->tokenClass)
+        {
+            pToken->offset += pTokenizer->chunkOffset;
+
+            *pText = (const char *) pTokenizer->buffer + lStart;
+
+            return(TRUE);
+        }
+
+        /*
+        ** carry the token over, a string after its opening quote so that
+        ** its escapes are followed from chunk to chunk
+        */
+
+        pTokenizer->carrying = TRUE;
+        pTokenizer->carryClass = pToken->tokenClass;
+        pTokenizer->carryOffset = pTokenizer->chunkOffset + lStart;
+        pTokenizer->carryLength = 0;
+        pTokenizer->carryEscaped = FALSE;
+
+        pTokenizer->position = lStart;
+
+        if (SMART_TOKEN_STRING == pToken->tokenClass)
+        {
+            pTokenizer->carryQuote = pTokenizer->buffer[lStart];
+
+            pTokenizer->carry[pTokenizer->carryLength++] = pTokenizer->carryQuote;
+
+            pTokenizer->position++;
+        }
+    }
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerTokenizeParallel
+(
+    smartTokenizerHandle pTokenizer,
+    const char * pBuffer,
+    size_t pSize,
+    size_t pThreads,
+    smartTokenRange ** pRanges,
+    size_t * pRangeCount
+)
+{
+    tokenizerRange * lRanges = NULL;
+
+    Bool * lRedo = NULL;
+    Bool lRedoAny = FALSE;
+    Bool lFailed = FALSE;
+
+    size_t lCount;
+    size_t lIndex;
+    size_t lEntry;
+    size_t lLow;
+    size_t lHigh;
+    size_t lMiddle;
+
+    /*
+    ** there is no tokenizer, range array pointer or range count
+    */
+
+    if (NULL == pTokenizer || NULL == pRanges || NULL == pRangeCount)
+    {
+        return(FALSE);
+    }
+
+    /*
+    ** there is no buffer or no thread
+    */
+
+    if ((NULL == pBuffer && 0 != pSize) || 0 == pThreads)
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    lCount = pSize / TOKENIZER_PARALLEL_MINIMUM;
+    lCount = (lCount < pThreads) ? lCount : pThreads;
+    lCount = (0 < lCount) ? lCount : 1;
+
+    if (!SafeCalloc(pRanges, lCount * sizeof(smartTokenRange)))
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    if (!SafeCalloc(&lRanges, lCount * sizeof(tokenizerRange)) || !SafeCalloc(&lRedo, lCount * sizeof(Bool)))
+    {
+        SafeFree(&lRanges);
+        SafeFree(pRanges);
+
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    /*
+    ** split the input evenly and move each split on to a token boundary,
+    ** each range being scanned by a copy of the tokenizer of its own
+    */
+
+    for (lIndex = 0; lIndex < lCount; lIndex++)
+    {
+        lRanges[lIndex].scanner = *pTokenizer;
+
+        lRanges[lIndex].scanner.buffer = (const unsigned char *) pBuffer;
+        lRanges[lIndex].scanner.size = pSize;
+        lRanges[lIndex].scanner.blockValid = FALSE;
+        lRanges[lIndex].scanner.streaming = FALSE;
+        lRanges[lIndex].scanner.carrying = FALSE;
+        lRanges[lIndex].scanner.carry = NULL;
+        lRanges[lIndex].scanner.carryCapacity = 0;
+        lRanges[lIndex].scanner.mapping = NULL;
+        lRanges[lIndex].scanner.mappingSize = 0;
+
+        if (0 < lIndex)
+        {
+            lEntry = (size_t) (((unsigned long long) pSize * lIndex) / lCount);
+
+            lRanges[lIndex].start = TokenizerBoundary(pTokenizer, (const unsigned char *) pBuffer, pSize, lEntry > lRanges[lIndex - 1].start ? lEntry : lRanges[lIndex - 1].start);
+
+            lRanges[lIndex - 1].end = lRanges[lIndex].start;
+        }
+
+        lRanges[lIndex].scanner.position = lRanges[lIndex].start;
+    }
+
+    lRanges[lCount - 1].end = pSize;
+
+    TokenizerRunRanges(lRanges, lCount, NULL);
+
+    /*
+    ** the ranges are fixed up in order, the tokens of the ranges before a
+    ** range ending where its first token starts; when that is not its
+    ** start its start was inside a quoted string, and its tokens are kept
+    ** from the one that starts there, or scanned again from there
+    */
+
+    lEntry = 0;
+
+    for (lIndex = 0; lIndex < lCount; lIndex++)
+    {
+        (* pRanges)[lIndex].offset = lEntry;
+
+        if (lEntry != lRanges[lIndex].start)
+        {
+            lLow = 0;
+            lHigh = lRanges[lIndex].count;
+
+            while (lLow < lHigh)
+            {
+                lMiddle = lLow + (lHigh - lLow) / 2;
+
+                if (lRanges[lIndex].tokens[lMiddle].offset < lEntry)
+                {
+                    lLow = lMiddle + 1;
+                }
+                else
+                {
+                    lHigh = lMiddle;
+                }
+            }
+
+            if (lLow < lRanges[lIndex].count && lEntry == lRanges[lIndex].tokens[lLow].offset)
+            {
+                memmove(lRanges[lIndex].tokens, lRanges[lIndex].tokens + lLow, (lRanges[lIndex].count - lLow) * sizeof(smartToken));
+
+                lRanges[lIndex].count -= lLow;
+            }
+            else if (lEntry >= lRanges[lIndex].end)
+            {
+                /*
+                ** a string runs over the whole range
+                */
+
+                lRanges[lIndex].count = 0;
+            }
+            else
+            {
+                lRanges[lIndex].speculation = lRanges[lIndex].tokens;
+                lRanges[lIndex].speculationCount = lRanges[lIndex].count;
+
+                lRanges[lIndex].tokens = NULL;
+                lRanges[lIndex].count = 0;
+                lRanges[lIndex].capacity = 0;
+
+                lRanges[lIndex].scanner.position = lEntry;
+                lRanges[lIndex].scanner.blockValid = FALSE;
+
+                lRedo[lIndex] = TRUE;
+                lRedoAny = TRUE;
+
+                lEntry = TokenizerSkipRange(&lRanges[lIndex].scanner, lEntry, lRanges[lIndex].end);
+            }
+        }
+
+        if (!lRedo[lIndex] && 0 < lRanges[lIndex].count)
+        {
+            lEntry = lRanges[lIndex].tokens[lRanges[lIndex].count - 1].offset + lRanges[lIndex].tokens[lRanges[lIndex].count - 1].length;
+        }
+
+        (* pRanges)[lIndex].length = lEntry - (* pRanges)[lIndex].offset;
+    }
+
+    /*
+    ** the ranges scanned again start where they are now known to, so they
+    ** are scanned at once
+    */
+
+    if (lRedoAny)
+    {
+        TokenizerRunRanges(lRanges, lCount, lRedo);
+    }
+
+    for (lIndex = 0; lIndex < lCount; lIndex++)
+    {
+        lFailed = lFailed || lRanges[lIndex].failed;
+
+        if (NULL != lRanges[lIndex].speculation)
+        {
+            SafeFree(&lRanges[lIndex].speculation);
+        }
+
+        (* pRanges)[lIndex].tokens = lRanges[lIndex].tokens;
+        (* pRanges)[lIndex].count = lRanges[lIndex].count;
+    }
+
+    SafeFree(&lRedo);
+    SafeFree(&lRanges);
+
+    if (lFailed)
+    {
+        SmartTokenizerFreeRanges(pRanges, lCount);
+
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    *pRangeCount = lCount;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerFreeRanges
+(
+    smartTokenRange ** pRanges,
+    size_t pRangeCount
+)
+{
+    size_t lIndex;
+
+    /*
+    ** there are no ranges
+    */
+
+    if (NULL == pRanges || NULL == *pRanges)
+    {
+        return(FALSE);
+    }
+
+    for (lIndex = 0; lIndex < pRangeCount; lIndex++)
+    {
+        if (NULL != (* pRanges)[lIndex].tokens && !SafeFree(&(* pRanges)[lIndex].tokens))
+        {
+            return(FALSE); // set breakpoint here for debugging
+        }
+    }
+
+    return(SafeFree(pRanges));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerSetKernel
+(
+    smartTokenizerHandle pTokenizer,
+    unsigned int pKernel
+)
+{
+    /*
+    ** there is no tokenizer
+    */
+
+    if (NULL == pTokenizer)
+    {
+        return(FALSE);
+    }
+
+    if (!TokenizerKernelSupported(pKernel, &pTokenizer->kernel, &pTokenizer->kernelId))
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    pTokenizer->blockValid = FALSE;
+
+    return(TRUE);
+}
+
+STORAGE_CLASS unsigned int CALLING_CONVENTION SmartTokenizerGetKernel
+(
+    smartTokenizerHandle pTokenizer
+)
+{
+    /*
+    ** there is no tokenizer
+    */
+
+    if (NULL == pTokenizer)
+    {
+        return(SMART_TOKENIZER_KERNEL_AUTO);
+    }
+
+    return(pTokenizer->kernelId);
+}
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartTokenizerGetPosition
+(
+    smartTokenizerHandle pTokenizer
+)
+{
+    /*
+    ** there is no tokenizer
+    */
+
+    if (NULL == pTokenizer)
+    {
+        return(0);
+    }
+
+    return(pTokenizer->position);
+}
+
+/*----------------------------------------------------------------------------
+  Private functions
+  ----------------------------------------------------------------------------*/
+
+static void TokenizerClassify
+(
+    smartTokenizerHandle pTokenizer,
+    const unsigned char * pDelimiters,
+    size_t pLength
+)
+{
+    size_t lIndex;
+
+    /*
+    ** every byte is a word byte until it is made a delimiter
+    */
+
+    for (lIndex = 0; lIndex < TOKENIZER_BYTES; lIndex++)
+    {
+        pTokenizer->classes[lIndex] = (pTokenizer->classes[lIndex] & TOKENIZER_QUOTE) | TOKENIZER_WORD;
+
+        if ('0' <= lIndex && '9' >= lIndex)
+        {
+            pTokenizer->classes[lIndex] |= TOKENIZER_DIGIT;
+        }
+    }
+
+    for (lIndex = 0; lIndex < pLength; lIndex++)
+    {
+        switch (pDelimiters[lIndex])
+        {
+            case ' ': case '\t': case '\r': case '\n': case '\v': case '\f':
+            {
+                pTokenizer->classes[pDelimiters[lIndex]] = (pTokenizer->classes[pDelimiters[lIndex]] & TOKENIZER_QUOTE) | TOKENIZER_SPACE;
+                break;
+            }
+
+            default:
+            {
+                pTokenizer->classes[pDelimiters[lIndex]] = (pTokenizer->classes[pDelimiters[lIndex]] & TOKENIZER_QUOTE) | TOKENIZER_PUNCTUATION;
+                break;
+            }
+        }
+    }
+
+    TokenizerCompileSets(pTokenizer);
+}
+
+static size_t TokenizerScan
+(
+    smartTokenizerHandle pTokenizer,
+    smartToken * pTokens,
+    size_t pCapacity
+)
+{
+    const unsigned char * lBuffer = pTokenizer->buffer;
+
+    size_t lSize = pTokenizer->size;
+    size_t lStart;
+    size_t lEnd = pTokenizer->position;
+    size_t lCount;
+
+    unsigned char lByteClass;
+    unsigned int lClass;
+
+    if (NULL != pTokenizer->kernel)
+    {
+        return(TokenizerScanBlocks(pTokenizer, pTokens, pCapacity));
+    }
+
+    /*
+    ** the scalar fallback tests a byte at a time against the class table,
+    ** which is faster for short tokens than building masks a bit at a time
+    */
+
+    for (lCount = 0; lCount < pCapacity && lEnd < lSize; lCount++)
+    {
+        lStart = lEnd;
+
+        lByteClass = pTokenizer->classes[lBuffer[lStart]];
+
+        /*
+        ** a quote takes precedence over the class it would otherwise have
+        */
+
+        if (TOKENIZER_QUOTE & lByteClass)
+        {
+            lEnd = TokenizerQuoteEnd(pTokenizer, lStart);
+
+            lClass = SMART_TOKEN_STRING;
+        }
+        else if (TOKENIZER_WORD & lByteClass)
+        {
+            lEnd = TokenizerSpan(pTokenizer, lStart + 1, TOKENIZER_WORD);
+
+            lClass = (TOKENIZER_DIGIT & lByteClass) ? SMART_TOKEN_NUMBER : SMART_TOKEN_WORD;
+        }
+        else if (TOKENIZER_SPACE & lByteClass)
+        {
+            lEnd = TokenizerSpan(pTokenizer, lStart + 1, TOKENIZER_SPACE);
+
+            lClass = SMART_TOKEN_WHITESPACE;
+        }
+        else
+        {
+            lEnd = lStart + 1;
+
+            lClass = SMART_TOKEN_PUNCTUATION;
+        }
+
+        pTokens[lCount].offset = lStart;
+        pTokens[lCount].length = lEnd - lStart;
+        pTokens[lCount].tokenClass = lClass;
+    }
+
+    pTokenizer->position = lEnd;
+
+    return(lCount);
+}
+
+static size_t TokenizerScanBlocks
+(
+    smartTokenizerHandle pTokenizer,
+    smartToken * pTokens,
+    size_t pCapacity
+)
+{
+    const unsigned char * lBuffer = pTokenizer->buffer;
+
+    size_t lSize = pTokenizer->size;
+    size_t lStart;
+    size_t lEnd = pTokenizer->position;
+    size_t lCount;
+    size_t lBase;
+
+    uint64_t lBit;
+    uint64_t lWords;
+    uint64_t lSpaces;
+    uint64_t lStarts;
+
+    unsigned int lClass;
+
+    /*
+    ** there is nothing left to tokenize, nor a block to load
+    */
+
+    if (lEnd >= lSize)
+    {
+        return(0);
+    }
+
+    if (!pTokenizer->blockValid || TOKENIZER_BLOCK_SIZE <= lEnd - pTokenizer->blockBase)
+    {
+        TokenizerLoadBlock(pTokenizer, lEnd & ~((size_t) TOKENIZER_BLOCK_SIZE - 1));
+    }
+
+    /*
+    ** the masks of the block are kept in locals, the token stores could
+    ** otherwise alias them
+    */
+
+    lBase = pTokenizer->blockBase;
+    lWords = pTokenizer->blockMasks[TOKENIZER_WORD_SET];
+    lSpaces = pTokenizer->blockMasks[TOKENIZER_SPACE_SET];
+    lStarts = pTokenizer->blockStarts;
+
+    for (lCount = 0; lCount < pCapacity && lEnd < lSize; lCount++)
+    {
+        lStart = lEnd;
+
+        if (TOKENIZER_BLOCK_SIZE <= lStart - lBase)
+        {
+            TokenizerLoadBlock(pTokenizer, lStart & ~((size_t) TOKENIZER_BLOCK_SIZE - 1));
+
+            lBase = pTokenizer->blockBase;
+            lWords = pTokenizer->blockMasks[TOKENIZER_WORD_SET];
+            lSpaces = pTokenizer->blockMasks[TOKENIZER_SPACE_SET];
+            lStarts = pTokenizer->blockStarts;
+        }
+
+        /*
+        ** the masks give the class of the first byte, except for a quote or
+        ** punctuation byte, which are in neither set
+        */
+
+        lBit = (uint64_t) 1 << (lStart - lBase);
+
+        if (lBit & (lWords | lSpaces))
+        {
+            lClass = (lBit & lSpaces) ? SMART_TOKEN_WHITESPACE : (TOKENIZER_DIGIT & pTokenizer->classes[lBuffer[lStart]]) ? SMART_TOKEN_NUMBER : SMART_TOKEN_WORD;
+
+            /*
+            ** the token ends at the next start, most often in the same block
+            */
+
+            if (0 != (lStarts & ~((lBit << 1) - 1)))
+            {
+                lEnd = lBase + TokenizerCountTrailingZeros(lStarts & ~((lBit << 1) - 1));
+
+                lEnd = (lEnd < lSize) ? lEnd : lSize;
+            }
+            else
+            {
+                lEnd = TokenizerNextStart(pTokenizer, lStart);
+
+                lBase = pTokenizer->blockBase;
+                lWords = pTokenizer->blockMasks[TOKENIZER_WORD_SET];
+                lSpaces = pTokenizer->blockMasks[TOKENIZER_SPACE_SET];
+                lStarts = pTokenizer->blockStarts;
+            }
+        }
+        else if (TOKENIZER_QUOTE & pTokenizer->classes[lBuffer[lStart]])
+        {
+            lEnd = TokenizerQuoteEnd(pTokenizer, lStart);
+
+            lClass = SMART_TOKEN_STRING;
+        }
+        else
+        {
+            lEnd = lStart + 1;
+
+            lClass = SMART_TOKEN_PUNCTUATION;
+        }
+
+        pTokens[lCount].offset = lStart;
+        pTokens[lCount].length = lEnd - lStart;
+        pTokens[lCount].tokenClass = lClass;
+    }
+
+    pTokenizer->position = lEnd;
+
+    return(lCount);
+}
+
+static size_t TokenizerSpan
+(
+    smartTokenizerHandle pTokenizer,
+    size_t pPosition,
+    unsigned char pFlags
+)
+{
+    const unsigned char * lBuffer = pTokenizer->buffer;
+
+    /*
+    ** a quote byte ends any run, it opens a string of its own
+    */
+
+    while (pPosition < pTokenizer->size && pFlags == (pTokenizer->classes[lBuffer[pPosition]] & (pFlags | TOKENIZER_QUOTE)))
+    {
+        pPosition++;
+    }
+
+    return(pPosition);
+}
+
+static size_t TokenizerNextStart
+(
+    smartTokenizerHandle pTokenizer,
+    size_t pPosition
+)
+{
+    uint64_t lStarts;
+
+    /*
+    ** the starts past the position in its block, then those of the blocks
+    ** that follow
+    */
+
+    lStarts = pTokenizer->blockStarts & ~((((uint64_t) 1 << (pPosition - pTokenizer->blockBase)) << 1) - 1);
+
+    while (0 == lStarts)
+    {
+        if (pTokenizer->blockBase + TOKENIZER_BLOCK_SIZE >= pTokenizer->size)
+        {
+            return(pTokenizer->size);
+        }
+
+        TokenizerLoadBlock(pTokenizer, pTokenizer->blockBase + TOKENIZER_BLOCK_SIZE);
+
+        lStarts = pTokenizer->blockStarts;
+    }
+
+    pPosition = pTokenizer->blockBase + TokenizerCountTrailingZeros(lStarts);
+
+    return(pPosition < pTokenizer->size ? pPosition : pTokenizer->size);
+}
+
+static void TokenizerLoadBlock
+(
+    smartTokenizerHandle pTokenizer,
+    size_t pBase
+)
+{
+    unsigned char lBlock[TOKENIZER_BLOCK_SIZE];
+
+    size_t lBytes = pTokenizer->size - pBase;
+
+    unsigned int lSet;
+
+    uint64_t lWords;
+    uint64_t lSpaces;
+    uint64_t lPreviousWord;
+    uint64_t lPreviousSpace;
+
+    unsigned char lPrevious;
+
+    if (TOKENIZER_BLOCK_SIZE <= lBytes)
+    {
+        pTokenizer->kernel(pTokenizer->buffer + pBase, pTokenizer->sets, pTokenizer->blockMasks);
+    }
+    else
+    {
+        memset(lBlock, 0, sizeof(lBlock));
+
+        if (0 != lBytes)
+        {
+            memcpy(lBlock, pTokenizer->buffer + pBase, lBytes);
+        }
+
+        pTokenizer->kernel(lBlock, pTokenizer->sets, pTokenizer->blockMasks);
+
+        for (lSet = 0; lSet < TOKENIZER_SETS; lSet++)
+        {
+            pTokenizer->blockMasks[lSet] &= ((uint64_t) 1 << lBytes) - 1;
+        }
+    }
+
+    /*
+    ** a token starts at a word or space byte that does not follow a byte of
+    ** the same set, and at every byte in neither set
+    */
+
+    lWords = pTokenizer->blockMasks[TOKENIZER_WORD_SET];
+    lSpaces = pTokenizer->blockMasks[TOKENIZER_SPACE_SET];
+
+    lPreviousWord = 0;
+    lPreviousSpace = 0;
+
+    if (0 != pBase)
+    {
+        lPrevious = pTokenizer->buffer[pBase - 1];
+
+        lPreviousWord = (pTokenizer->sets[TOKENIZER_WORD_SET].bits[lPrevious / 64] >> (lPrevious % 64)) & 1;
+        lPreviousSpace = (pTokenizer->sets[TOKENIZER_SPACE_SET].bits[lPrevious / 64] >> (lPrevious % 64)) & 1;
+    }
+
+    pTokenizer->blockStarts = (lWords & ~((lWords << 1) | lPreviousWord)) | (lSpaces & ~((lSpaces << 1) | lPreviousSpace)) | ~(lWords | lSpaces);
+
+    pTokenizer->blockBase = pBase;
+    pTokenizer->blockValid = TRUE;
+}
+
+static void TokenizerCompileSets
+(
+    smartTokenizerHandle pTokenizer
+)
+{
+    unsigned int lByte;
+    unsigned int lSet;
+
+    unsigned char lFlags[TOKENIZER_SETS] = { TOKENIZER_WORD, TOKENIZER_SPACE };
+
+    memset(pTokenizer->sets, 0, sizeof(pTokenizer->sets));
+
+    for (lSet = 0; lSet < TOKENIZER_SETS; lSet++)
+    {
+        for (lByte = 0; lByte < TOKENIZER_BYTES; lByte++)
+        {
+            /*
+            ** a quote byte ends any run, it opens a string of its own
+            */
+
+            if (lFlags[lSet] == (pTokenizer->classes[lByte] & (lFlags[lSet] | TOKENIZER_QUOTE)))
+            {
+                pTokenizer->sets[lSet].bits[lByte / 64] |= (uint64_t) 1 << (lByte % 64);
+
+                pTokenizer->sets[lSet].rows[lByte >> 7][lByte & 0x0F] |= (unsigned char) (1 << ((lByte >> 4) & 0x07));
+            }
+        }
+    }
+
+    pTokenizer->blockValid = FALSE;
+}
+
+static Bool TokenizerKernelSupported
+(
+    unsigned int pKernel,
+    tokenizerKernel * pFound,
+    unsigned int * pId
+)
+{
+    Bool lSsse3 = FALSE;
+    Bool lAvx2 = FALSE;
+
+#if defined TOKENIZER_X86 && defined _MSC_VER
+
+    int lInformation[4];
+
+    __cpuid(lInformation, 1);
+
+    lSsse3 = (0 != (lInformation[2] & (1 << 9)));
+
+    /*
+    ** AVX2 also needs the operating system to save the 256 bit registers
+    */
+
+    if (0 != (lInformation[2] & (1 << 27)) && 0 != (lInformation[2] & (1 << 28)) && 6 == (_xgetbv(0) & 6))
+    {
+        __cpuidex(lInformation, 7, 0);
+
+        lAvx2 = (0 != (lInformation[1] & (1 << 5)));
+    }
+
+#elif defined TOKENIZER_X86
+
+    __builtin_cpu_init();
+
+    lSsse3 = __builtin_cpu_supports("ssse3");
+    lAvx2 = __builtin_cpu_supports("avx2");
+
+#endif
+
+    if (SMART_TOKENIZER_KERNEL_AUTO == pKernel)
+    {
+#ifdef TOKENIZER_NEON
+        pKernel = SMART_TOKENIZER_KERNEL_NEON;
+#else
+        pKernel = lAvx2 ? SMART_TOKENIZER_KERNEL_AVX2 : lSsse3 ? SMART_TOKENIZER_KERNEL_SSSE3 : SMART_TOKENIZER_KERNEL_SCALAR;
+#endif
+    }
+
+    switch (pKernel)
+    {
+        case SMART_TOKENIZER_KERNEL_SCALAR:
+        {
+            *pFound = NULL;
+            break;
+        }
+
+#ifdef TOKENIZER_X86
+
+        case SMART_TOKENIZER_KERNEL_SSSE3:
+        {
+            if (!lSsse3)
+            {
+                return(FALSE);
+            }
+
+            *pFound = TokenizerKernelSsse3;
+            break;
+        }
+
+        case SMART_TOKENIZER_KERNEL_AVX2:
+        {
+            if (!lAvx2)
+            {
+                return(FALSE);
+            }
+
+            *pFound = TokenizerKernelAvx2;
+            break;
+        }
+
+#endif
+
+#ifdef TOKENIZER_NEON
+
+        case SMART_TOKENIZER_KERNEL_NEON:
+        {
+            *pFound = TokenizerKernelNeon;
+            break;
+        }
+
+#endif
+
+        default:
+        {
+            return(FALSE);
+        }
+    }
+
+    *pId = pKernel;
+
+    return(TRUE);
+}
+
+#ifdef TOKENIZER_X86
+
+TOKENIZER_TARGET("ssse3") static void TokenizerKernelSsse3
+(
+    const unsigned char * pBlock,
+    const tokenizerSet * pSets,
+    uint64_t * pMasks
+)
+{
+    __m128i lNibble = _mm_set1_epi8(0x0F);
+    __m128i lSeven = _mm_set1_epi8(0x07);
+    __m128i lBitTable = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+
+    __m128i lBytes;
+    __m128i lLow;
+    __m128i lHigh;
+    __m128i lBit;
+    __m128i lUpper;
+    __m128i lRow;
+
+    unsigned int lSet;
+    unsigned int lOffset;
+
+    for (lSet = 0; lSet < TOKENIZER_SETS; lSet++)
+    {
+        pMasks[lSet] = 0;
+    }
+
+    for (lOffset = 0; lOffset < TOKENIZER_BLOCK_SIZE; lOffset += 16)
+    {
+        /*
+        ** the low nibble picks the row entry, the high nibble picks the row
+        ** and the bit within the entry
+        */
+
+        lBytes = _mm_loadu_si128((const __m128i *) (pBlock + lOffset));
+
+        lLow = _mm_and_si128(lBytes, lNibble);
+        lHigh = _mm_and_si128(_mm_srli_epi16(lBytes, 4), lNibble);
+
+        lBit = _mm_shuffle_epi8(lBitTable, lHigh);
+        lUpper = _mm_cmpgt_epi8(lHigh, lSeven);
+
+        for (lSet = 0; lSet < TOKENIZER_SETS; lSet++)
+        {
+            lRow = _mm_or_si128(_mm_and_si128(lUpper, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) pSets[lSet].rows[1]), lLow)),
+                                _mm_andnot_si128(lUpper, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) pSets[lSet].rows[0]), lLow)));
+
+            pMasks[lSet] |= (uint64_t) (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lRow, lBit), lBit)) << lOffset;
+        }
+    }
+}
+
+TOKENIZER_TARGET("avx2") static void TokenizerKernelAvx2
+(
+    const unsigned char * pBlock,
+    const tokenizerSet * pSets,
+    uint64_t * pMasks
+)
+{
+    __m256i lNibble = _mm256_set1_epi8(0x0F);
+    __m256i lSeven = _mm256_set1_epi8(0x07);
+    __m256i lBitTable = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                         1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+
+    __m256i lBytes;
+    __m256i lLow;
+    __m256i lHigh;
+    __m256i lBit;
+    __m256i lUpper;
+    __m256i lRow;
+
+    unsigned int lSet;
+    unsigned int lOffset;
+
+    for (lSet = 0; lSet < TOKENIZER_SETS; lSet++)
+    {
+        pMasks[lSet] = 0;
+    }
+
+    for (lOffset = 0; lOffset < TOKENIZER_BLOCK_SIZE; lOffset += 32)
+    {
+        /*
+        ** the shuffle looks up within each 128 bit lane, so the rows are
+        ** repeated in both lanes
+        */
+
+        lBytes = _mm256_loadu_si256((const __m256i *) (pBlock + lOffset));
+
+        lLow = _mm256_and_si256(lBytes, lNibble);
+        lHigh = _mm256_and_si256(_mm256_srli_epi16(lBytes, 4), lNibble);
+
+        lBit = _mm256_shuffle_epi8(lBitTable, lHigh);
+        lUpper = _mm256_cmpgt_epi8(lHigh, lSeven);
+
+        for (lSet = 0; lSet < TOKENIZER_SETS; lSet++)
+        {
+            lRow = _mm256_blendv_epi8(_mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) pSets[lSet].rows[0])), lLow),
+                                      _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) pSets[lSet].rows[1])), lLow),
+                                      lUpper);
+
+            pMasks[lSet] |= (uint64_t) (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(lRow, lBit), lBit)) << lOffset;
+        }
+    }
+}
+
+#endif
+
+#ifdef TOKENIZER_NEON
+
+static void TokenizerKernelNeon
+(
+    const unsigned char * pBlock,
+    const tokenizerSet * pSets,
+    uint64_t * pMasks
+)
+{
+    static const unsigned char lBits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+
+    uint8x16_t lBitTable = vld1q_u8(lBits);
+    uint8x16_t lNibble = vdupq_n_u8(0x0F);
+    uint8x16_t lSeven = vdupq_n_u8(0x07);
+
+    uint8x16_t lBytes;
+    uint8x16_t lLow;
+    uint8x16_t lHigh;
+    uint8x16_t lBit;
+    uint8x16_t lUpper;
+    uint8x16_t lIn[TOKENIZER_SETS][4];
+    uint8x16_t lSum;
+
+    unsigned int lSet;
+    unsigned int lVector;
+
+    for (lVector = 0; lVector < 4; lVector++)
+    {
+        lBytes = vld1q_u8(pBlock + 16 * lVector);
+
+        lLow = vandq_u8(lBytes, lNibble);
+        lHigh = vshrq_n_u8(lBytes, 4);
+
+        lBit = vqtbl1q_u8(lBitTable, lHigh);
+        lUpper = vcgtq_u8(lHigh, lSeven);
+
+        for (lSet = 0; lSet < TOKENIZER_SETS; lSet++)
+        {
+            lIn[lSet][lVector] = vtstq_u8(vbslq_u8(lUpper, vqtbl1q_u8(vld1q_u8(pSets[lSet].rows[1]), lLow), vqtbl1q_u8(vld1q_u8(pSets[lSet].rows[0]), lLow)), lBit);
+        }
+    }
+
+    /*
+    ** NEON has no byte mask move, so each byte keeps the bit of its lane
+    ** and pairwise additions gather the 64 bits
+    */
+
+    for (lSet = 0; lSet < TOKENIZER_SETS; lSet++)
+    {
+        lSum = vpaddq_u8(vpaddq_u8(vandq_u8(lIn[lSet][0], lBitTable), vandq_u8(lIn[lSet][1], lBitTable)),
+                         vpaddq_u8(vandq_u8(lIn[lSet][2], lBitTable), vandq_u8(lIn[lSet][3], lBitTable)));
+
+        lSum = vpaddq_u8(lSum, lSum);
+
+        pMasks[lSet] = vgetq_lane_u64(vreinterpretq_u64_u8(lSum), 0);
+    }
+}
+
+#endif
+
+static size_t TokenizerQuoteEnd
+(
+    smartTokenizerHandle pTokenizer,
+    size_t pPosition
+)
+{
+    const unsigned char * lBuffer = pTokenizer->buffer;
+
+    unsigned char lQuote = lBuffer[pPosition++];
+
+    while (pPosition < pTokenizer->size)
+    {
+        if (lQuote == lBuffer[pPosition])
+        {
+            return(pPosition + 1);
+        }
+
+        /*
+        ** the escaped byte is skipped even if it is a quote
+        */
+
+        if (pTokenizer->escape == (int) lBuffer[pPosition])
+        {
+            pPosition++;
+        }
+
+        pPosition++;
+    }
+
+    return(pTokenizer->size);
+}
+
+static Bool TokenizerUnmap
+(
+    smartTokenizerHandle pTokenizer
+)
+{
+    if (NULL == pTokenizer->mapping)
+    {
+        return(TRUE);
+    }
+
+    if (!SafeFileUnmap(&pTokenizer->mapping, pTokenizer->mappingSize))
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    pTokenizer->buffer = NULL;
+    pTokenizer->size = 0;
+    pTokenizer->position = 0;
+
+    pTokenizer->mappingSize = 0;
+
+    return(TRUE);
+}
+
+static size_t TokenizerBoundary
+(
+    smartTokenizerHandle pTokenizer,
+    const unsigned char * pBuffer,
+    size_t pSize,
+    size_t pPosition
+)
+{
+    unsigned char lPrevious;
+    unsigned char lCurrent;
+
+    if (0 == pPosition || pPosition >= pSize)
+    {
+        return(pPosition < pSize ? pPosition : pSize);
+    }
+
+    /*
+    ** a byte is reduced to its run, word or white space, or to none for a
+    ** quote or punctuation byte, which always starts a token
+    */
+
+    lPrevious = pTokenizer->classes[pBuffer[pPosition - 1]];
+    lPrevious = (TOKENIZER_QUOTE & lPrevious) ? 0 : lPrevious & (TOKENIZER_WORD | TOKENIZER_SPACE);
+
+    for (; pPosition < pSize; pPosition++)
+    {
+        lCurrent = pTokenizer->classes[pBuffer[pPosition]];
+        lCurrent = (TOKENIZER_QUOTE & lCurrent) ? 0 : lCurrent & (TOKENIZER_WORD | TOKENIZER_SPACE);
+
+        if (0 == lCurrent || lCurrent != lPrevious)
+        {
+            return(pPosition);
+        }
+    }
+
+    return(pSize);
+}
+
+static int TokenizerScanRange
+(
+    void * pRange
+)
+{
+    tokenizerRange * lRange = (tokenizerRange *) pRange;
+
+    smartToken * lTokens;
+
+    size_t lCount;
+    size_t lIndex;
+    size_t lSpeculation = 0;
+
+    while (lRange->scanner.position < lRange->end)
+    {
+        if (!TokenizerGrowRange(lRange, lRange->count + TOKENIZER_PARALLEL_BATCH))
+        {
+            lRange->failed = TRUE;
+
+            return(0); // set breakpoint here for debugging
+        }
+
+        lTokens = lRange->tokens + lRange->count;
+
+        lCount = TokenizerScan(&lRange->scanner, lTokens, TOKENIZER_PARALLEL_BATCH);
+
+        for (lIndex = 0; lIndex < lCount; lIndex++)
+        {
+            /*
+            ** the range ends before the first token that starts past it
+            */
+
+            if (lTokens[lIndex].offset >= lRange->end)
+            {
+                lRange->count += lIndex;
+
+                return(0);
+            }
+
+            /*
+            ** once a token scanned again starts where one scanned from the
+            ** start did, the tokens from there on are the same
+            */
+
+            if (NULL != lRange->speculation)
+            {
+                while (lSpeculation < lRange->speculationCount && lRange->speculation[lSpeculation].offset < lTokens[lIndex].offset)
+                {
+                    lSpeculation++;
+                }
+
+                if (lSpeculation < lRange->speculationCount && lRange->speculation[lSpeculation].offset == lTokens[lIndex].offset)
+                {
+                    lRange->count += lIndex;
+
+                    if (!TokenizerGrowRange(lRange, lRange->count + lRange->speculationCount - lSpeculation))
+                    {
+                        lRange->failed = TRUE;
+
+                        return(0); // set breakpoint here for debugging
+                    }
+
+                    memcpy(lRange->tokens + lRange->count, lRange->speculation + lSpeculation, (lRange->speculationCount - lSpeculation) * sizeof(smartToken));
+
+                    lRange->count += lRange->speculationCount - lSpeculation;
+
+                    return(0);
+                }
+            }
+        }
+
+        lRange->count += lCount;
+    }
+
+    return(0);
+}
+
+static Bool TokenizerGrowRange
+(
+    tokenizerRange * pRange,
+    size_t pCapacity
+)
+{
+    size_t lCapacity;
+
+    if (pCapacity <= pRange->capacity)
+    {
+        return(TRUE);
+    }
+
+    /*
+    ** start from a guess of a token every four bytes and double from there
+    */
+
+    lCapacity = (0 != pRange->capacity) ? pRange->capacity : TOKENIZER_PARALLEL_BATCH + (pRange->end - pRange->start) / 4;
+
+    while (lCapacity < pCapacity)
+    {
+        lCapacity *= 2;
+    }
+
+    if (NULL == pRange->tokens)
+    {
+        if (!SafeMalloc(&pRange->tokens, lCapacity * sizeof(smartToken)))
+        {
+            return(FALSE); // set breakpoint here for debugging
+        }
+    }
+    else if (!SafeRealloc(&pRange->tokens, lCapacity * sizeof(smartToken)))
+    {
+        return(FALSE); // set breakpoint here for debugging
+    }
+
+    pRange->capacity = lCapacity;
+
+    return(TRUE);
+}
+
+static void TokenizerRunRanges
+(
+    tokenizerRange * pRanges,
+    size_t pCount,
+    const Bool * pRun
+)
+{
+    size_t lIndex;
+
+    for (lIndex = 1; lIndex < pCount; lIndex++)
+    {
+        if (NULL == pRun || pRun[lIndex])
+        {
+            pRanges[lIndex].threaded = (thrd_success == thrd_create(&pRanges[lIndex].thread, TokenizerScanRange, &pRanges[lIndex]));
+
+            if (!pRanges[lIndex].threaded)
+            {
+                TokenizerScanRange(&pRanges[lIndex]);
+            }
+        }
+    }
+
+    if (NULL == pRun || pRun[0])
+    {
+        TokenizerScanRange(&pRanges[0]);
+    }
+
+    for (lIndex = 1; lIndex < pCount; lIndex++)
+    {
+        if (pRanges[lIndex].threaded)
+        {
+            thrd_join(pRanges[lIndex].thread, NULL);
+
+            pRanges[lIndex].threaded = FALSE;
+        }
+    }
+}
+
+static size_t TokenizerSkipRange
+(
+    smartTokenizerHandle pTokenizer,
+    size_t pPosition,
+    size_t pEnd
+)
+{
+    /*
+    ** outside strings the end of the range is a token boundary, so only a
+    ** string can carry the position past it
+    */
+
+    while (pPosition < pEnd)
+    {
+        if (TOKENIZER_QUOTE & pTokenizer->classes[pTokenizer->buffer[pPosition]])
+        {
+            pPosition = TokenizerQuoteEnd(pTokenizer, pPosition);
+        }
+        else
+        {
+            pPosition++;
+        }
+    }
+
+    return(pPosition);
+}
+
+static size_t TokenizerContinue
+(
+    smartTokenizerHandle pTokenizer,
+    size_t pLimit,
+    Bool * pComplete
+)
+{
+    const unsigned char * lBuffer = pTokenizer->buffer;
+
+    size_t lPosition = pTokenizer->position;
+
+    unsigned char lFlags;
+
+    if (SMART_TOKEN_STRING == pTokenizer->carryClass)
+    {
+        for (; lPosition < pLimit; lPosition++)
+        {
+            if (pTokenizer->carryEscaped)
+            {
+                pTokenizer->carryEscaped = FALSE;
+            }
+            else if (pTokenizer->carryQuote == lBuffer[lPosition])
+            {
+                *pComplete = TRUE;
+
+                return(lPosition + 1);
+            }
+            else if (pTokenizer->escape == (int) lBuffer[lPosition])
+            {
+                pTokenizer->carryEscaped = TRUE;
+            }
+        }
+
+        *pComplete = FALSE;
+
+        return(lPosition);
+    }
+
+    lFlags = (SMART_TOKEN_WHITESPACE == pTokenizer->carryClass) ? TOKENIZER_SPACE : TOKENIZER_WORD;
+
+    while (lPosition < pLimit && lFlags == (pTokenizer->classes[lBuffer[lPosition]] & (lFlags | TOKENIZER_QUOTE)))
+    {
+        lPosition++;
+    }
+
+    *pComplete = (lPosition < pLimit);
+
+    return(lPosition);
+}
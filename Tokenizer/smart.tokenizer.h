@@ -1,4 +1,656 @@
-#ifndef TOKENIZER_H
-#define TOKENIZER_H
+/*----------------------------------------------------------------------------
+  Smart Tokenizer
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
 
-#endif
\ No newline at end of file
+/*----------------------------------------------------------------------------
+  Smart Tokenizer internal header file
+  ----------------------------------------------------------------------------*/
+
+#ifndef SMART_TOKENIZER_H
+#define SMART_TOKENIZER_H
+
+#include <stdint.h>
+#include <threads.h>
+
+#include "smart.tokenizer.t.h"
+
+#if defined __x86_64__ || defined __i386__ || defined _M_X64 || defined _M_IX86
+
+#define TOKENIZER_X86
+
+#endif
+
+#if defined __aarch64__ || defined _M_ARM64
+
+#define TOKENIZER_NEON
+
+#include <arm_neon.h>
+
+#endif
+
+#if defined _MSC_VER
+
+#include <intrin.h>
+
+#define TokenizerCountTrailingZeros(pWord) TokenizerBitScanForward(pWord)
+
+#define TOKENIZER_TARGET(pTarget)
+
+static __inline unsigned int TokenizerBitScanForward(uint64_t pWord)
+{
+    unsigned long lIndex;
+
+    _BitScanForward64(&lIndex, pWord);
+
+    return((unsigned int) lIndex);
+}
+
+#else
+
+#ifdef TOKENIZER_X86
+
+#include <immintrin.h>
+
+#endif
+
+#define TokenizerCountTrailingZeros(pWord) ((unsigned int) __builtin_ctzll(pWord))
+
+/*
+** a kernel for a wider instruction set is compiled for it alone, and is
+** only called once the processor is known to support it
+*/
+
+#define TOKENIZER_TARGET(pTarget) __attribute__((target(pTarget)))
+
+#endif
+
+/*----------------------------------------------------------------------------
+  Private defines
+  ----------------------------------------------------------------------------*/
+
+/*
+** byte flags of the class table, a digit that is not a delimiter is also a
+** word byte
+*/
+
+#define TOKENIZER_WORD        0x01
+#define TOKENIZER_DIGIT       0x02
+#define TOKENIZER_SPACE       0x04
+#define TOKENIZER_PUNCTUATION 0x08
+#define TOKENIZER_QUOTE       0x10
+
+#define TOKENIZER_BYTES       256
+
+/*
+** the kernel classifies a block against two sets, the bytes that continue a
+** word or number and those that continue white space
+*/
+
+#define TOKENIZER_WORD_SET    0
+#define TOKENIZER_SPACE_SET   1
+#define TOKENIZER_SETS        2
+
+#define TOKENIZER_BLOCK_SIZE  64
+
+/*
+** the carry buffer of a stream holds the part of a token seen in earlier
+** chunks
+*/
+
+#define TOKENIZER_DEFAULT_CARRY 4096
+
+/*
+** a file is mapped on a huge page boundary so that its mapping can be
+** backed by huge pages
+*/
+
+#define TOKENIZER_MAP_ALIGNMENT ((size_t) 2 * 1024 * 1024)
+
+/*
+** an input is split into ranges of at least 64K for parallel tokenizing, a
+** thread costs more than tokenizing less, and each range is scanned a batch
+** of tokens at a time
+*/
+
+#define TOKENIZER_PARALLEL_MINIMUM ((size_t) 64 * 1024)
+#define TOKENIZER_PARALLEL_BATCH   256
+
+#define TOKENIZER_DEFAULT_DELIMITERS " \t\r\n\v\f!\"#$%&'()*+,-./:;<=>?@[\\]^`{|}~"
+
+/*----------------------------------------------------------------------------
+  Private data types
+  ----------------------------------------------------------------------------*/
+
+/*
+** a set is a 256 bit lookup, and the same lookup arranged for a byte
+** shuffle: row n holds, for each low nibble, the bits of the high nibbles
+** 8n to 8n+7
+*/
+
+typedef struct tokenizerSet {
+    uint64_t bits[TOKENIZER_BYTES / 64];
+
+    unsigned char rows[2][16];
+} tokenizerSet;
+
+/*
+** a kernel sets bit n of the mask of a set when byte n of the block is in
+** the set
+*/
+
+typedef void (* tokenizerKernel)(const unsigned char * pBlock, const tokenizerSet * pSets, uint64_t * pMasks);
+
+typedef struct smartTokenizer {
+    unsigned char classes[TOKENIZER_BYTES];
+
+    int escape;
+
+    tokenizerSet sets[TOKENIZER_SETS];
+
+    tokenizerKernel kernel;                                         /* NULL for the scalar fallback */
+    unsigned int kernelId;
+
+    const unsigned char * buffer;
+    size_t size;
+    size_t position;
+
+    /*
+    ** the set and token start masks of the block holding the position (the
+    ** starts are only meaningful outside quoted strings)
+    */
+
+    Bool blockValid;
+    size_t blockBase;
+    uint64_t blockMasks[TOKENIZER_SETS];
+    uint64_t blockStarts;
+
+    /*
+    ** a stream runs over its chunks in turn, the buffer being the current
+    ** chunk and the chunk offset its offset in the stream
+    */
+
+    Bool streaming;
+    Bool finished;
+    size_t chunkOffset;
+
+    /*
+    ** the token carried from chunk to chunk: its class, its offset in the
+    ** stream and its bytes so far, with the quote and escape state of a
+    ** string
+    */
+
+    Bool carrying;
+    unsigned int carryClass;
+    size_t carryOffset;
+    unsigned char * carry;
+    size_t carryCapacity;
+    size_t carryLength;
+    unsigned char carryQuote;
+    Bool carryEscaped;
+
+    /*
+    ** the mapping of the file opened by SmartTokenizerOpenFile(), which is
+    ** then the buffer
+    */
+
+    void * mapping;
+    size_t mappingSize;
+} smartTokenizer;
+
+typedef smartTokenizer * smartTokenizerHandle;
+
+/*
+** a range of an input tokenized in parallel, scanned by a copy of the
+** tokenizer from its start (or from its entry once that is known) up to
+** the first token that starts at or past its end
+*/
+
+typedef struct tokenizerRange {
+    smartTokenizer scanner;
+
+    size_t start;
+    size_t end;
+
+    smartToken * tokens;
+    size_t count;
+    size_t capacity;
+
+    /*
+    ** the tokens scanned from the start when they were found wrong, which
+    ** the tokens scanned from the entry rejoin at the first token both
+    ** have
+    */
+
+    smartToken * speculation;
+    size_t speculationCount;
+
+    thrd_t thread;
+    Bool threaded;
+
+    Bool failed;
+} tokenizerRange;
+
+/*----------------------------------------------------------------------------
+  Private function prototypes
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  TokenizerClassify()
+  ----------------------------------------------------------------------------
+  Rebuild the class table from a delimiter set, keeping the quote bytes
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer  - (I) The tokenizer handle
+  pDelimiters - (I) The delimiter bytes
+  pLength     - (I) The number of delimiter bytes
+  ----------------------------------------------------------------------------*/
+
+static void TokenizerClassify
+(
+    smartTokenizerHandle pTokenizer,
+    const unsigned char * pDelimiters,
+    size_t pLength
+);
+
+/*----------------------------------------------------------------------------
+  TokenizerScan()
+  ----------------------------------------------------------------------------
+  Scan tokens from the position of the tokenizer and move past them, a byte
+  at a time or, when there is a kernel, with TokenizerScanBlocks()
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  pTokens    - (O) The spans and classes of the tokens
+  pCapacity  - (I) The most tokens to scan
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  The number of tokens scanned, zero once the whole buffer is tokenized
+  ----------------------------------------------------------------------------*/
+
+static size_t TokenizerScan
+(
+    smartTokenizerHandle pTokenizer,
+    smartToken * pTokens,
+    size_t pCapacity
+);
+
+/*----------------------------------------------------------------------------
+  TokenizerScanBlocks()
+  ----------------------------------------------------------------------------
+  TokenizerScan() from the masks the kernel makes of each block of 64 bytes
+  ----------------------------------------------------------------------------*/
+
+static size_t TokenizerScanBlocks
+(
+    smartTokenizerHandle pTokenizer,
+    smartToken * pTokens,
+    size_t pCapacity
+);
+
+/*----------------------------------------------------------------------------
+  TokenizerSpan()
+  ----------------------------------------------------------------------------
+  Find the end of a run of bytes whose class table entries have a flag set
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  pPosition  - (I) The offset of the first byte to test
+  pFlags     - (I) The class table flag of the run
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  The offset of the first byte past the run
+  ----------------------------------------------------------------------------*/
+
+static size_t TokenizerSpan
+(
+    smartTokenizerHandle pTokenizer,
+    size_t pPosition,
+    unsigned char pFlags
+);
+
+/*----------------------------------------------------------------------------
+  TokenizerNextStart()
+  ----------------------------------------------------------------------------
+  Find the start of the token that follows a word, number or whitespace
+  token from the token start masks of the blocks
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  pPosition  - (I) The offset of the start of the token, in the loaded block
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  The offset of the first byte past the token
+  ----------------------------------------------------------------------------*/
+
+static size_t TokenizerNextStart
+(
+    smartTokenizerHandle pTokenizer,
+    size_t pPosition
+);
+
+/*----------------------------------------------------------------------------
+  TokenizerLoadBlock()
+  ----------------------------------------------------------------------------
+  Classify the block at an offset with the kernel, padding a block cut
+  short by the end of the input so that its missing bytes are in no set,
+  and derive the mask of the bytes that start a token
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  pBase      - (I) The offset of the block, a multiple of the block size
+  ----------------------------------------------------------------------------*/
+
+static void TokenizerLoadBlock
+(
+    smartTokenizerHandle pTokenizer,
+    size_t pBase
+);
+
+/*----------------------------------------------------------------------------
+  TokenizerCompileSets()
+  ----------------------------------------------------------------------------
+  Rebuild the sets of the kernel from the class table
+  ----------------------------------------------------------------------------*/
+
+static void TokenizerCompileSets
+(
+    smartTokenizerHandle pTokenizer
+);
+
+/*----------------------------------------------------------------------------
+  TokenizerKernelSupported()
+  ----------------------------------------------------------------------------
+  Check whether the processor supports a kernel, with CPUID on x86
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pKernel - (I) The kernel, SMART_TOKENIZER_KERNEL_AUTO selects the widest
+                supported one
+  pFound  - (O) The kernel function, NULL for the scalar fallback
+  pId     - (O) The kernel
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The kernel is supported
+
+  False - The kernel is unknown or not supported
+  ----------------------------------------------------------------------------*/
+
+static Bool TokenizerKernelSupported
+(
+    unsigned int pKernel,
+    tokenizerKernel * pFound,
+    unsigned int * pId
+);
+
+#ifdef TOKENIZER_X86
+
+/*----------------------------------------------------------------------------
+  TokenizerKernelSsse3()
+  ----------------------------------------------------------------------------
+  Classify a block 16 bytes at a time with byte shuffle lookups (SSE2 has no
+  byte shuffle, so the narrowest vector kernel needs SSSE3)
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pBlock - (I) The block
+  pSets  - (I) The sets
+  pMasks - (O) A mask for each set
+  ----------------------------------------------------------------------------*/
+
+static void TokenizerKernelSsse3
+(
+    const unsigned char * pBlock,
+    const tokenizerSet * pSets,
+    uint64_t * pMasks
+);
+
+/*----------------------------------------------------------------------------
+  TokenizerKernelAvx2()
+  ----------------------------------------------------------------------------
+  TokenizerKernelSsse3() 32 bytes at a time
+  ----------------------------------------------------------------------------*/
+
+static void TokenizerKernelAvx2
+(
+    const unsigned char * pBlock,
+    const tokenizerSet * pSets,
+    uint64_t * pMasks
+);
+
+#endif
+
+#ifdef TOKENIZER_NEON
+
+/*----------------------------------------------------------------------------
+  TokenizerKernelNeon()
+  ----------------------------------------------------------------------------
+  TokenizerKernelSsse3() with NEON table lookups
+  ----------------------------------------------------------------------------*/
+
+static void TokenizerKernelNeon
+(
+    const unsigned char * pBlock,
+    const tokenizerSet * pSets,
+    uint64_t * pMasks
+);
+
+#endif
+
+/*----------------------------------------------------------------------------
+  TokenizerQuoteEnd()
+  ----------------------------------------------------------------------------
+  Find the end of the quoted string opened at an offset, skipping the byte
+  that follows each escape byte
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  pPosition  - (I) The offset of the opening quote
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  The offset of the first byte past the closing quote, or the size of the
+  input when the string is not closed
+  ----------------------------------------------------------------------------*/
+
+static size_t TokenizerQuoteEnd
+(
+    smartTokenizerHandle pTokenizer,
+    size_t pPosition
+);
+
+/*----------------------------------------------------------------------------
+  TokenizerUnmap()
+  ----------------------------------------------------------------------------
+  Release the mapping of the file the tokenizer opened, if any
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - There is no longer a mapping
+
+  False - The SafeFileUnmap() failed
+  ----------------------------------------------------------------------------*/
+
+static Bool TokenizerUnmap
+(
+    smartTokenizerHandle pTokenizer
+);
+
+/*----------------------------------------------------------------------------
+  TokenizerBoundary()
+  ----------------------------------------------------------------------------
+  Find the first offset at or past an offset where a token would start
+  outside a quoted string, judging each byte by the byte before it
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  pBuffer    - (I) The input
+  pSize      - (I) The number of bytes in the input
+  pPosition  - (I) The offset to start from
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  The offset, or the size of the input when there is none
+  ----------------------------------------------------------------------------*/
+
+static size_t TokenizerBoundary
+(
+    smartTokenizerHandle pTokenizer,
+    const unsigned char * pBuffer,
+    size_t pSize,
+    size_t pPosition
+);
+
+/*----------------------------------------------------------------------------
+  TokenizerScanRange()
+  ----------------------------------------------------------------------------
+  Scan the tokens of a range, the start function of a range's thread
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pRange - (I/O) The range
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  Zero
+  ----------------------------------------------------------------------------*/
+
+static int TokenizerScanRange
+(
+    void * pRange
+);
+
+/*----------------------------------------------------------------------------
+  TokenizerGrowRange()
+  ----------------------------------------------------------------------------
+  Make room in the token array of a range
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pRange    - (I/O) The range
+  pCapacity - (I)   The number of tokens the array must hold
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The array holds the tokens
+
+  False - The SafeMalloc() or SafeRealloc() failed
+  ----------------------------------------------------------------------------*/
+
+static Bool TokenizerGrowRange
+(
+    tokenizerRange * pRange,
+    size_t pCapacity
+);
+
+/*----------------------------------------------------------------------------
+  TokenizerRunRanges()
+  ----------------------------------------------------------------------------
+  Scan ranges at once, each but the first on a thread of its own (or on
+  the calling thread when no thread can be created)
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pRanges - (I/O) The ranges
+  pCount  - (I)   The number of ranges
+  pRun    - (I)   Which ranges to scan, NULL for all of them
+  ----------------------------------------------------------------------------*/
+
+static void TokenizerRunRanges
+(
+    tokenizerRange * pRanges,
+    size_t pCount,
+    const Bool * pRun
+);
+
+/*----------------------------------------------------------------------------
+  TokenizerSkipRange()
+  ----------------------------------------------------------------------------
+  Skip from the start of a token to the first token that starts at or past
+  the end of a range, following only the quoted strings
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle, running over the input
+  pPosition  - (I) The offset of the start of a token
+  pEnd       - (I) The end of the range, a token boundary outside strings
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  The offset of the start of the token
+  ----------------------------------------------------------------------------*/
+
+static size_t TokenizerSkipRange
+(
+    smartTokenizerHandle pTokenizer,
+    size_t pPosition,
+    size_t pEnd
+);
+
+/*----------------------------------------------------------------------------
+  TokenizerContinue()
+  ----------------------------------------------------------------------------
+  Find how far the carried token continues into the chunk from the position
+  of the tokenizer, a byte at a time, keeping the escape state of a string
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  pLimit     - (I) The offset past the last byte that fits the carry buffer
+  pComplete  - (O) Whether the token ends before the limit
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  The offset of the first byte past the part of the token found
+  ----------------------------------------------------------------------------*/
+
+static size_t TokenizerContinue
+(
+    smartTokenizerHandle pTokenizer,
+    size_t pLimit,
+    Bool * pComplete
+);
+
+#endif
@@ -1,4 +1,630 @@
-#ifndef TOKENIZER_I_H
-#define TOKENIZER_I_H
+/*----------------------------------------------------------------------------
+  Smart Tokenizer
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
 
-#endif
\ No newline at end of file
+/*----------------------------------------------------------------------------
+  Smart Tokenizer application programmer's interface (API) header file
+  ----------------------------------------------------------------------------*/
+
+#ifndef SMART_TOKENIZER_I_H
+#define SMART_TOKENIZER_I_H
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerConstructSmartTokenizer()
+  ----------------------------------------------------------------------------
+  Construct a tokenizer with the default delimiter set and no quotes.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I/O) Pointer to recieve the tokenizer handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Tokenizer was succesfully constructed
+
+  False - Tokenizer was not successfully constructed due to:
+
+          1. The tokenizer handle pointer was NULL
+          2. The SafeMalloc() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  This function requires the contents of the pTokenizer handle to be
+  initialized to NULL prior to calling this function.
+
+  A tokenizer runs over a buffer owned by the caller and returns each token
+  as a span of the buffer (see smartToken), so no memory is allocated or
+  copied per token. The default delimiters are the white space and the
+  ASCII punctuation bytes other than the underscore.
+
+  A tokenizer is not thread safe, it is intended to be used by a single
+  thread (or to be guarded by the caller).
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerConstructSmartTokenizer
+(
+    smartTokenizerHandle * pTokenizer
+);
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerDestructSmartTokenizer()
+  ----------------------------------------------------------------------------
+  Destruct a tokenizer. The buffer it was running over is not touched, a
+  file it opened is closed.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I/O) Pointer to the tokenizer handle, set to NULL
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Tokenizer was succesfully destructed
+
+  False - Tokenizer was not successfully destructed due to:
+
+          1. The tokenizer handle pointer was NULL or pointed to NULL
+          2. The SafeFileUnmap() or SafeFree() failed
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerDestructSmartTokenizer
+(
+    smartTokenizerHandle * pTokenizer
+);
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerSetDelimiters()
+  ----------------------------------------------------------------------------
+  Replace the delimiter set of a tokenizer.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer  - (I) The tokenizer handle
+  pDelimiters - (I) The delimiter bytes, NULL to restore the default set
+  pLength     - (I) The number of delimiter bytes (a zero byte may be one)
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The delimiter set was replaced
+
+  False - The tokenizer handle was NULL
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Delimiters end words and numbers. A white space delimiter is part of a
+  whitespace token, any other delimiter is a punctuation token of its own.
+  A byte that is not a delimiter is part of a word or number, so a set of
+  only "," splits comma separated values and keeps the spaces in the
+  fields.
+
+  A quote byte stays a quote whether or not it is in the delimiter set.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerSetDelimiters
+(
+    smartTokenizerHandle pTokenizer,
+    const char * pDelimiters,
+    size_t pLength
+);
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerSetQuotes()
+  ----------------------------------------------------------------------------
+  Replace the quote bytes of a tokenizer. A quote byte opens a string token
+  that is closed by the same byte.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  pQuotes    - (I) The quote bytes, NULL for none
+  pLength    - (I) The number of quote bytes
+  pEscape    - (I) The byte that escapes the byte following it inside a
+                   string, SMART_TOKENIZER_NO_ESCAPE for none
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The quote bytes were replaced
+
+  False - The quote bytes were not replaced due to:
+
+          1. The tokenizer handle was NULL
+          2. The escape was not a byte or SMART_TOKENIZER_NO_ESCAPE
+  ----------------------------------------------------------------------------
+  Notes:
+
+  A string token spans its quotes and the escapes inside it; it is the
+  caller that unescapes the string when it needs its value. A string that
+  is not closed runs to the end of the input.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerSetQuotes
+(
+    smartTokenizerHandle pTokenizer,
+    const char * pQuotes,
+    size_t pLength,
+    int pEscape
+);
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerBegin()
+  ----------------------------------------------------------------------------
+  Start tokenizing a buffer from its first byte.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  pBuffer    - (I) The buffer, which must not change or be freed while it
+                   is tokenized
+  pSize      - (I) The number of bytes in the buffer
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The buffer will be tokenized
+
+  False - The buffer will not be tokenized due to:
+
+          1. The tokenizer handle was NULL
+          2. The buffer was NULL and its size was not zero
+          3. The SafeFileUnmap() of the file opened before failed
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerBegin
+(
+    smartTokenizerHandle pTokenizer,
+    const char * pBuffer,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerOpenFile()
+  ----------------------------------------------------------------------------
+  Map a file into memory and start tokenizing it from its first byte.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  pPath      - (I) The path of the file
+  pBuffer    - (O) The first byte of the mapped file, which the spans of its
+                   tokens are offsets into (NULL for an empty file)
+  pSize      - (O) The number of bytes in the file
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The file will be tokenized
+
+  False - The file will not be tokenized due to:
+
+          1. The tokenizer handle, path, buffer pointer or size pointer was
+             NULL
+          2. The SafeFileUnmap() of the file opened before failed
+          3. The SafeFileMapRead() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The file is mapped read only rather than read into a buffer, so it is
+  neither copied nor held in memory as a whole; the mapping is advised to
+  be read sequentially and to be backed by huge pages. The tokens are then
+  taken with SmartTokenizerNext() or SmartTokenizerNextBatch() as for a
+  buffer. The mapping stays valid until SmartTokenizerCloseFile(),
+  SmartTokenizerBegin(), SmartTokenizerBeginStream(), the next
+  SmartTokenizerOpenFile() or the destruction of the tokenizer, which all
+  release it.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerOpenFile
+(
+    smartTokenizerHandle pTokenizer,
+    const char * pPath,
+    const char ** pBuffer,
+    size_t * pSize
+);
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerCloseFile()
+  ----------------------------------------------------------------------------
+  Release the mapping of the file opened by SmartTokenizerOpenFile(), so
+  that the tokenizer is left with nothing to tokenize.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The file was closed, or none was open
+
+  False - The file was not closed due to:
+
+          1. The tokenizer handle was NULL
+          2. The SafeFileUnmap() failed
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerCloseFile
+(
+    smartTokenizerHandle pTokenizer
+);
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerNext()
+  ----------------------------------------------------------------------------
+  Get the next token of the buffer.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  pToken     - (O) The span and class of the token
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - A token was returned
+
+  False - No token was returned due to:
+
+          1. The tokenizer handle or token pointer was NULL
+          2. The whole buffer has been tokenized
+          3. A stream was begun
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerNext
+(
+    smartTokenizerHandle pTokenizer,
+    smartToken * pToken
+);
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerNextBatch()
+  ----------------------------------------------------------------------------
+  Get up to a number of the next tokens of the buffer into an array, saving
+  a call per token.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  pTokens    - (O) The array of tokens
+  pCapacity  - (I) The number of tokens the array holds
+  pCount     - (O) The number of tokens returned
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - One or more tokens were returned
+
+  False - No token was returned due to:
+
+          1. The tokenizer handle, token array or count pointer was NULL
+          2. The capacity was zero
+          3. The whole buffer has been tokenized
+          4. A stream was begun
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerNextBatch
+(
+    smartTokenizerHandle pTokenizer,
+    smartToken * pTokens,
+    size_t pCapacity,
+    size_t * pCount
+);
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerBeginStream()
+  ----------------------------------------------------------------------------
+  Start tokenizing a stream that the caller feeds a chunk at a time.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer     - (I) The tokenizer handle
+  pCarryCapacity - (I) The most bytes of a token carried from one chunk to
+                       the next, zero for 4096
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The stream was begun
+
+  False - The stream was not begun due to:
+
+          1. The tokenizer handle was NULL
+          2. The SafeFileUnmap() of the file opened before failed
+          3. The SafeMalloc() or SafeFree() of the carry buffer failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  A stream is fed with SmartTokenizerFeed(), its tokens are taken with
+  SmartTokenizerStreamNext() until it returns False, and the next chunk is
+  fed; SmartTokenizerFinish() ends the input. SmartTokenizerNext() and
+  SmartTokenizerNextBatch() return no tokens while a stream is begun,
+  SmartTokenizerBegin() ends it.
+
+  A token inside a chunk is returned in place. Only a token that reaches
+  the end of a chunk, and so may go on in the next one, is copied into the
+  carry buffer, which is allocated once here; so the memory a stream uses
+  does not grow with its length. A token longer than the carry buffer is
+  returned in pieces of the same class as it is read, only the first piece
+  of a string starting with its quote.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerBeginStream
+(
+    smartTokenizerHandle pTokenizer,
+    size_t pCarryCapacity
+);
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerFeed()
+  ----------------------------------------------------------------------------
+  Feed the next chunk of a stream.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  pChunk     - (I) The chunk, which must not change or be freed until the
+                   next chunk is fed or the stream is finished and its
+                   tokens taken
+  pSize      - (I) The number of bytes in the chunk
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The chunk was fed
+
+  False - The chunk was not fed due to:
+
+          1. The tokenizer handle was NULL
+          2. The chunk was NULL and its size was not zero
+          3. No stream was begun or the stream was finished
+          4. The tokens of the previous chunk were not all taken
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerFeed
+(
+    smartTokenizerHandle pTokenizer,
+    const char * pChunk,
+    size_t pSize
+);
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerFinish()
+  ----------------------------------------------------------------------------
+  End the input of a stream, so that the token carried at its end is
+  returned by SmartTokenizerStreamNext().
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The stream was finished
+
+  False - The stream was not finished due to:
+
+          1. The tokenizer handle was NULL
+          2. No stream was begun
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerFinish
+(
+    smartTokenizerHandle pTokenizer
+);
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerStreamNext()
+  ----------------------------------------------------------------------------
+  Get the next complete token of a stream.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  pToken     - (O) The span and class of the token, its offset being from
+                   the start of the stream
+  pText      - (O) The first byte of the token, in the chunk or in the carry
+                   buffer, valid until the next call on the tokenizer
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - A token was returned
+
+  False - No token was returned due to:
+
+          1. The tokenizer handle, token or text pointer was NULL
+          2. No stream was begun
+          3. The chunk has been tokenized and the next is needed, or the
+             stream is finished and has been tokenized
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerStreamNext
+(
+    smartTokenizerHandle pTokenizer,
+    smartToken * pToken,
+    const char ** pText
+);
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerTokenizeParallel()
+  ----------------------------------------------------------------------------
+  Tokenize a whole buffer on several threads, returning the tokens of each
+  range of it in an array of its own.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer  - (I)   The tokenizer handle, whose delimiters, quotes and
+                      kernel are used (its own buffer and position are not)
+  pBuffer     - (I)   The buffer
+  pSize       - (I)   The number of bytes in the buffer
+  pThreads    - (I)   The most ranges, and so threads, to split the buffer
+                      into
+  pRanges     - (I/O) Pointer to recieve the array of ranges, in the order
+                      of the buffer
+  pRangeCount - (O)   The number of ranges
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The buffer was tokenized
+
+  False - The buffer was not tokenized due to:
+
+          1. The tokenizer handle, range array pointer or range count
+             pointer was NULL
+          2. The buffer was NULL and its size was not zero
+          3. The thread count was zero
+          4. The range array pointer did not point to NULL
+          5. The SafeCalloc(), SafeMalloc() or SafeRealloc() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The tokens of the ranges, one after the other, are those that
+  SmartTokenizerNextBatch() returns for the buffer; their offsets are from
+  the start of the buffer. The ranges are at least 64K, so a small buffer
+  is tokenized in fewer ranges than threads, down to a single range on the
+  calling thread. The ranges and their token arrays must be freed with
+  SmartTokenizerFreeRanges().
+
+  The buffer is split evenly and each split moved on to the next byte
+  where a token would start outside a quoted string, then the ranges are
+  tokenized at once, each as if it started outside a string. A range
+  whose start turns out to be inside a string, because a string of the
+  range before it runs past it, keeps its tokens from the first one that
+  starts where that string ends; when there is none it is tokenized again
+  from there, again at once with any other such range, rejoining its first
+  tokens where they agree. Long strings and unbalanced quotes only cost
+  time, the tokens are the same.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerTokenizeParallel
+(
+    smartTokenizerHandle pTokenizer,
+    const char * pBuffer,
+    size_t pSize,
+    size_t pThreads,
+    smartTokenRange ** pRanges,
+    size_t * pRangeCount
+);
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerFreeRanges()
+  ----------------------------------------------------------------------------
+  Free the ranges returned by SmartTokenizerTokenizeParallel() and their
+  token arrays.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pRanges     - (I/O) Pointer to the array of ranges, set to NULL
+  pRangeCount - (I)   The number of ranges
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The ranges were freed
+
+  False - The ranges were not freed due to:
+
+          1. The range array pointer was NULL or pointed to NULL
+          2. The SafeFree() failed
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerFreeRanges
+(
+    smartTokenRange ** pRanges,
+    size_t pRangeCount
+);
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerSetKernel()
+  ----------------------------------------------------------------------------
+  Choose the kernel that classifies the input, overriding the automatic
+  choice made when the tokenizer was constructed.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) The tokenizer handle
+  pKernel    - (I) The kernel, SMART_TOKENIZER_KERNEL_AUTO for the widest
+                   kernel the processor supports
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The kernel was chosen
+
+  False - The kernel was not chosen due to:
+
+          1. The tokenizer handle was NULL
+          2. The kernel is unknown, not compiled for this processor family
+             or not supported by this processor
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Each kernel produces the same tokens. The kernels classify 64 bytes of
+  input at a time into a bit mask per run class (word and number bytes,
+  white space bytes), the first byte outside a run's class ending it. The
+  vector kernels look the bytes up in the delimiter set with byte shuffles,
+  and are chosen on x86 by CPUID and always used on AArch64.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTokenizerSetKernel
+(
+    smartTokenizerHandle pTokenizer,
+    unsigned int pKernel
+);
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerGetKernel()
+  ----------------------------------------------------------------------------
+  Get the kernel that classifies the input.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) Tokenizer handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  The kernel, SMART_TOKENIZER_KERNEL_AUTO when there is no tokenizer
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS unsigned int CALLING_CONVENTION SmartTokenizerGetKernel
+(
+    smartTokenizerHandle pTokenizer
+);
+
+/*----------------------------------------------------------------------------
+  SmartTokenizerGetPosition()
+  ----------------------------------------------------------------------------
+  Get the offset of the first byte of the buffer, or of the chunk of a
+  stream, not yet tokenized.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTokenizer - (I) Tokenizer handle
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  The offset, zero when there is no tokenizer
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS size_t CALLING_CONVENTION SmartTokenizerGetPosition
+(
+    smartTokenizerHandle pTokenizer
+);
+
+#endif
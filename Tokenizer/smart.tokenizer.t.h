@@ -0,0 +1,120 @@
+/*----------------------------------------------------------------------------
+  Smart Tokenizer
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Tokenizer application programmer's types (APT) header file
+  ----------------------------------------------------------------------------*/
+
+#ifndef SMART_TOKENIZER_T_H
+#define SMART_TOKENIZER_T_H
+
+/*----------------------------------------------------------------------------
+  Token classes
+  ----------------------------------------------------------------------------
+  word        - A run of bytes that are not delimiters, not starting with a
+                decimal digit
+  number      - A run of bytes that are not delimiters, starting with a
+                decimal digit
+  punctuation - A single delimiter byte that is not white space
+  whitespace  - A run of delimiter bytes that are white space
+  string      - A quoted string, from its opening quote through its closing
+                quote (or the end of the input when it is not closed)
+  ----------------------------------------------------------------------------*/
+
+#define SMART_TOKEN_WORD        1
+#define SMART_TOKEN_NUMBER      2
+#define SMART_TOKEN_PUNCTUATION 3
+#define SMART_TOKEN_WHITESPACE  4
+#define SMART_TOKEN_STRING      5
+
+/*----------------------------------------------------------------------------
+  Token span
+  ----------------------------------------------------------------------------
+  A token is returned as a span of the input rather than a copy: the offset
+  of its first byte from the start of the input, its length in bytes and
+  its class. The spans of the tokens of an input tile it without gaps.
+  ----------------------------------------------------------------------------*/
+
+typedef struct smartToken {
+    size_t offset;
+    size_t length;
+
+    unsigned int tokenClass;
+} smartToken;
+
+/*----------------------------------------------------------------------------
+  Token range
+  ----------------------------------------------------------------------------
+  The tokens of one range of an input tokenized in parallel: the span of
+  the input they tile and the array of them, allocated by the tokenizer
+  and freed with SmartTokenizerFreeRanges().
+  ----------------------------------------------------------------------------*/
+
+typedef struct smartTokenRange {
+    size_t offset;
+    size_t length;
+
+    smartToken * tokens;
+    size_t count;
+} smartTokenRange;
+
+/*----------------------------------------------------------------------------
+  Escape byte passed to SmartTokenizerSetQuotes() for quoted strings
+  without escapes
+  ----------------------------------------------------------------------------*/
+
+#define SMART_TOKENIZER_NO_ESCAPE -1
+
+/*----------------------------------------------------------------------------
+  Classification kernels
+  ----------------------------------------------------------------------------
+  The kernel classifies the input 64 bytes at a time. The automatic choice
+  is the widest kernel the processor supports.
+  ----------------------------------------------------------------------------*/
+
+#define SMART_TOKENIZER_KERNEL_AUTO   0
+#define SMART_TOKENIZER_KERNEL_SCALAR 1
+#define SMART_TOKENIZER_KERNEL_SSSE3  2
+#define SMART_TOKENIZER_KERNEL_AVX2   3
+#define SMART_TOKENIZER_KERNEL_NEON   4
+
+#ifndef SMART_TOKENIZER_H
+
+/*----------------------------------------------------------------------------
+  Abstracted Smart Tokenizer object handle data types
+  ----------------------------------------------------------------------------*/
+
+typedef void * smartTokenizerHandle;
+
+#endif
+
+#endif
@@ -0,0 +1,1215 @@
+/*----------------------------------------------------------------------------
+  Smart Tokenizer
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Tokenizer test program implementation file
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Standard libraries
+  ----------------------------------------------------------------------------*/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*----------------------------------------------------------------------------
+  Public data types
+  ----------------------------------------------------------------------------*/
+
+#include "compilation.t.h"
+#include "types.t.h"
+
+#include "smart.memory.t.h"
+#include "smart.tokenizer.t.h"
+
+/*----------------------------------------------------------------------------
+  Public functions
+  ----------------------------------------------------------------------------*/
+
+#include "smart.memory.i.h"
+
+#include "smart.tokenizer.i.h"
+
+/*----------------------------------------------------------------------------
+  Private defines, data types and function prototypes
+  ----------------------------------------------------------------------------*/
+
+#include "smart.tokenizer.test.h"
+
+/*----------------------------------------------------------------------------
+  <Eeek> Globals </Eeek>
+  ----------------------------------------------------------------------------*/
+
+smartTokenizerHandle gTokenizer;
+
+char gBuffer[TEST_RANDOM_SIZE];
+
+smartToken gTokens[TEST_RANDOM_SIZE];
+smartToken gNextTokens[TEST_RANDOM_SIZE];
+
+/*
+** W(ord), N(umber), P(unctuation), S(pace) and Q(uoted string) followed by
+** the length of each token
+*/
+
+testCase gCases[] = {
+    { "abc 123,x_y", NULL, NULL, SMART_TOKENIZER_NO_ESCAPE, "W3 S1 N3 P1 W3" },
+    { "  \t\n", NULL, NULL, SMART_TOKENIZER_NO_ESCAPE, "S4" },
+    { "a, b ,c", ",", NULL, SMART_TOKENIZER_NO_ESCAPE, "W1 P1 W3 P1 W1" },
+    { "say \"hi, \\\"you\\\"\" ok", NULL, "\"", '\\', "W3 S1 Q13 S1 W2" },
+    { "'open", NULL, "'", SMART_TOKENIZER_NO_ESCAPE, "Q5" },
+    { "x'a'y", NULL, "'", SMART_TOKENIZER_NO_ESCAPE, "W1 Q3 W1" },
+    { "3.14e5 v2", NULL, NULL, SMART_TOKENIZER_NO_ESCAPE, "N1 P1 N4 S1 W2" },
+    { "", NULL, NULL, SMART_TOKENIZER_NO_ESCAPE, "" }
+};
+
+/*----------------------------------------------------------------------------
+  Main
+  ----------------------------------------------------------------------------*/
+
+void main
+(
+    void
+)
+{
+    int lOption;
+
+    srand(TEST_SEED);
+
+    SmartTokenizerConstructSmartTokenizer(&gTokenizer);
+
+    do
+    {
+        printf("Option: ");
+
+        do
+        {
+            lOption = toupper(fgetc(stdin));
+        }
+        while (!isprint(lOption)); /* eat carriage returns (etc) */
+
+        switch ((char) lOption)
+        {
+            case '?':
+            {
+                DisplayOptions();
+                break;
+            }
+
+            case 'Q':
+            {
+                SmartTokenizerDestructSmartTokenizer(&gTokenizer);
+                break;
+            }
+
+            case 'K':
+            {
+                KnownAnswerTest();
+                break;
+            }
+
+            case 'R':
+            {
+                IteratedRandomTest();
+                break;
+            }
+
+            case 'S':
+            {
+                IteratedStreamTest();
+                break;
+            }
+
+            case 'P':
+            {
+                PerformanceTest();
+                break;
+            }
+
+            case 'F':
+            {
+                FileTest();
+                break;
+            }
+
+            case 'M':
+            {
+                IteratedParallelTest();
+                break;
+            }
+
+            case 'T':
+            {
+                ParallelPerformanceTest();
+                break;
+            }
+
+            default:
+            {
+                printf("Valid options are K,R,S,P,F,M,T,Q,?\n");
+                break;
+            }
+        }
+    }
+    while ('Q' != lOption);
+}
+
+void DisplayOptions
+(
+    void
+)
+{
+    printf("\n"
+           "Options:\n"
+           "(K) Known answer test\n"
+           "(R) Iterated random buffer test\n"
+           "(S) Iterated random stream test\n"
+           "(P) Iterated log text performance test\n"
+           "(F) Iterated mapped file test\n"
+           "(M) Iterated random parallel test\n"
+           "(T) Iterated log text parallel performance test\n\n"
+           "(Q) Quit\n"
+           "(?) Display this option list\n"
+           "\n");
+}
+
+void KnownAnswerTest
+(
+    void
+)
+{
+    size_t lCase;
+    size_t lCount;
+
+    smartToken lToken;
+
+    char lActual[256];
+    char * lCursor;
+
+    unsigned long lDisagreements = 0;
+
+    printf("\n");
+
+    for (lCase = 0; lCase < sizeof(gCases) / sizeof(gCases[0]); lCase++)
+    {
+        SmartTokenizerSetDelimiters(gTokenizer, gCases[lCase].delimiters, NULL == gCases[lCase].delimiters ? 0 : strlen(gCases[lCase].delimiters));
+        SmartTokenizerSetQuotes(gTokenizer, gCases[lCase].quotes, NULL == gCases[lCase].quotes ? 0 : strlen(gCases[lCase].quotes), gCases[lCase].escape);
+
+        SmartTokenizerBegin(gTokenizer, gCases[lCase].input, strlen(gCases[lCase].input));
+
+        lActual[0] = '\0';
+        lCursor = lActual;
+        lCount = 0;
+
+        while (SmartTokenizerNext(gTokenizer, &lToken))
+        {
+            lCursor += sprintf(lCursor, "%s%c%ld", 0 == lCount++ ? "" : " ", " WNPSQ"[lToken.tokenClass], lToken.length);
+        }
+
+        if (0 != strcmp(gCases[lCase].expected, lActual))
+        {
+            printf("Case %ld disagreement: expected \"%s\" tokenized \"%s\"\n", lCase, gCases[lCase].expected, lActual);
+
+            lDisagreements++;
+        }
+    }
+
+    SmartTokenizerSetDelimiters(gTokenizer, NULL, 0);
+    SmartTokenizerSetQuotes(gTokenizer, NULL, 0, SMART_TOKENIZER_NO_ESCAPE);
+
+    printf("%ld cases, %ld disagreements\n\n", sizeof(gCases) / sizeof(gCases[0]), lDisagreements);
+}
+
+void IteratedRandomTest
+(
+    void
+)
+{
+    unsigned long lIterations;
+    unsigned long lIteration;
+
+    size_t lSize;
+    size_t lIndex;
+    size_t lCount;
+    size_t lNextCount;
+    size_t lBatchCount;
+    size_t lCapacity;
+
+    const char * lDelimiterSets[] = { NULL, ",", ", \t\n", "" };
+    const char * lQuoteSets[] = { NULL, "\"", "\"'" };
+
+    const char * lDelimiters;
+    const char * lQuotes;
+    int lEscape;
+
+    printf("\n");
+    printf("Iterations: ");
+    scanf("%ld", &lIterations);
+
+    for (lIteration = 1; lIteration <= lIterations; lIteration++)
+    {
+        printf("Iteration : %ld ", lIteration);
+
+        lSize = (size_t) (rand() % TEST_RANDOM_SIZE);
+
+        for (lIndex = 0; lIndex < lSize; lIndex++)
+        {
+            gBuffer[lIndex] = (0 == rand() % 16) ? (char) (rand() % 256) : TEST_ALPHABET[rand() % (sizeof(TEST_ALPHABET) - 1)];
+        }
+
+        lDelimiters = lDelimiterSets[rand() % (sizeof(lDelimiterSets) / sizeof(lDelimiterSets[0]))];
+        lQuotes = lQuoteSets[rand() % (sizeof(lQuoteSets) / sizeof(lQuoteSets[0]))];
+        lEscape = (0 == rand() % 2) ? SMART_TOKENIZER_NO_ESCAPE : '\\';
+
+        /*
+        ** every kernel must produce the same tokens
+        */
+
+        if (!SmartTokenizerSetKernel(gTokenizer, SMART_TOKENIZER_KERNEL_SCALAR + (unsigned int) (rand() % TEST_KERNELS)))
+        {
+            SmartTokenizerSetKernel(gTokenizer, SMART_TOKENIZER_KERNEL_SCALAR);
+        }
+
+        SmartTokenizerSetDelimiters(gTokenizer, lDelimiters, NULL == lDelimiters ? 0 : strlen(lDelimiters));
+        SmartTokenizerSetQuotes(gTokenizer, lQuotes, NULL == lQuotes ? 0 : strlen(lQuotes), lEscape);
+
+        /*
+        ** tokenize once a token at a time and once in batches
+        */
+
+        SmartTokenizerBegin(gTokenizer, gBuffer, lSize);
+
+        for (lNextCount = 0; SmartTokenizerNext(gTokenizer, &gNextTokens[lNextCount]); lNextCount++)
+        {
+            /* collect the tokens */
+        }
+
+        printf(">");
+
+        SmartTokenizerBegin(gTokenizer, gBuffer, lSize);
+
+        lCapacity = 1 + (size_t) (rand() % TEST_BATCH_TOKENS);
+
+        for (lCount = 0; SmartTokenizerNextBatch(gTokenizer, &gTokens[lCount], TEST_RANDOM_SIZE - lCount < lCapacity ? TEST_RANDOM_SIZE - lCount : lCapacity, &lBatchCount); lCount += lBatchCount)
+        {
+            /* collect the batches */
+        }
+
+        if (lCount != lNextCount || 0 != memcmp(gTokens, gNextTokens, lCount * sizeof(smartToken)))
+        {
+            printf("Batch disagreement: %ld batched tokens %ld tokens\n", lCount, lNextCount);
+            break;
+        }
+
+        if (!CheckTokens(gBuffer, lSize, gTokens, lCount, lDelimiters, lQuotes, lEscape))
+        {
+            printf("Token disagreement: iteration %ld\n", lIteration);
+            break;
+        }
+
+        printf("<");
+
+        printf("\r");
+    }
+
+    SmartTokenizerSetDelimiters(gTokenizer, NULL, 0);
+    SmartTokenizerSetQuotes(gTokenizer, NULL, 0, SMART_TOKENIZER_NO_ESCAPE);
+    SmartTokenizerSetKernel(gTokenizer, SMART_TOKENIZER_KERNEL_AUTO);
+
+    printf("\n\n");
+}
+
+void IteratedStreamTest
+(
+    void
+)
+{
+    unsigned long lIterations;
+    unsigned long lIteration;
+
+    size_t lSize;
+    size_t lIndex;
+    size_t lCount;
+    size_t lStreamCount;
+    size_t lFed;
+    size_t lChunk;
+    size_t lCarryCapacity;
+    size_t lToken;
+
+    const char * lDelimiterSets[] = { NULL, ",", ", \t\n", "" };
+    const char * lQuoteSets[] = { NULL, "\"", "\"'" };
+
+    const char * lDelimiters;
+    const char * lQuotes;
+    const char * lText;
+    int lEscape;
+
+    Bool lAgree = TRUE;
+
+    printf("\n");
+    printf("Iterations: ");
+    scanf("%ld", &lIterations);
+
+    for (lIteration = 1; lAgree && lIteration <= lIterations; lIteration++)
+    {
+        printf("Iteration : %ld ", lIteration);
+
+        lSize = (size_t) (rand() % TEST_RANDOM_SIZE);
+
+        for (lIndex = 0; lIndex < lSize; lIndex++)
+        {
+            gBuffer[lIndex] = (0 == rand() % 16) ? (char) (rand() % 256) : TEST_ALPHABET[rand() % (sizeof(TEST_ALPHABET) - 1)];
+        }
+
+        lDelimiters = lDelimiterSets[rand() % (sizeof(lDelimiterSets) / sizeof(lDelimiterSets[0]))];
+        lQuotes = lQuoteSets[rand() % (sizeof(lQuoteSets) / sizeof(lQuoteSets[0]))];
+        lEscape = (0 == rand() % 2) ? SMART_TOKENIZER_NO_ESCAPE : '\\';
+
+        if (!SmartTokenizerSetKernel(gTokenizer, SMART_TOKENIZER_KERNEL_SCALAR + (unsigned int) (rand() % TEST_KERNELS)))
+        {
+            SmartTokenizerSetKernel(gTokenizer, SMART_TOKENIZER_KERNEL_SCALAR);
+        }
+
+        SmartTokenizerSetDelimiters(gTokenizer, lDelimiters, NULL == lDelimiters ? 0 : strlen(lDelimiters));
+        SmartTokenizerSetQuotes(gTokenizer, lQuotes, NULL == lQuotes ? 0 : strlen(lQuotes), lEscape);
+
+        /*
+        ** the whole buffer gives the tokens the stream must agree with
+        */
+
+        SmartTokenizerBegin(gTokenizer, gBuffer, lSize);
+
+        for (lCount = 0; SmartTokenizerNext(gTokenizer, &gTokens[lCount]); lCount++)
+        {
+            /* collect the tokens */
+        }
+
+        printf(">");
+
+        /*
+        ** half the streams carry any token whole, the others split the
+        ** longer tokens into pieces
+        */
+
+        lCarryCapacity = (0 == rand() % 2) ? TEST_RANDOM_SIZE : 1 + (size_t) (rand() % TEST_STREAM_CARRY);
+
+        SmartTokenizerBeginStream(gTokenizer, lCarryCapacity);
+
+        lStreamCount = 0;
+
+        for (lFed = 0; lAgree; lFed += lChunk)
+        {
+            if (lFed < lSize)
+            {
+                lChunk = (size_t) (rand() % (TEST_STREAM_CHUNK + 1));
+                lChunk = (lSize - lFed < lChunk) ? lSize - lFed : lChunk;
+
+                SmartTokenizerFeed(gTokenizer, gBuffer + lFed, lChunk);
+            }
+            else
+            {
+                lChunk = 0;
+
+                SmartTokenizerFinish(gTokenizer);
+            }
+
+            while (SmartTokenizerStreamNext(gTokenizer, &gNextTokens[lStreamCount], &lText))
+            {
+                if (0 != memcmp(lText, gBuffer + gNextTokens[lStreamCount].offset, gNextTokens[lStreamCount].length))
+                {
+                    printf("Text disagreement: token %ld\n", lStreamCount);
+
+                    lAgree = FALSE;
+                }
+
+                lStreamCount++;
+            }
+
+            if (lFed >= lSize)
+            {
+                break;
+            }
+        }
+
+        /*
+        ** each piece lies in a token of the same class, and is the whole
+        ** token when the token fits the carry buffer
+        */
+
+        for (lIndex = 0, lToken = 0; lAgree && lIndex < lStreamCount; lIndex++)
+        {
+            while (lToken < lCount && gTokens[lToken].offset + gTokens[lToken].length <= gNextTokens[lIndex].offset)
+            {
+                lToken++;
+            }
+
+            if (lToken == lCount ||
+                gTokens[lToken].tokenClass != gNextTokens[lIndex].tokenClass ||
+                gNextTokens[lIndex].offset + gNextTokens[lIndex].length > gTokens[lToken].offset + gTokens[lToken].length ||
+                (gTokens[lToken].length <= lCarryCapacity && 0 != memcmp(&gTokens[lToken], &gNextTokens[lIndex], sizeof(smartToken))))
+            {
+                printf("Stream disagreement: piece %ld token %ld\n", lIndex, lToken);
+
+                lAgree = FALSE;
+            }
+        }
+
+        if (lAgree && !CheckPieces(gNextTokens, lStreamCount, lSize))
+        {
+            printf("Stream disagreement: the pieces do not tile the buffer\n");
+
+            lAgree = FALSE;
+        }
+
+        printf("<");
+
+        printf("\r");
+    }
+
+    SmartTokenizerBegin(gTokenizer, NULL, 0);
+
+    SmartTokenizerSetDelimiters(gTokenizer, NULL, 0);
+    SmartTokenizerSetQuotes(gTokenizer, NULL, 0, SMART_TOKENIZER_NO_ESCAPE);
+    SmartTokenizerSetKernel(gTokenizer, SMART_TOKENIZER_KERNEL_AUTO);
+
+    printf("\n\n");
+}
+
+void PerformanceTest
+(
+    void
+)
+{
+    unsigned long lIterations;
+    unsigned long lIteration;
+
+    unsigned int lKernel;
+
+    char * lText = NULL;
+
+    size_t lSize;
+    size_t lCount;
+
+    unsigned long long lTokenCount;
+
+    smartToken lTokens[TEST_PERFORMANCE_BATCH];
+
+    struct timespec lStartTime;
+    struct timespec lEndTime;
+
+    double lSeconds;
+
+    const char * lKernelNames[] = { "Auto", "Scalar", "SSSE3", "AVX2", "NEON" };
+
+    printf("\n");
+    printf("Iterations: ");
+    scanf("%ld", &lIterations);
+
+    if (!SafeMalloc(&lText, TEST_PERFORMANCE_SIZE))
+    {
+        printf("Allocation failed\n");
+        return;
+    }
+
+    lSize = FillLogText(lText, TEST_PERFORMANCE_SIZE);
+
+    for (lKernel = SMART_TOKENIZER_KERNEL_SCALAR; lKernel < SMART_TOKENIZER_KERNEL_SCALAR + TEST_KERNELS; lKernel++)
+    {
+        if (!SmartTokenizerSetKernel(gTokenizer, lKernel))
+        {
+            continue;
+        }
+
+        lTokenCount = 0;
+        lSeconds = 0;
+
+        for (lIteration = 1; lIteration <= lIterations; lIteration++)
+        {
+            printf("Iteration : %ld ", lIteration);
+
+            timespec_get(&lStartTime, TIME_UTC);
+
+            SmartTokenizerBegin(gTokenizer, lText, lSize);
+
+            while (SmartTokenizerNextBatch(gTokenizer, lTokens, TEST_PERFORMANCE_BATCH, &lCount))
+            {
+                lTokenCount += lCount;
+            }
+
+            timespec_get(&lEndTime, TIME_UTC);
+
+            lSeconds += (double) (lEndTime.tv_sec - lStartTime.tv_sec) + ((double) (lEndTime.tv_nsec - lStartTime.tv_nsec)) / 1e9;
+
+            printf("\r");
+        }
+
+        printf("%-6s Tokenize Timer: %9.3f secs %9.1f MB/sec %12.0f tokens/sec\n", lKernelNames[lKernel], lSeconds, ((double) lIterations * (double) lSize) / (1024.0 * 1024.0) / lSeconds, (double) lTokenCount / lSeconds);
+    }
+
+    printf("\n");
+
+    SmartTokenizerSetKernel(gTokenizer, SMART_TOKENIZER_KERNEL_AUTO);
+
+    SafeFree(&lText);
+}
+
+void FileTest
+(
+    void
+)
+{
+    unsigned long lIterations;
+    unsigned long lIteration;
+
+    char * lText = NULL;
+    char * lRead = NULL;
+
+    const char * lMapped;
+
+    size_t lSize;
+    size_t lMappedSize;
+    size_t lCount;
+    size_t lTextCount;
+
+    unsigned long long lTokenCount;
+
+    smartToken lTokens[TEST_PERFORMANCE_BATCH];
+    smartToken lTextTokens[TEST_PERFORMANCE_BATCH];
+
+    smartTokenizerHandle lTextTokenizer = NULL;
+
+    struct timespec lStartTime;
+    struct timespec lEndTime;
+
+    double lMapSeconds = 0;
+    double lReadSeconds = 0;
+
+    FILE * lFile;
+
+    printf("\n");
+    printf("Iterations: ");
+    scanf("%ld", &lIterations);
+
+    if (!SafeMalloc(&lText, TEST_PERFORMANCE_SIZE) || !SafeMalloc(&lRead, TEST_PERFORMANCE_SIZE))
+    {
+        printf("Allocation failed\n");
+
+        SafeFree(&lText);
+
+        return;
+    }
+
+    lSize = FillLogText(lText, TEST_PERFORMANCE_SIZE);
+
+    /*
+    ** an empty file has no tokens
+    */
+
+    lFile = fopen(TEST_FILE_NAME, "wb");
+
+    if (NULL == lFile)
+    {
+        printf("File creation failed\n");
+
+        SafeFree(&lRead);
+        SafeFree(&lText);
+
+        return;
+    }
+
+    fclose(lFile);
+
+    if (!SmartTokenizerOpenFile(gTokenizer, TEST_FILE_NAME, &lMapped, &lMappedSize) || 0 != lMappedSize || SmartTokenizerNext(gTokenizer, &lTokens[0]))
+    {
+        printf("Empty file disagreement\n");
+    }
+
+    lFile = fopen(TEST_FILE_NAME, "wb");
+
+    if (NULL == lFile || lSize != fwrite(lText, 1, lSize, lFile))
+    {
+        printf("File write failed\n");
+    }
+
+    if (NULL != lFile)
+    {
+        fclose(lFile);
+    }
+
+    /*
+    ** the tokens of the mapped file must be those of the text it was
+    ** written from
+    */
+
+    SmartTokenizerConstructSmartTokenizer(&lTextTokenizer);
+
+    /*
+    ** the tokens are compared whole, padding included
+    */
+
+    memset(lTokens, 0, sizeof(lTokens));
+    memset(lTextTokens, 0, sizeof(lTextTokens));
+
+    if (!SmartTokenizerOpenFile(gTokenizer, TEST_FILE_NAME, &lMapped, &lMappedSize) || lSize != lMappedSize || 0 != memcmp(lMapped, lText, lSize))
+    {
+        printf("Mapped file disagreement\n");
+    }
+    else
+    {
+        SmartTokenizerBegin(lTextTokenizer, lText, lSize);
+
+        while (SmartTokenizerNextBatch(gTokenizer, lTokens, TEST_PERFORMANCE_BATCH, &lCount))
+        {
+            if (!SmartTokenizerNextBatch(lTextTokenizer, lTextTokens, lCount, &lTextCount) || lCount != lTextCount || 0 != memcmp(lTokens, lTextTokens, lCount * sizeof(smartToken)))
+            {
+                printf("Mapped token disagreement: offset %ld\n", lTokens[0].offset);
+                break;
+            }
+        }
+    }
+
+    SmartTokenizerDestructSmartTokenizer(&lTextTokenizer);
+
+    /*
+    ** time the file mapped against the file read into a buffer, the file
+    ** is most likely cached for both
+    */
+
+    lTokenCount = 0;
+
+    for (lIteration = 1; lIteration <= lIterations; lIteration++)
+    {
+        printf("Iteration : %ld ", lIteration);
+
+        timespec_get(&lStartTime, TIME_UTC);
+
+        SmartTokenizerOpenFile(gTokenizer, TEST_FILE_NAME, &lMapped, &lMappedSize);
+
+        while (SmartTokenizerNextBatch(gTokenizer, lTokens, TEST_PERFORMANCE_BATCH, &lCount))
+        {
+            lTokenCount += lCount;
+        }
+
+        SmartTokenizerCloseFile(gTokenizer);
+
+        timespec_get(&lEndTime, TIME_UTC);
+
+        lMapSeconds += (double) (lEndTime.tv_sec - lStartTime.tv_sec) + ((double) (lEndTime.tv_nsec - lStartTime.tv_nsec)) / 1e9;
+
+        printf(">");
+
+        timespec_get(&lStartTime, TIME_UTC);
+
+        lFile = fopen(TEST_FILE_NAME, "rb");
+
+        lMappedSize = (NULL == lFile) ? 0 : fread(lRead, 1, TEST_PERFORMANCE_SIZE, lFile);
+
+        if (NULL != lFile)
+        {
+            fclose(lFile);
+        }
+
+        SmartTokenizerBegin(gTokenizer, lRead, lMappedSize);
+
+        while (SmartTokenizerNextBatch(gTokenizer, lTokens, TEST_PERFORMANCE_BATCH, &lCount))
+        {
+            /* tokenize the buffer */
+        }
+
+        timespec_get(&lEndTime, TIME_UTC);
+
+        lReadSeconds += (double) (lEndTime.tv_sec - lStartTime.tv_sec) + ((double) (lEndTime.tv_nsec - lStartTime.tv_nsec)) / 1e9;
+
+        printf("<");
+
+        printf("\r");
+    }
+
+    printf("Mapped Tokenize Timer: %9.3f secs %9.1f MB/sec %12.0f tokens/sec\n", lMapSeconds, ((double) lIterations * (double) lSize) / (1024.0 * 1024.0) / lMapSeconds, (double) lTokenCount / lMapSeconds);
+    printf("Read   Tokenize Timer: %9.3f secs %9.1f MB/sec\n", lReadSeconds, ((double) lIterations * (double) lSize) / (1024.0 * 1024.0) / lReadSeconds);
+
+    printf("\n");
+
+    SmartTokenizerBegin(gTokenizer, NULL, 0);
+
+    remove(TEST_FILE_NAME);
+
+    SafeFree(&lRead);
+    SafeFree(&lText);
+}
+
+void IteratedParallelTest
+(
+    void
+)
+{
+    unsigned long lIterations;
+    unsigned long lIteration;
+
+    size_t lSize;
+    size_t lIndex;
+    size_t lCount;
+    size_t lBatchCount;
+    size_t lThreads;
+    size_t lRangeCount;
+    size_t lRange;
+    size_t lToken;
+    size_t lOffset;
+    size_t lQuoteRarity;
+
+    const char * lDelimiterSets[] = { NULL, ",", ", \t\n", "" };
+    const char * lQuoteSets[] = { NULL, "\"", "\"'" };
+    const size_t lQuoteRarities[] = { 1, 64, 4096 };
+
+    const char * lDelimiters;
+    const char * lQuotes;
+    int lEscape;
+
+    char * lBuffer = NULL;
+
+    smartToken * lTokens = NULL;
+
+    smartTokenRange * lRanges = NULL;
+
+    Bool lAgree = TRUE;
+
+    printf("\n");
+    printf("Iterations: ");
+    scanf("%ld", &lIterations);
+
+    if (!SafeMalloc(&lBuffer, TEST_PARALLEL_SIZE) || !SafeMalloc(&lTokens, TEST_PARALLEL_SIZE * sizeof(smartToken)))
+    {
+        printf("Allocation failed\n");
+
+        SafeFree(&lBuffer);
+
+        return;
+    }
+
+    for (lIteration = 1; lAgree && lIteration <= lIterations; lIteration++)
+    {
+        printf("Iteration : %ld ", lIteration);
+
+        lSize = (size_t) ((((unsigned long long) rand() << 16) ^ (unsigned long long) rand()) % TEST_PARALLEL_SIZE);
+
+        /*
+        ** the rarer the quotes the longer the strings, and the more often a
+        ** split lands inside one
+        */
+
+        lQuoteRarity = lQuoteRarities[rand() % (sizeof(lQuoteRarities) / sizeof(lQuoteRarities[0]))];
+
+        for (lIndex = 0; lIndex < lSize; lIndex++)
+        {
+            lBuffer[lIndex] = (0 == rand() % 16) ? (char) (rand() % 256) : TEST_ALPHABET[rand() % (sizeof(TEST_ALPHABET) - 1)];
+
+            if (('"' == lBuffer[lIndex] || '\'' == lBuffer[lIndex]) && 0 != rand() % lQuoteRarity)
+            {
+                lBuffer[lIndex] = 'a';
+            }
+        }
+
+        lDelimiters = lDelimiterSets[rand() % (sizeof(lDelimiterSets) / sizeof(lDelimiterSets[0]))];
+        lQuotes = lQuoteSets[rand() % (sizeof(lQuoteSets) / sizeof(lQuoteSets[0]))];
+        lEscape = (0 == rand() % 2) ? SMART_TOKENIZER_NO_ESCAPE : '\\';
+
+        if (!SmartTokenizerSetKernel(gTokenizer, SMART_TOKENIZER_KERNEL_SCALAR + (unsigned int) (rand() % TEST_KERNELS)))
+        {
+            SmartTokenizerSetKernel(gTokenizer, SMART_TOKENIZER_KERNEL_SCALAR);
+        }
+
+        SmartTokenizerSetDelimiters(gTokenizer, lDelimiters, NULL == lDelimiters ? 0 : strlen(lDelimiters));
+        SmartTokenizerSetQuotes(gTokenizer, lQuotes, NULL == lQuotes ? 0 : strlen(lQuotes), lEscape);
+
+        SmartTokenizerBegin(gTokenizer, lBuffer, lSize);
+
+        for (lCount = 0; SmartTokenizerNextBatch(gTokenizer, &lTokens[lCount], TEST_PERFORMANCE_BATCH, &lBatchCount); lCount += lBatchCount)
+        {
+            /* collect the batches */
+        }
+
+        printf(">");
+
+        lThreads = 1 + (size_t) (rand() % TEST_PARALLEL_THREADS);
+
+        if (!SmartTokenizerTokenizeParallel(gTokenizer, lBuffer, lSize, lThreads, &lRanges, &lRangeCount))
+        {
+            printf("Parallel tokenize failed\n");
+            break;
+        }
+
+        /*
+        ** the ranges tile the buffer and their tokens, in order, are those
+        ** of the whole buffer
+        */
+
+        lToken = 0;
+        lOffset = 0;
+
+        for (lRange = 0; lAgree && lRange < lRangeCount; lRange++)
+        {
+            if (lOffset != lRanges[lRange].offset)
+            {
+                lAgree = FALSE;
+            }
+
+            for (lIndex = 0; lAgree && lIndex < lRanges[lRange].count; lIndex++, lToken++)
+            {
+                if (lToken == lCount ||
+                    lTokens[lToken].offset != lRanges[lRange].tokens[lIndex].offset ||
+                    lTokens[lToken].length != lRanges[lRange].tokens[lIndex].length ||
+                    lTokens[lToken].tokenClass != lRanges[lRange].tokens[lIndex].tokenClass)
+                {
+                    lAgree = FALSE;
+                }
+
+                lOffset += lRanges[lRange].tokens[lIndex].length;
+            }
+
+            if (lOffset != lRanges[lRange].offset + lRanges[lRange].length)
+            {
+                lAgree = FALSE;
+            }
+        }
+
+        if (!lAgree || lToken != lCount || lOffset != lSize)
+        {
+            printf("Parallel disagreement: range %ld token %ld of %ld\n", lRange, lToken, lCount);
+
+            lAgree = FALSE;
+        }
+
+        SmartTokenizerFreeRanges(&lRanges, lRangeCount);
+
+        printf("<");
+
+        printf("\r");
+    }
+
+    SmartTokenizerBegin(gTokenizer, NULL, 0);
+
+    SmartTokenizerSetDelimiters(gTokenizer, NULL, 0);
+    SmartTokenizerSetQuotes(gTokenizer, NULL, 0, SMART_TOKENIZER_NO_ESCAPE);
+    SmartTokenizerSetKernel(gTokenizer, SMART_TOKENIZER_KERNEL_AUTO);
+
+    SafeFree(&lTokens);
+    SafeFree(&lBuffer);
+
+    printf("\n\n");
+}
+
+void ParallelPerformanceTest
+(
+    void
+)
+{
+    unsigned long lIterations;
+    unsigned long lIteration;
+
+    size_t lThreads;
+    size_t lRangeCount;
+    size_t lRange;
+
+    char * lText = NULL;
+
+    size_t lSize;
+
+    unsigned long long lTokenCount;
+
+    smartTokenRange * lRanges = NULL;
+
+    struct timespec lStartTime;
+    struct timespec lEndTime;
+
+    double lSeconds;
+
+    printf("\n");
+    printf("Iterations: ");
+    scanf("%ld", &lIterations);
+
+    if (!SafeMalloc(&lText, TEST_PERFORMANCE_SIZE))
+    {
+        printf("Allocation failed\n");
+        return;
+    }
+
+    lSize = FillLogText(lText, TEST_PERFORMANCE_SIZE);
+
+    /*
+    ** the log text has quoted strings, so some splits land inside one
+    */
+
+    SmartTokenizerSetQuotes(gTokenizer, "\"", 1, '\\');
+
+    for (lThreads = 1; lThreads <= TEST_PARALLEL_THREADS; lThreads *= 2)
+    {
+        lTokenCount = 0;
+        lSeconds = 0;
+
+        for (lIteration = 1; lIteration <= lIterations; lIteration++)
+        {
+            printf("Iteration : %ld ", lIteration);
+
+            timespec_get(&lStartTime, TIME_UTC);
+
+            if (SmartTokenizerTokenizeParallel(gTokenizer, lText, lSize, lThreads, &lRanges, &lRangeCount))
+            {
+                for (lRange = 0; lRange < lRangeCount; lRange++)
+                {
+                    lTokenCount += lRanges[lRange].count;
+                }
+
+                SmartTokenizerFreeRanges(&lRanges, lRangeCount);
+            }
+
+            timespec_get(&lEndTime, TIME_UTC);
+
+            lSeconds += (double) (lEndTime.tv_sec - lStartTime.tv_sec) + ((double) (lEndTime.tv_nsec - lStartTime.tv_nsec)) / 1e9;
+
+            printf("\r");
+        }
+
+        printf("%ld Thread(s) Tokenize Timer: %9.3f secs %9.1f MB/sec %12.0f tokens/sec\n", lThreads, lSeconds, ((double) lIterations * (double) lSize) / (1024.0 * 1024.0) / lSeconds, (double) lTokenCount / lSeconds);
+    }
+
+    printf("\n");
+
+    SmartTokenizerSetQuotes(gTokenizer, NULL, 0, SMART_TOKENIZER_NO_ESCAPE);
+
+    SafeFree(&lText);
+}
+
+Bool CheckTokens
+(
+    const char * pBuffer,
+    size_t pSize,
+    smartToken * pTokens,
+    size_t pCount,
+    const char * pDelimiters,
+    const char * pQuotes,
+    int pEscape
+)
+{
+    Bool lDelimiter[256];
+    Bool lSpace[256];
+    Bool lQuote[256];
+
+    const unsigned char * lBuffer = (const unsigned char *) pBuffer;
+
+    size_t lIndex;
+    size_t lToken;
+    size_t lOffset = 0;
+    size_t lEnd;
+
+    unsigned char lByte;
+
+    memset(lDelimiter, 0, sizeof(lDelimiter));
+    memset(lSpace, 0, sizeof(lSpace));
+    memset(lQuote, 0, sizeof(lQuote));
+
+    if (NULL == pDelimiters)
+    {
+        pDelimiters = TEST_DEFAULT_DELIMITERS;
+    }
+
+    for (lIndex = 0; '\0' != pDelimiters[lIndex]; lIndex++)
+    {
+        lByte = (unsigned char) pDelimiters[lIndex];
+
+        lDelimiter[lByte] = TRUE;
+        lSpace[lByte] = (NULL != strchr(" \t\r\n\v\f", lByte));
+    }
+
+    for (lIndex = 0; NULL != pQuotes && '\0' != pQuotes[lIndex]; lIndex++)
+    {
+        lQuote[(unsigned char) pQuotes[lIndex]] = TRUE;
+    }
+
+    for (lToken = 0; lToken < pCount; lToken++)
+    {
+        /*
+        ** the tokens tile the buffer
+        */
+
+        if (lOffset != pTokens[lToken].offset || 0 == pTokens[lToken].length)
+        {
+            return(FALSE);
+        }
+
+        lEnd = lOffset + pTokens[lToken].length;
+        lByte = lBuffer[lOffset];
+
+        switch (pTokens[lToken].tokenClass)
+        {
+            case SMART_TOKEN_STRING:
+            {
+                if (!lQuote[lByte])
+                {
+                    return(FALSE);
+                }
+
+                for (lIndex = lOffset + 1; lIndex < pSize && lByte != lBuffer[lIndex]; lIndex++)
+                {
+                    if (pEscape == (int) lBuffer[lIndex])
+                    {
+                        lIndex++;
+                    }
+                }
+
+                if ((lIndex < pSize ? lIndex + 1 : pSize) != lEnd)
+                {
+                    return(FALSE);
+                }
+
+                break;
+            }
+
+            case SMART_TOKEN_WORD:
+            case SMART_TOKEN_NUMBER:
+            {
+                if ((SMART_TOKEN_NUMBER == pTokens[lToken].tokenClass) != ('0' <= lByte && '9' >= lByte))
+                {
+                    return(FALSE);
+                }
+
+                for (lIndex = lOffset; lIndex < lEnd; lIndex++)
+                {
+                    if (lDelimiter[lBuffer[lIndex]] || lQuote[lBuffer[lIndex]])
+                    {
+                        return(FALSE);
+                    }
+                }
+
+                if (lEnd < pSize && !lDelimiter[lBuffer[lEnd]] && !lQuote[lBuffer[lEnd]])
+                {
+                    return(FALSE);
+                }
+
+                break;
+            }
+
+            case SMART_TOKEN_WHITESPACE:
+            {
+                for (lIndex = lOffset; lIndex < lEnd; lIndex++)
+                {
+                    if (!lSpace[lBuffer[lIndex]] || lQuote[lBuffer[lIndex]])
+                    {
+                        return(FALSE);
+                    }
+                }
+
+                if (lEnd < pSize && lSpace[lBuffer[lEnd]] && !lQuote[lBuffer[lEnd]])
+                {
+                    return(FALSE);
+                }
+
+                break;
+            }
+
+            case SMART_TOKEN_PUNCTUATION:
+            {
+                if (1 != pTokens[lToken].length || !lDelimiter[lByte] || lSpace[lByte] || lQuote[lByte])
+                {
+                    return(FALSE);
+                }
+
+                break;
+            }
+
+            default:
+            {
+                return(FALSE);
+            }
+        }
+
+        lOffset = lEnd;
+    }
+
+    return(pSize == lOffset);
+}
+
+Bool CheckPieces
+(
+    smartToken * pTokens,
+    size_t pCount,
+    size_t pSize
+)
+{
+    size_t lToken;
+    size_t lOffset = 0;
+
+    for (lToken = 0; lToken < pCount; lToken++)
+    {
+        if (lOffset != pTokens[lToken].offset || 0 == pTokens[lToken].length)
+        {
+            return(FALSE);
+        }
+
+        lOffset += pTokens[lToken].length;
+    }
+
+    return(pSize == lOffset);
+}
+
+size_t FillLogText
+(
+    char * pBuffer,
+    size_t pSize
+)
+{
+    static const char * lLevels[] = { "INFO", "WARN", "DEBUG", "ERROR" };
+    static const char * lPaths[] = { "/api/v1/items", "/api/v1/users/search", "/health", "/static/app.js" };
+
+    char lLine[256];
+
+    size_t lLength;
+    size_t lSize = 0;
+
+    for (;;)
+    {
+        lLength = (size_t) sprintf(lLine, "2026-10-17 %02d:%02d:%02d.%03d %s [worker-%d] request id=%d path=%s status=%d bytes=%d elapsed=%d.%03ds user=\"%s\"\n",
+                                   rand() % 24, rand() % 60, rand() % 60, rand() % 1000, lLevels[rand() % 4], rand() % 64, rand(), lPaths[rand() % 4],
+                                   200 + 100 * (rand() % 4), rand() % 100000, rand() % 3, rand() % 1000, 0 == rand() % 2 ? "anonymous" : "jane doe");
+
+        if (lSize + lLength > pSize)
+        {
+            return(lSize);
+        }
+
+        memcpy(pBuffer + lSize, lLine, lLength);
+
+        lSize += lLength;
+    }
+}
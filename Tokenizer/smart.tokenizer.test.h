@@ -0,0 +1,144 @@
+/*----------------------------------------------------------------------------
+  Smart Tokenizer
+ 
+  Copyright 2010 John L. Hart IV. All rights reserved.
+ 
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+ 
+  1. Redistributions of source code must retain the above copyright notice,
+     this list of conditions and the following disclaimer.
+ 
+  2. Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in the
+     documentation and/or other materials provided with the distribution.
+ 
+  THIS SOFTWARE IS PROVIDED BY John L. Hart IV ``AS IS'' AND ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+  NO EVENT SHALL John L. Hart IV OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+ 
+  The views and conclusions contained in the software and documentation are
+  those of the authors and should not be interpreted as representing official
+  policies, either expressed or implied, of John L Hart IV.
+  ----------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------
+  Smart Tokenizer test program header file
+  ----------------------------------------------------------------------------*/
+
+#ifndef SMART_TOKENIZER_TEST_H
+#define SMART_TOKENIZER_TEST_H
+
+#define TEST_RANDOM_SIZE 4096
+#define TEST_BATCH_TOKENS 64
+
+#define TEST_STREAM_CHUNK 96
+#define TEST_STREAM_CARRY 16
+
+#define TEST_PERFORMANCE_SIZE ((size_t) 64 * 1024 * 1024)
+#define TEST_PERFORMANCE_BATCH 1024
+
+#define TEST_PARALLEL_SIZE ((size_t) 1024 * 1024)
+#define TEST_PARALLEL_THREADS 8
+
+#define TEST_FILE_NAME "smart.tokenizer.test.txt"
+
+#define TEST_KERNELS 4                                              /* scalar, SSSE3, AVX2 and NEON */
+
+#define TEST_DEFAULT_DELIMITERS " \t\r\n\v\f!\"#$%&'()*+,-./:;<=>?@[\\]^`{|}~"
+
+#define TEST_ALPHABET "abcXYZ_019 \t\n,.;=\"'\\"
+
+#define TEST_SEED 1
+
+/*----------------------------------------------------------------------------
+  Private data types
+  ----------------------------------------------------------------------------*/
+
+typedef struct testCase {
+    const char * input;
+
+    const char * delimiters;
+    const char * quotes;
+    int escape;
+
+    const char * expected;
+} testCase;
+
+/*----------------------------------------------------------------------------
+  Private function prototypes
+  ----------------------------------------------------------------------------*/
+
+void DisplayOptions
+(
+    void
+);
+
+void KnownAnswerTest
+(
+    void
+);
+
+void IteratedRandomTest
+(
+    void
+);
+
+void IteratedStreamTest
+(
+    void
+);
+
+void PerformanceTest
+(
+    void
+);
+
+void FileTest
+(
+    void
+);
+
+void IteratedParallelTest
+(
+    void
+);
+
+void ParallelPerformanceTest
+(
+    void
+);
+
+Bool CheckTokens
+(
+    const char * pBuffer,
+    size_t pSize,
+    smartToken * pTokens,
+    size_t pCount,
+    const char * pDelimiters,
+    const char * pQuotes,
+    int pEscape
+);
+
+Bool CheckPieces
+(
+    smartToken * pTokens,
+    size_t pCount,
+    size_t pSize
+);
+
+size_t FillLogText
+(
+    char * pBuffer,
+    size_t pSize
+);
+
+#endif
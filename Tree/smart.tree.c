@@ -47,6 +47,7 @@
 
 #include "compilation.t.h"
 #include "types.t.h"
+#include "smart.memory.t.h"
 #include "smart.memory.i.h"
 
 /*----------------------------------------------------------------------------
@@ -71,24 +72,59 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeConstructSmartTree
     long (* pCompareKeyFunction)(const smartTreeKeyHandle pKey1, const smartTreeKeyHandle pKey2),
 	size_t pMemoryMaximum
 )
+{
+	return(SmartTreeConstructSmartTreeWithAllocator(pTree, pCompareKeyFunction, pMemoryMaximum, NULL));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeConstructSmartTreeWithAllocator
+(
+    smartTreeHandle * pTree,
+    long (* pCompareKeyFunction)(const smartTreeKeyHandle pKey1, const smartTreeKeyHandle pKey2),
+	size_t pMemoryMaximum,
+	smartAllocatorHandle pAllocator
+)
+{
+	return(SmartTreeConstructSmartTreeWithBudget(pTree, pCompareKeyFunction, pMemoryMaximum, NULL, pAllocator));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeConstructSmartTreeWithBudget
+(
+    smartTreeHandle * pTree,
+    long (* pCompareKeyFunction)(const smartTreeKeyHandle pKey1, const smartTreeKeyHandle pKey2),
+	size_t pMemoryMaximum,
+	smartBudgetHandle pBudget,
+	smartAllocatorHandle pAllocator
+)
 {
     if (NULL == pCompareKeyFunction)
 	{
 		return(FALSE);
 	}
     
-	if (!SafeMalloc(pTree, sizeof(smartTree)))
+	if (!SafeAllocatorMalloc(pAllocator, (void **) pTree, sizeof(smartTree)))
 	{
 		return(FALSE);
 	}
 
+    (* pTree)->allocator = pAllocator;
+
     (* pTree)->compareKeyFunction = pCompareKeyFunction;
 
-	(* pTree)->memoryMaximum = pMemoryMaximum;
-	(* pTree)->memoryAllocated = sizeof(smartTree);
+	(* pTree)->budget = NULL;
+
+	if (!SmartBudgetConstructSmartBudgetWithAllocator(&(* pTree)->budget, pMemoryMaximum, pBudget, pAllocator) || !SmartBudgetReserve((* pTree)->budget, sizeof(smartTree)))
+	{
+		SmartBudgetDestructSmartBudget(&(* pTree)->budget);
+
+		SafeAllocatorFree(pAllocator, (void **) pTree, sizeof(smartTree));
+
+		return(FALSE);
+	}
 
     (* pTree)->root = NULL;
 
+	(* pTree)->nodeAlignment = 0;
+
 	return(TRUE);
 }
 
@@ -116,7 +152,12 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeConstructNode
 		return(FALSE);
 	}
 
-	if (pTree->memoryMaximum > 0 && pTree->memoryMaximum < pTree->memoryAllocated + sizeof(smartTreeNode) + pKeySize + pDataSize)
+	/*
+	** reserve the memory for all of the objects at once so that concurrent
+	** constructors cannot take the tree over its maximum
+	*/
+
+	if (!SmartBudgetReserve(pTree->budget, sizeof(smartTreeNode) + pKeySize + pDataSize))
 	{
 		return(FALSE);
 	}
@@ -125,22 +166,28 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeConstructNode
 	** allocate memory for the objects
 	*/
 
-    if (!SmartMalloc(pNode, sizeof(smartTreeNode), &pTree->memoryAllocated))
+    if (!SafeAllocatorMalloc(pTree->allocator, (void **) pNode, sizeof(smartTreeNode)))
 	{
+		SmartBudgetRelease(pTree->budget, sizeof(smartTreeNode) + pKeySize + pDataSize);
+
 		return(FALSE);
 	}
 
-    if (!SmartMalloc(pKey, pKeySize, &pTree->memoryAllocated))
+    if (!SafeAllocatorAlignedMalloc(pTree->allocator, pKey, pKeySize, pTree->nodeAlignment))
 	{
-		SmartFree(pNode, sizeof(smartTreeNode), &pTree->memoryAllocated);
+		SafeAllocatorFree(pTree->allocator, (void **) pNode, sizeof(smartTreeNode));
+
+		SmartBudgetRelease(pTree->budget, sizeof(smartTreeNode) + pKeySize + pDataSize);
 
 		return(FALSE);
 	}
 
-    if (!SmartMalloc(pData, pDataSize, &pTree->memoryAllocated))
+    if (!SafeAllocatorAlignedMalloc(pTree->allocator, pData, pDataSize, pTree->nodeAlignment))
 	{
-		SmartFree(pKey, pKeySize, &pTree->memoryAllocated);
-		SmartFree(pNode, sizeof(smartTreeNode), &pTree->memoryAllocated);
+		SafeAllocatorAlignedFree(pTree->allocator, pKey, pKeySize, pTree->nodeAlignment);
+		SafeAllocatorFree(pTree->allocator, (void **) pNode, sizeof(smartTreeNode));
+
+		SmartBudgetRelease(pTree->budget, sizeof(smartTreeNode) + pKeySize + pDataSize);
 
 		return(FALSE);
 	}
@@ -914,22 +961,24 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeDestructNode
     smartTreeNodeHandle * pNode
 )
 {
-	if (!SmartFree(&(* pNode)->data, (* pNode)->dataSize, &pTree->memoryAllocated))
+	size_t lNodeSize = sizeof(smartTreeNode) + (* pNode)->keySize + (* pNode)->dataSize;
+
+	if (!SafeAllocatorAlignedFree(pTree->allocator, &(* pNode)->data, (* pNode)->dataSize, pTree->nodeAlignment))
 	{
 		return(FALSE);
 	}
 
-	if (!SmartFree(&(* pNode)->key, (* pNode)->keySize, &pTree->memoryAllocated))
+	if (!SafeAllocatorAlignedFree(pTree->allocator, &(* pNode)->key, (* pNode)->keySize, pTree->nodeAlignment))
 	{
 		return(FALSE);
 	}
 
-	if (!SmartFree(pNode, sizeof(smartTreeNode), &pTree->memoryAllocated))
+	if (!SafeAllocatorFree(pTree->allocator, (void **) pNode, sizeof(smartTreeNode)))
 	{
 		return(FALSE);
 	}
 
-	return(TRUE);
+	return(SmartBudgetRelease(pTree->budget, lNodeSize));
 }
 
 STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeDestructSmartTree
@@ -946,12 +995,21 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeDestructSmartTree
         return(FALSE);
     }
 
-    if (!SubtreePrune(*pTree, &(* pTree)->root))
-	{
-		return(FALSE);
-	}
+    /*
+    ** nodes allocated from a region are released with the region
+    */
+
+    if (NULL == (* pTree)->allocator || NULL != (* pTree)->allocator->deallocate)
+    {
+        if (!SubtreePrune(*pTree, &(* pTree)->root))
+		{
+			return(FALSE);
+		}
+    }
+
+    SmartBudgetDestructSmartBudget(&(* pTree)->budget);
 
-    if (!SafeFree(pTree))
+    if (!SafeAllocatorFree((* pTree)->allocator, (void **) pTree, sizeof(smartTree)))
 	{
 		return(FALSE);
 	}
@@ -991,6 +1049,59 @@ STORAGE_CLASS long CALLING_CONVENTION SmartTreeGetMaxDepth
 	return((lLesserDepth > lGreaterDepth) ? (1 + lLesserDepth) : (1 + lGreaterDepth));
 }
 
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeSetPressureFunction
+(
+	smartTreeHandle pTree,
+	smartPressureFunction pPressureFunction,
+	void * pContext
+)
+{
+    /*
+    ** there is no tree
+    */
+
+	if (NULL == pTree)
+	{
+		return(FALSE);
+	}
+
+	return(SmartBudgetSetPressureFunction(pTree->budget, pPressureFunction, pContext));
+}
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeSetNodeAlignment
+(
+	smartTreeHandle pTree,
+	size_t pAlignment
+)
+{
+    /*
+    ** there is no tree
+    */
+
+	if (NULL == pTree)
+	{
+		return(FALSE);
+	}
+
+	if (0 != (pAlignment & (pAlignment - 1)))
+	{
+		return(FALSE);
+	}
+
+	/*
+	** nodes already constructed were allocated with the old alignment
+	*/
+
+	if (NULL != pTree->root || sizeof(smartTree) != SmartBudgetGetValue(pTree->budget))
+	{
+		return(FALSE);
+	}
+
+	pTree->nodeAlignment = pAlignment;
+
+	return(TRUE);
+}
+
 STORAGE_CLASS size_t CALLING_CONVENTION SmartTreeGetMemoryAllocated
 (
 	smartTreeHandle pTree
@@ -1005,7 +1116,7 @@ STORAGE_CLASS size_t CALLING_CONVENTION SmartTreeGetMemoryAllocated
 		return(0);
 	}
 
-	return(pTree->memoryAllocated);
+	return(SmartBudgetGetValue(pTree->budget));
 }
 
 STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeIsValid
@@ -78,8 +78,11 @@ typedef struct smartTree {
 
 	long (* compareKeyFunction)(const smartTreeKeyHandle pKey1, const smartTreeKeyHandle pKey2);
 	
-	size_t memoryMaximum;
-	size_t memoryAllocated;
+	smartAllocatorHandle allocator;
+
+	smartBudgetHandle budget;
+
+	size_t nodeAlignment;
 } smartTree;
 
 typedef smartTree * smartTreeHandle;
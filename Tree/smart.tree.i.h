@@ -84,6 +84,86 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeConstructSmartTree
 	size_t pMemoryMaximum
 );
 
+/*----------------------------------------------------------------------------
+  SmartTreeConstructSmartTreeWithAllocator()
+  ----------------------------------------------------------------------------
+  Construct an empty tree whose memory is obtained from an allocator.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTree                 - (I/O) Pointer to recieve the tree handle
+  pCompareKeyFunction   - (I)   Pointer to the node key comparison function
+  pMemoryMaximum        - (I)   The maximum number of bytes used by the tree
+  pAllocator            - (I)   The allocator handle (NULL selects Malloc())
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Tree was succesfully constructed
+
+  False - Tree was not successfully constructed due to:
+
+          1. The ComparisonKeyFunction was NULL
+          2. The SafeAllocatorMalloc() failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  This function behaves as SmartTreeConstructSmartTree() except that the tree
+  control structure and every node, key object and data object constructed
+  for the tree are allocated from (and returned to) the allocator. The
+  allocator must outlive the tree.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeConstructSmartTreeWithAllocator
+(
+    smartTreeHandle * pTree,
+    long (* pCompareKeyFunction)(const smartTreeKeyHandle pKey1, const smartTreeKeyHandle pKey2),
+	size_t pMemoryMaximum,
+	smartAllocatorHandle pAllocator
+);
+
+/*----------------------------------------------------------------------------
+  SmartTreeConstructSmartTreeWithBudget()
+  ----------------------------------------------------------------------------
+  Construct an empty tree whose memory is charged to a parent budget as well
+  as to the tree's own maximum.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTree                 - (I/O) Pointer to recieve the tree handle
+  pCompareKeyFunction   - (I)   Pointer to the node key comparison function
+  pMemoryMaximum        - (I)   The maximum number of bytes used by the tree
+  pBudget               - (I)   The parent budget handle (NULL for none)
+  pAllocator            - (I)   The allocator handle (NULL selects Malloc())
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - Tree was succesfully constructed
+
+  False - Tree was not successfully constructed due to:
+
+          1. The ComparisonKeyFunction was NULL
+          2. The SafeAllocatorMalloc() failed
+          3. The tree control structure would exceed the maximum of the tree
+             or of the parent budget (or one of its ancestors)
+  ----------------------------------------------------------------------------
+  Notes:
+
+  Each tree keeps its own budget for pMemoryMaximum whose parent is pBudget,
+  so a node is only constructed when it fits the tree, the tenant budget
+  passed in and every budget above that, all checked with a single
+  reservation. Destructing the tree hands its charge back to the parent
+  budget, which must outlive the tree.
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeConstructSmartTreeWithBudget
+(
+    smartTreeHandle * pTree,
+    long (* pCompareKeyFunction)(const smartTreeKeyHandle pKey1, const smartTreeKeyHandle pKey2),
+	size_t pMemoryMaximum,
+	smartBudgetHandle pBudget,
+	smartAllocatorHandle pAllocator
+);
+
 /*----------------------------------------------------------------------------
   SmartTreeConstructNode()
   ----------------------------------------------------------------------------
@@ -119,6 +199,12 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeConstructSmartTree
 
   Destructing a tree will destruct all associated nodes, key objects and data
   objects.
+
+  The bytes for the node, key object and data object are reserved against the
+  tree's maximum (and any parent budgets) in one atomic step before anything
+  is allocated, so threads constructing nodes for a shared tree at the same
+  time can neither lose updates to the tree's memory count nor take it over
+  its maximum.
   ----------------------------------------------------------------------------*/
 
 STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeConstructNode
@@ -506,6 +592,12 @@ STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeDestructNode
 		  3. The destruction of a node data object failed
           4. The SafeFree() of a node failed
 		  5. The SafeFree() of the tree failed
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The nodes of a tree bound to a region allocator (an allocator without a
+  deallocate function such as a Smart Arena) are not visited, they are
+  released all at once with the region.
   ----------------------------------------------------------------------------*/
 
 STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeDestructSmartTree
@@ -565,6 +657,82 @@ STORAGE_CLASS long CALLING_CONVENTION SmartTreeGetMaxDepth
 	smartTreeNodeHandle pNode
 );
 
+/*----------------------------------------------------------------------------
+  SmartTreeSetPressureFunction()
+  ----------------------------------------------------------------------------
+  Register a function to be called when constructing a node would take the
+  tree over its maximum number of bytes.
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTree              - (I) The tree handle
+  pPressureFunction - (I) The pressure function, NULL to remove it
+  pContext          - (I) A pointer passed back to the pressure function
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The pressure function was registered
+
+  False - The tree handle was NULL
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The pressure function is called by SmartTreeConstructNode() with the
+  number of bytes the tree is short. It may delete and destruct nodes of the
+  tree (for example the least or the oldest) and return TRUE to have the
+  construction retried, or return FALSE to have it fail. This lets the
+  tree's maximum act as a cache limit.
+
+  The pressure function must not construct nodes itself. A parent budget
+  may register its own pressure function with
+  SmartBudgetSetPressureFunction().
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeSetPressureFunction
+(
+	smartTreeHandle pTree,
+	smartPressureFunction pPressureFunction,
+	void * pContext
+);
+
+/*----------------------------------------------------------------------------
+  SmartTreeSetNodeAlignment()
+  ----------------------------------------------------------------------------
+  Set the alignment of the key and data objects of the nodes constructed by
+  SmartTreeConstructNode().
+  ----------------------------------------------------------------------------
+  Parameters:
+
+  pTree      - (I) The tree handle
+  pAlignment - (I) The alignment, a power of two such as 64 for a cache line
+                   or 32 for an AVX register, or zero for the alignment of
+                   the allocator
+  ----------------------------------------------------------------------------
+  Return Values:
+
+  True  - The alignment was set
+
+  False - The alignment was not set due to one of the following:
+
+          1. The tree handle was NULL.
+          2. The alignment was not a power of two.
+          3. The tree already has nodes.
+  ----------------------------------------------------------------------------
+  Notes:
+
+  The alignment must be set before the first node is constructed, since
+  SmartTreeDestructNode() releases the objects with the same alignment.
+  Only the bytes requested are charged to the tree, not the padding used to
+  align them. A tree bound to an allocator without aligned allocation fails
+  to construct nodes with an alignment beyond that of Malloc().
+  ----------------------------------------------------------------------------*/
+
+STORAGE_CLASS Bool CALLING_CONVENTION SmartTreeSetNodeAlignment
+(
+	smartTreeHandle pTree,
+	size_t pAlignment
+);
+
 /*----------------------------------------------------------------------------
   SmartTreeGetmemoryAllocated()
   ----------------------------------------------------------------------------
@@ -39,6 +39,7 @@
   ----------------------------------------------------------------------------*/
 
 #include <ctype.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -52,6 +53,7 @@
 #include "types.t.h"
 #include "math.t.h"
 
+#include "smart.memory.t.h"
 #include "smart.tree.t.h"
 
 /*----------------------------------------------------------------------------
@@ -205,9 +207,15 @@ void main
                 break;
             }
 
+			case 'E':
+            {
+				EvictionTest();
+                break;
+            }
+
             default:
             {
-                printf("Valid options are C,F,L,G,U,X,R,P,T,D,S,A,Z,I,Q,?\n");
+                printf("Valid options are C,F,L,G,U,X,R,P,T,E,D,S,A,Z,I,Q,?\n");
                 break;
             }
         }
@@ -230,7 +238,8 @@ void DisplayOptions
 		   "(X) Delete current node\n\n"
 		   "(R) Remove all nodes\n\n"
 		   "(P) Iterated performance speed test\n"
-		   "(T) Iterated thorough test\n\n"
+		   "(T) Iterated thorough test\n"
+		   "(E) Memory pressure eviction test\n\n"
 		   "(D) Display tree disgramatically\n"
 		   "(S) Display tree structurally\n"
 		   "(A) Display nodes ordered A-Z\n"
@@ -823,6 +832,7 @@ void IteratedRandomSelfTest
 
 		SmartTreeDestructSmartTree(&gTree);
 		SmartTreeConstructSmartTree(&gTree, _compare, (size_t) 0);
+		SmartTreeSetNodeAlignment(gTree, TEST_NODE_ALIGNMENT);
 
 		if (lIteration > lIterations)
 		{
@@ -847,6 +857,11 @@ void IteratedRandomSelfTest
 
 			SmartTreeConstructNode(gTree, &gNodes[lNodeIndex], &lKeyPointer, sizeof(long), &lDataPointer, (size_t) DATA_ELEMENT_SIZE);
 
+			if (0 != ((uintptr_t) lKeyPointer & (TEST_NODE_ALIGNMENT - 1)) || 0 != ((uintptr_t) lDataPointer & (TEST_NODE_ALIGNMENT - 1)))
+			{
+				printf("Node alignment disagreement: node %ld key at %p data at %p\n", lNodeIndex + 1, lKeyPointer, lDataPointer);
+			}
+
 			*lKeyPointer = (rand() + rand() - RAND_MAX) % 99999;
 			sprintf(lDataPointer, "Entry #%06d", lNodeIndex + 1);
 
@@ -1149,6 +1164,105 @@ void IteratedRandomSelfPerformanceTest
 	printf("       Total: %7.3f%% %06.0f secs\n\n", 100.0, lTotalSeconds);
 }
 
+void EvictionTest
+(
+	void
+)
+{
+	smartTreeHandle lTree = NULL;
+
+	smartTreeNodeHandle lNode;
+
+    long * lKeyPointer;
+    char * lDataPointer;
+
+	unsigned long lNodeIndex;
+	unsigned long lEvictions = 0;
+
+	size_t lMemoryMaximum = (TEST_EVICTION_NODES + 1) * (TEST_EVICTION_NODE_SIZE + sizeof(long) + DATA_ELEMENT_SIZE);
+
+	Bool lPassed = TRUE;
+
+	/*
+	** a tree with room for a fixed number of nodes that evicts its least
+	** node whenever it is full
+	*/
+
+	if (!SmartTreeConstructSmartTree(&lTree, _compare, lMemoryMaximum))
+	{
+		return;
+	}
+
+	SmartTreeSetPressureFunction(lTree, EvictLeastNode, &lTree);
+
+	for (lNodeIndex = 0; lNodeIndex < TEST_NODES; lNodeIndex++)
+	{
+		lNode = NULL;
+		lKeyPointer = NULL;
+		lDataPointer = NULL;
+
+		if (!SmartTreeConstructNode(lTree, &lNode, &lKeyPointer, sizeof(long), &lDataPointer, (size_t) DATA_ELEMENT_SIZE))
+		{
+			lPassed = FALSE;
+			break;
+		}
+
+		*lKeyPointer = (long) rand();
+
+		sprintf(lDataPointer, "Creation Ordinal:%08ld", lNodeIndex);
+
+		if (!SmartTreeInsertNode(lTree, lNode))
+		{
+			SmartTreeDestructNode(lTree, &lNode);
+		}
+
+		if (lMemoryMaximum < SmartTreeGetMemoryAllocated(lTree))
+		{
+			lPassed = FALSE;
+		}
+	}
+
+	lEvictions = TEST_NODES - (unsigned long) SmartTreeGetNodeCount(SmartTreeGetRoot(lTree));
+
+	if (!SmartTreeIsValid(lTree))
+	{
+		lPassed = FALSE;
+	}
+
+	printf("\n");
+	printf("Nodes constructed = %ld\n", (unsigned long) TEST_NODES);
+	printf("Nodes evicted     = %ld\n", lEvictions);
+	printf("Nodes remaining   = %ld\n", SmartTreeGetNodeCount(SmartTreeGetRoot(lTree)));
+	printf("Memory Allocated  = %ld of %ld\n", SmartTreeGetMemoryAllocated(lTree), lMemoryMaximum);
+	printf("\n");
+	printf("Eviction test: %s\n\n", lPassed ? "OK" : "FAILED");
+
+	SmartTreeDestructSmartTree(&lTree);
+}
+
+Bool EvictLeastNode
+(
+	void * pTree,
+	size_t pShortfall
+)
+{
+	smartTreeHandle lTree = * (smartTreeHandle *) pTree;
+
+	smartTreeNodeHandle lNode = SmartTreeGetLeastNode(lTree);
+
+	(void) pShortfall;
+
+	if (NULL == lNode)
+	{
+		return(FALSE);
+	}
+
+	SmartTreeDeleteNode(lTree, lNode);
+	SmartTreeDestructNode(lTree, &lNode);
+
+	return(TRUE);
+}
+
 long _compare
 (
     const smartTreeKeyHandle pKey1,
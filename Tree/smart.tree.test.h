@@ -41,6 +41,11 @@
 
 #define DATA_ELEMENT_SIZE 64
 
+#define TEST_NODE_ALIGNMENT 64                         /* a cache line, for the self test */
+
+#define TEST_EVICTION_NODES     1000
+#define TEST_EVICTION_NODE_SIZE 64                     /* generous per node overhead */
+
 #ifdef UNPREDICTABLE_RANDOMNESS
 #define TEST_SEED ((unsigned int)time(NULL))
 #else
@@ -220,6 +225,17 @@ void IteratedRandomSelfPerformanceTest
 	void
 );
 
+void EvictionTest
+(
+	void
+);
+
+Bool EvictLeastNode
+(
+	void * pTree,
+	size_t pShortfall
+);
+
 long _compare
 (
     const smartTreeKeyHandle pKey1,
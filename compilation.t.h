@@ -67,4 +67,12 @@
 
 #endif
 
+/*----------------------------------------------------------------------------
+  Build options
+  ----------------------------------------------------------------------------*/
+
+/* Define SMART_MEMORY_PROFILE to compile allocation profiling into Smart Memory. */
+
+/* #define SMART_MEMORY_PROFILE */
+
 #endif
\ No newline at end of file